@@ -6,6 +6,7 @@
 #include <cmath>
 
 #include "../../include/dislocation_solver.h"
+#include "../../include/ensemble.h"
 
 using namespace dealii;
 
@@ -31,6 +32,31 @@ public:
   void
   run();
 
+  /** Set the parameters of a run of the parameter sweep, keys with prefixes
+   * \c problem, \c dislocation and \c stress
+   */
+  void
+  set_parameters(const ParameterVariant &variant);
+
+  /** Set up a run of the parameter sweep on a copy of \c mesh, the probe
+   * values are added to \c table after each time step instead of writing the
+   * results. The sparsity pattern of the stress solver is shared with
+   * \c reference if given (same mesh and order), otherwise built.
+   */
+  void
+  setup_run(const Triangulation<dim> &mesh,
+            const std::string &       name,
+            EnsembleTable &           table,
+            Problem<dim> *            reference);
+
+  /** Run of the parameter sweep prepared by setup_run
+   */
+  void
+  run_ensemble();
+
+  static void
+  read_mesh(Triangulation<dim> &triangulation);
+
 private:
   DislocationSolver<dim> solver;
 
@@ -39,6 +65,12 @@ private:
   void
   make_grid();
 
+  void
+  time_loop();
+
+  void
+  add_ensemble_row();
+
   void
   handle_boundaries();
 
@@ -92,6 +124,9 @@ private:
 
   double previous_time_step;
   double next_output_time;
+
+  EnsembleTable *ensemble_table;
+  std::string    run_name;
 };
 
 template <int dim>
@@ -103,6 +138,7 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
   , load_component(0)
   , previous_time_step()
   , next_output_time()
+  , ensemble_table(nullptr)
 {
   prm.declare_entry("Initial temperature",
                     "1000",
@@ -187,8 +223,88 @@ void
 Problem<dim>::run()
 {
   make_grid();
+  solver.initialize();
+  initialize();
+  time_loop();
+
+  std::cout << "Finished in " << timer.wall_time() << " s\n";
+}
+
+template <int dim>
+void
+Problem<dim>::set_parameters(const ParameterVariant &variant)
+{
+  StressSolver<dim> &stress_solver = solver.get_stress_solver();
+
+  ParameterHandler &prm_dislocation = solver.get_parameters();
+  ParameterHandler &prm_stress      = stress_solver.get_parameters();
+
+  apply_parameter_variant(variant,
+                          {{"problem", &prm},
+                           {"dislocation", &prm_dislocation},
+                           {"stress", &prm_stress}});
+
+  // probe values of all runs are collected in a single table
+  prm_dislocation.set("Output probes", false);
+
+  stress_solver.initialize_parameters();
+  solver.initialize_parameters();
+
+  // concurrent runs write separate profiling reports
+  const std::string report = prm_dislocation.get("Profiling report");
+  if (!report.empty())
+    solver.get_profiler()->set_report(
+      report + "-" + variant.name,
+      prm_dislocation.get_bool("Profiling per time step"));
+}
+
+template <int dim>
+void
+Problem<dim>::setup_run(const Triangulation<dim> &mesh,
+                        const std::string &       name,
+                        EnsembleTable &           table,
+                        Problem<dim> *            reference)
+{
+  ensemble_table = &table;
+  run_name       = name;
+
+  solver.get_mesh().copy_triangulation(mesh);
+  handle_boundaries();
+  solver.add_probe(Point<dim>());
+
+  solver.initialize();
+
+  // the DOFs are distributed for each run, the sparsity pattern only once
+  StressSolver<dim> &stress_solver = solver.get_stress_solver();
+  stress_solver.share_sparsity_pattern(
+    reference ? reference->solver.get_stress_solver() : stress_solver);
+}
+
+template <int dim>
+void
+Problem<dim>::run_ensemble()
+{
   initialize();
+  time_loop();
+
+  std::cout << "Run '" << run_name << "' finished in " << timer.wall_time()
+            << " s\n";
+}
 
+template <int dim>
+void
+Problem<dim>::read_mesh(Triangulation<dim> &triangulation)
+{
+  GridIn<dim> gi;
+  gi.attach_triangulation(triangulation);
+  std::ifstream f("mesh-" + std::to_string(dim) + "d.msh");
+  gi.read_msh(f);
+}
+
+template <int dim>
+void
+Problem<dim>::time_loop()
+{
   const double dx_max = prm.get_double("Max dx");
   const double dz_max = prm.get_double("Max dz");
 
@@ -216,33 +332,42 @@ Problem<dim>::run()
 
       const bool keep_going = solver.solve() && !dx_reached && !dz_reached;
 
+      if (ensemble_table)
+        add_ensemble_row();
+
       if (!keep_going)
         break;
 
       if (output_enabled)
         {
-          solver.output_vtk();
+          if (!ensemble_table)
+            solver.output_vtk();
 
           std::cout << "Restoring previous dt=" << previous_time_step << "s\n";
           set_time_step(previous_time_step);
         }
     };
 
-  solver.output_vtk();
+  if (!ensemble_table)
+    solver.output_vtk();
+}
 
-  std::cout << "Finished in " << timer.wall_time() << " s\n";
+template <int dim>
+void
+Problem<dim>::add_ensemble_row()
+{
+  std::vector<std::string> names;
+  std::vector<double>      values;
+  solver.get_probe_values(names, values);
+
+  ensemble_table->add_row(run_name, names, values);
 }
 
 template <int dim>
 void
 Problem<dim>::make_grid()
 {
-  Triangulation<dim> &triangulation = solver.get_mesh();
-
-  GridIn<dim> gi;
-  gi.attach_triangulation(triangulation);
-  std::ifstream f("mesh-" + std::to_string(dim) + "d.msh");
-  gi.read_msh(f);
+  read_mesh(solver.get_mesh());
 
   handle_boundaries();
 
@@ -342,14 +467,18 @@ Problem<dim>::handle_boundaries()
               }
           }
 
-      GridOutFlags::Msh flags(true);
+      if (!ensemble_table)
+        {
+          GridOutFlags::Msh flags(true);
 
-      GridOut go;
-      go.set_flags(flags);
+          GridOut go;
+          go.set_flags(flags);
 
-      std::ofstream f_out("mesh-" + std::to_string(dim) + "d-processed.msh");
-      f_out << std::setprecision(16);
-      go.write_msh(triangulation, f_out);
+          std::ofstream f_out("mesh-" + std::to_string(dim) +
+                              "d-processed.msh");
+          f_out << std::setprecision(16);
+          go.write_msh(triangulation, f_out);
+        }
 
       boundary_info = get_boundary_summary(triangulation);
     }
@@ -386,8 +515,6 @@ template <int dim>
 void
 Problem<dim>::initialize()
 {
-  solver.initialize();
-
   Vector<double> &temperature = solver.get_temperature();
 
   temperature = 0;
@@ -445,7 +572,11 @@ Problem<dim>::initialize()
   // initialize stresses and output probes at zero time
   update_BCs(0);
   solver.solve(true);
-  solver.output_vtk();
+
+  if (ensemble_table)
+    add_ensemble_row();
+  else
+    solver.output_vtk();
 }
 
 template <int dim>
@@ -526,8 +657,11 @@ main(int argc, char *argv[])
 {
   const std::vector<std::string> arguments(argv, argv + argc);
 
-  bool init  = false;
-  int  order = 2;
+  bool        init  = false;
+  int         order = 2;
+  std::string ensemble;
+  int         n_runs    = 0;
+  int         n_threads = 0;
 
   for (unsigned int i = 1; i < arguments.size(); ++i)
     {
@@ -535,11 +669,52 @@ main(int argc, char *argv[])
         init = true;
       if (arguments[i] == "order" && i + 1 < arguments.size())
         order = std::stoi(arguments[i + 1]);
+      if (arguments[i] == "ensemble" && i + 1 < arguments.size())
+        ensemble = arguments[i + 1];
+      if (arguments[i] == "runs" && i + 1 < arguments.size())
+        n_runs = std::stoi(arguments[i + 1]);
+      if (arguments[i] == "threads" && i + 1 < arguments.size())
+        n_threads = std::stoi(arguments[i + 1]);
     }
 
   deallog.attach(std::cout);
   deallog.depth_console(2);
 
+  if (!init && !ensemble.empty())
+    {
+      // parameter sweep: the mesh is read once and shared by all runs
+      Triangulation<3> mesh;
+      Problem<3>::read_mesh(mesh);
+
+      const std::vector<ParameterVariant> variants =
+        read_parameter_variants(ensemble);
+
+      EnsembleTable        table;
+      const EnsembleRunner runner(n_runs, n_threads);
+
+      // the latest run still in progress provides the sparsity pattern
+      std::weak_ptr<Problem<3>> reference;
+
+      const std::vector<std::string> failed =
+        runner.run(variants, [&](const ParameterVariant &variant) {
+          std::shared_ptr<Problem<3>> p3d(new Problem<3>(order));
+          p3d->set_parameters(variant);
+
+          const std::shared_ptr<Problem<3>> r = reference.lock();
+          p3d->setup_run(mesh, variant.name, table, r.get());
+          reference = p3d;
+
+          return [p3d]() { p3d->run_ensemble(); };
+        });
+
+      table.write("probes-ensemble-3d.txt");
+
+      for (const auto &name : failed)
+        std::cout << "Run '" << name << "' failed\n";
+
+      return failed.empty() ? 0 : 1;
+    }
+
   Problem<3> p3d(order, init);
   if (!init)
     p3d.run();
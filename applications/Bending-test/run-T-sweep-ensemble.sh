@@ -0,0 +1,32 @@
+#!/bin/bash
+
+source ./helper.sh
+
+# order, threads
+initialize # 2 0
+
+# Temperature
+arr_T=(400 500 600 700 800 900)
+
+# Force
+F=5
+
+# Number of concurrent runs (0: number of cores)
+runs=0
+
+clean_results
+setup_parameters
+
+./create-mesh.sh
+
+f=ensemble.tsv
+
+printf "name\tproblem:Initial temperature\tstress:Reference temperature" >$f
+printf "\tproblem:Max force\n" >>$f
+
+for T in "${arr_T[@]}"; do
+    printf "F%s-T%s\t%s\t%s\t%s\n" "$F" "$T" "$T" "$T" "$F" >>$f
+done
+
+./macplas-bending order "$order" ensemble "$f" runs "$runs" \
+    threads "$threads" >log-ensemble
@@ -23,6 +23,15 @@ private:
   void
   initialize();
 
+  void
+  restore();
+
+  void
+  add_probes();
+
+  void
+  output_checkpoint();
+
   void
   apply_temperature_bc();
 
@@ -32,6 +41,9 @@ private:
   void
   solve_temperature();
 
+  void
+  refine_mesh();
+
   TemperatureSolver<dim> temperature_solver;
   DislocationSolver<dim> dislocation_solver;
 
@@ -59,6 +71,18 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
     Patterns::Integer(0),
     "Number of time steps between result output (0 - disabled)");
 
+  prm.declare_entry(
+    "Checkpoint frequency",
+    "0",
+    Patterns::Integer(0),
+    "Number of time steps between saving checkpoints (0 - disabled)");
+
+  prm.declare_entry("Restart",
+                    "false",
+                    Patterns::Bool(),
+                    "Continue the calculation from the newest valid "
+                    "checkpoints instead of the initial conditions");
+
   prm.declare_entry("Lx",
                     "0.84",
                     Patterns::Double(0),
@@ -89,6 +113,28 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
                     Patterns::Integer(1),
                     "Number of elements in z direction");
 
+  prm.declare_entry("Refinement frequency",
+                    "0",
+                    Patterns::Integer(0),
+                    "Number of time steps between adaptive mesh refinement "
+                    "(0 - disabled)");
+
+  prm.declare_entry("Refine fraction",
+                    "0.3",
+                    Patterns::Double(0, 1),
+                    "Fraction of the total error in the cells to be refined");
+
+  prm.declare_entry("Coarsen fraction",
+                    "0.03",
+                    Patterns::Double(0, 1),
+                    "Fraction of the total error in the cells to be coarsened");
+
+  prm.declare_entry("Max refinement level",
+                    "2",
+                    Patterns::Integer(0),
+                    "Maximum number of refinements of the initial cells "
+                    "(0 - unlimited)");
+
   prm.declare_entry("Initial temperature",
                     "1685",
                     Patterns::Double(0),
@@ -152,7 +198,10 @@ void
 Problem<dim>::run()
 {
   make_grid();
-  initialize();
+  if (prm.get_bool("Restart"))
+    restore();
+  else
+    initialize();
 
   if (prm.get_bool("Temperature only"))
     solve_temperature();
@@ -164,7 +213,9 @@ template <int dim>
 void
 Problem<dim>::solve_temperature_dislocation()
 {
-  const int n_output = prm.get_integer("Output frequency");
+  const int n_output     = prm.get_integer("Output frequency");
+  const int n_refine     = prm.get_integer("Refinement frequency");
+  const int n_checkpoint = prm.get_integer("Checkpoint frequency");
 
   for (unsigned int i = 1;; ++i)
     {
@@ -186,6 +237,12 @@ Problem<dim>::solve_temperature_dislocation()
           temperature_solver.output_vtk();
           dislocation_solver.output_vtk();
         }
+
+      if (n_refine > 0 && i % n_refine == 0)
+        refine_mesh();
+
+      if (n_checkpoint > 0 && i % n_checkpoint == 0)
+        output_checkpoint();
     };
 
   temperature_solver.output_vtk();
@@ -196,7 +253,9 @@ template <int dim>
 void
 Problem<dim>::solve_temperature()
 {
-  const int n_output = prm.get_integer("Output frequency");
+  const int n_output     = prm.get_integer("Output frequency");
+  const int n_refine     = prm.get_integer("Refinement frequency");
+  const int n_checkpoint = prm.get_integer("Checkpoint frequency");
 
   for (unsigned int i = 1;; ++i)
     {
@@ -210,11 +269,54 @@ Problem<dim>::solve_temperature()
         {
           temperature_solver.output_vtk();
         }
+
+      if (n_refine > 0 && i % n_refine == 0)
+        refine_mesh();
+
+      if (n_checkpoint > 0 && i % n_checkpoint == 0)
+        output_checkpoint();
     };
 
   temperature_solver.output_vtk();
 }
 
+template <int dim>
+void
+Problem<dim>::refine_mesh()
+{
+  const bool temperature_only = prm.get_bool("Temperature only");
+
+  Triangulation<dim> &triangulation = temperature_solver.get_mesh();
+
+  Vector<float> error;
+  if (temperature_only)
+    temperature_solver.estimate_error(error);
+  else
+    dislocation_solver.estimate_error(error);
+
+  mark_cells_for_refinement(triangulation,
+                            error,
+                            prm.get_double("Refine fraction"),
+                            prm.get_double("Coarsen fraction"),
+                            prm.get_integer("Max refinement level"));
+
+  temperature_solver.prepare_for_refinement();
+
+  if (!temperature_only)
+    {
+      // both solvers use identical meshes
+      Triangulation<dim> &triangulation_disl = dislocation_solver.get_mesh();
+      copy_refinement_flags(triangulation, triangulation_disl);
+
+      dislocation_solver.prepare_for_refinement();
+      triangulation_disl.execute_coarsening_and_refinement();
+      dislocation_solver.finish_refinement();
+    }
+
+  triangulation.execute_coarsening_and_refinement();
+  temperature_solver.finish_refinement();
+}
+
 template <int dim>
 void
 Problem<dim>::make_grid()
@@ -245,15 +347,7 @@ Problem<dim>::initialize()
 
   temperature_solver.output_mesh();
 
-  const std::vector<double> Z = split_string(prm.get("Probe coordinates z"));
-
-  for (const double &z : Z)
-    {
-      Point<dim> p;
-      p[dim - 1] = z;
-      temperature_solver.add_probe(p);
-      dislocation_solver.add_probe(p);
-    }
+  add_probes();
 
   Vector<double> &temperature = temperature_solver.get_temperature();
   temperature.add(prm.get_double("Initial temperature"));
@@ -273,6 +367,52 @@ Problem<dim>::initialize()
   dislocation_solver.output_parameter_table();
 }
 
+template <int dim>
+void
+Problem<dim>::restore()
+{
+  // the checkpoints replace the mesh and fields created by make_grid
+  AssertThrow(temperature_solver.load_checkpoint(),
+              ExcMessage("No valid temperature checkpoint found for restart"));
+
+  add_probes();
+
+  if (prm.get_bool("Temperature only"))
+    return;
+
+  AssertThrow(dislocation_solver.load_checkpoint(),
+              ExcMessage("No valid dislocation checkpoint found for restart"));
+
+  AssertThrow(temperature_solver.get_time() == dislocation_solver.get_time(),
+              ExcMessage("Temperature and dislocation checkpoints are not "
+                         "from the same time step"));
+}
+
+template <int dim>
+void
+Problem<dim>::add_probes()
+{
+  const std::vector<double> Z = split_string(prm.get("Probe coordinates z"));
+
+  for (const double &z : Z)
+    {
+      Point<dim> p;
+      p[dim - 1] = z;
+      temperature_solver.add_probe(p);
+      dislocation_solver.add_probe(p);
+    }
+}
+
+template <int dim>
+void
+Problem<dim>::output_checkpoint()
+{
+  temperature_solver.output_checkpoint();
+
+  if (!prm.get_bool("Temperature only"))
+    dislocation_solver.output_checkpoint();
+}
+
 template <int dim>
 void
 Problem<dim>::apply_temperature_bc()
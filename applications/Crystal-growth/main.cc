@@ -41,9 +41,9 @@ private:
   update_fields();
 
   void
-  update_one_field(Vector<double> &         field,
-                   const std::string &      name,
-                   const std::vector<bool> &do_not_change);
+  update_field_list(const std::vector<Vector<double> *> &fields,
+                    const std::vector<std::string> &     names,
+                    const std::vector<bool> &            do_not_change);
 
   void
   initialize_temperature();
@@ -177,6 +177,8 @@ private:
 
   DoFFieldSmoother<dim> smoother;
 
+  MeshMotion<dim> mesh_motion;
+
   double N0;
 
   double previous_time_step;
@@ -234,6 +236,15 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
                     Patterns::Bool(),
                     "Calculate just the temperature field");
 
+  prm.declare_entry(
+    "Coupling",
+    "sequential",
+    Patterns::Selection("sequential|lagged"),
+    "Coupling of the temperature and dislocation time steps (sequential - "
+    "dislocation step with the new temperature, lagged - dislocation step "
+    "with the temperature at the beginning of the time step, concurrently "
+    "with the temperature step)");
+
   prm.declare_entry("Export data",
                     "false",
                     Patterns::Bool(),
@@ -244,6 +255,12 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
                     Patterns::Bool(),
                     "Export results in vtk format");
 
+  prm.declare_entry("Export checkpoint",
+                    "false",
+                    Patterns::Bool(),
+                    "Save restart checkpoints of the solvers together with "
+                    "the results");
+
   prm.declare_entry(
     "Pull rate",
     "1e-5",
@@ -320,6 +337,13 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
                     Patterns::Double(0),
                     "Tolerance of linear solver for Laplace transform");
 
+  prm.declare_entry("Laplace solver",
+                    "CG",
+                    Patterns::Selection("CG|UMFPACK"),
+                    "Linear solver for Laplace transform, the matrix is "
+                    "assembled once and factorized (UMFPACK) or "
+                    "preconditioned (CG)");
+
   prm.declare_entry("Max time",
                     "0",
                     Patterns::Double(0),
@@ -630,9 +654,8 @@ Problem<dim>::deform_grid()
 {
   Timer timer;
 
-  // the mesh will be modified, make a copy
-  Triangulation<dim> triangulation;
-  triangulation.copy_triangulation(temperature_solver.get_mesh());
+  // the mesh is modified in place, the topology does not change
+  Triangulation<dim> &triangulation = temperature_solver.get_mesh();
 
   temperature_solver.get_support_points(support_points_prev);
   calculate_field_gradients();
@@ -774,16 +797,10 @@ Problem<dim>::deform_grid()
     }
 
   // Update the mesh and obtain displacements for all DoFs.
-  // Use improved implementation of function which allows to specify tolerance
-  // instead of built-in (from \c GridTools).
-  laplace_transform<dim>(points_new,
-                         triangulation,
-                         nullptr,
-                         false,
+  // The Laplace matrix is reused between the time steps.
+  mesh_motion.set_solver(prm.get("Laplace solver"),
                          prm.get_double("Laplace tolerance"));
-
-  temperature_solver.get_mesh().clear();
-  temperature_solver.get_mesh().copy_triangulation(triangulation);
+  mesh_motion.move(points_new, triangulation);
 
   temperature_solver.get_support_points(support_points);
 
@@ -807,17 +824,13 @@ Problem<dim>::deform_grid()
 
   surface_projector.set_points(projector_points);
 
-  temperature_solver.get_mesh().clear();
-  temperature_solver.get_mesh().copy_triangulation(triangulation);
+  // same vertex numbering in all meshes, see make_grid
+  const std::vector<Point<dim>> &vertices = triangulation.get_vertices();
 
-  advection_solver.get_mesh().clear();
-  advection_solver.get_mesh().copy_triangulation(triangulation);
+  MeshMotion<dim>::set_vertices(advection_solver.get_mesh(), vertices);
 
   if (with_dislocation())
-    {
-      dislocation_solver.get_mesh().clear();
-      dislocation_solver.get_mesh().copy_triangulation(triangulation);
-    }
+    MeshMotion<dim>::set_vertices(dislocation_solver.get_mesh(), vertices);
 
   std::cout << "Deforming grid - done " << format_time(timer) << "\n";
 }
@@ -872,7 +885,6 @@ Problem<dim>::calculate_field_gradients()
   // output gradients
   const auto         dims = coordinate_names(dim);
   const unsigned int n    = temperature_solver.get_temperature().size();
-  Vector<double>     grad_component(n);
 
   std::vector<std::string> field_names{"T"};
 
@@ -885,8 +897,9 @@ Problem<dim>::calculate_field_gradients()
   // skip gradients of creep strain for now
 
   // initialize displacement with zeros at t=0
+  const auto zero = std::make_shared<const Vector<double>>(n);
   for (unsigned int k = 0; k < dim; ++k)
-    temperature_solver.add_field("d" + dims[k], grad_component);
+    temperature_solver.add_field("d" + dims[k], zero);
 
   for (const auto &name : field_names)
     {
@@ -894,8 +907,10 @@ Problem<dim>::calculate_field_gradients()
 
       for (unsigned int k = 0; k < dim; ++k)
         {
+          // shared by the solvers without copying
+          const auto grad_component = std::make_shared<Vector<double>>(n);
           for (unsigned int i = 0; i < n; ++i)
-            grad_component[i] = grad[i][k];
+            (*grad_component)[i] = grad[i][k];
 
           temperature_solver.add_field("d" + name + "_d" + dims[k],
                                        grad_component);
@@ -985,7 +1000,31 @@ Problem<dim>::update_fields()
   Vector<double> &   T = temperature_solver.get_temperature();
   const unsigned int n = T.size();
 
-  update_one_field(T, "T", interface_dofs);
+  // all fields are updated and smoothed together
+  std::vector<Vector<double> *> fields{&T};
+  std::vector<std::string>      names{"T"};
+
+  if (f_test.size() > 0)
+    {
+      fields.push_back(&f_test);
+      names.push_back("f_test");
+    }
+
+  if (with_dislocation())
+    {
+      fields.push_back(&dislocation_solver.get_dislocation_density());
+      names.push_back("N_m");
+
+      BlockVector<double> &e_c = dislocation_solver.get_strain_c();
+
+      for (unsigned int j = 0; j < e_c.n_blocks(); ++j)
+        {
+          fields.push_back(&e_c.block(j));
+          names.push_back("e_c_" + std::to_string(j));
+        }
+    }
+
+  update_field_list(fields, names, interface_dofs);
 
   // output the displacement at DoFs as well
   const auto     dims = coordinate_names(dim);
@@ -999,31 +1038,18 @@ Problem<dim>::update_fields()
     }
 
   if (f_test.size() > 0)
-    {
-      update_one_field(f_test, "f_test", interface_dofs);
-
-      temperature_solver.add_field("f_test", f_test);
-    }
+    temperature_solver.add_field("f_test", f_test);
 
   if (with_dislocation())
     {
       Vector<double> &N_m = dislocation_solver.get_dislocation_density();
 
-      update_one_field(N_m, "N_m", interface_dofs);
-
       // disallow non-physical behaviour
       for (unsigned int i = 0; i < n; ++i)
         N_m[i] = std::max(N_m[i], N0);
 
       BlockVector<double> &e_c = dislocation_solver.get_strain_c();
 
-      for (unsigned int j = 0; j < e_c.n_blocks(); ++j)
-        {
-          Vector<double> &e = e_c.block(j);
-
-          update_one_field(e, "e_c_" + std::to_string(j), interface_dofs);
-        }
-
       if (prm.get_bool("Reset interface fields"))
         {
           std::vector<bool> mask(N_m.size());
@@ -1046,53 +1072,76 @@ Problem<dim>::update_fields()
 
 template <int dim>
 void
-Problem<dim>::update_one_field(Vector<double> &         field,
-                               const std::string &      name,
-                               const std::vector<bool> &do_not_change)
+Problem<dim>::update_field_list(const std::vector<Vector<double> *> &fields,
+                                const std::vector<std::string> &     names,
+                                const std::vector<bool> &do_not_change)
 {
-  Vector<double> df(field.size());
+  AssertDimension(fields.size(), names.size());
 
-  if (use_advection())
-    {
-      df += advection_solver.get_field(name);
-      df -= field;
-    }
-  else
+  const unsigned int n_fields = fields.size();
+
+  std::vector<Vector<double>> df(n_fields);
+
+  for (unsigned int k = 0; k < n_fields; ++k)
     {
-      const auto &grad = grad_eval.get_gradient(name);
+      const Vector<double> &field = *fields[k];
+      const std::string &   name  = names[k];
 
-      for (unsigned int i = 0; i < field.size(); ++i)
-        df[i] = shift[i] * grad[i];
-    }
+      df[k].reinit(field.size());
 
-  for (unsigned int i = 0; i < do_not_change.size(); ++i)
-    if (do_not_change[i])
-      df[i] = 0;
+      if (use_advection())
+        {
+          df[k] += advection_solver.get_field(name);
+          df[k] -= field;
+        }
+      else
+        {
+          const auto &grad = grad_eval.get_gradient(name);
 
+          for (unsigned int i = 0; i < field.size(); ++i)
+            df[k][i] = shift[i] * grad[i];
+        }
 
-  // smooth field change
-  smoother.add_field("F", df);
+      for (unsigned int i = 0; i < do_not_change.size(); ++i)
+        if (do_not_change[i])
+          df[k][i] = 0;
+
+      smoother.add_field(name, df[k]);
+    }
+
+  // smooth field changes
   smoother.calculate(prm.get_double("Field change relaxation factor"),
                      prm.get_double(
                        "Field change relaxation factor at boundary"));
-  df = smoother.get_field("F");
 
-  for (unsigned int i = 0; i < do_not_change.size(); ++i)
-    if (do_not_change[i])
-      df[i] = 0;
+  for (unsigned int k = 0; k < n_fields; ++k)
+    {
+      Vector<double> &field = *fields[k];
+
+      df[k] = smoother.get_field(names[k]);
+
+      for (unsigned int i = 0; i < do_not_change.size(); ++i)
+        if (do_not_change[i])
+          df[k][i] = 0;
 
-  // update field
-  field += df;
+      // update field
+      field += df[k];
 
-  // smooth field
-  smoother.add_field("F", field);
+      smoother.add_field(names[k], field);
+    }
+
+  // smooth fields
   smoother.calculate(prm.get_double("Field relaxation factor"),
                      prm.get_double("Field relaxation factor at boundary"));
-  field = smoother.get_field("F");
+
+  for (unsigned int k = 0; k < n_fields; ++k)
+    {
+      *fields[k] = smoother.get_field(names[k]);
 
 #ifdef DEBUG
-  temperature_solver.add_field("d_" + name, df);
+      temperature_solver.add_field("d_" + names[k], df[k]);
 #endif
+    }
 }
 
 template <int dim>
@@ -1624,14 +1673,37 @@ Problem<dim>::solve_temperature_dislocation()
 
       deform_grid();
 
-      set_temperature_BC();
+      bool keep_going_temp, keep_going_disl;
 
-      const bool keep_going_temp = temperature_solver.solve();
+      if (prm.get("Coupling") == "lagged")
+        {
+          // the temperature is not affected by the dislocation step, both
+          // solvers have separate meshes and fields at this point; the
+          // solvers log by their own loggers and the interpolators of the
+          // boundary conditions by the default logger of the task's thread,
+          // the lines of both steps are not mixed
+          dislocation_solver.get_temperature() =
+            temperature_solver.get_temperature();
+
+          Threads::Task<bool> temperature_step = Threads::new_task([this]() {
+            set_temperature_BC();
+            return temperature_solver.solve();
+          });
+
+          keep_going_disl = dislocation_solver.solve();
+          keep_going_temp = temperature_step.return_value();
+        }
+      else
+        {
+          set_temperature_BC();
 
-      dislocation_solver.get_temperature() =
-        temperature_solver.get_temperature();
+          keep_going_temp = temperature_solver.solve();
 
-      const bool keep_going_disl = dislocation_solver.solve();
+          dislocation_solver.get_temperature() =
+            temperature_solver.get_temperature();
+
+          keep_going_disl = dislocation_solver.solve();
+        }
 
       postprocess();
 
@@ -1670,6 +1742,13 @@ Problem<dim>::output_results() const
         dislocation_solver.output_data();
     }
 
+  if (prm.get_bool("Export checkpoint"))
+    {
+      temperature_solver.output_checkpoint();
+      if (has_dislocation)
+        dislocation_solver.output_checkpoint();
+    }
+
   if (vtk)
     {
       temperature_solver.output_vtk();
@@ -3,6 +3,11 @@
 # -*- coding: utf-8 -*-
 """
 Script for setting-up parametric crystal model
+
+The mesh input (mesh.in) and the data files depend on the geometry
+parameters, hence each parameter set of a sweep is a separate run; sweeps
+of the parameters which do not change the mesh (e.g. in the Bending-test
+application) can share it using EnsembleRunner (include/ensemble.h).
 """
 
 import numpy as np
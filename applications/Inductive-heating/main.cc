@@ -28,8 +28,11 @@ private:
   void
   initialize_dislocation();
 
+  /** Set the temperature BC, also the inductor position and current in the
+   * output of the dislocation solver if \c dislocation_output is set
+   */
   void
-  apply_T_BC();
+  apply_T_BC(const bool dislocation_output = true);
 
   void
   interpolate_q_em(const double z);
@@ -100,6 +103,9 @@ private:
   // external temperature BC
   SurfaceInterpolator2D T2d;
 
+  // reused for all time instances of the external temperature BC
+  InterpolationPlan<2> T2d_plan;
+
   // normalized Joulean heat flux density
   Vector<double> q0;
 
@@ -142,6 +148,11 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
   : temperature_solver(order, use_default_prm)
   , dislocation_solver(order, use_default_prm)
 {
+  // the interpolation of the boundary data is reported with the temperature
+  q2d.set_profiler(temperature_solver.get_profiler());
+  q3d.set_profiler(temperature_solver.get_profiler());
+  T2d.set_profiler(temperature_solver.get_profiler());
+
   // Physical parameters from https://doi.org/10.1016/j.jcrysgro.2020.125842
 
   prm.declare_entry("Initial temperature",
@@ -225,6 +236,15 @@ Problem<dim>::Problem(const unsigned int order, const bool use_default_prm)
                     Patterns::Bool(),
                     "Calculate just the temperature field");
 
+  prm.declare_entry(
+    "Coupling",
+    "sequential",
+    Patterns::Selection("sequential|lagged"),
+    "Coupling of the temperature and dislocation time steps (sequential - "
+    "dislocation step with the new temperature, lagged - dislocation step "
+    "with the temperature at the beginning of the time step, concurrently "
+    "with the temperature step)");
+
   prm.declare_entry("Start from steady temperature",
                     "true",
                     Patterns::Bool(),
@@ -596,17 +616,44 @@ Problem<dim>::solve_temperature_dislocation()
       const int n_outer = prm.get_integer("Outer temperature iterations");
 
       bool keep_going_temp = false;
+      bool keep_going_disl = false;
 
-      for (int n = 0; n < n_outer; ++n)
+      if (prm.get("Coupling") == "lagged")
         {
+          // the temperature is not affected by the dislocation step, the
+          // dislocation output is updated before both steps run concurrently
           apply_T_BC();
-          keep_going_temp = temperature_solver.solve(n > 0);
+
+          dislocation_solver.get_temperature() =
+            temperature_solver.get_temperature();
+
+          Threads::Task<bool> temperature_step = Threads::new_task([&]() {
+            bool keep_going = false;
+            for (int n = 0; n < n_outer; ++n)
+              {
+                if (n > 0)
+                  apply_T_BC(false);
+                keep_going = temperature_solver.solve(n > 0);
+              }
+            return keep_going;
+          });
+
+          keep_going_disl = dislocation_solver.solve();
+          keep_going_temp = temperature_step.return_value();
         }
+      else
+        {
+          for (int n = 0; n < n_outer; ++n)
+            {
+              apply_T_BC();
+              keep_going_temp = temperature_solver.solve(n > 0);
+            }
 
-      dislocation_solver.get_temperature() =
-        temperature_solver.get_temperature();
+          dislocation_solver.get_temperature() =
+            temperature_solver.get_temperature();
 
-      const bool keep_going_disl = dislocation_solver.solve();
+          keep_going_disl = dislocation_solver.solve();
+        }
 
       postprocess();
 
@@ -807,7 +854,7 @@ Problem<dim>::initialize_dislocation()
 
 template <int dim>
 void
-Problem<dim>::apply_T_BC()
+Problem<dim>::apply_T_BC(const bool dislocation_output)
 {
   const double t =
     temperature_solver.get_time() + temperature_solver.get_time_step();
@@ -817,7 +864,7 @@ Problem<dim>::apply_T_BC()
 
   temperature_solver.add_output("z[m]", z);
   temperature_solver.add_output("I[A]", I);
-  if (with_dislocation())
+  if (with_dislocation() && dislocation_output)
     {
       dislocation_solver.add_output("z[m]", z);
       dislocation_solver.add_output("I[A]", I);
@@ -875,7 +922,8 @@ Problem<dim>::apply_T_BC()
       for (const auto &it : weights)
         {
           Vector<double> tmp(T_BC);
-          T2d.interpolate(T_time[it[0]], points, boundary_dofs, tmp);
+          T2d.interpolate(
+            T_time[it[0]], points, boundary_dofs, tmp, T2d_plan);
           T_BC.add(it[1], tmp);
         }
 
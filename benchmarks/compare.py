@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+
+import csv
+import sys
+
+if len(sys.argv) < 3:
+    print(f"Usage: {sys.argv[0]} baseline.csv results.csv [tolerance]")
+    sys.exit(1)
+
+tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 0.1
+keys = ["case", "dim", "order", "refine", "threads", "phase"]
+
+
+def read(file_name):
+    data = {}
+    with open(file_name) as f:
+        for row in csv.DictReader(f):
+            # the last run of the same configuration is used
+            data[tuple(row[k] for k in keys)] = float(row["wall_time[s]"])
+    return data
+
+
+baseline = read(sys.argv[1])
+results = read(sys.argv[2])
+
+n_slower = 0
+for key in sorted(results):
+    if key not in baseline or baseline[key] <= 0:
+        continue
+
+    ratio = results[key] / baseline[key]
+    status = ""
+    if ratio > 1 + tolerance:
+        status = "SLOWER"
+        n_slower += 1
+    elif ratio < 1 - tolerance:
+        status = "faster"
+
+    print(f"{' '.join(key):60} {baseline[key]:10.4g} {results[key]:10.4g} "
+          f"{ratio:6.2f} {status}")
+
+print(f"{n_slower} regression(s) above {100 * tolerance:g}%")
+sys.exit(1 if n_slower > 0 else 0)
@@ -0,0 +1,463 @@
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/base/utilities.h>
+
+#include <deal.II/grid/grid_generator.h>
+
+#include "../include/dislocation_solver.h"
+#include "../include/temperature_solver.h"
+#include "../include/utilities.h"
+
+using namespace dealii;
+
+/** Performance benchmarks of the solvers and utilities.
+ * Results are appended to \c "benchmark-results.csv"
+ */
+template <int dim>
+class Benchmark
+{
+public:
+  Benchmark(const unsigned int order,
+            const unsigned int n_refine,
+            const unsigned int n_steps,
+            const bool         use_default_prm);
+
+  void
+  run(const std::vector<std::string> &cases);
+
+private:
+  void
+  make_grid(Triangulation<dim> &triangulation) const;
+
+  void
+  set_temperature(const std::vector<Point<dim>> &points,
+                  Vector<double> &               temperature) const;
+
+  void
+  run_temperature();
+
+  void
+  run_stress();
+
+  void
+  run_dislocation();
+
+  void
+  run_interpolation();
+
+  void
+  run_laplace_transform();
+
+  /** Write all phases of \c profiler starting with \c prefix
+   */
+  void
+  record(const std::string &name,
+         const Profiler &   profiler,
+         const std::string &prefix,
+         const unsigned int n_dofs,
+         const unsigned int n_calls);
+
+  /** Write a single result row
+   */
+  void
+  record(const std::string &name,
+         const std::string &phase,
+         const unsigned int n_dofs,
+         const double       wall_time);
+
+  unsigned int order;
+
+  unsigned int n_refine;
+
+  unsigned int n_steps;
+
+  bool use_default_prm;
+
+  /** Radius of the domain
+   */
+  double R;
+
+  /** Height of the domain
+   */
+  double H;
+};
+
+template <int dim>
+Benchmark<dim>::Benchmark(const unsigned int order,
+                          const unsigned int n_refine,
+                          const unsigned int n_steps,
+                          const bool         use_default_prm)
+  : order(order)
+  , n_refine(n_refine)
+  , n_steps(n_steps)
+  , use_default_prm(use_default_prm)
+  , R(0.1)
+  , H(0.2)
+{}
+
+template <int dim>
+void
+Benchmark<dim>::run(const std::vector<std::string> &cases)
+{
+  for (const auto &c : cases)
+    {
+      std::cout << "Benchmark '" << c << "', dim=" << dim
+                << ", order=" << order << ", refine=" << n_refine << "\n";
+
+      if (c == "temperature")
+        run_temperature();
+      else if (c == "stress")
+        run_stress();
+      else if (c == "dislocation")
+        run_dislocation();
+      else if (c == "interpolation")
+        run_interpolation();
+      else if (c == "laplace")
+        run_laplace_transform();
+      else
+        AssertThrow(false, ExcMessage("Unknown benchmark " + c));
+    }
+}
+
+template <int dim>
+void
+Benchmark<dim>::make_grid(Triangulation<dim> &triangulation) const
+{
+  // 2D: axisymmetric r-z domain, 3D: box
+  Point<dim> p2;
+  for (unsigned int i = 0; i < dim - 1; ++i)
+    p2[i] = R;
+  p2[dim - 1] = H;
+
+  GridGenerator::hyper_rectangle(triangulation, Point<dim>(), p2, true);
+  triangulation.refine_global(n_refine);
+}
+
+template <int dim>
+void
+Benchmark<dim>::set_temperature(const std::vector<Point<dim>> &points,
+                                Vector<double> &temperature) const
+{
+  // linear profile, hot bottom
+  for (unsigned int i = 0; i < temperature.size(); ++i)
+    temperature[i] = 1600 - 500 * points[i][dim - 1] / H;
+}
+
+template <int dim>
+void
+Benchmark<dim>::run_temperature()
+{
+  TemperatureSolver<dim> solver(order, use_default_prm);
+
+  make_grid(solver.get_mesh());
+  solver.initialize();
+  solver.get_temperature().add(1000);
+
+  // steady state, nonlinear due to the temperature-dependent conductivity
+  solver.get_time_step() = 0;
+  solver.set_bc1(2 * dim - 2, 1600);
+  solver.set_bc_convective(2 * dim - 1, 10, 300);
+
+  Timer timer;
+  solver.solve();
+  timer.stop();
+
+  const Profiler &profiler  = *solver.get_profiler();
+  const auto      counters  = profiler.get_counters();
+  const auto      it_newton = counters.find("temperature/Newton iterations");
+  const unsigned int n_newton =
+    it_newton != counters.end() ? it_newton->second : 1;
+
+  const unsigned int n_dofs = solver.get_dof_handler().n_dofs();
+  record("temperature", profiler, "temperature/", n_dofs, n_newton);
+  record("temperature",
+         "Newton iteration",
+         n_dofs,
+         timer.wall_time() / n_newton);
+}
+
+template <int dim>
+void
+Benchmark<dim>::run_stress()
+{
+  StressSolver<dim> solver(order, use_default_prm);
+
+  make_grid(solver.get_mesh());
+  solver.initialize();
+
+  std::vector<Point<dim>> points;
+  solver.get_support_points(points);
+  set_temperature(points, solver.get_temperature());
+
+  // u_k = 0 at the lower boundary in direction k
+  for (unsigned int k = 0; k < dim; ++k)
+    solver.set_bc1(2 * k, k, 0);
+
+  for (unsigned int i = 0; i < n_steps; ++i)
+    solver.solve();
+
+  record("stress",
+         *solver.get_profiler(),
+         "stress/",
+         dim * solver.get_dof_handler().n_dofs(),
+         n_steps);
+}
+
+template <int dim>
+void
+Benchmark<dim>::run_dislocation()
+{
+  DislocationSolver<dim> solver(order, use_default_prm);
+
+  make_grid(solver.get_mesh());
+  solver.initialize();
+
+  std::vector<Point<dim>> points;
+  solver.get_support_points(points);
+  set_temperature(points, solver.get_temperature());
+
+  StressSolver<dim> &stress_solver = solver.get_stress_solver();
+  for (unsigned int k = 0; k < dim; ++k)
+    stress_solver.set_bc1(2 * k, k, 0);
+
+  // initial step, not measured: a new profiler is used afterwards
+  solver.solve(true);
+  solver.set_profiler(std::make_shared<Profiler>());
+
+  unsigned int n_steps_done = 0;
+  while (n_steps_done < n_steps)
+    {
+      const bool keep_going = solver.solve();
+      ++n_steps_done;
+
+      if (!keep_going)
+        break;
+    }
+
+  record("dislocation",
+         *solver.get_profiler(),
+         "dislocation/",
+         solver.get_dof_handler().n_dofs(),
+         n_steps_done);
+}
+
+template <int dim>
+void
+Benchmark<dim>::run_interpolation()
+{
+  TemperatureSolver<dim> solver(order, use_default_prm);
+
+  make_grid(solver.get_mesh());
+  solver.initialize();
+
+  // triangulated cylindrical surface r=R with a point field q=z
+  const std::string  file_name = "benchmark-surface.vtk";
+  const unsigned int n_phi     = 8 << n_refine;
+  const unsigned int n_z       = 2 << n_refine;
+  {
+    std::ofstream f(file_name);
+    f << "# vtk DataFile Version 4.2\nsurface\nASCII\n"
+      << "DATASET UNSTRUCTURED_GRID\n";
+
+    f << "POINTS " << n_phi * (n_z + 1) << " double\n";
+    for (unsigned int j = 0; j <= n_z; ++j)
+      for (unsigned int i = 0; i < n_phi; ++i)
+        {
+          const double phi = 2 * numbers::PI * i / n_phi;
+          f << R * std::cos(phi) << ' ' << R * std::sin(phi) << ' '
+            << H * j / n_z << '\n';
+        }
+
+    const unsigned int n_triangles = 2 * n_phi * n_z;
+    f << "CELLS " << n_triangles << ' ' << 4 * n_triangles << '\n';
+    for (unsigned int j = 0; j < n_z; ++j)
+      for (unsigned int i = 0; i < n_phi; ++i)
+        {
+          const unsigned int a = j * n_phi + i;
+          const unsigned int b = j * n_phi + (i + 1) % n_phi;
+          const unsigned int c = a + n_phi;
+          const unsigned int d = b + n_phi;
+          f << "3 " << a << ' ' << b << ' ' << d << '\n'
+            << "3 " << a << ' ' << d << ' ' << c << '\n';
+        }
+
+    f << "POINT_DATA " << n_phi * (n_z + 1) << '\n'
+      << "SCALARS q double\nLOOKUP_TABLE default\n";
+    for (unsigned int j = 0; j <= n_z; ++j)
+      for (unsigned int i = 0; i < n_phi; ++i)
+        f << H * j / n_z << '\n';
+  }
+
+  SurfaceInterpolator3D surf;
+  surf.read_vtk(file_name);
+
+  std::vector<Point<dim>> points;
+  std::vector<bool>       boundary_dofs;
+  solver.get_boundary_points(1, points, boundary_dofs);
+  Vector<double> q(points.size());
+
+  unsigned int n_boundary_dofs = 0;
+  for (const bool b : boundary_dofs)
+    n_boundary_dofs += b;
+
+  Timer timer;
+  for (unsigned int i = 0; i < n_steps; ++i)
+    surf.interpolate(
+      SurfaceInterpolator3D::PointField, "q", points, boundary_dofs, q);
+  record("interpolation",
+         "interpolate",
+         n_boundary_dofs,
+         timer.wall_time() / n_steps);
+
+  timer.restart();
+  InterpolationPlan<3> plan;
+  surf.create_plan(SurfaceInterpolator3D::PointField,
+                   points,
+                   boundary_dofs,
+                   plan);
+  record("interpolation", "create_plan", n_boundary_dofs, timer.wall_time());
+
+  timer.restart();
+  for (unsigned int i = 0; i < n_steps; ++i)
+    surf.interpolate(plan, "q", q);
+  record("interpolation",
+         "interpolate_plan",
+         n_boundary_dofs,
+         timer.wall_time() / n_steps);
+}
+
+template <int dim>
+void
+Benchmark<dim>::run_laplace_transform()
+{
+  Triangulation<dim> triangulation;
+  make_grid(triangulation);
+
+  // fix all boundary vertices, shift the top surface up
+  Point<dim> dz;
+  dz[dim - 1] = 0.1 * H;
+
+  std::map<unsigned int, Point<dim>> new_points;
+  for (const auto &cell : triangulation.active_cell_iterators())
+    for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
+      {
+        const auto face = cell->face(i);
+        if (!face->at_boundary())
+          continue;
+
+        const bool top = face->boundary_id() == 2 * dim - 1;
+        for (unsigned int j = 0; j < GeometryInfo<dim>::vertices_per_face; ++j)
+          {
+            const Point<dim> &p = face->vertex(j);
+            const bool at_top   = std::abs(p[dim - 1] - H) < 1e-8 * H;
+            if (top || !at_top)
+              new_points[face->vertex_index(j)] = at_top ? Point<dim>(p + dz) :
+                                                           p;
+          }
+      }
+
+  Timer timer;
+  laplace_transform(new_points, triangulation, nullptr, false, 1e-10);
+  record("laplace",
+         "laplace_transform",
+         dim * triangulation.n_vertices(),
+         timer.wall_time());
+}
+
+template <int dim>
+void
+Benchmark<dim>::record(const std::string &name,
+                       const Profiler &   profiler,
+                       const std::string &prefix,
+                       const unsigned int n_dofs,
+                       const unsigned int n_calls)
+{
+  for (const auto &it : profiler.get_wall_times())
+    {
+      if (Utilities::match_at_string_start(it.first, prefix))
+        record(name,
+               it.first.substr(prefix.size()),
+               n_dofs,
+               it.second / n_calls);
+    }
+}
+
+template <int dim>
+void
+Benchmark<dim>::record(const std::string &name,
+                       const std::string &phase,
+                       const unsigned int n_dofs,
+                       const double       wall_time)
+{
+  const std::string file_name = "benchmark-results.csv";
+
+  const bool write_header = !std::ifstream(file_name).good();
+
+  std::ofstream f(file_name, std::ios::app);
+  if (write_header)
+    f << "case,dim,order,refine,threads,n_dofs,phase,wall_time[s],"
+         "dofs_per_s,memory[MB]\n";
+
+  Utilities::System::MemoryStats stats;
+  Utilities::System::get_memory_stats(stats);
+
+  f << std::setprecision(6);
+  f << name << ',' << dim << ',' << order << ',' << n_refine << ','
+    << MultithreadInfo::n_threads() << ',' << n_dofs << ',' << phase << ','
+    << wall_time << ',' << (wall_time > 0 ? n_dofs / wall_time : 0) << ','
+    << stats.VmRSS / 1024.0 << '\n';
+}
+
+int
+main(int argc, char *argv[])
+{
+  const std::vector<std::string> arguments(argv, argv + argc);
+
+  int  order           = 1;
+  int  dimension       = 2;
+  int  n_refine        = 4;
+  int  n_steps         = 5;
+  bool use_default_prm = false;
+
+  std::vector<std::string> cases;
+
+  for (unsigned int i = 1; i < arguments.size(); ++i)
+    {
+      if (arguments[i] == "order" && i + 1 < arguments.size())
+        order = std::stoi(arguments[++i]);
+      else if (arguments[i] == "refine" && i + 1 < arguments.size())
+        n_refine = std::stoi(arguments[++i]);
+      else if (arguments[i] == "steps" && i + 1 < arguments.size())
+        n_steps = std::stoi(arguments[++i]);
+      else if (arguments[i] == "2d" || arguments[i] == "2D")
+        dimension = 2;
+      else if (arguments[i] == "3d" || arguments[i] == "3D")
+        dimension = 3;
+      else if (arguments[i] == "init" || arguments[i] == "use_default_prm")
+        use_default_prm = true;
+      else
+        cases.push_back(arguments[i]);
+    }
+
+  if (cases.empty())
+    cases = {
+      "temperature", "stress", "dislocation", "interpolation", "laplace"};
+
+  AssertThrow(n_steps > 0, ExcMessage("At least one step is required"));
+
+  deallog.attach(std::cout);
+  deallog.depth_console(0);
+
+  if (dimension == 2)
+    {
+      Benchmark<2> b2(order, n_refine, n_steps, use_default_prm);
+      b2.run(cases);
+    }
+  else if (dimension == 3)
+    {
+      Benchmark<3> b3(order, n_refine, n_steps, use_default_prm);
+      b3.run(cases);
+    }
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# strong scaling: fixed problem size, increasing number of threads
+# weak scaling: the number of DOFs per thread is kept constant
+
+n_max=$(nproc)
+
+for d in 2D 3D ; do
+  ./macplas-benchmark $d init temperature stress dislocation
+
+  if [ $d == 2D ]; then r=5; f=4; else r=2; f=8; fi
+
+  for p in 1 2 3 ; do
+    for (( n=1; n<=n_max; n*=2 )); do
+      sed -Ei "s/(set Number of threads *=).*/\1 $n/" *.prm
+      ./macplas-benchmark $d order $p refine $r
+    done
+
+    n=1
+    for (( i=0; n<=n_max; i++, n*=f )); do
+      sed -Ei "s/(set Number of threads *=).*/\1 $n/" *.prm
+      ./macplas-benchmark $d order $p refine $((r+i))
+    done
+  done
+done
@@ -1,9 +1,11 @@
 #ifndef macplas_advection_solver_h
 #define macplas_advection_solver_h
 
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/base/parameter_handler.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/timer.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/fe/fe_q.h>
 
@@ -11,6 +13,7 @@
 #include <deal.II/lac/precondition_selector.h>
 #include <deal.II/lac/solver_selector.h>
 #include <deal.II/lac/sparse_direct.h>
+#include <deal.II/lac/sparse_ilu.h>
 #include <deal.II/lac/sparse_matrix.h>
 
 #include <deal.II/numerics/data_out.h>
@@ -97,11 +100,37 @@ public:
   ParameterHandler &
   get_parameters();
 
+  /** Get profiler, shared with other solvers by set_profiler
+   */
+  std::shared_ptr<Profiler>
+  get_profiler() const;
+
+  /** Use \c profiler for performance measurements, e.g. to share a single
+   * report between several solvers. The report is set once by the solver
+   * which created \c profiler (its "Profiling report" parameter)
+   */
+  void
+  set_profiler(const std::shared_ptr<Profiler> &profiler);
+
   /** Initialize DOF handler and fields
    */
   void
   initialize();
 
+  /** Prepare the transfer of the fields and velocity to the adapted mesh.
+   * Call after flagging the cells and before
+   * \c Triangulation::execute_coarsening_and_refinement.
+   */
+  void
+  prepare_for_refinement();
+
+  /** Distribute DOFs on the adapted mesh, interpolate the fields and
+   * velocity and rebuild the hanging node constraints, sparsity pattern and
+   * matrix at the next solve
+   */
+  void
+  finish_refinement();
+
   /** Get coordinates of boundary DOFs
    */
   void
@@ -130,11 +159,31 @@ public:
   void
   add_field(const std::string &name, const Vector<double> &field);
 
+  /** Add a FE field without copying. The solver shares \c field with the
+   * caller until it is advected, the caller's vector is not modified.
+   */
+  void
+  add_field(const std::string &name, const FieldStore::FieldPointer &field);
+
   /** Get calculated gradients by field name
    */
   const Vector<double> &
   get_field(const std::string &name) const;
 
+  /** Save mesh, velocity, fields and time-stepping state to a single
+   * checkpoint file \c "checkpoint-advection-<dim>d-order<order>-0.bin", the
+   * previous checkpoints are rotated
+   */
+  void
+  output_checkpoint() const;
+
+  /** Restore mesh, velocity, fields and time-stepping state from the newest
+   * valid checkpoint, calls AdvectionSolver::initialize.
+   * @returns \c false if no valid checkpoint was found
+   */
+  bool
+  load_checkpoint();
+
   /** Save results to disk in \c vtk format
    */
   void
@@ -169,16 +218,118 @@ private:
   void
   prepare_for_solve();
 
+  /** Structure that holds scratch data for the stabilization factor:
+   * the constant parameters
+   */
+  struct StabilizationScratchData
+  {
+    double tau0;
+    double C;
+  };
+
+  /** Structure that holds local contributions to the stabilization factor
+   */
+  struct StabilizationCopyData
+  {
+    std::vector<types::global_dof_index> local_dof_indices;
+    std::vector<double>                  factors;
+    double                               dt_C;
+  };
+
+  /** Local stabilization factor function
+   */
+  void
+  local_stabilization_factor(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    StabilizationScratchData &                            scratch_data,
+    StabilizationCopyData &                               copy_data);
+
   /** Assemble the system matrix and right-hand-side vector
    */
   void
   assemble_system();
 
-  /** Solve the system of linear equations
+  /** Structure that holds scratch data
+   */
+  struct AssemblyScratchData
+  {
+    AssemblyScratchData(const Quadrature<dim> &   quadrature,
+                        const FiniteElement<dim> &fe,
+                        const unsigned int        n_fields);
+    AssemblyScratchData(const AssemblyScratchData &scratch_data);
+
+    FEValues<dim> fe_values;
+
+    std::vector<std::vector<double>>         f_prev_q;
+    std::vector<std::vector<Tensor<1, dim>>> grad_f_prev_q;
+    std::vector<double>                      u_component_q;
+    std::vector<Tensor<1, dim>>              u_q;
+  };
+
+  /** Structure that holds local contributions
+   */
+  struct AssemblyCopyData
+  {
+    FullMatrix<double>                   cell_matrix;
+    BlockVector<double>                  cell_rhs;
+    std::vector<types::global_dof_index> local_dof_indices;
+  };
+
+  /** Parameters of the iterative linear solver, read from \c prm once before
+   * the fields are solved concurrently
+   */
+  struct LinearSolverSettings
+  {
+    std::string  type;
+    unsigned int iterations;
+    double       tolerance;
+    double       rel_tolerance;
+    bool         log_history;
+    bool         log_result;
+  };
+
+  /** Local assembly function
+   */
+  void
+  local_assemble_system(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    AssemblyScratchData &                                 scratch_data,
+    AssemblyCopyData &                                    copy_data);
+
+  /** Copy local contributions to global
+   */
+  void
+  copy_local_to_global(const AssemblyCopyData &copy_data);
+
+  /** Solve the system of linear equations for all fields.
+   * The matrix is factorized or preconditioned once, the fields are solved
+   * in parallel by iterative solvers.
    */
   void
   solve_system();
 
+  /** Solve the system of linear equations for the field \c k
+   * with the given solver settings and preconditioner. Does not access
+   * \c prm, can be called concurrently for different fields.
+   * @returns warning message if not converged
+   */
+  template <typename PreconditionerType>
+  std::string
+  solve_field(const unsigned int          k,
+              const LinearSolverSettings &settings,
+              const PreconditionerType &  preconditioner);
+
+  /** Returns \c true if the factorization of the given type was calculated
+   * for the current system matrix (same hash)
+   */
+  bool
+  is_factorization_up_to_date(const std::string &type) const;
+
+  /** Store the hash of the factorized system matrix of the given type
+   */
+  void
+  store_factorized_matrix(const std::string &type);
+
   /** Calculate field change and limit if necessary
    */
   void
@@ -190,13 +341,19 @@ private:
   std::string
   output_name_suffix() const;
 
+  /** Helper method for creating checkpoint file name.
+   * @returns \c "checkpoint-advection-<dim>d-order<order>"
+   */
+  std::string
+  checkpoint_base_name() const;
+
   /** Velocity field split into components and magnitude, m/s
    */
   BlockVector<double> velocity;
 
   /** All FE fields
    */
-  std::map<std::string, Vector<double>> fields;
+  FieldStore fields;
 
   /** Time derivative of all FE fields
    */
@@ -215,6 +372,10 @@ private:
    */
   StabilizationType stabilization_type;
 
+  /** Time stepping theta, read from \c prm before the assembly
+   */
+  double theta;
+
   /** Mesh
    */
   Triangulation<dim> triangulation;
@@ -227,6 +388,14 @@ private:
    */
   DoFHandler<dim> dh;
 
+  /** Hanging node constraints, empty without local refinement
+   */
+  HangingNodeConstraints hanging_node_constraints;
+
+  /** Transfer of the fields to the adapted mesh
+   */
+  FieldTransfer<dim> field_transfer;
+
   /** Sparsity pattern
    */
   SparsityPattern sparsity_pattern;
@@ -239,6 +408,23 @@ private:
    */
   BlockVector<double> system_rhs;
 
+  /** Hash of the system matrix at the time of the last factorization,
+   * stored only if factorization reuse is enabled
+   */
+  std::uint64_t factorized_hash = 0;
+
+  /** Type of the stored factorization ("UMFPACK", "ilu" or empty)
+   */
+  std::string factorization_type;
+
+  /** LU factorization of the system matrix (reused if unchanged)
+   */
+  SparseDirectUMFPACK direct_solver;
+
+  /** ILU preconditioner of the system matrix (reused if unchanged)
+   */
+  SparseILU<double> ilu;
+
   /** Boundary IDs for first-type BC
    */
   std::set<unsigned int> bc1;
@@ -259,6 +445,23 @@ private:
    * Calculated based on the Courant number.
    */
   double time_step_scale;
+
+  /** Writer for field output, keeps the time-series index
+   */
+  mutable DataOutWriter<dim> output_writer;
+
+  /** Writer of output files in a background thread. Declared after all data
+   * referenced by queued tasks, so it is destroyed (and flushed) first.
+   */
+  mutable BackgroundWriter background_writer;
+
+  /** Performance measurements
+   */
+  std::shared_ptr<Profiler> profiler;
+
+  /** Log output
+   */
+  mutable Logger logger;
 };
 
 
@@ -269,18 +472,20 @@ AdvectionSolver<dim>::AdvectionSolver(const unsigned int order,
                                       const bool         use_default_prm)
   : fe(order)
   , dh(triangulation)
+  , field_transfer(dh)
   , current_time(0)
   , current_time_step(0)
   , time_step_scale(1)
+  , profiler(std::make_shared<Profiler>())
 {
-  std::cout << "Creating advection solver, order=" << order << ", dim=" << dim
-            << " ("
+  logger.info() << "Creating advection solver, order=" << order
+                << ", dim=" << dim << " ("
 #ifdef DEBUG
-               "Debug"
+                   "Debug"
 #else
-               "Release"
+                   "Release"
 #endif
-               ")\n";
+                   ")\n";
 
   prm.declare_entry("Time stepping theta",
                     "1",
@@ -333,7 +538,8 @@ AdvectionSolver<dim>::AdvectionSolver(const unsigned int order,
   prm.declare_entry("Preconditioner type",
                     "jacobi",
                     Patterns::Selection(
-                      PreconditionSelector<>::get_precondition_names()),
+                      PreconditionSelector<>::get_precondition_names() +
+                      "|ilu"),
                     "Name of preconditioner");
 
   prm.declare_entry("Preconditioner relaxation",
@@ -341,6 +547,12 @@ AdvectionSolver<dim>::AdvectionSolver(const unsigned int order,
                     Patterns::Double(0),
                     "Relaxation factor of preconditioner");
 
+  prm.declare_entry("Reuse factorization",
+                    "false",
+                    Patterns::Bool(),
+                    "Reuse LU factorization (UMFPACK) or ILU preconditioner "
+                    "across time steps while the system matrix is unchanged");
+
   prm.declare_entry("Log convergence full",
                     "false",
                     Patterns::Bool(),
@@ -366,6 +578,12 @@ AdvectionSolver<dim>::AdvectionSolver(const unsigned int order,
                     Patterns::Integer(0),
                     "Number of QGauss<dim> quadrature points (0: order+1)");
 
+  prm.declare_entry("Number of threads",
+                    "0",
+                    Patterns::Integer(0),
+                    "Maximum number of threads to be used (0 - autodetect, "
+                    "ignored if fixed, e.g. for ensemble runs)");
+
   prm.declare_entry(
     "Output precision",
     "8",
@@ -377,6 +595,42 @@ AdvectionSolver<dim>::AdvectionSolver(const unsigned int order,
                     Patterns::Integer(0),
                     "Number of cell subdivisions for vtk output (0: order)");
 
+  prm.declare_entry("Output format",
+                    "vtk",
+                    Patterns::Selection(DataOutWriter<dim>::get_format_names()),
+                    "Format of field output (vtk - ASCII, vtu - compressed "
+                    "binary, hdf5 - HDF5 with XDMF index)");
+
+  prm.declare_entry("Output queue size",
+                    "0",
+                    Patterns::Integer(0),
+                    "Maximal number of output tasks queued for writing by a "
+                    "background thread (0 - write synchronously)");
+
+  prm.declare_entry("Number of checkpoints",
+                    "2",
+                    Patterns::Integer(1),
+                    "Number of rotated checkpoint files to keep");
+
+  prm.declare_entry("Log level",
+                    "default",
+                    Patterns::Selection("default|" + Logger::get_level_names()),
+                    "Verbosity of the log output (default - value of the "
+                    "MACPLAS_LOG_LEVEL environment variable if set, detail "
+                    "otherwise)");
+
+  prm.declare_entry("Profiling report",
+                    "",
+                    Patterns::Anything(),
+                    "Base name of JSON and CSV performance reports written at "
+                    "exit (empty - no report)");
+
+  prm.declare_entry("Profiling per time step",
+                    "false",
+                    Patterns::Bool(),
+                    "Additionally report the times of all phases at each "
+                    "time step");
+
   if (use_default_prm)
     {
       std::ofstream of("advection.prm");
@@ -389,23 +643,36 @@ AdvectionSolver<dim>::AdvectionSolver(const unsigned int order,
       }
     catch (std::exception &e)
       {
-        std::cout << e.what() << "\n";
+        logger.error() << e.what() << "\n";
 
         std::ofstream of("advection-default.prm");
         prm.print_parameters(of, ParameterHandler::Text);
       }
 
   initialize_parameters();
+
+  const std::string profiling_report = prm.get("Profiling report");
+  if (!profiling_report.empty())
+    profiler->set_report(profiling_report,
+                         prm.get_bool("Profiling per time step"));
 }
 
 template <int dim>
 void
 AdvectionSolver<dim>::initialize_parameters()
 {
-  std::cout << solver_name() << "  Initializing parameters";
+  logger.info() << solver_name() << "  Initializing parameters";
 
   get_time_step() = prm.get_double("Time step");
 
+  ThreadLimit::set(prm.get_integer("Number of threads"));
+
+  background_writer.set_max_queued_tasks(prm.get_integer("Output queue size"));
+
+  const std::string log_level = prm.get("Log level");
+  if (log_level != "default")
+    logger.set_level(log_level);
+
   const long int n_q_default = get_degree() + 1;
 
   if (prm.get_integer("Number of cell quadrature points") == 0)
@@ -424,10 +691,13 @@ AdvectionSolver<dim>::initialize_parameters()
   else
     AssertThrow(false, ExcMessage("Unsupported stabilization type " + st));
 
-  std::cout << "  done\n";
+  logger.info() << "  done\n";
+
+  logger.info() << "n_q_cell=" << prm.get("Number of cell quadrature points")
+                << "\n";
 
-  std::cout << "n_q_cell=" << prm.get("Number of cell quadrature points")
-            << "\n";
+  logger.info() << "n_cores=" << MultithreadInfo::n_cores() << "\n"
+                << "n_threads=" << MultithreadInfo::n_threads() << "\n";
 }
 
 template <int dim>
@@ -437,6 +707,20 @@ AdvectionSolver<dim>::solver_name() const
   return "MACPLAS:Advection";
 }
 
+template <int dim>
+std::shared_ptr<Profiler>
+AdvectionSolver<dim>::get_profiler() const
+{
+  return profiler;
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::set_profiler(const std::shared_ptr<Profiler> &profiler)
+{
+  this->profiler = profiler;
+}
+
 template <int dim>
 const Triangulation<dim> &
 AdvectionSolver<dim>::get_mesh() const
@@ -506,21 +790,82 @@ AdvectionSolver<dim>::initialize()
 {
   Timer timer;
 
-  std::cout << solver_name() << "  Initializing finite element solution";
+  logger.info() << solver_name() << "  Initializing finite element solution";
 
   dh.distribute_dofs(fe);
   const unsigned int n_dofs = dh.n_dofs();
 
+  calculate_hanging_node_constraints(dh, hanging_node_constraints);
+
   velocity.reinit(dim + 1, n_dofs); // dim components and magnitude
   stabilization_factor.reinit(n_dofs);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+
+  logger.info() << solver_name() << "  "
+                << "Number of active cells: " << triangulation.n_active_cells()
+                << "\n"
+                << solver_name() << "  "
+                << "Number of degrees of freedom: " << n_dofs << "\n";
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::prepare_for_refinement()
+{
+  field_transfer.clear();
+  for (unsigned int k = 0; k < dim; ++k)
+    field_transfer.add(velocity.block(k));
+  field_transfer.add(fields);
 
-  std::cout << solver_name() << "  "
-            << "Number of active cells: " << triangulation.n_active_cells()
-            << "\n"
-            << solver_name() << "  "
-            << "Number of degrees of freedom: " << n_dofs << "\n";
+  field_transfer.prepare();
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::finish_refinement()
+{
+  const Profiler::Scope scope(*profiler, "advection/refinement");
+
+  dh.distribute_dofs(fe);
+  const unsigned int n_dofs = dh.n_dofs();
+
+  calculate_hanging_node_constraints(dh, hanging_node_constraints);
+
+  field_transfer.interpolate(hanging_node_constraints);
+
+  velocity.reinit(dim + 1, n_dofs);
+  for (unsigned int k = 0; k < dim; ++k)
+    field_transfer.get(k, velocity.block(k));
+
+  auto &U_mag = velocity.block(dim);
+  for (unsigned int i = 0; i < n_dofs; ++i)
+    {
+      double u2 = 0;
+      for (unsigned int k = 0; k < dim; ++k)
+        u2 += sqr(velocity.block(k)[i]);
+      U_mag[i] = std::sqrt(u2);
+    }
+
+  field_transfer.get(fields);
+  field_transfer.clear();
+
+  dot_fields.clear();
+  stabilization_factor.reinit(n_dofs);
+
+  // rebuilt by prepare_for_solve, the factorization is recalculated
+  system_matrix.clear();
+  factorized_hash = 0;
+  factorization_type.clear();
+  direct_solver.clear();
+  ilu.clear();
+  sparsity_pattern.reinit(0, 0, 0);
+
+  logger.info() << solver_name() << "  "
+                << "Number of active cells: " << triangulation.n_active_cells()
+                << "\n"
+                << solver_name() << "  "
+                << "Number of degrees of freedom: " << n_dofs << "\n";
 }
 
 template <int dim>
@@ -565,7 +910,15 @@ void
 AdvectionSolver<dim>::add_field(const std::string &   name,
                                 const Vector<double> &field)
 {
-  fields[name] = field;
+  fields.set(name, field);
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::add_field(const std::string &              name,
+                                const FieldStore::FieldPointer &field)
+{
+  fields.set(name, field);
 }
 
 template <int dim>
@@ -589,12 +942,17 @@ AdvectionSolver<dim>::solve(const bool skip_time_advance)
   prepare_for_solve();
   assemble_system();
   solve_system();
+  for (unsigned int k = 0; k < fields_prev.n_blocks(); ++k)
+    hanging_node_constraints.distribute(fields_prev.block(k));
   postprocess_fields();
 
-  std::cout << solver_name() << "  "
-            << "Time " << t << " s"
-            << " step " << dt << " s"
-            << " scale=" << time_step_scale << " n_fields=" << n_fields << "\n";
+  logger.info() << solver_name() << "  "
+                << "Time " << t << " s"
+                << " step " << dt << " s"
+                << " scale=" << time_step_scale << " n_fields=" << n_fields
+                << "\n";
+
+  profiler->end_time_step(t);
 
   return t + 1e-4 * dt < t_max;
 }
@@ -639,6 +997,8 @@ template <int dim>
 void
 AdvectionSolver<dim>::prepare_for_solve()
 {
+  const Profiler::Scope scope(*profiler, "advection/prepare");
+
   const unsigned int n_dofs   = dh.n_dofs();
   const unsigned int n_fields = fields.size();
 
@@ -650,8 +1010,8 @@ AdvectionSolver<dim>::prepare_for_solve()
   unsigned int k = 0;
   for (const auto &it : fields)
     {
-      AssertDimension(n_dofs, it.second.size());
-      fields_prev.block(k) = it.second;
+      AssertDimension(n_dofs, it.second->size());
+      fields_prev.block(k) = *it.second;
       dot_fields[it.first].reinit(n_dofs);
       ++k;
     }
@@ -661,31 +1021,27 @@ AdvectionSolver<dim>::prepare_for_solve()
   const double dt   = get_time_step();
   double       dt_C = std::numeric_limits<double>::max();
 
-  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-  typename DoFHandler<dim>::active_cell_iterator cell = dh.begin_active(),
-                                                 endc = dh.end();
-  for (; cell != endc; ++cell)
-    {
-      const double h = cell->diameter();
-
-      cell->get_dof_indices(local_dof_indices);
-
-      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+  // the factors are calculated in parallel, only the maximum over cells is
+  // taken in the (serial) copier
+  WorkStream::run(
+    dh.begin_active(),
+    dh.end(),
+    [this](const typename DoFHandler<dim>::active_cell_iterator &cell,
+           StabilizationScratchData &scratch_data,
+           StabilizationCopyData &   copy_data) {
+      local_stabilization_factor(cell, scratch_data, copy_data);
+    },
+    [&](const StabilizationCopyData &copy_data) {
+      for (unsigned int i = 0; i < copy_data.local_dof_indices.size(); ++i)
         {
-          const unsigned int j = local_dof_indices[i];
-          const double       u = velocity.block(dim)[j];
-
-          if (u > 0)
-            {
-              stabilization_factor[j] =
-                std::max(stabilization_factor[j], tau0 * h / (2 * u));
-              dt_C = std::min(dt_C, C * h / u);
-            }
+          const auto j            = copy_data.local_dof_indices[i];
+          stabilization_factor[j] = std::max(stabilization_factor[j],
+                                             copy_data.factors[i]);
         }
-    }
+      dt_C = std::min(dt_C, copy_data.dt_C);
+    },
+    StabilizationScratchData{tau0, C},
+    StabilizationCopyData());
 
   if (dt_C > 0 && dt_C < std::numeric_limits<double>::max())
     time_step_scale = dt_C / dt;
@@ -694,7 +1050,7 @@ AdvectionSolver<dim>::prepare_for_solve()
     return;
 
   DynamicSparsityPattern dsp(n_dofs);
-  DoFTools::make_sparsity_pattern(dh, dsp);
+  DoFTools::make_sparsity_pattern(dh, dsp, hanging_node_constraints, false);
 
   sparsity_pattern.copy_from(dsp);
   system_matrix.reinit(sparsity_pattern);
@@ -702,111 +1058,88 @@ AdvectionSolver<dim>::prepare_for_solve()
 
 template <int dim>
 void
-AdvectionSolver<dim>::assemble_system()
+AdvectionSolver<dim>::local_stabilization_factor(
+  const typename DoFHandler<dim>::active_cell_iterator &cell,
+  StabilizationScratchData &scratch_data,
+  StabilizationCopyData &   copy_data)
 {
-  Timer timer;
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  const double       h             = cell->diameter();
 
-  std::cout << solver_name() << "  Assembling system";
+  copy_data.local_dof_indices.resize(dofs_per_cell);
+  copy_data.factors.resize(dofs_per_cell);
+  copy_data.dt_C = std::numeric_limits<double>::max();
+  cell->get_dof_indices(copy_data.local_dof_indices);
 
-  const double dt     = get_time_step() * time_step_scale;
-  const double tau_dt = stabilization_type == gls ? 1 / dt : 0;
-  const double theta  = prm.get_double("Time stepping theta");
+  for (unsigned int i = 0; i < dofs_per_cell; ++i)
+    {
+      const double u = velocity.block(dim)[copy_data.local_dof_indices[i]];
 
-  const QGauss<dim> quadrature(
-    prm.get_integer("Number of cell quadrature points"));
+      copy_data.factors[i] = 0;
+      if (u > 0)
+        {
+          copy_data.factors[i] = scratch_data.tau0 * h / (2 * u);
+          copy_data.dt_C = std::min(copy_data.dt_C, scratch_data.C * h / u);
+        }
+    }
+}
 
-  FEValues<dim> fe_values(fe,
-                          quadrature,
-                          update_values | update_gradients | update_JxW_values);
+template <int dim>
+AdvectionSolver<dim>::AssemblyScratchData::AssemblyScratchData(
+  const Quadrature<dim> &   quadrature,
+  const FiniteElement<dim> &fe,
+  const unsigned int        n_fields)
+  : fe_values(fe,
+              quadrature,
+              update_values | update_gradients | update_JxW_values)
+  , f_prev_q(n_fields, std::vector<double>(quadrature.size()))
+  , grad_f_prev_q(n_fields, std::vector<Tensor<1, dim>>(quadrature.size()))
+  , u_component_q(quadrature.size())
+  , u_q(quadrature.size())
+{}
 
-  const unsigned int n_dofs        = dh.n_dofs();
-  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-  const unsigned int n_q_points    = quadrature.size();
-  const unsigned int n_fields      = fields_prev.n_blocks();
+template <int dim>
+AdvectionSolver<dim>::AssemblyScratchData::AssemblyScratchData(
+  const AssemblyScratchData &scratch_data)
+  : fe_values(scratch_data.fe_values.get_fe(),
+              scratch_data.fe_values.get_quadrature(),
+              scratch_data.fe_values.get_update_flags())
+  , f_prev_q(scratch_data.f_prev_q)
+  , grad_f_prev_q(scratch_data.grad_f_prev_q)
+  , u_component_q(scratch_data.u_component_q)
+  , u_q(scratch_data.u_q)
+{}
 
-  std::vector<std::vector<double>> f_prev_q(n_fields,
-                                            std::vector<double>(n_q_points));
+template <int dim>
+void
+AdvectionSolver<dim>::assemble_system()
+{
+  const Profiler::Scope scope(*profiler, "advection/assemble");
 
-  std::vector<std::vector<Tensor<1, dim>>> grad_f_prev_q(
-    n_fields, std::vector<Tensor<1, dim>>(n_q_points));
+  Timer timer;
 
-  std::vector<double>         u_component_q(n_q_points);
-  std::vector<Tensor<1, dim>> u_q(n_q_points);
+  logger.info() << solver_name() << "  Assembling system";
 
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+  const QGauss<dim> quadrature(
+    prm.get_integer("Number of cell quadrature points"));
 
-  FullMatrix<double>  cell_matrix(dofs_per_cell, dofs_per_cell);
-  BlockVector<double> cell_rhs(n_fields, dofs_per_cell);
+  const unsigned int n_dofs   = dh.n_dofs();
+  const unsigned int n_fields = fields_prev.n_blocks();
 
   system_matrix = 0;
   system_rhs    = 0;
 
-  typename DoFHandler<dim>::active_cell_iterator cell = dh.begin_active(),
-                                                 endc = dh.end();
-  for (; cell != endc; ++cell)
-    {
-      cell_matrix.reinit(dofs_per_cell, dofs_per_cell);
-      cell_rhs.reinit(n_fields, dofs_per_cell);
-
-      fe_values.reinit(cell);
-
-      cell->get_dof_indices(local_dof_indices);
-
-      for (unsigned int k = 0; k < n_fields; ++k)
-        {
-          fe_values.get_function_values(fields_prev.block(k), f_prev_q[k]);
-          fe_values.get_function_gradients(fields_prev.block(k),
-                                           grad_f_prev_q[k]);
-        }
-
-      for (unsigned int k = 0; k < dim; ++k)
-        {
-          fe_values.get_function_values(velocity.block(k), u_component_q);
-          for (unsigned int q = 0; q < n_q_points; ++q)
-            u_q[q][k] = u_component_q[q];
-        }
-
-      for (unsigned int q = 0; q < n_q_points; ++q)
-        {
-          const double weight = fe_values.JxW(q);
-
-          for (unsigned int i = 0; i < dofs_per_cell; ++i)
-            {
-              const double tau    = stabilization_factor[local_dof_indices[i]];
-              const double phi_i0 = fe_values.shape_value(i, q);
-              const double phi_i =
-                phi_i0 +
-                tau * (phi_i0 * tau_dt + u_q[q] * fe_values.shape_grad(i, q));
-
-              for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                {
-                  const double          phi_j = fe_values.shape_value(j, q);
-                  const Tensor<1, dim> &grad_phi_j = fe_values.shape_grad(j, q);
-
-                  cell_matrix(i, j) +=
-                    (phi_j / dt + theta * (u_q[q] * grad_phi_j)) * phi_i *
-                    weight;
-                }
-
-              for (unsigned int k = 0; k < n_fields; ++k)
-                cell_rhs.block(k)(i) +=
-                  (f_prev_q[k][q] / dt +
-                   (theta - 1) * (u_q[q] * grad_f_prev_q[k][q])) *
-                  phi_i * weight;
-            }
-        }
-
-      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-        {
-          for (unsigned int j = 0; j < dofs_per_cell; ++j)
-            system_matrix.add(local_dof_indices[i],
-                              local_dof_indices[j],
-                              cell_matrix(i, j));
+  // read once, not in each cell
+  theta = prm.get_double("Time stepping theta");
 
-          for (unsigned int k = 0; k < n_fields; ++k)
-            system_rhs.block(k)(local_dof_indices[i]) += cell_rhs.block(k)(i);
-        }
-    }
+  // the matrix and all right-hand-side blocks are assembled in one pass
+  WorkStream::run(dh.begin_active(),
+                  dh.end(),
+                  *this,
+                  &AdvectionSolver::local_assemble_system,
+                  &AdvectionSolver::copy_local_to_global,
+                  AssemblyScratchData(quadrature, fe, n_fields),
+                  AssemblyCopyData());
 
   // apply Dirichlet boundary conditions
   for (const auto &b : bc1)
@@ -840,104 +1173,320 @@ AdvectionSolver<dim>::assemble_system()
         }
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::local_assemble_system(
+  const typename DoFHandler<dim>::active_cell_iterator &cell,
+  AssemblyScratchData &                                 scratch_data,
+  AssemblyCopyData &                                    copy_data)
+{
+  // precalculate constant parameters
+  const double dt     = get_time_step() * time_step_scale;
+  const double tau_dt = stabilization_type == gls ? 1 / dt : 0;
+
+  FEValues<dim> &        fe_values  = scratch_data.fe_values;
+  const Quadrature<dim> &quadrature = fe_values.get_quadrature();
+
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  const unsigned int n_q_points    = quadrature.size();
+  const unsigned int n_fields      = fields_prev.n_blocks();
+
+  std::vector<std::vector<double>> &f_prev_q = scratch_data.f_prev_q;
+  std::vector<std::vector<Tensor<1, dim>>> &grad_f_prev_q =
+    scratch_data.grad_f_prev_q;
+  std::vector<double> &        u_component_q = scratch_data.u_component_q;
+  std::vector<Tensor<1, dim>> &u_q           = scratch_data.u_q;
+
+  FullMatrix<double> & cell_matrix = copy_data.cell_matrix;
+  BlockVector<double> &cell_rhs    = copy_data.cell_rhs;
+
+  std::vector<types::global_dof_index> &local_dof_indices =
+    copy_data.local_dof_indices;
+
+  // resize and initialize with zeros
+  cell_matrix.reinit(dofs_per_cell, dofs_per_cell);
+  cell_rhs.reinit(n_fields, dofs_per_cell);
+  local_dof_indices.resize(dofs_per_cell);
+
+  fe_values.reinit(cell);
+
+  cell->get_dof_indices(local_dof_indices);
+
+  for (unsigned int k = 0; k < n_fields; ++k)
+    {
+      fe_values.get_function_values(fields_prev.block(k), f_prev_q[k]);
+      fe_values.get_function_gradients(fields_prev.block(k), grad_f_prev_q[k]);
+    }
+
+  for (unsigned int k = 0; k < dim; ++k)
+    {
+      fe_values.get_function_values(velocity.block(k), u_component_q);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        u_q[q][k] = u_component_q[q];
+    }
+
+  for (unsigned int q = 0; q < n_q_points; ++q)
+    {
+      const double weight = fe_values.JxW(q);
+
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+        {
+          const double tau    = stabilization_factor[local_dof_indices[i]];
+          const double phi_i0 = fe_values.shape_value(i, q);
+          const double phi_i =
+            phi_i0 +
+            tau * (phi_i0 * tau_dt + u_q[q] * fe_values.shape_grad(i, q));
+
+          for (unsigned int j = 0; j < dofs_per_cell; ++j)
+            {
+              const double          phi_j      = fe_values.shape_value(j, q);
+              const Tensor<1, dim> &grad_phi_j = fe_values.shape_grad(j, q);
+
+              cell_matrix(i, j) +=
+                (phi_j / dt + theta * (u_q[q] * grad_phi_j)) * phi_i * weight;
+            }
+
+          for (unsigned int k = 0; k < n_fields; ++k)
+            cell_rhs.block(k)(i) +=
+              (f_prev_q[k][q] / dt +
+               (theta - 1) * (u_q[q] * grad_f_prev_q[k][q])) *
+              phi_i * weight;
+        }
+    }
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::copy_local_to_global(const AssemblyCopyData &copy_data)
+{
+  const unsigned int n_fields = copy_data.cell_rhs.n_blocks();
+
+  hanging_node_constraints.distribute_local_to_global(
+    copy_data.cell_matrix, copy_data.local_dof_indices, system_matrix);
+
+  for (unsigned int k = 0; k < n_fields; ++k)
+    hanging_node_constraints.distribute_local_to_global(
+      copy_data.cell_rhs.block(k),
+      copy_data.local_dof_indices,
+      system_rhs.block(k));
 }
 
 template <int dim>
 void
 AdvectionSolver<dim>::solve_system()
 {
+  const Profiler::Scope scope(*profiler, "advection/linear solve");
+
   Timer timer;
 
-  std::cout << solver_name() << "  Solving system";
+  logger.info() << solver_name() << "  Solving system";
 
   const unsigned int n_fields = fields_prev.n_blocks();
 
   const std::string solver_type = prm.get("Linear solver type");
+  const bool        reuse       = prm.get_bool("Reuse factorization");
 
   if (solver_type == "UMFPACK")
     {
-      std::cout << " (" << solver_type << ")";
+      logger.info() << " (" << solver_type;
+
+      if (reuse && is_factorization_up_to_date(solver_type))
+        {
+          logger.info() << ", reused";
+        }
+      else
+        {
+          direct_solver.initialize(system_matrix);
+
+          if (reuse)
+            store_factorized_matrix(solver_type);
+        }
 
-      SparseDirectUMFPACK A;
-      A.initialize(system_matrix);
+      logger.info() << ")";
 
       for (unsigned int k = 0; k < n_fields; ++k)
         {
-          A.vmult(fields_prev.block(k), system_rhs.block(k));
+          direct_solver.vmult(fields_prev.block(k), system_rhs.block(k));
         }
+
+      if (!reuse)
+        direct_solver.clear();
     }
   else
     {
-      const unsigned int solver_iterations =
-        prm.get_integer("Linear solver iterations");
-      const double solver_rel_tolerance =
+      // ParameterHandler is not thread-safe, read all parameters before
+      // the fields are solved concurrently
+      LinearSolverSettings settings;
+      settings.type       = solver_type;
+      settings.iterations = prm.get_integer("Linear solver iterations");
+      settings.tolerance  = prm.get_double("Linear solver tolerance");
+      settings.rel_tolerance =
         prm.get_double("Linear solver relative tolerance");
+      settings.log_history = prm.get_bool("Log convergence full");
+      settings.log_result  = prm.get_bool("Log convergence final");
 
-      const bool log_history = prm.get_bool("Log convergence full");
-      const bool log_result  = prm.get_bool("Log convergence final");
+      const bool log_history = settings.log_history;
+      const bool log_result  = settings.log_result;
 
       if (log_history || log_result)
-        std::cout << "\n";
+        logger.info() << "\n";
+
+      std::vector<std::string> warnings(n_fields);
+
+      // the fields are independent, full convergence log is kept readable
+      const auto solve_all = [&](const auto &preconditioner) {
+        if (log_history)
+          {
+            for (unsigned int k = 0; k < n_fields; ++k)
+              warnings[k] = solve_field(k, settings, preconditioner);
+          }
+        else
+          {
+            Threads::TaskGroup<void> tasks;
+            for (unsigned int k = 0; k < n_fields; ++k)
+              tasks += Threads::new_task([&, k]() {
+                warnings[k] = solve_field(k, settings, preconditioner);
+              });
+            tasks.join_all();
+          }
+      };
 
       const std::string preconditioner_type = prm.get("Preconditioner type");
-      const double      preconditioner_relaxation =
-        prm.get_double("Preconditioner relaxation");
 
-      PreconditionSelector<> preconditioner(preconditioner_type,
-                                            preconditioner_relaxation);
-      preconditioner.use_matrix(system_matrix);
+      if (preconditioner_type == "ilu")
+        {
+          if (reuse && is_factorization_up_to_date(preconditioner_type))
+            {
+              // the line is already terminated if the convergence is logged
+              if (log_history || log_result)
+                logger.info() << solver_name() << "  Reusing ILU\n";
+              else
+                logger.info() << " (ILU reused)";
+            }
+          else
+            {
+              ilu.initialize(system_matrix);
 
-      for (unsigned int k = 0; k < n_fields; ++k)
+              if (reuse)
+                store_factorized_matrix(preconditioner_type);
+            }
+
+          solve_all(ilu);
+
+          if (!reuse)
+            ilu.clear();
+        }
+      else
         {
-          double solver_tolerance = prm.get_double("Linear solver tolerance");
+          const double preconditioner_relaxation =
+            prm.get_double("Preconditioner relaxation");
 
-          const double rhs_norm = system_rhs.block(k).l2_norm();
+          PreconditionSelector<> preconditioner(preconditioner_type,
+                                                preconditioner_relaxation);
+          preconditioner.use_matrix(system_matrix);
 
-          if (rhs_norm > 0)
-            solver_tolerance *= rhs_norm;
+          solve_all(preconditioner);
+        }
 
-          ReductionControl control(solver_iterations,
-                                   solver_tolerance,
-                                   solver_rel_tolerance,
-                                   log_history,
-                                   log_result);
-          SolverSelector<> solver;
-          solver.select(solver_type);
-          solver.set_control(control);
+      for (const auto &w : warnings)
+        {
+          if (w.empty())
+            continue;
 
-          try
-            {
-              solver.solve(system_matrix,
-                           fields_prev.block(k),
-                           system_rhs.block(k),
-                           preconditioner);
-            }
-          catch (dealii::SolverControl::NoConvergence &e)
-            {
-              if (control.last_step() < solver_iterations)
-                throw;
-              // otherwise: maximum number of iterations reached, do nothing
-            }
+          if (!(log_history || log_result))
+            logger.info() << "\n";
 
-          if (control.last_step() >= solver_iterations ||
-              (control.last_value() >= solver_tolerance &&
-               control.last_value() >=
-                 control.initial_value() * solver_rel_tolerance))
-            {
-              if (!(log_history || log_result))
-                std::cout << "\n";
-
-              std::cout << solver_name()
-                        << "  Warning: not converged! Residual(0)="
-                        << control.initial_value() << " Residual("
-                        << control.last_step() << ")=" << control.last_value()
-                        << " tol=" << solver_tolerance << "\n";
-            }
+          logger.info() << w;
         }
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+template <typename PreconditionerType>
+std::string
+AdvectionSolver<dim>::solve_field(const unsigned int          k,
+                                  const LinearSolverSettings &settings,
+                                  const PreconditionerType &  preconditioner)
+{
+  const unsigned int solver_iterations    = settings.iterations;
+  const double       solver_rel_tolerance = settings.rel_tolerance;
+
+  const bool log_history = settings.log_history;
+  const bool log_result  = settings.log_result;
+
+  double solver_tolerance = settings.tolerance;
+
+  const double rhs_norm = system_rhs.block(k).l2_norm();
+
+  if (rhs_norm > 0)
+    solver_tolerance *= rhs_norm;
+
+  ReductionControl control(solver_iterations,
+                           solver_tolerance,
+                           solver_rel_tolerance,
+                           log_history,
+                           log_result);
+  SolverSelector<> solver;
+  solver.select(settings.type);
+  solver.set_control(control);
+
+  try
+    {
+      solver.solve(system_matrix,
+                   fields_prev.block(k),
+                   system_rhs.block(k),
+                   preconditioner);
+    }
+  catch (dealii::SolverControl::NoConvergence &e)
+    {
+      if (control.last_step() < solver_iterations)
+        throw;
+      // otherwise: maximum number of iterations reached, do nothing
+    }
+
+  profiler->add_count("advection/linear iterations", control.last_step());
+
+  if (control.last_step() >= solver_iterations ||
+      (control.last_value() >= solver_tolerance &&
+       control.last_value() >= control.initial_value() * solver_rel_tolerance))
+    {
+      std::stringstream ss;
+      ss << solver_name() << "  Warning: not converged! Residual(0)="
+         << control.initial_value() << " Residual(" << control.last_step()
+         << ")=" << control.last_value() << " tol=" << solver_tolerance
+         << "\n";
+      return ss.str();
+    }
+
+  return "";
+}
+
+template <int dim>
+bool
+AdvectionSolver<dim>::is_factorization_up_to_date(
+  const std::string &type) const
+{
+  return factorization_type == type && !system_matrix.empty() &&
+         matrix_hash(system_matrix) == factorized_hash;
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::store_factorized_matrix(const std::string &type)
+{
+  factorized_hash    = matrix_hash(system_matrix);
+  factorization_type = type;
+
+  // only one factorization is stored
+  if (type != "UMFPACK")
+    direct_solver.clear();
+  if (type != "ilu")
+    ilu.clear();
 }
 
 template <int dim>
@@ -945,11 +1494,11 @@ void
 AdvectionSolver<dim>::postprocess_fields()
 {
   unsigned int k = 0;
-  for (auto &it : fields)
+  for (const auto &it : fields)
     {
-      Vector<double> &f_new = fields_prev.block(k);
-      Vector<double> &f_old = it.second;
-      Vector<double> &df    = dot_fields[it.first];
+      Vector<double> &      f_new = fields_prev.block(k);
+      const Vector<double> &f_old = *it.second;
+      Vector<double> &      df    = dot_fields[it.first];
 
       // calculate the correct field change
       df = f_new;
@@ -977,9 +1526,11 @@ AdvectionSolver<dim>::postprocess_fields()
           df -= f_old;
         }
 
-      f_old = f_new;
       df /= get_time_step();
 
+      // a shared field is replaced, not modified
+      fields.set(it.first, f_new);
+
       ++k;
     }
 }
@@ -994,29 +1545,115 @@ AdvectionSolver<dim>::output_name_suffix() const
   return ss.str();
 }
 
+template <int dim>
+std::string
+AdvectionSolver<dim>::checkpoint_base_name() const
+{
+  return "checkpoint-advection-" + std::to_string(dim) + "d-order" +
+         std::to_string(get_degree());
+}
+
 template <int dim>
 const Vector<double> &
 AdvectionSolver<dim>::get_field(const std::string &name) const
 {
-  return fields.at(name);
+  return fields.get(name);
 }
 
 template <int dim>
 void
-AdvectionSolver<dim>::output_vtk() const
+AdvectionSolver<dim>::output_checkpoint() const
 {
   Timer timer;
 
+  const std::string base_name = checkpoint_base_name();
+  logger.info() << solver_name() << "  Saving checkpoint '"
+                << CheckpointArchive::get_file_name(base_name, 0) << "'";
+
+  // finish the queued output, the checkpoint should not be newer than it
+  background_writer.flush();
+
+  CheckpointArchive archive;
+  archive.add_mesh("mesh", triangulation);
+  archive.add_data("velocity", velocity);
+  for (const auto &it : fields)
+    archive.add_data("field:" + it.first, *it.second);
+
+  archive.add_value("time", current_time);
+  archive.add_value("time_step", current_time_step);
+
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  archive.add_string("parameters", ss.str());
+
+  archive.write(base_name, prm.get_integer("Number of checkpoints"));
+
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+bool
+AdvectionSolver<dim>::load_checkpoint()
+{
+  Timer timer;
+
+  CheckpointArchive archive;
+
   const std::string file_name =
-    "result-advection" + output_name_suffix() + ".vtk";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+    archive.read(checkpoint_base_name(),
+                 prm.get_integer("Number of checkpoints"));
+  if (file_name.empty())
+    {
+      logger.info() << solver_name() << "  No valid checkpoint found\n";
+      return false;
+    }
 
-  DataOut<dim> data_out;
+  logger.info() << solver_name() << "  Loading checkpoint '" << file_name
+                << "'\n";
+
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  if (archive.get_string("parameters") != ss.str())
+    logger.warning() << solver_name()
+                     << "  Warning: parameters differ from the checkpoint, "
+                        "using the current values\n";
+
+  archive.get_mesh("mesh", triangulation);
+  initialize();
+
+  archive.get_data("velocity", velocity);
+  for (const auto &name : archive.get_names("field:"))
+    archive.get_data("field:" + name, fields.get_mutable(name));
+
+  current_time      = archive.get_value("time");
+  current_time_step = archive.get_value("time_step");
+
+  logger.info() << solver_name() << "  Restored t=" << get_time()
+                << " s, dt=" << get_time_step() << " s " << format_time(timer)
+                << "\n";
+
+  return true;
+}
+
+template <int dim>
+void
+AdvectionSolver<dim>::output_vtk() const
+{
+  const Profiler::Scope scope(*profiler, "advection/output");
+
+  Timer timer;
+
+  const std::string format    = prm.get("Output format");
+  const std::string file_name = "result-advection" + output_name_suffix();
+  logger.info() << solver_name() << "  Saving to '" << file_name << "."
+                << DataOutWriter<dim>::get_extension(format) << "'";
+
+  BufferedDataOut<dim> data_out;
 
   data_out.attach_dof_handler(dh);
 
   for (const auto &it : fields)
-    data_out.add_data_vector(it.second, it.first);
+    data_out.add_data_vector(*it.second, it.first);
 
   for (const auto &it : dot_fields)
     data_out.add_data_vector(it.second, "dot_" + it.first);
@@ -1028,14 +1665,18 @@ AdvectionSolver<dim>::output_vtk() const
 
   data_out.build_patches(prm.get_integer("Output subdivisions"));
 
-  std::ofstream output(file_name);
+  const std::string series_name = "result-advection-" + std::to_string(dim) +
+                                  "d-order" + std::to_string(get_degree());
 
-  const int precision = prm.get_integer("Output precision");
-  output << std::setprecision(precision);
+  output_writer.write(data_out,
+                      file_name,
+                      series_name,
+                      format,
+                      get_time(),
+                      prm.get_integer("Output precision"),
+                      background_writer);
 
-  data_out.write_vtk(output);
-
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1052,15 +1693,15 @@ AdvectionSolver<dim>::output_boundary_values(const unsigned int id) const
                    boundary_dofs.cend(),
                    [](const bool b) { return b; }))
     {
-      std::cout << solver_name()
-                << "  output_boundary_values: skipping empty boundary " << id
-                << "\n";
+      logger.info() << solver_name()
+                    << "  output_boundary_values: skipping empty boundary "
+                    << id << "\n";
       return;
     }
 
   const std::string file_name = "result-advection" + output_name_suffix() +
                                 "-boundary" + std::to_string(id) + ".dat";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  logger.info() << solver_name() << "  Saving to '" << file_name << "'";
 
   std::ofstream output(file_name);
 
@@ -1092,7 +1733,7 @@ AdvectionSolver<dim>::output_boundary_values(const unsigned int id) const
         output << points[i][d] << '\t';
 
       for (const auto &it : fields)
-        output << it.second[i] << '\t';
+        output << (*it.second)[i] << '\t';
 
       for (unsigned int k = 0; k < dim; ++k)
         output << velocity.block(k)[i] << '\t';
@@ -1100,7 +1741,7 @@ AdvectionSolver<dim>::output_boundary_values(const unsigned int id) const
       output << stabilization_factor[i] << '\n';
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 #endif
\ No newline at end of file
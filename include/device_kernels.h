@@ -0,0 +1,655 @@
+#ifndef macplas_device_kernels_h
+#define macplas_device_kernels_h
+
+// Optional Kokkos backend of the pointwise dislocation and stress kernels,
+// enabled by defining MACPLAS_WITH_KOKKOS at compile time. Requires deal.II
+// built with Kokkos (bundled since deal.II 9.5) or Kokkos 3.6 or later
+// linked to the application.
+#ifdef MACPLAS_WITH_KOKKOS
+
+#  include <deal.II/lac/block_vector.h>
+#  include <deal.II/lac/vector.h>
+
+#  include <Kokkos_Core.hpp>
+
+#  include <cstdlib>
+#  include <mutex>
+#  include <string>
+#  include <vector>
+
+#  include "utilities.h"
+
+using namespace dealii;
+
+/** Field in the memory of the Kokkos default execution space
+ */
+using DeviceVector = Kokkos::View<double *, Kokkos::LayoutLeft>;
+
+/** Block field in the memory of the Kokkos default execution space,
+ * <tt>(DOF, block)</tt>, the values of each block are contiguous
+ */
+using DeviceBlockVector = Kokkos::View<double **, Kokkos::LayoutLeft>;
+
+/** Unmanaged view of a host field, e.g. of \c Vector data
+ */
+template <typename Number>
+using HostVectorView = Kokkos::View<Number *,
+                                    Kokkos::LayoutLeft,
+                                    Kokkos::HostSpace,
+                                    Kokkos::MemoryUnmanaged>;
+
+/** Initialize Kokkos if it is not done by the application (or by deal.II),
+ * it is then finalized at exit. Thread-safe.
+ */
+inline void
+ensure_device_initialized();
+
+/** Mutex serializing the use of the device, e.g. by concurrent runs of a
+ * parameter sweep (the host backends of Kokkos are not reentrant)
+ */
+inline std::mutex &
+device_mutex();
+
+/** Copy \c src to the device, \c dst is reallocated if its size differs
+ */
+inline void
+copy_to_device(const Vector<double> &src, DeviceVector &dst);
+
+/** Same as above, for \c BlockVector
+ */
+inline void
+copy_to_device(const BlockVector<double> &src, DeviceBlockVector &dst);
+
+/** Copy \c src from the device, the sizes must match
+ */
+inline void
+copy_to_host(const DeviceVector &src, Vector<double> &dst);
+
+/** Same as above, for \c BlockVector
+ */
+inline void
+copy_to_host(const DeviceBlockVector &src, BlockVector<double> &dst);
+
+/** Copies of TabulatedFunction tables in device memory. All functions are
+ * tabulated on the same grid. Unlike TabulatedFunction, the argument is
+ * clamped to \f$[x_\min, x_\max]\f$ (there is no original function on the
+ * device), the caller checks the range on the host with
+ * DeviceTables::contains.
+ */
+struct DeviceTables
+{
+  /** Constructor, creates empty tables
+   */
+  inline DeviceTables();
+
+  /** Copy the tables of \c functions multiplied by \c scales to the device,
+   * initializes Kokkos if needed. Throws an exception if a table is empty or
+   * the grids differ.
+   */
+  inline void
+  initialize(const std::vector<const TabulatedFunction *> &functions,
+             const std::vector<double> &                   scales);
+
+  /** Returns \c true if \f$[x_\mathrm{lo}, x_\mathrm{hi}]\f$ is within the
+   * tabulated range
+   */
+  inline bool
+  contains(const double x_lo, const double x_hi) const;
+
+  /** Get value of function \c k at \f$x\f$
+   */
+  KOKKOS_INLINE_FUNCTION double
+  value(const unsigned int k, const double x) const;
+
+  /** Lower bound \f$x_\min\f$
+   */
+  double x_min;
+
+  /** Upper bound \f$x_\max\f$
+   */
+  double x_max;
+
+  /** Inverse of the grid step, \f$1/\Delta x\f$
+   */
+  double inv_dx;
+
+  /** Number of grid points
+   */
+  unsigned int n_points;
+
+  /** Tabulated values, <tt>(function, point)</tt>
+   */
+  Kokkos::View<double **, Kokkos::LayoutRight> values;
+};
+
+/** Pointwise Alexander-Haasen model on the device, same as
+ * DislocationSolver::derivatives and DislocationSolver::derivative2_N_m_N_m
+ * with the tabulated material functions and a constant correction of the
+ * Peierls potential. Set up by DislocationSolver.
+ */
+struct DeviceDislocationKernel
+{
+  /** Calculate \f$\dot{N_m}\f$ and the factor \f$f\f$ of the creep strain
+   * rate \f$\dot{\varepsilon^c_{ij}} = f S_{ij}\f$
+   */
+  KOKKOS_INLINE_FUNCTION void
+  derivatives(const double N_m,
+              const double J_2,
+              const double T,
+              double &     dot_N_m,
+              double &     dot_strain_factor) const;
+
+  /** Calculate \f$\partial \dot{N_m} / \partial N_m\f$
+   */
+  KOKKOS_INLINE_FUNCTION double
+  derivative2_N_m_N_m(const double N_m, const double J_2, const double T) const;
+
+  /** Tables of \f$Q\f$, \f$D\f$ and \f$\tau_\mathrm{crit}\f$ (in this order)
+   */
+  DeviceTables tables;
+
+  /** Model parameters, see DislocationSolver
+   */
+  double b, K, k_0, l, p, S, F, k_B;
+
+  /** Constant correction of the Peierls potential \f$dQ\f$, eV
+   */
+  double dQ;
+
+  /** 1 if \f$\tau_\mathrm{crit}\f$ is included in \f$\tau_\mathrm{eff}^l\f$,
+   * 0 otherwise
+   */
+  double with_tau_crit_l;
+};
+
+/** Pointwise calculation of stress from strain on the device, same as
+ * StressSolver::calculate_stress_from_strain with the tabulated elastic
+ * constants and thermal expansion coefficient. Set up by
+ * StressSolver::get_device_kernel.
+ */
+template <int n_components>
+struct DeviceStressKernel
+{
+  /** Calculate stress \c s from the elastic strain \c strain_e (including
+   * the thermal strain) and the creep strain \c strain_c at temperature
+   * \f$T\f$
+   */
+  KOKKOS_INLINE_FUNCTION void
+  stress(const double  T,
+         const double *strain_e,
+         const double *strain_c,
+         double *      s) const;
+
+  /** Calculate the second invariant of the stress deviator \f$J_2\f$
+   */
+  KOKKOS_INLINE_FUNCTION static double
+  J_2(const double *s);
+
+  /** Index of the table of \f$C_{ij}\f$, \f$i \le j\f$, for the full
+   * elastic matrix; the thermal expansion coefficient follows the elastic
+   * constants
+   */
+  KOKKOS_INLINE_FUNCTION static unsigned int
+  table_index(const unsigned int i, const unsigned int j);
+
+  /** Tables of \f$C_{11}\f$, \f$C_{12}\f$, \f$C_{44}\f$ or the upper
+   * triangle of the full elastic matrix (see table_index), followed by the
+   * thermal expansion coefficient \f$\alpha\f$
+   */
+  DeviceTables tables;
+
+  /** Full elastic matrix
+   */
+  bool full;
+
+  /** Reference temperature \f$T_\mathrm{ref}\f$, K
+   */
+  double T_ref;
+};
+
+/** Integration of the dislocation density and creep strain on the device.
+ * The fields \f$N_m\f$, \f$\varepsilon^c_{ij}\f$, \f$J_2\f$, \f$T\f$ and
+ * the stress stay in device memory during all time substeps, which are
+ * fused into a single kernel: the stress is refreshed pointwise from the
+ * fixed elastic strain (same as <tt>StressSolver::solve(true)</tt>) and the
+ * deviator is calculated on the fly. The fields are copied once per time
+ * step, before and after the integration.
+ */
+template <int n_components>
+class DeviceDislocationIntegrator
+{
+public:
+  /** Copy the fields at the beginning of the time step to the device,
+   * initializes Kokkos if needed
+   */
+  inline void
+  upload(const Vector<double> &     N_m,
+         const BlockVector<double> &strain_c,
+         const Vector<double> &     T,
+         const Vector<double> &     J_2,
+         const BlockVector<double> &stress,
+         const BlockVector<double> &strain_e);
+
+  /** Integrate \c n_sub substeps of length \c dt with the forward Euler
+   * method or, if \c linearized is set, with the analytical expression for
+   * linearized \f$N_m\f$. The stress is refreshed after each substep except
+   * the last one if \c update_stress is set.
+   */
+  inline void
+  integrate(const DeviceDislocationKernel &         dislocation,
+            const DeviceStressKernel<n_components> &stress_kernel,
+            const bool                              linearized,
+            const double                            dt,
+            const unsigned int                      n_sub,
+            const bool                              update_stress);
+
+  /** Copy the integrated fields to the host
+   */
+  inline void
+  download(Vector<double> &N_m, BlockVector<double> &strain_c) const;
+
+private:
+  /** Dislocation density \f$N_m\f$, m<sup>-2</sup>
+   */
+  DeviceVector N_m;
+
+  /** Creep strain \f$\varepsilon^c_{ij}\f$, dimensionless
+   */
+  DeviceBlockVector strain_c;
+
+  /** Temperature \f$T\f$, K
+   */
+  DeviceVector T;
+
+  /** Second invariant of the stress deviator \f$J_2\f$, Pa<sup>2</sup>
+   */
+  DeviceVector J_2;
+
+  /** Stress \f$\sigma_{ij}\f$, Pa
+   */
+  DeviceBlockVector stress;
+
+  /** Elastic strain including the thermal strain, dimensionless
+   */
+  DeviceBlockVector strain_e;
+};
+
+
+// IMPLEMENTATION
+
+void
+ensure_device_initialized()
+{
+  static std::mutex           mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (Kokkos::is_initialized())
+    return;
+
+  Kokkos::initialize();
+  std::atexit([]() { Kokkos::finalize(); });
+}
+
+std::mutex &
+device_mutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+void
+copy_to_device(const Vector<double> &src, DeviceVector &dst)
+{
+  if (dst.extent(0) != src.size())
+    dst = DeviceVector("macplas::vector", src.size());
+
+  const HostVectorView<const double> src_view(src.begin(), src.size());
+  Kokkos::deep_copy(dst, src_view);
+}
+
+void
+copy_to_device(const BlockVector<double> &src, DeviceBlockVector &dst)
+{
+  const unsigned int n_blocks = src.n_blocks();
+  const unsigned int N        = n_blocks > 0 ? src.block(0).size() : 0;
+
+  if (dst.extent(0) != N || dst.extent(1) != n_blocks)
+    dst = DeviceBlockVector("macplas::block_vector", N, n_blocks);
+
+  for (unsigned int j = 0; j < n_blocks; ++j)
+    {
+      AssertDimension(src.block(j).size(), N);
+
+      const HostVectorView<const double> src_view(src.block(j).begin(), N);
+      Kokkos::deep_copy(Kokkos::subview(dst, Kokkos::ALL(), j), src_view);
+    }
+}
+
+void
+copy_to_host(const DeviceVector &src, Vector<double> &dst)
+{
+  AssertDimension(src.extent(0), dst.size());
+
+  const HostVectorView<double> dst_view(dst.begin(), dst.size());
+  Kokkos::deep_copy(dst_view, src);
+}
+
+void
+copy_to_host(const DeviceBlockVector &src, BlockVector<double> &dst)
+{
+  AssertDimension(src.extent(1), dst.n_blocks());
+
+  for (unsigned int j = 0; j < dst.n_blocks(); ++j)
+    {
+      AssertDimension(src.extent(0), dst.block(j).size());
+
+      const HostVectorView<double> dst_view(dst.block(j).begin(),
+                                            dst.block(j).size());
+      Kokkos::deep_copy(dst_view, Kokkos::subview(src, Kokkos::ALL(), j));
+    }
+}
+
+// DeviceTables
+
+DeviceTables::DeviceTables()
+  : x_min(0)
+  , x_max(0)
+  , inv_dx(0)
+  , n_points(0)
+{}
+
+void
+DeviceTables::initialize(
+  const std::vector<const TabulatedFunction *> &functions,
+  const std::vector<double> &                   scales)
+{
+  AssertThrow(!functions.empty() && functions.size() == scales.size(),
+              ExcMessage("DeviceTables: invalid number of functions"));
+
+  ensure_device_initialized();
+
+  const TabulatedFunction &f_0 = *functions[0];
+
+  for (const TabulatedFunction *f : functions)
+    {
+      AssertThrow(!f->empty(),
+                  ExcMessage("DeviceTables: device integration requires "
+                             "property tables (\"Number of points\" >= 2)"));
+
+      AssertThrow(f->get_table().size() == f_0.get_table().size() &&
+                    f->get_x_min() == f_0.get_x_min() &&
+                    f->get_x_max() == f_0.get_x_max(),
+                  ExcMessage("DeviceTables: the functions are tabulated on "
+                             "different grids"));
+    }
+
+  x_min    = f_0.get_x_min();
+  x_max    = f_0.get_x_max();
+  n_points = f_0.get_table().size();
+  inv_dx   = (n_points - 1) / (x_max - x_min);
+
+  values = Kokkos::View<double **, Kokkos::LayoutRight>("macplas::tables",
+                                                        functions.size(),
+                                                        n_points);
+
+  auto values_host = Kokkos::create_mirror_view(values);
+  for (unsigned int k = 0; k < functions.size(); ++k)
+    {
+      const std::vector<double> &table = functions[k]->get_table();
+
+      for (unsigned int i = 0; i < n_points; ++i)
+        values_host(k, i) = scales[k] * table[i];
+    }
+  Kokkos::deep_copy(values, values_host);
+}
+
+bool
+DeviceTables::contains(const double x_lo, const double x_hi) const
+{
+  return x_lo >= x_min && x_hi <= x_max;
+}
+
+KOKKOS_INLINE_FUNCTION double
+DeviceTables::value(const unsigned int k, const double x) const
+{
+  double t = (x - x_min) * inv_dx;
+  t        = t < 0 ? 0 : (t > n_points - 1 ? n_points - 1 : t);
+
+  const unsigned int i0 = static_cast<unsigned int>(t);
+  const unsigned int i  = i0 < n_points - 2 ? i0 : n_points - 2;
+  const double       w  = t - i;
+
+  return (1 - w) * values(k, i) + w * values(k, i + 1);
+}
+
+// DeviceDislocationKernel
+
+KOKKOS_INLINE_FUNCTION void
+DeviceDislocationKernel::derivatives(const double N_m,
+                                     const double J_2,
+                                     const double T,
+                                     double &     dot_N_m,
+                                     double &     dot_strain_factor) const
+{
+  const double tau_0    = S * Kokkos::sqrt(J_2) -
+                       tables.value(1, T) * Kokkos::sqrt(N_m);
+  const double tau_crit = tables.value(2, T);
+
+  const double tau_p = tau_0 - tau_crit > 0 ? tau_0 - tau_crit : 0.0;
+  const double tau_l = tau_0 - with_tau_crit_l * tau_crit > 0 ?
+                         tau_0 - with_tau_crit_l * tau_crit :
+                         0.0;
+
+  const double v = k_0 * Kokkos::pow(tau_p, p) *
+                   Kokkos::exp(-(tables.value(0, T) + dQ) / (k_B * T));
+
+  dot_N_m = K * v * Kokkos::pow(tau_l, l) * N_m;
+
+  dot_strain_factor = J_2 == 0 ? 0 : b * v * N_m / (2 * F * Kokkos::sqrt(J_2));
+}
+
+KOKKOS_INLINE_FUNCTION double
+DeviceDislocationKernel::derivative2_N_m_N_m(const double N_m,
+                                             const double J_2,
+                                             const double T) const
+{
+  const double D        = tables.value(1, T);
+  const double tau_0    = S * Kokkos::sqrt(J_2) - D * Kokkos::sqrt(N_m);
+  const double tau_crit = tables.value(2, T);
+
+  const double tau_p = tau_0 - tau_crit > 0 ? tau_0 - tau_crit : 0.0;
+  const double tau_l = tau_0 - with_tau_crit_l * tau_crit > 0 ?
+                         tau_0 - with_tau_crit_l * tau_crit :
+                         0.0;
+
+  return K * k_0 * Kokkos::exp(-(tables.value(0, T) + dQ) / (k_B * T)) *
+         (                                                               //
+           Kokkos::pow(tau_p, p) * Kokkos::pow(tau_l, l) -               //
+           (                                                             //
+             p * Kokkos::pow(tau_p, p - 1) * Kokkos::pow(tau_l, l) +     //
+             l * Kokkos::pow(tau_l, l - 1) * Kokkos::pow(tau_p, p)       //
+             ) *                                                         //
+             (Kokkos::sqrt(N_m) * D / 2)                                 //
+         );
+}
+
+// DeviceStressKernel
+
+template <int n_components>
+KOKKOS_INLINE_FUNCTION void
+DeviceStressKernel<n_components>::stress(const double  T,
+                                         const double *strain_e,
+                                         const double *strain_c,
+                                         double *      s) const
+{
+  const unsigned int n_C =
+    full ? n_components * (n_components + 1) / 2 : 3;
+
+  // thermal strain, see StressSolver::get_strain
+  const double epsilon_T = tables.value(n_C, T) * (T - T_ref);
+
+  double epsilon[n_components];
+  for (unsigned int k = 0; k < n_components; ++k)
+    epsilon[k] = strain_e[k] - (k < 3 ? epsilon_T : 0) - strain_c[k];
+
+  if (full)
+    {
+      for (unsigned int i = 0; i < n_components; ++i)
+        {
+          s[i] = 0;
+          for (unsigned int j = 0; j < n_components; ++j)
+            s[i] += tables.value(table_index(i, j), T) * epsilon[j];
+        }
+
+      return;
+    }
+
+  const double C_11 = tables.value(0, T);
+  const double C_12 = tables.value(1, T);
+  const double C_44 = tables.value(2, T);
+
+  const double epsilon_sum = epsilon[0] + epsilon[1] + epsilon[2];
+
+  for (unsigned int k = 0; k < n_components; ++k)
+    s[k] = k < 3 ? C_11 * epsilon[k] + C_12 * (epsilon_sum - epsilon[k]) :
+                   C_44 * epsilon[k];
+}
+
+template <int n_components>
+KOKKOS_INLINE_FUNCTION double
+DeviceStressKernel<n_components>::J_2(const double *s)
+{
+  double s_vM = (s[0] - s[1]) * (s[0] - s[1]) + (s[1] - s[2]) * (s[1] - s[2]) +
+                (s[2] - s[0]) * (s[2] - s[0]);
+  for (unsigned int k = 3; k < n_components; ++k)
+    s_vM += 6 * s[k] * s[k];
+
+  // J_2 = s_vM^2 / 3
+  return s_vM / 6;
+}
+
+template <int n_components>
+KOKKOS_INLINE_FUNCTION unsigned int
+DeviceStressKernel<n_components>::table_index(const unsigned int i,
+                                              const unsigned int j)
+{
+  return i <= j ? i + j * (j + 1) / 2 : j + i * (i + 1) / 2;
+}
+
+// DeviceDislocationIntegrator
+
+template <int n_components>
+void
+DeviceDislocationIntegrator<n_components>::upload(
+  const Vector<double> &     N_m_host,
+  const BlockVector<double> &strain_c_host,
+  const Vector<double> &     T_host,
+  const Vector<double> &     J_2_host,
+  const BlockVector<double> &stress_host,
+  const BlockVector<double> &strain_e_host)
+{
+  AssertDimension(strain_c_host.n_blocks(), n_components);
+  AssertDimension(stress_host.n_blocks(), n_components);
+  AssertDimension(strain_e_host.n_blocks(), n_components);
+
+  ensure_device_initialized();
+
+  std::lock_guard<std::mutex> lock(device_mutex());
+
+  copy_to_device(N_m_host, N_m);
+  copy_to_device(strain_c_host, strain_c);
+  copy_to_device(T_host, T);
+  copy_to_device(J_2_host, J_2);
+  copy_to_device(stress_host, stress);
+  copy_to_device(strain_e_host, strain_e);
+}
+
+template <int n_components>
+void
+DeviceDislocationIntegrator<n_components>::integrate(
+  const DeviceDislocationKernel &         dislocation,
+  const DeviceStressKernel<n_components> &stress_kernel,
+  const bool                              linearized,
+  const double                            dt,
+  const unsigned int                      n_sub,
+  const bool                              update_stress)
+{
+  // the lambda captures by value, not the members
+  const DeviceVector      N_m_d      = N_m;
+  const DeviceBlockVector strain_c_d = strain_c;
+  const DeviceVector      T_d        = T;
+  const DeviceVector      J_2_d      = J_2;
+  const DeviceBlockVector stress_d   = stress;
+  const DeviceBlockVector strain_e_d = strain_e;
+
+  std::lock_guard<std::mutex> lock(device_mutex());
+
+  Kokkos::parallel_for(
+    "macplas::integrate_dislocations",
+    Kokkos::RangePolicy<>(0, N_m_d.extent(0)),
+    KOKKOS_LAMBDA(const int i) {
+      double s[n_components], epsilon_c[n_components], epsilon_e[n_components];
+      for (unsigned int k = 0; k < n_components; ++k)
+        {
+          s[k]         = stress_d(i, k);
+          epsilon_c[k] = strain_c_d(i, k);
+          epsilon_e[k] = strain_e_d(i, k);
+        }
+
+      const double T_i   = T_d(i);
+      double       J_2_i = J_2_d(i);
+      double       N_m_i = N_m_d(i);
+
+      for (unsigned int n = 0; n < n_sub; ++n)
+        {
+          double a, f;
+          dislocation.derivatives(N_m_i, J_2_i, T_i, a, f);
+
+          if (linearized)
+            {
+              // see DislocationSolver::integrate_linearized_N_m
+              const double b =
+                dislocation.derivative2_N_m_N_m(N_m_i, J_2_i, T_i);
+
+              N_m_i += b == 0 ? a * dt : a / b * (Kokkos::exp(b * dt) - 1);
+
+              dislocation.derivatives(N_m_i, J_2_i, T_i, a, f);
+            }
+          else
+            N_m_i += dt * a;
+
+          // the deviator is calculated on the fly
+          const double s_ave = (s[0] + s[1] + s[2]) / 3;
+          for (unsigned int k = 0; k < n_components; ++k)
+            epsilon_c[k] += f * (k < 3 ? s[k] - s_ave : s[k]) * dt;
+
+          if (update_stress && n + 1 < n_sub)
+            {
+              stress_kernel.stress(T_i, epsilon_e, epsilon_c, s);
+              J_2_i = DeviceStressKernel<n_components>::J_2(s);
+            }
+        }
+
+      N_m_d(i) = N_m_i;
+      for (unsigned int k = 0; k < n_components; ++k)
+        strain_c_d(i, k) = epsilon_c[k];
+    });
+
+  Kokkos::fence();
+}
+
+template <int n_components>
+void
+DeviceDislocationIntegrator<n_components>::download(
+  Vector<double> &     N_m_host,
+  BlockVector<double> &strain_c_host) const
+{
+  std::lock_guard<std::mutex> lock(device_mutex());
+
+  copy_to_host(N_m, N_m_host);
+  copy_to_host(strain_c, strain_c_host);
+}
+
+#endif
+
+#endif
@@ -2,7 +2,9 @@
 #define macplas_dislocation_solver_h
 
 #include <deal.II/base/function_parser.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/base/parameter_handler.h>
+#include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/base/utilities.h>
 
@@ -10,10 +12,14 @@
 #include <deal.II/grid/tria.h>
 
 #include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/linear_operator.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_gmres.h>
 #include <deal.II/lac/vector.h>
 
 #include <deal.II/numerics/data_out.h>
-#include <deal.II/numerics/fe_field_function.h>
+#include <deal.II/numerics/derivative_approximation.h>
+#include <deal.II/numerics/error_estimator.h>
 
 #include <fstream>
 #include <iostream>
@@ -46,7 +52,9 @@ public:
 
   /** Advance time and calculate the dislocation density and creep strain.
    * Calls DislocationSolver::advance_time unless \c stress_only is enabled,
-   * then only the stress is calculated.
+   * then only the stress is calculated. If \c "Error tolerance" is set, time
+   * steps with a too large error estimate are repeated with a smaller time
+   * step.
    * @returns \c true if the final time has not been reached and simulation has converged
    */
   bool
@@ -226,12 +234,46 @@ public:
   ParameterHandler &
   get_parameters();
 
+  /** Get profiler, shared with other solvers by set_profiler
+   */
+  std::shared_ptr<Profiler>
+  get_profiler() const;
+
+  /** Use \c profiler for performance measurements, e.g. to share a single
+   * report between several solvers.
+   * Also used by the stress solver
+   */
+  void
+  set_profiler(const std::shared_ptr<Profiler> &profiler);
+
   /** Initialize DOF handler and fields.
    * Calls StressSolver::initialize
    */
   void
   initialize();
 
+  /** Estimate the error for adaptive mesh refinement, one value for each
+   * active cell. The Kelly error estimator or the gradient of the
+   * dislocation density and/or \f$J_2\f$ is used, see "Refinement
+   * indicator" and "Refinement field".
+   */
+  void
+  estimate_error(Vector<float> &error) const;
+
+  /** Prepare the transfer of the dislocation density, creep strain,
+   * displacement, temperature and user-defined fields to the adapted mesh.
+   * Call after flagging the cells and before
+   * \c Triangulation::execute_coarsening_and_refinement.
+   */
+  void
+  prepare_for_refinement();
+
+  /** Interpolate the fields to the adapted mesh and recalculate the
+   * stresses. Calls StressSolver::finish_refinement
+   */
+  void
+  finish_refinement();
+
   /** Add probe point
    */
   void
@@ -247,6 +289,16 @@ public:
   void
   add_field(const std::string &name, const Vector<double> &value);
 
+  /** Add user-defined field shared with the caller without copying
+   */
+  void
+  add_field(const std::string &name, const FieldStore::FieldPointer &value);
+
+  /** Get user-defined fields
+   */
+  const FieldStore &
+  get_fields() const;
+
   /** Read raw results from disk
    */
   void
@@ -257,6 +309,21 @@ public:
   void
   output_data() const;
 
+  /** Save mesh, fields and time-stepping state to a single checkpoint file
+   * \c "checkpoint-dislocation-<dim>d-order<order>-0.bin", the previous
+   * checkpoints are rotated
+   */
+  void
+  output_checkpoint() const;
+
+  /** Restore mesh, fields and time-stepping state from the newest valid
+   * checkpoint, calls DislocationSolver::initialize. The stresses are
+   * recalculated at the beginning of the next DislocationSolver::solve.
+   * @returns \c false if no valid checkpoint was found
+   */
+  bool
+  load_checkpoint();
+
   /** Save results to disk in \c vtk format.
    * Does not call StressSolver::output_vtk but directly reuses stress fields.
    */
@@ -280,12 +347,21 @@ public:
                          const double       T2 = 1700,
                          const unsigned int n  = 30) const;
 
-private:
-  /** Initialize parameters. Called by the constructor
+  /** Get the current values written by \c output_probes: time, user-defined
+   * values, limits of fields and values at probe points, with column names
+   * as in \c "probes-dislocation-<dim>d.txt". Valid after \c solve
+   */
+  void
+  get_probe_values(std::vector<std::string> &names,
+                   std::vector<double> &     values) const;
+
+  /** Initialize parameters. Called by the constructor, call again after
+   * modifying the parameters returned by \c get_parameters
    */
   void
   initialize_parameters();
 
+private:
   /** Initialize variables related to the adaptive time-stepping.
    * Sets user-defined output values \c max_dt_*[s] to zero.
    */
@@ -304,7 +380,8 @@ private:
 
   /** Time stepping: adjust time step according to user-specified settings.
    * Considers maximum \f$v \Delta t\f$, \f$\Delta \varepsilon^c\f$ and relative
-   * \f$\Delta N_m\f$, calls DislocationSolver::limit_time_step.
+   * \f$\Delta N_m\f$ and the time step proposed by the error controller,
+   * calls DislocationSolver::limit_time_step.
    */
   void
   update_time_step();
@@ -314,8 +391,44 @@ private:
   void
   advance_time();
 
-  /** Write current values of fields at probe points to disk.
-   * File name \c "probes-dislocation-<dim>d.txt"
+  /** Time stepping: integrate over the current time step with the selected
+   * time scheme
+   */
+  void
+  integrate();
+
+  /** Time stepping: returns \c true if the time step is controlled by the
+   * embedded error estimate
+   */
+  bool
+  use_error_control() const;
+
+  /** Time stepping: error of the time step estimated by the difference from
+   * the lower-order (Euler) solution, scaled by the tolerances. The step is
+   * accepted if the result does not exceed 1.
+   */
+  double
+  calculate_error_estimate() const;
+
+  /** Time stepping: propose the next time step by PI control of the error
+   * estimate of the accepted step
+   */
+  void
+  update_error_control(const double error);
+
+  /** Time stepping: restore the fields at the beginning of the time step
+   */
+  void
+  restore_fields();
+
+  /** Write memory consumption of the fields to the log, including the ones
+   * of the stress solver
+   */
+  void
+  log_memory_consumption() const;
+
+  /** Write current values of fields at probe points to disk if
+   * \c "Output probes" is set. File name \c "probes-dislocation-<dim>d.txt"
    */
   void
   output_probes() const;
@@ -426,6 +539,38 @@ private:
                     const Vector<double> &T,
                     const Vector<double> &S) const;
 
+  /** Calculate \f$\dot{N_m}\f$ and the creep strain rate factor \f$f\f$,
+   * \f$\dot{\varepsilon^c_{ij}} = f S_{ij}\f$, in one go.
+   * Shares \f$\tau_\mathrm{eff}\f$ and \f$v\f$ evaluation between both,
+   * see derivative_N_m and derivative_strain.
+   */
+  void
+  derivatives(const double N_m,
+              const double J_2,
+              const double T,
+              double &     dot_N_m,
+              double &     dot_strain_factor) const;
+
+  /** Same as above, for all DoFs: calculate \f$\dot{N_m}\f$ and
+   * \f$\dot{\varepsilon^c_{ij}}\f$ from the stress \c s. Multithreaded
+   */
+  void
+  derivatives(const Vector<double> &     N_m,
+              const Vector<double> &     J_2,
+              const Vector<double> &     T,
+              const BlockVector<double> &s,
+              Vector<double> &           dot_N_m,
+              BlockVector<double> &      dot_strain_c) const;
+
+  /** Calculate the stress deviator \f$S_j\f$ at DOF \c i from the stress
+   * \c s (Voigt notation). Used by the integrators instead of the stored
+   * deviator, which is not kept with \c "Low memory"
+   */
+  static double
+  deviator(const BlockVector<double> &s,
+           const unsigned int         j,
+           const unsigned int         i);
+
   /** Calculate the dislocation velocity \f$v =
    * k_0 \tau_\mathrm{eff}^p \exp\left(-\frac{Q}{k_B T}\right)\f$
    */
@@ -470,11 +615,46 @@ private:
   void
   integrate_linearized_N_m_midpoint();
 
+  /** Time integration of the \c "Euler" and \c "Linearized N_m" schemes on
+   * the device, see DeviceDislocationIntegrator. Returns \c false (and
+   * nothing is done) if the temperature is outside the range of the
+   * property tables, the host version is then used.
+   */
+  bool
+  integrate_device();
+
+#ifdef MACPLAS_WITH_KOKKOS
+  /** Copy the property tables and the model parameters to the device
+   */
+  DeviceDislocationKernel
+  get_device_kernel() const;
+#endif
+
   /** Time integration using the backward Euler method (implicit)
    */
   void
   integrate_implicit();
 
+  /** Time integration using the backward Euler method (implicit) for the
+   * coupled system of \f$N_m\f$, \f$\varepsilon^c_{ij}\f$ and the elastic
+   * equilibrium, solved by the Jacobian-free Newton-Krylov method with a
+   * backtracking line search. Jacobian-vector products are approximated by
+   * finite differences of the residual, each one requiring a call of
+   * StressSolver::solve. The analytical Jacobian of the local equations at
+   * frozen stresses is used as the preconditioner.
+   */
+  void
+  integrate_Newton();
+
+  /** Calculate the backward Euler residual of \f$N_m\f$ (block 0) and
+   * \f$\varepsilon^c_{ij}\f$ (blocks 1..n_components) for the current fields,
+   * divided by \c weights, used by integrate_Newton. The stresses need to be
+   * up to date.
+   */
+  void
+  calculate_Newton_residual(const BlockVector<double> &weights,
+                            BlockVector<double> &      residual) const;
+
   /** Recalculate stress before time integration.
    * Does nothing if \c after is specified in the parameters.
    */
@@ -499,6 +679,12 @@ private:
   std::string
   output_name_suffix() const;
 
+  /** Helper method for creating checkpoint file name.
+   * @returns \c "checkpoint-dislocation-<dim>d-order<order>"
+   */
+  std::string
+  checkpoint_base_name() const;
+
   /** Stress solver.
    * To avoid redundancy, the mesh, finite element, DOF handler, as well as
    * the temperature and creep strain fields are stored in StressSolver.
@@ -509,14 +695,60 @@ private:
    */
   Vector<double> dislocation_density;
 
+  /** Dislocation density at the beginning of the time step, used by the
+   * integrators and for restoring the fields if the time step diverges. Kept
+   * between the time steps to reuse the storage. Empty if
+   * \c dislocation_density_0_float is used.
+   */
+  Vector<double> dislocation_density_0;
+
+  /** Displacement at the beginning of the time step, empty if
+   * \c "Low memory" is set
+   */
+  BlockVector<double> displacement_0;
+
+  /** Creep strain at the beginning of the time step, empty if
+   * \c strain_c_0_float is used
+   */
+  BlockVector<double> strain_c_0;
+
+  /** Single-precision copies of \c dislocation_density_0 and \c strain_c_0,
+   * used instead of them if \c "Low memory" is set and the time scheme needs
+   * the values at the beginning of the time step only for restoring the
+   * fields (\c "Euler" and \c "Linearized N_m")
+   */
+  Vector<float> dislocation_density_0_float;
+
+  /** See \c dislocation_density_0_float
+   */
+  BlockVector<float> strain_c_0_float;
+
+  /** Dislocation density of the embedded lower-order solution, for the error
+   * estimate
+   */
+  Vector<double> dislocation_density_low;
+
+  /** Creep strain of the embedded lower-order solution
+   */
+  BlockVector<double> strain_c_low;
+
   /** User-defined fields
    */
-  std::map<std::string, Vector<double>> additional_fields;
+  FieldStore additional_fields;
+
+  /** Transfer of the fields to the adapted mesh
+   */
+  FieldTransfer<dim> field_transfer;
 
   /** Locations of probe points
    */
   std::vector<Point<dim>> probes;
 
+  /** Cached cells and shape function values at probe points.
+   * Updated in \c solve before each call to \c output_probes.
+   */
+  DoFPointEvaluation<dim> probe_evaluation;
+
   /** User-defined output values
    */
   std::map<std::string, double> additional_output;
@@ -525,6 +757,32 @@ private:
    */
   bool probes_header_written;
 
+  /** Flag for logging the memory consumption once, at the first time step
+   */
+  bool memory_reported;
+
+  /** Flag for recalculating the stresses at the next time step, set by
+   * DislocationSolver::load_checkpoint since the stresses are not stored
+   */
+  bool stress_outdated;
+
+  /** Writer for field output, keeps the time-series index
+   */
+  mutable DataOutWriter<dim> output_writer;
+
+  /** Writer of output files in a background thread. Declared after all data
+   * referenced by queued tasks, so it is destroyed (and flushed) first.
+   */
+  mutable BackgroundWriter background_writer;
+
+  /** Performance measurements
+   */
+  std::shared_ptr<Profiler> profiler;
+
+  /** Log output
+   */
+  mutable Logger logger;
+
 
   /** Parameter handler
    */
@@ -535,6 +793,22 @@ private:
    */
   std::string time_scheme;
 
+  /** Integrate on the device, \c "Device integration" parameter
+   */
+  bool use_device_integration;
+
+#ifdef MACPLAS_WITH_KOKKOS
+  /** Device fields of integrate_device
+   */
+  DeviceDislocationIntegrator<StressSolver<dim>::n_components>
+    device_integrator;
+#endif
+
+  /** Minimal number of DoFs processed by one thread in pointwise
+   * calculations
+   */
+  constexpr static unsigned int grain_size = 256;
+
   /** Time stepping: current time \f$t\f$, s
    */
   double current_time;
@@ -548,6 +822,22 @@ private:
    */
   double previous_time_step;
 
+  /** Time stepping: scaled error estimate of the previous accepted time step,
+   * 0 if unknown. Used by the PI controller.
+   */
+  double previous_error;
+
+  /** Time stepping: next time step proposed by the error controller, s
+   * (0 - none)
+   */
+  double error_time_step;
+
+  /** Whether the last Newton iteration of the \c "Newton" time scheme has
+   * converged. A step with a failed iteration is rejected and repeated with
+   * at most half the time step, also without error control.
+   */
+  bool newton_converged;
+
   /** Wall clock for timing
    */
   Timer solver_timer;
@@ -568,6 +858,18 @@ private:
    */
   FunctionParser<1> m_tau_crit;
 
+  /** Tabulated \c m_Q
+   */
+  TabulatedFunction m_Q_table;
+
+  /** Tabulated \c m_D
+   */
+  TabulatedFunction m_D_table;
+
+  /** Tabulated \c m_tau_crit
+   */
+  TabulatedFunction m_tau_crit_table;
+
   /** Switch that enables \f$\tau_\mathrm{crit}\f$ in \f$\tau_\mathrm{eff}^l\f$
    * term of the time derivative of dislocation density \f$\dot{N_m}\f$
    */
@@ -613,20 +915,31 @@ template <int dim>
 DislocationSolver<dim>::DislocationSolver(const unsigned int order,
                                           const bool         use_default_prm)
   : stress_solver(order, use_default_prm)
+  , field_transfer(stress_solver.get_dof_handler())
   , probes_header_written(false)
+  , memory_reported(false)
+  , stress_outdated(false)
+  , profiler(std::make_shared<Profiler>())
   , current_time(0)
   , current_time_step(0)
   , previous_time_step(0)
-{
-  std::cout << "Creating dislocation density solver, order=" << order
-            << ", dim=" << dim
-            << " ("
+  , previous_error(0)
+  , error_time_step(0)
+  , newton_converged(true)
+  , use_device_integration(false)
+{
+  logger.info() << "Creating dislocation density solver, order=" << order
+                << ", dim=" << dim
+                << " ("
 #ifdef DEBUG
-               "Debug"
+                   "Debug"
 #else
-               "Release"
+                   "Release"
 #endif
-               ")\n";
+                   ")\n";
+
+  // common report for dislocation and stress calculation
+  stress_solver.set_profiler(profiler);
 
   const std::string info_T = " (temperature function)";
 
@@ -737,6 +1050,14 @@ DislocationSolver<dim>::DislocationSolver(const unsigned int order,
                     Patterns::Bool(),
                     "Fast update of stress during time substeps");
 
+  prm.declare_entry("Device integration",
+                    "false",
+                    Patterns::Bool(),
+                    "Integrate the Euler and Linearized N_m time schemes on "
+                    "the Kokkos device (requires compilation with "
+                    "MACPLAS_WITH_KOKKOS, property tables of both solvers "
+                    "and a constant Peierls potential correction)");
+
   prm.declare_entry("Stress recalculation strategy",
                     "after",
                     Patterns::Selection("after|before|always|both"),
@@ -771,6 +1092,58 @@ DislocationSolver<dim>::DislocationSolver(const unsigned int order,
     Patterns::Double(0),
     "Maximum relative effective stress change for adaptive time-stepping (0 - disabled)");
 
+  prm.declare_entry(
+    "Error tolerance",
+    "0",
+    Patterns::Double(0),
+    "Relative tolerance of the embedded error estimate of N_m, steps with "
+    "larger error are rejected and repeated with a smaller time step. Requires "
+    "the Midpoint, Linearized N_m midpoint, Implicit or Newton time scheme "
+    "(optional, 0 - disabled)");
+
+  prm.declare_entry("Strain error tolerance",
+                    "1e-6",
+                    Patterns::Double(0),
+                    "Absolute tolerance of the embedded error estimate of the "
+                    "creep strain");
+
+  prm.declare_entry("Max rejected steps",
+                    "10",
+                    Patterns::Integer(0),
+                    "Maximum number of rejections of a time step, the last "
+                    "attempt is accepted");
+
+  prm.declare_entry("Newton tolerance",
+                    "1e-6",
+                    Patterns::Double(0),
+                    "Relative tolerance of the N_m residual for the Newton "
+                    "time scheme");
+
+  prm.declare_entry("Newton strain tolerance",
+                    "1e-9",
+                    Patterns::Double(0),
+                    "Absolute tolerance of the creep strain residual for the "
+                    "Newton time scheme");
+
+  prm.declare_entry("Max Newton iterations",
+                    "20",
+                    Patterns::Integer(1),
+                    "Maximum number of nonlinear iterations for the Newton "
+                    "time scheme, steps without convergence are rejected and "
+                    "repeated with half the time step");
+
+  prm.declare_entry("Krylov tolerance",
+                    "0.1",
+                    Patterns::Double(0, 1),
+                    "Relative tolerance of the linear (GMRES) solver in the "
+                    "Newton time scheme");
+
+  prm.declare_entry("Max Krylov iterations",
+                    "20",
+                    Patterns::Integer(1),
+                    "Maximum number of linear (GMRES) iterations per Newton "
+                    "iteration, each requiring a stress calculation");
+
   prm.declare_entry("Max time",
                     "10",
                     Patterns::Double(0),
@@ -781,6 +1154,33 @@ DislocationSolver<dim>::DislocationSolver(const unsigned int order,
                     Patterns::Anything(),
                     "Time integration scheme");
 
+  prm.declare_entry("Refinement indicator",
+                    "Kelly",
+                    Patterns::Selection("Kelly|gradient"),
+                    "Error indicator for adaptive mesh refinement (Kelly - "
+                    "error estimator, gradient - approximate gradient scaled "
+                    "by h^(1+dim/2))");
+
+  prm.declare_entry("Refinement field",
+                    "N_m+J_2",
+                    Patterns::Selection("N_m|J_2|N_m+J_2"),
+                    "Field for the refinement indicator, normalized and "
+                    "summed if both");
+
+  prm.declare_entry("Output probes",
+                    "true",
+                    Patterns::Bool(),
+                    "Write values at probe points to disk");
+
+  prm.declare_entry("Low memory",
+                    "false",
+                    Patterns::Bool(),
+                    "Do not keep the displacement at the beginning of the "
+                    "time step, it is recalculated after a rejected step "
+                    "but not restored if the simulation diverges; keep the "
+                    "dislocation density and creep strain at the beginning "
+                    "of the time step in single precision for the Euler and "
+                    "Linearized N_m schemes");
 
   prm.declare_entry("Output precision",
                     "8",
@@ -792,6 +1192,62 @@ DislocationSolver<dim>::DislocationSolver(const unsigned int order,
                     Patterns::Integer(0),
                     "Number of cell subdivisions for vtk output (0: order)");
 
+  prm.declare_entry("Output format",
+                    "vtk",
+                    Patterns::Selection(DataOutWriter<dim>::get_format_names()),
+                    "Format of field output (vtk - ASCII, vtu - compressed "
+                    "binary, hdf5 - HDF5 with XDMF index)");
+
+  prm.declare_entry("Output queue size",
+                    "0",
+                    Patterns::Integer(0),
+                    "Maximal number of output tasks queued for writing by a "
+                    "background thread (0 - write synchronously)");
+
+  prm.declare_entry("Log level",
+                    "default",
+                    Patterns::Selection("default|" + Logger::get_level_names()),
+                    "Verbosity of the log output (default - value of the "
+                    "MACPLAS_LOG_LEVEL environment variable if set, detail "
+                    "otherwise)");
+
+  prm.declare_entry("Profiling report",
+                    "",
+                    Patterns::Anything(),
+                    "Base name of JSON and CSV performance reports written at "
+                    "exit (empty - no report)");
+
+  prm.declare_entry("Profiling per time step",
+                    "false",
+                    Patterns::Bool(),
+                    "Additionally report the times of all phases at each "
+                    "time step");
+
+  prm.declare_entry("Number of checkpoints",
+                    "2",
+                    Patterns::Integer(1),
+                    "Number of rotated checkpoint files to keep");
+
+  prm.enter_subsection("Property table");
+  {
+    prm.declare_entry("Number of points",
+                      "0",
+                      Patterns::Integer(0),
+                      "Number of points for tabulation of temperature functions"
+                      " (0 - disabled, exact evaluation)");
+
+    prm.declare_entry("Min temperature",
+                      "250",
+                      Patterns::Double(0),
+                      "Lower temperature bound of tabulation in K");
+
+    prm.declare_entry("Max temperature",
+                      "1700",
+                      Patterns::Double(0),
+                      "Upper temperature bound of tabulation in K");
+  }
+  prm.leave_subsection();
+
   if (use_default_prm)
     {
       std::ofstream of("dislocation.prm");
@@ -804,7 +1260,7 @@ DislocationSolver<dim>::DislocationSolver(const unsigned int order,
       }
     catch (std::exception &e)
       {
-        std::cout << e.what() << "\n";
+        logger.error() << e.what() << "\n";
 
         std::ofstream of("dislocation-default.prm");
         prm.print_parameters(of, ParameterHandler::Text);
@@ -812,6 +1268,12 @@ DislocationSolver<dim>::DislocationSolver(const unsigned int order,
 
   initialize_parameters();
   initialize_dt_output();
+
+  // set once by the owner, the profiler is shared with the stress solver
+  const std::string profiling_report = prm.get("Profiling report");
+  if (!profiling_report.empty())
+    profiler->set_report(profiling_report,
+                         prm.get_bool("Profiling per time step"));
 }
 
 template <int dim>
@@ -821,6 +1283,21 @@ DislocationSolver<dim>::solver_name() const
   return "MACPLAS:Dislocation";
 }
 
+template <int dim>
+std::shared_ptr<Profiler>
+DislocationSolver<dim>::get_profiler() const
+{
+  return profiler;
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::set_profiler(const std::shared_ptr<Profiler> &profiler)
+{
+  this->profiler = profiler;
+  stress_solver.set_profiler(profiler);
+}
+
 template <int dim>
 bool
 DislocationSolver<dim>::solve(const bool stress_only)
@@ -832,6 +1309,7 @@ DislocationSolver<dim>::solve(const bool stress_only)
       update_time_step();
 
       add_output("wall_time[s]", solver_timer.wall_time());
+      probe_evaluation.reinit(get_dof_handler(), probes);
       output_probes();
       // set here to keep const-ness of output_probes
       probes_header_written = true;
@@ -839,61 +1317,153 @@ DislocationSolver<dim>::solve(const bool stress_only)
       return has_converged();
     }
 
+  if (stress_outdated)
+    {
+      // after restoring a checkpoint, with the boundary conditions set since
+      stress_solver.solve();
+      stress_outdated = false;
+    }
+
   if (!stress_solver.has_converged())
     {
-      std::cout << solver_name()
-                << "  Stress calculation diverged, stopping.\n";
+      logger.error() << solver_name()
+                     << "  Stress calculation diverged, stopping.\n";
       return false;
     }
 
-  advance_time();
+  StressSolver<dim> &ss = get_stress_solver();
+  // Save fields at the previous time, reusing the storage
+  const bool low_memory = prm.get_bool("Low memory");
+  if (low_memory &&
+      (time_scheme == "Euler" || time_scheme == "Linearized N_m"))
+    {
+      // only for restoring the fields, not read by the integrators
+      dislocation_density_0_float = get_dislocation_density();
+      strain_c_0_float            = ss.get_strain_c();
+      dislocation_density_0.reinit(0);
+      strain_c_0.reinit(0);
+    }
+  else
+    {
+      dislocation_density_0 = get_dislocation_density();
+      strain_c_0            = ss.get_strain_c();
+      dislocation_density_0_float.reinit(0);
+      strain_c_0_float.reinit(0);
+    }
+  if (low_memory)
+    displacement_0.reinit(0);
+  else
+    displacement_0 = ss.get_displacement();
+
+  const unsigned int n_rejected_max = prm.get_integer("Max rejected steps");
+
+  for (unsigned int n_rejected = 0;; ++n_rejected)
+    {
+      advance_time();
+
+      std::ostream &out = logger.info();
+      out.unsetf(std::ios_base::floatfield);
+      out << std::setprecision(8);
+      out << solver_name() << "  Time " << get_time() << " s"
+          << " step " << get_time_step() << " s\n";
+
+      integrate();
+
+      // the fields are integrated at each DOF, keep them continuous at
+      // hanging nodes
+      const HangingNodeConstraints &constraints =
+        ss.get_hanging_node_constraints();
+      constraints.distribute(dislocation_density);
+      for (unsigned int k = 0; k < ss.get_strain_c().n_blocks(); ++k)
+        constraints.distribute(ss.get_strain_c().block(k));
+
+      // without error control, only steps with a failed Newton iteration
+      // are rejected
+      const bool error_control = use_error_control();
+      if (!error_control && newton_converged)
+        break;
+
+      const double error = error_control ? calculate_error_estimate() : 0;
+      if (error_control)
+        add_output("error_estimate", error);
+      add_output("rejected_steps", n_rejected);
+
+      if (has_converged() && error <= 1 && newton_converged)
+        {
+          update_error_control(error);
+          break;
+        }
+
+      // reject the step, repeat with a smaller time step
+      double &     dt          = get_time_step();
+      const double dt_rejected = dt;
+      if (error_control)
+        dt *=
+          std::isfinite(error) ? std::max(0.2, 0.9 / std::sqrt(error)) : 0.2;
+      if (!newton_converged)
+        dt = std::min(dt, 0.5 * dt_rejected);
+      limit_time_step();
+
+      if (n_rejected >= n_rejected_max || dt >= dt_rejected)
+        {
+          // no further reduction is allowed
+          dt = dt_rejected;
+          if (has_converged() && error_control)
+            {
+              logger.warning()
+                << solver_name() << "  Warning: error estimate " << error
+                << " exceeds the tolerance, accepting the time step\n";
+              update_error_control(error);
+            }
+          else if (has_converged())
+            logger.warning() << solver_name()
+                             << "  Warning: Newton iteration did not converge, "
+                                "accepting the time step\n";
+          break;
+        }
+
+      logger.info() << solver_name() << "  Rejected time step, "
+                    << (newton_converged ? "" : "Newton iteration failed, ");
+      if (error_control)
+        logger.info() << "error estimate " << error << ", ";
+      logger.info() << "retrying with step " << dt << " s\n";
+      profiler->add_count("dislocation/rejected steps");
+
+      get_time() -= dt_rejected;
+      restore_fields();
+      // stresses at the beginning of the time step
+      stress_solver.solve();
+    }
+
   const double dt    = get_time_step();
   const double t     = get_time();
   const double t_max = get_max_time();
 
-  std::cout.unsetf(std::ios_base::floatfield);
-  std::cout << std::setprecision(8);
-  std::cout << solver_name() << "  Time " << t << " s"
-            << " step " << dt << " s\n";
-
-  StressSolver<dim> &ss = get_stress_solver();
-  // Save fields at the previous time
-  const Vector<double>      N_m          = get_dislocation_density();
-  const BlockVector<double> displacement = ss.get_displacement();
-  const BlockVector<double> strain_c     = ss.get_strain_c();
-
-  if (time_scheme == "Euler")
-    integrate_Euler();
-  else if (time_scheme == "Midpoint" || time_scheme == "RK2")
-    integrate_midpoint();
-  else if (time_scheme == "Linearized N_m")
-    integrate_linearized_N_m();
-  else if (time_scheme == "Linearized N_m midpoint" ||
-           time_scheme == "Linearized N_m RK2")
-    integrate_linearized_N_m_midpoint();
-  else if (Utilities::match_at_string_start(time_scheme, "Implicit"))
-    integrate_implicit();
-  else
-    AssertThrow(false, ExcNotImplemented());
+  if (!memory_reported)
+    {
+      log_memory_consumption();
+      memory_reported = true;
+    }
 
   add_output("wall_time[s]", solver_timer.wall_time());
+  probe_evaluation.reinit(get_dof_handler(), probes);
   output_probes();
   probes_header_written = true;
 
   if (!has_converged())
     {
-      std::cout << solver_name() << "  Simulation diverged, stopping.\n";
+      logger.error() << solver_name() << "  Simulation diverged, stopping.\n";
       // The fields are now unusable, restore the ones at the previous time
       get_time() -= get_time_step();
-      get_dislocation_density() = N_m;
-      ss.get_displacement()     = displacement;
-      ss.get_strain_c()         = strain_c;
+      restore_fields();
       output_mesh();
       return false;
     }
 
   update_time_step();
 
+  profiler->end_time_step(t);
+
   if (dt > 0 && t + 1e-4 * dt >= t_max)
     return false;
 
@@ -1048,34 +1618,10 @@ DislocationSolver<dim>::get_field_at_points(
   const Vector<double> &         source,
   const std::vector<Point<dim>> &points) const
 {
-  Functions::FEFieldFunction<dim> ff(get_dof_handler(), source);
-
-  std::vector<double> values(points.size(), 0);
-
-  try
-    {
-      ff.value_list(points, values);
-    }
-  catch (std::exception &e)
-    {
-#ifdef DEBUG
-      std::cout << e.what() << "\n";
-#endif
-
-      for (unsigned int i = 0; i < points.size(); ++i)
-        {
-          try
-            {
-              values[i] = ff.value(points[i]);
-            }
-          catch (std::exception &e)
-            {
-              values[i] = 0;
-            }
-        }
-    }
+  DoFPointEvaluation<dim> point_evaluation;
+  point_evaluation.reinit(get_dof_handler(), points);
 
-  return values;
+  return point_evaluation.evaluate(source);
 }
 
 template <int dim>
@@ -1160,6 +1706,85 @@ DislocationSolver<dim>::initialize()
   dislocation_density.add(prm.get_double("Initial dislocation density"));
 }
 
+template <int dim>
+void
+DislocationSolver<dim>::estimate_error(Vector<float> &error) const
+{
+  const DoFHandler<dim> &dh        = get_dof_handler();
+  const std::string      indicator = prm.get("Refinement indicator");
+  const std::string      field     = prm.get("Refinement field");
+  const unsigned int     n_cells   = get_mesh().n_active_cells();
+
+  const auto estimate = [&](const Vector<double> &f) {
+    Vector<float> e(n_cells);
+
+    if (indicator == "Kelly")
+      {
+        KellyErrorEstimator<dim>::estimate(
+          dh,
+          QGauss<dim - 1>(get_degree() + 1),
+          std::map<types::boundary_id, const Function<dim> *>(),
+          f,
+          e);
+      }
+    else
+      {
+        DerivativeApproximation::approximate_gradient(MappingQ1<dim>(),
+                                                      dh,
+                                                      f,
+                                                      e);
+
+        unsigned int i = 0;
+        for (const auto &cell : dh.active_cell_iterators())
+          e[i++] *= std::pow(cell->diameter(), 1 + 0.5 * dim);
+      }
+
+    // N_m and J_2 have different units and magnitudes
+    const double norm = e.l2_norm();
+    if (norm > 0)
+      e /= norm;
+
+    return e;
+  };
+
+  error.reinit(n_cells);
+  if (field != "J_2")
+    error += estimate(get_dislocation_density());
+  if (field != "N_m")
+    error += estimate(get_stress_J_2());
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::prepare_for_refinement()
+{
+  stress_solver.prepare_for_refinement();
+
+  field_transfer.clear();
+  field_transfer.add(dislocation_density);
+  field_transfer.add(additional_fields);
+  field_transfer.prepare();
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::finish_refinement()
+{
+  stress_solver.finish_refinement();
+
+  field_transfer.interpolate(stress_solver.get_hanging_node_constraints());
+  field_transfer.get(0, dislocation_density);
+  field_transfer.get(additional_fields);
+  field_transfer.clear();
+
+  // higher-order interpolation can undershoot at steep gradients
+  for (auto &N_m : dislocation_density)
+    N_m = std::max(N_m, 0.0);
+
+  // stresses at the adapted mesh
+  stress_solver.solve();
+}
+
 template <int dim>
 void
 DislocationSolver<dim>::add_probe(const Point<dim> &p)
@@ -1184,14 +1809,29 @@ void
 DislocationSolver<dim>::add_field(const std::string &   name,
                                   const Vector<double> &value)
 {
-  additional_fields[name] = value;
+  additional_fields.set(name, value);
 }
 
 template <int dim>
 void
-DislocationSolver<dim>::load_data()
+DislocationSolver<dim>::add_field(const std::string &              name,
+                                  const FieldStore::FieldPointer &value)
 {
-  Timer timer;
+  additional_fields.set(name, value);
+}
+
+template <int dim>
+const FieldStore &
+DislocationSolver<dim>::get_fields() const
+{
+  return additional_fields;
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::load_data()
+{
+  Timer timer;
 
   const std::string s = output_name_suffix();
 
@@ -1201,7 +1841,7 @@ DislocationSolver<dim>::load_data()
   read_data(get_strain_c(), "strain_c" + s);
   // skip calculated quantities (stresses)
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1211,33 +1851,132 @@ DislocationSolver<dim>::output_data() const
   Timer timer;
 
   const std::string s = output_name_suffix();
+  BackgroundWriter &w = background_writer;
 
-  write_data(get_temperature(), "temperature" + s);
-  write_data(get_dislocation_density(), "dislocation_density" + s);
-  write_data(get_displacement(), "displacement" + s);
-  write_data(get_stress(), "stress" + s);
-  write_data(get_stress_deviator(), "stress_deviator" + s);
-  write_data(get_stress_hydrostatic(), "stress_hydrostatic" + s);
-  write_data(get_stress_J_2(), "stress_J_2" + s);
-  write_data(get_strain_e(), "strain_e" + s);
-  write_data(get_strain_c(), "strain_c" + s);
+  write_data(get_temperature(), "temperature" + s, w);
+  write_data(get_dislocation_density(), "dislocation_density" + s, w);
+  write_data(get_displacement(), "displacement" + s, w);
+  write_data(get_stress(), "stress" + s, w);
+  write_data(get_stress_deviator(), "stress_deviator" + s, w);
+  write_data(get_stress_hydrostatic(), "stress_hydrostatic" + s, w);
+  write_data(get_stress_J_2(), "stress_J_2" + s, w);
+  write_data(get_strain_e(), "strain_e" + s, w);
+  write_data(get_strain_c(), "strain_c" + s, w);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::output_checkpoint() const
+{
+  Timer timer;
+
+  const std::string base_name = checkpoint_base_name();
+  logger.info() << solver_name() << "  Saving checkpoint '"
+                << CheckpointArchive::get_file_name(base_name, 0) << "'";
+
+  // finish the queued output, the checkpoint should not be newer than it
+  background_writer.flush();
+
+  CheckpointArchive archive;
+  archive.add_mesh("mesh", get_mesh());
+  archive.add_data("temperature", get_temperature());
+  archive.add_data("dislocation_density", dislocation_density);
+  archive.add_data("displacement", get_displacement());
+  archive.add_data("strain_c", get_strain_c());
+  for (const auto &it : additional_fields)
+    archive.add_data("field:" + it.first, *it.second);
+  for (const auto &it : additional_output)
+    archive.add_value("output:" + it.first, it.second);
+
+  archive.add_value("time", current_time);
+  archive.add_value("time_step", current_time_step);
+  archive.add_value("previous_time_step", previous_time_step);
+  archive.add_value("previous_error", previous_error);
+  archive.add_value("error_time_step", error_time_step);
+  archive.add_value("probes_header_written", probes_header_written);
+
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  archive.add_string("parameters", ss.str());
+
+  archive.write(base_name, prm.get_integer("Number of checkpoints"));
+
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+bool
+DislocationSolver<dim>::load_checkpoint()
+{
+  Timer timer;
+
+  CheckpointArchive archive;
+
+  const std::string file_name =
+    archive.read(checkpoint_base_name(),
+                 prm.get_integer("Number of checkpoints"));
+  if (file_name.empty())
+    {
+      logger.info() << solver_name() << "  No valid checkpoint found\n";
+      return false;
+    }
+
+  logger.info() << solver_name() << "  Loading checkpoint '" << file_name
+                << "'\n";
+
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  if (archive.get_string("parameters") != ss.str())
+    logger.warning() << solver_name()
+                     << "  Warning: parameters differ from the checkpoint, "
+                        "using the current values\n";
+
+  archive.get_mesh("mesh", get_mesh());
+  initialize();
+
+  archive.get_data("temperature", get_temperature());
+  archive.get_data("dislocation_density", dislocation_density);
+  archive.get_data("displacement", get_displacement());
+  archive.get_data("strain_c", get_strain_c());
+
+  for (const auto &name : archive.get_names("field:"))
+    archive.get_data("field:" + name, additional_fields.get_mutable(name));
+  for (const auto &name : archive.get_names("output:"))
+    additional_output[name] = archive.get_value("output:" + name);
+
+  current_time          = archive.get_value("time");
+  current_time_step     = archive.get_value("time_step");
+  previous_time_step    = archive.get_value("previous_time_step");
+  previous_error        = archive.get_value("previous_error");
+  error_time_step       = archive.get_value("error_time_step");
+  probes_header_written = archive.get_value("probes_header_written") != 0;
+  stress_outdated       = true;
+
+  logger.info() << solver_name() << "  Restored t=" << get_time()
+                << " s, dt=" << get_time_step() << " s " << format_time(timer)
+                << "\n";
+
+  return true;
 }
 
 template <int dim>
 void
 DislocationSolver<dim>::output_vtk() const
 {
+  const Profiler::Scope scope(*profiler, "dislocation/output");
+
   Timer timer;
 
   const DoFHandler<dim> &dh = get_dof_handler();
 
-  const std::string file_name =
-    "result-dislocation" + output_name_suffix() + ".vtk";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  const std::string format    = prm.get("Output format");
+  const std::string file_name = "result-dislocation" + output_name_suffix();
+  logger.info() << solver_name() << "  Saving to '" << file_name << "."
+                << DataOutWriter<dim>::get_extension(format) << "'";
 
-  DataOut<dim> data_out;
+  BufferedDataOut<dim> data_out;
 
   data_out.attach_dof_handler(dh);
 
@@ -1256,14 +1995,12 @@ DislocationSolver<dim>::output_vtk() const
     Q[i] = calc_Q(T[i], tau[i]);
   output_data_vector(Q, "Q", data_out);
 
-  Vector<double> D(T.size());
-  for (unsigned int i = 0; i < T.size(); ++i)
-    D[i] = calc_D(T[i]);
+  const Vector<double> D =
+    evaluate_pointwise(T, [this](const double x) { return calc_D(x); });
   output_data_vector(D, "D", data_out);
 
-  Vector<double> tau_crit(T.size());
-  for (unsigned int i = 0; i < T.size(); ++i)
-    tau_crit[i] = calc_tau_crit(T[i]);
+  const Vector<double> tau_crit =
+    evaluate_pointwise(T, [this](const double x) { return calc_tau_crit(x); });
   output_data_vector(tau_crit, "tau_crit", data_out);
 
   const BlockVector<double> &displacement = get_displacement();
@@ -1320,20 +2057,24 @@ DislocationSolver<dim>::output_vtk() const
 
   for (const auto &it : additional_fields)
     {
-      if (it.second.size() == T.size())
-        data_out.add_data_vector(it.second, it.first);
+      if (it.second->size() == T.size())
+        data_out.add_data_vector(*it.second, it.first);
     }
 
   data_out.build_patches(prm.get_integer("Output subdivisions"));
 
-  std::ofstream output(file_name);
-
-  const int precision = prm.get_integer("Output precision");
-  output << std::setprecision(precision);
+  const std::string series_name = "result-dislocation-" + std::to_string(dim) +
+                                  "d-order" + std::to_string(get_degree());
 
-  data_out.write_vtk(output);
+  output_writer.write(data_out,
+                      file_name,
+                      series_name,
+                      format,
+                      get_time(),
+                      prm.get_integer("Output precision"),
+                      background_writer);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1350,15 +2091,15 @@ DislocationSolver<dim>::output_boundary_values(const unsigned int id) const
                    boundary_dofs.cend(),
                    [](const bool b) { return b; }))
     {
-      std::cout << solver_name()
-                << "  output_boundary_values: skipping empty boundary " << id
-                << "\n";
+      logger.info() << solver_name()
+                    << "  output_boundary_values: skipping empty boundary "
+                    << id << "\n";
       return;
     }
 
   const std::string file_name = "result-dislocation" + output_name_suffix() +
                                 "-boundary" + std::to_string(id) + ".dat";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  logger.info() << solver_name() << "  Saving to '" << file_name << "'";
 
   std::ofstream output(file_name);
 
@@ -1401,7 +2142,7 @@ DislocationSolver<dim>::output_boundary_values(const unsigned int id) const
 
   for (const auto &it : additional_fields)
     {
-      if (it.second.size() == T.size())
+      if (it.second->size() == T.size())
         output << '\t' << it.first;
     }
 
@@ -1439,14 +2180,14 @@ DislocationSolver<dim>::output_boundary_values(const unsigned int id) const
 
       for (const auto &it : additional_fields)
         {
-          if (it.second.size() == T.size())
-            output << '\t' << it.second[i];
+          if (it.second->size() == T.size())
+            output << '\t' << (*it.second)[i];
         }
 
       output << '\n';
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1456,16 +2197,19 @@ DislocationSolver<dim>::output_mesh() const
   Timer timer;
 
   const std::string file_name = "mesh" + output_name_suffix() + ".msh";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  logger.info() << solver_name() << "  Saving to '" << file_name << "'";
 
-  std::ofstream output(file_name);
+  // format here, the mesh could be changed while the file is written
+  std::stringstream output;
   output << std::setprecision(16);
 
   GridOut grid_out;
   grid_out.set_flags(GridOutFlags::Msh(true));
   grid_out.write_msh(get_mesh(), output);
 
-  std::cout << " " << format_time(timer) << "\n";
+  background_writer.write_file(file_name, output.str());
+
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1475,8 +2219,8 @@ DislocationSolver<dim>::output_parameter_table(const double       T1,
                                                const unsigned int n) const
 {
   const std::string fname = "dislocation-parameter-table.tsv";
-  std::cout << solver_name() << "  Saving table '" << fname << "', T=" << T1
-            << "-" << T2 << " K, n=" << n << '\n';
+  logger.info() << solver_name() << "  Saving table '" << fname << "', T=" << T1
+                << "-" << T2 << " K, n=" << n << '\n';
 
   std::ofstream output(fname);
 
@@ -1503,7 +2247,7 @@ template <int dim>
 void
 DislocationSolver<dim>::initialize_parameters()
 {
-  std::cout << solver_name() << "  Initializing parameters";
+  logger.info() << solver_name() << "  Initializing parameters";
 
   const std::string m_Q_expression = prm.get("Peierls potential");
   m_Q.initialize("T", m_Q_expression, typename FunctionParser<1>::ConstMap());
@@ -1521,6 +2265,23 @@ DislocationSolver<dim>::initialize_parameters()
                         m_tau_crit_expression,
                         typename FunctionParser<1>::ConstMap());
 
+  prm.enter_subsection("Property table");
+  const unsigned int n_table = prm.get_integer("Number of points");
+  const double       T_min   = prm.get_double("Min temperature");
+  const double       T_max   = prm.get_double("Max temperature");
+  prm.leave_subsection();
+
+  // m_dQ is a function of stress and is not tabulated
+  m_Q_table.initialize(m_Q, T_min, T_max, n_table);
+  m_D_table.initialize(m_D, T_min, T_max, n_table);
+  m_tau_crit_table.initialize(m_tau_crit, T_min, T_max, n_table);
+
+  background_writer.set_max_queued_tasks(prm.get_integer("Output queue size"));
+
+  const std::string log_level = prm.get("Log level");
+  if (log_level != "default")
+    logger.set_level(log_level);
+
   m_b   = prm.get_double("Burgers vector");
   m_K   = prm.get_double("Material constant K");
   m_k_0 = prm.get_double("Material constant k_0");
@@ -1534,6 +2295,54 @@ DislocationSolver<dim>::initialize_parameters()
 
   time_scheme = prm.get("Time scheme");
 
+  AssertThrow(!use_error_control() || time_scheme == "Midpoint" ||
+                time_scheme == "RK2" ||
+                time_scheme == "Linearized N_m midpoint" ||
+                time_scheme == "Linearized N_m RK2" ||
+                Utilities::match_at_string_start(time_scheme, "Implicit") ||
+                time_scheme == "Newton",
+              ExcMessage("Error tolerance is not supported by time scheme '" +
+                         time_scheme + "'"));
+
+  AssertThrow(time_scheme != "Newton" ||
+                (prm.get_double("Newton tolerance") > 0 &&
+                 prm.get_double("Newton strain tolerance") > 0),
+              ExcMessage("Newton tolerances must be positive"));
+
+  use_device_integration = prm.get_bool("Device integration");
+
+#ifndef MACPLAS_WITH_KOKKOS
+  AssertThrow(!use_device_integration,
+              ExcMessage("DislocationSolver: device integration requires "
+                         "compilation with MACPLAS_WITH_KOKKOS"));
+#endif
+  AssertThrow(!use_device_integration || time_scheme == "Euler" ||
+                time_scheme == "Linearized N_m",
+              ExcMessage("DislocationSolver: device integration is not "
+                         "supported by time scheme '" +
+                         time_scheme + "'"));
+  AssertThrow(!use_device_integration || n_table >= 2,
+              ExcMessage("DislocationSolver: device integration requires "
+                         "property tables (\"Number of points\" >= 2)"));
+
+  if (use_device_integration)
+    {
+      // there is no function parser on the device
+      bool dQ_constant = true;
+      try
+        {
+          Utilities::string_to_double(m_dQ_expression);
+        }
+      catch (std::exception &)
+        {
+          dQ_constant = false;
+        }
+      AssertThrow(dQ_constant,
+                  ExcMessage("DislocationSolver: device integration requires "
+                             "a constant Peierls potential correction, got '" +
+                             m_dQ_expression + "'"));
+    }
+
   get_time_step() = previous_time_step = prm.get_double("Time step");
 
   const long int n_vtk_default = get_degree();
@@ -1541,21 +2350,23 @@ DislocationSolver<dim>::initialize_parameters()
   if (prm.get_integer("Output subdivisions") == 0)
     prm.set("Output subdivisions", n_vtk_default);
 
-  std::cout << "  done\n";
+  logger.info() << "  done\n";
 
-  std::cout << "b=" << m_b << "\n"
-            << "Q=" << m_Q_expression << "\n"
-            << "dQ=" << m_dQ_expression << "\n"
-            << "D=" << m_D_expression << "\n"
-            << "tau_crit=" << m_tau_crit_expression << "\n"
-            << "K=" << m_K << "\n"
-            << "k_0=" << m_k_0 << "\n"
-            << "l=" << m_l << "\n"
-            << "p=" << m_p << "\n"
-            << "S=" << m_S << "\n"
-            << "F=" << m_F << "\n"
-            << "k_B=" << m_k_B << "\n"
-            << "time_scheme=" << time_scheme << "\n";
+  logger.info() << "b=" << m_b << "\n"
+                << "Q=" << m_Q_expression << "\n"
+                << "dQ=" << m_dQ_expression << "\n"
+                << "D=" << m_D_expression << "\n"
+                << "tau_crit=" << m_tau_crit_expression << "\n"
+                << "K=" << m_K << "\n"
+                << "k_0=" << m_k_0 << "\n"
+                << "l=" << m_l << "\n"
+                << "p=" << m_p << "\n"
+                << "S=" << m_S << "\n"
+                << "F=" << m_F << "\n"
+                << "k_B=" << m_k_B << "\n"
+                << "time_scheme=" << time_scheme << "\n"
+                << "device_integration=" << use_device_integration << "\n"
+                << "n_table=" << n_table << "\n";
 }
 
 template <int dim>
@@ -1569,6 +2380,11 @@ DislocationSolver<dim>::initialize_dt_output()
     add_output("max_dt_dot_strain_c_" + std::to_string(i) + "[s]");
   add_output("max_dt_dot_N_m_rel[s]");
   add_output("max_dt_dot_tau_eff_rel[s]");
+  add_output("max_dt_error[s]");
+  add_output("error_estimate");
+  add_output("rejected_steps");
+  add_output("newton_iterations");
+  add_output("newton_residual");
 }
 
 template <int dim>
@@ -1652,8 +2468,8 @@ DislocationSolver<dim>::update_time_step()
           time_steps.push_back(dt);
           add_output("max_dt_v[s]", dt);
 #ifdef DEBUG
-          std::cout << "dt=" << dt << " s, "
-                    << "v_max=" << v_max << " m/s\n";
+          logger.detail() << "dt=" << dt << " s, "
+                          << "v_max=" << v_max << " m/s\n";
 #endif
         }
     }
@@ -1674,9 +2490,9 @@ DislocationSolver<dim>::update_time_step()
               add_output("max_dt_dot_strain_c_" + std::to_string(i) + "[s]",
                          dt);
 #ifdef DEBUG
-              std::cout << "dt=" << dt << " s, "
-                        << "dot_strain_c_" << i << "_max=" << dot_strain_c
-                        << " 1/s\n";
+              logger.detail() << "dt=" << dt << " s, "
+                              << "dot_strain_c_" << i << "_max=" << dot_strain_c
+                              << " 1/s\n";
 #endif
             }
         }
@@ -1701,8 +2517,8 @@ DislocationSolver<dim>::update_time_step()
           time_steps.push_back(dt);
           add_output("max_dt_dot_N_m_rel[s]", dt);
 #ifdef DEBUG
-          std::cout << "dt=" << dt << " s, "
-                    << "dot_N_m_rel_max=" << dot_N_m_rel << "\n";
+          logger.detail() << "dt=" << dt << " s, "
+                          << "dot_N_m_rel_max=" << dot_N_m_rel << "\n";
 #endif
         }
     }
@@ -1731,12 +2547,18 @@ DislocationSolver<dim>::update_time_step()
           time_steps.push_back(dt);
           add_output("max_dt_dot_tau_eff_rel[s]", dt);
 #ifdef DEBUG
-          std::cout << "dt=" << dt << " s, "
-                    << "max_dt_dot_tau_eff_rel=" << dot_tau_rel << "\n";
+          logger.detail() << "dt=" << dt << " s, "
+                          << "max_dt_dot_tau_eff_rel=" << dot_tau_rel << "\n";
 #endif
         }
     }
 
+  if (use_error_control() && error_time_step > 0)
+    {
+      time_steps.push_back(error_time_step);
+      add_output("max_dt_error[s]", error_time_step);
+    }
+
   if (!time_steps.empty())
     dt = *std::min_element(time_steps.begin(), time_steps.end());
   else if (dt_rel_max > 0 && get_time() > 0)
@@ -1773,116 +2595,272 @@ DislocationSolver<dim>::advance_time()
   get_time() += get_time_step();
 }
 
+template <int dim>
+void
+DislocationSolver<dim>::integrate()
+{
+  const Profiler::Scope scope(*profiler, "dislocation/integrate");
+
+  if (use_device_integration && integrate_device())
+    return;
+
+  if (time_scheme == "Euler")
+    integrate_Euler();
+  else if (time_scheme == "Midpoint" || time_scheme == "RK2")
+    integrate_midpoint();
+  else if (time_scheme == "Linearized N_m")
+    integrate_linearized_N_m();
+  else if (time_scheme == "Linearized N_m midpoint" ||
+           time_scheme == "Linearized N_m RK2")
+    integrate_linearized_N_m_midpoint();
+  else if (Utilities::match_at_string_start(time_scheme, "Implicit"))
+    integrate_implicit();
+  else if (time_scheme == "Newton")
+    integrate_Newton();
+  else
+    AssertThrow(false, ExcNotImplemented());
+}
+
+template <int dim>
+bool
+DislocationSolver<dim>::use_error_control() const
+{
+  return prm.get_double("Error tolerance") > 0;
+}
+
+template <int dim>
+double
+DislocationSolver<dim>::calculate_error_estimate() const
+{
+  const double tol_N_m      = prm.get_double("Error tolerance");
+  const double tol_strain_c = prm.get_double("Strain error tolerance");
+  const double N_0          = prm.get_double("Initial dislocation density");
+
+  const Vector<double> &     N_m      = get_dislocation_density();
+  const BlockVector<double> &strain_c = get_strain_c();
+
+  AssertDimension(N_m.size(), dislocation_density_low.size());
+  AssertDimension(strain_c.size(), strain_c_low.size());
+
+  // NaN are propagated to the result
+  double error = 0;
+  for (unsigned int i = 0; i < N_m.size(); ++i)
+    {
+      const double e = std::abs(N_m[i] - dislocation_density_low[i]) /
+                       (tol_N_m * std::max(std::abs(N_m[i]), N_0));
+      if (!(e <= error))
+        error = e;
+    }
+
+  if (tol_strain_c > 0)
+    {
+      for (unsigned int i = 0; i < strain_c.size(); ++i)
+        {
+          const double e =
+            std::abs(strain_c[i] - strain_c_low[i]) / tol_strain_c;
+          if (!(e <= error))
+            error = e;
+        }
+    }
+
+  return error;
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::update_error_control(const double error)
+{
+  // PI controller for an error estimate of order dt^2
+  // (Hairer, Wanner: Solving Ordinary Differential Equations II, IV.2)
+  double factor = 0.2;
+  if (std::isfinite(error))
+    {
+      const double e = std::max(error, 1e-10);
+
+      factor = 0.9 * std::pow(e, -0.7 / 2);
+      if (previous_error > 0)
+        factor *= std::pow(previous_error, 0.4 / 2);
+      factor = std::min(5.0, std::max(0.2, factor));
+
+      previous_error = e;
+    }
+
+  error_time_step = factor * get_time_step();
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::restore_fields()
+{
+  StressSolver<dim> &ss = get_stress_solver();
+
+  if (dislocation_density_0_float.size() > 0)
+    {
+      get_dislocation_density() = dislocation_density_0_float;
+      ss.get_strain_c()         = strain_c_0_float;
+    }
+  else
+    {
+      get_dislocation_density() = dislocation_density_0;
+      ss.get_strain_c()         = strain_c_0;
+    }
+  // not kept with "Low memory"
+  if (displacement_0.size() > 0)
+    ss.get_displacement() = displacement_0;
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::log_memory_consumption() const
+{
+  const std::vector<std::pair<std::string, std::size_t>> items = {
+    {"dislocation_density", dislocation_density.memory_consumption()},
+    {"dislocation_density_0", dislocation_density_0.memory_consumption()},
+    {"displacement_0", displacement_0.memory_consumption()},
+    {"strain_c_0", strain_c_0.memory_consumption()},
+    {"dislocation_density_0_float",
+     dislocation_density_0_float.memory_consumption()},
+    {"strain_c_0_float", strain_c_0_float.memory_consumption()},
+    {"dislocation_density_low", dislocation_density_low.memory_consumption()},
+    {"strain_c_low", strain_c_low.memory_consumption()},
+  };
+
+  std::size_t total = 0;
+  for (const auto &it : items)
+    total += it.second;
+
+  logger.info() << solver_name() << "  Memory usage " << total / 1e6
+                << " MB\n";
+  for (const auto &it : items)
+    logger.info() << solver_name() << "  " << it.first << "="
+                  << it.second / 1e6 << " MB\n";
+
+  stress_solver.log_memory_consumption();
+}
+
 template <int dim>
 void
 DislocationSolver<dim>::output_probes() const
 {
+  if (!prm.get_bool("Output probes"))
+    return;
+
+  const Profiler::Scope scope(*profiler, "dislocation/output");
+
   Timer timer;
 
   std::stringstream ss;
   ss << "probes-dislocation-" << dim << "d.txt";
   const std::string file_name = ss.str();
 
-  std::cout << solver_name() << "  "
-            << "Saving values at probe points to '" << file_name << "'";
-
-  const unsigned int N = probes.size();
+  logger.info() << solver_name() << "  "
+                << "Saving values at probe points to '" << file_name << "'";
 
-  const double t  = get_time();
-  const double dt = get_time_step();
-
-  const BlockVector<double> &d   = get_displacement();
-  const BlockVector<double> &s   = get_stress();
-  const BlockVector<double> &S   = get_stress_deviator();
-  const BlockVector<double> &e_c = get_strain_c();
+  std::vector<std::string> names;
+  std::vector<double>      values;
+  get_probe_values(names, values);
 
   if (!probes_header_written)
     {
       // write header at the first time step
-      std::ofstream output(file_name);
+      std::stringstream output;
 
-      for (unsigned int i = 0; i < N; ++i)
+      for (unsigned int i = 0; i < probes.size(); ++i)
         output << "# probe " << i << ":\t" << probes[i] << "\n";
 
-      output << "t[s]"
-             << "\tdt[s]";
-
-      for (const auto &it : additional_output)
-        output << "\t" << it.first;
-
-      output << "\tT_min[K]"
-             << "\tT_max[K]"
-             << "\tN_m_min[m^-2]"
-             << "\tN_m_max[m^-2]"
-             << "\tdot_N_m_min[m^-2s^-1]"
-             << "\tdot_N_m_max[m^-2s^-1]"
-             << "\tv_min[ms^-1]"
-             << "\tv_max[ms^-1]"
-             << "\tdisplacement_min[m]"
-             << "\tdisplacement_max[m]"
-             << "\tstress_min[Pa]"
-             << "\tstress_max[Pa]"
-             << "\tstrain_c_min[-]"
-             << "\tstrain_c_max[-]"
-             << "\tdot_strain_c_min[s^-1]"
-             << "\tdot_strain_c_max[s^-1]"
-             << "\ttau_eff_min[Pa]"
-             << "\ttau_eff_max[Pa]"
-             << "\tJ_2_min[Pa^2]"
-             << "\tJ_2_max[Pa^2]";
+      for (unsigned int i = 0; i < names.size(); ++i)
+        output << (i > 0 ? "\t" : "") << names[i];
+      output << "\n";
 
-      for (unsigned int i = 0; i < N; ++i)
-        {
-          output << "\tT_" << i << "[K]"
-                 << "\tN_m_" << i << "[m^-2]"
-                 << "\tdot_N_m_" << i << "[m^-2s^-1]"
-                 << "\tv_" << i << "[ms^-1]";
+      background_writer.write_file(file_name, output.str());
+    }
 
-          for (unsigned int j = 0; j < d.n_blocks(); ++j)
-            output << "\tdisplacement_" << j << "_" << i << "[m]";
+  // header is already written, append values at the current time step
+  std::stringstream output;
 
-          for (unsigned int j = 0; j < s.n_blocks(); ++j)
-            output << "\tstress_" << j << "_" << i << "[Pa]";
+  const int precision = prm.get_integer("Output precision");
+  output << std::setprecision(precision);
 
-          for (unsigned int j = 0; j < S.n_blocks(); ++j)
-            output << "\tstress_deviator_" << j << "_" << i << "[Pa]";
+  for (unsigned int i = 0; i < values.size(); ++i)
+    output << (i > 0 ? "\t" : "") << values[i];
+  output << "\n";
 
-          for (unsigned int j = 0; j < e_c.n_blocks(); ++j)
-            output << "\tstrain_c_" << j << "_" << i << "[-]";
+  background_writer.write_file(file_name, output.str(), std::ios::app);
 
-          for (unsigned int j = 0; j < e_c.n_blocks(); ++j)
-            output << "\tdot_strain_c_" << j << "_" << i << "[s^-1]";
+  logger.info() << " " << format_time(timer) << "\n";
+}
 
-          output << "\ttau_eff_" << i << "[Pa]"
-                 << "\tJ_2_" << i << "[Pa^2]";
-        }
-      output << "\n";
-    }
+template <int dim>
+void
+DislocationSolver<dim>::get_probe_values(std::vector<std::string> &names,
+                                         std::vector<double> &     values) const
+{
+  const unsigned int N = probes.size();
+
+  const BlockVector<double> &d   = get_displacement();
+  const BlockVector<double> &s   = get_stress();
+  const BlockVector<double> &S   = get_stress_deviator();
+  const BlockVector<double> &e_c = get_strain_c();
+
+  names.clear();
+  values.clear();
+
+  const auto add = [&](const std::string &name, const double value) {
+    names.push_back(name);
+    values.push_back(value);
+  };
+
+  const auto add_limits = [&](const std::string &              name,
+                              const std::string &              unit,
+                              const std::pair<double, double> &limits) {
+    add(name + "_min" + unit, limits.first);
+    add(name + "_max" + unit, limits.second);
+  };
+
+  add("t[s]", get_time());
+  add("dt[s]", get_time_step());
+
+  for (const auto &it : additional_output)
+    add(it.first, it.second);
 
   const Vector<double> &T   = get_temperature();
   const Vector<double> &N_m = get_dislocation_density();
   const Vector<double> &J_2 = get_stress_J_2();
 
-  // Process each field separately - easy to implement but potentially slow.
-  const std::vector<double> values_T   = get_field_at_probes(T);
-  const std::vector<double> values_N_m = get_field_at_probes(N_m);
-  const std::vector<double> values_J_2 = get_field_at_probes(J_2);
-
-  std::vector<std::vector<double>> values_d(d.n_blocks());
+  // evaluate all fields at the probe points in one pass
+  std::vector<const Vector<double> *> fields = {&T, &N_m, &J_2};
   for (unsigned int i = 0; i < d.n_blocks(); ++i)
-    values_d[i] = get_field_at_probes(d.block(i));
-
-  std::vector<std::vector<double>> values_s(s.n_blocks());
+    fields.push_back(&d.block(i));
   for (unsigned int i = 0; i < s.n_blocks(); ++i)
-    values_s[i] = get_field_at_probes(s.block(i));
-
-  std::vector<std::vector<double>> values_S(S.n_blocks());
+    fields.push_back(&s.block(i));
   for (unsigned int i = 0; i < S.n_blocks(); ++i)
-    values_S[i] = get_field_at_probes(S.block(i));
-
-  std::vector<std::vector<double>> values_e_c(e_c.n_blocks());
+    fields.push_back(&S.block(i));
   for (unsigned int i = 0; i < e_c.n_blocks(); ++i)
-    values_e_c[i] = get_field_at_probes(e_c.block(i));
+    fields.push_back(&e_c.block(i));
+
+  const std::vector<std::vector<double>> values_probes =
+    probe_evaluation.evaluate(fields);
+
+  auto it_values = values_probes.cbegin();
+
+  const std::vector<double> &values_T   = *it_values++;
+  const std::vector<double> &values_N_m = *it_values++;
+  const std::vector<double> &values_J_2 = *it_values++;
+
+  const std::vector<std::vector<double>> values_d(it_values,
+                                                  it_values + d.n_blocks());
+  it_values += d.n_blocks();
+
+  const std::vector<std::vector<double>> values_s(it_values,
+                                                  it_values + s.n_blocks());
+  it_values += s.n_blocks();
+
+  const std::vector<std::vector<double>> values_S(it_values,
+                                                  it_values + S.n_blocks());
+  it_values += S.n_blocks();
+
+  const std::vector<std::vector<double>> values_e_c(it_values,
+                                                    it_values + e_c.n_blocks());
 
   // calculate additional fields
   const std::vector<double> values_tau =
@@ -1903,92 +2881,76 @@ DislocationSolver<dim>::output_probes() const
   for (unsigned int i = 0; i < e_c.n_blocks(); ++i)
     dot_e_c.block(i) = derivative_strain(N_m, J_2, T, S.block(i));
 
-  // header is already written, append values at the current time step
-  std::ofstream output(file_name, std::ios::app);
-
-  const int precision = prm.get_integer("Output precision");
-  output << std::setprecision(precision);
-
-  const auto limits_T       = minmax(T);
-  const auto limits_N_m     = minmax(N_m);
-  const auto limits_dot_N_m = minmax(derivative_N_m(N_m, J_2, T));
-  const auto limits_v       = minmax(dislocation_velocity(N_m, J_2, T));
-  const auto limits_d       = minmax(d);
-  const auto limits_s       = minmax(s);
-  const auto limits_e_c     = minmax(e_c);
-  const auto limits_dot_e_c = minmax(dot_e_c);
-  const auto limits_tau     = minmax(tau_eff(N_m, J_2, T));
-  const auto limits_J_2     = minmax(J_2);
-
-  output << t << '\t' << dt;
-
-  for (const auto &it : additional_output)
-    output << "\t" << it.second;
-
-  output << '\t' << limits_T.first << '\t' << limits_T.second;
-  output << '\t' << limits_N_m.first << '\t' << limits_N_m.second;
-  output << '\t' << limits_dot_N_m.first << '\t' << limits_dot_N_m.second;
-  output << '\t' << limits_v.first << '\t' << limits_v.second;
-  output << '\t' << limits_d.first << '\t' << limits_d.second;
-  output << '\t' << limits_s.first << '\t' << limits_s.second;
-  output << '\t' << limits_e_c.first << '\t' << limits_e_c.second;
-  output << '\t' << limits_dot_e_c.first << '\t' << limits_dot_e_c.second;
-  output << '\t' << limits_tau.first << '\t' << limits_tau.second;
-  output << '\t' << limits_J_2.first << '\t' << limits_J_2.second;
+  add_limits("T", "[K]", minmax(T));
+  add_limits("N_m", "[m^-2]", minmax(N_m));
+  add_limits("dot_N_m", "[m^-2s^-1]", minmax(derivative_N_m(N_m, J_2, T)));
+  add_limits("v", "[ms^-1]", minmax(dislocation_velocity(N_m, J_2, T)));
+  add_limits("displacement", "[m]", minmax(d));
+  add_limits("stress", "[Pa]", minmax(s));
+  add_limits("strain_c", "[-]", minmax(e_c));
+  add_limits("dot_strain_c", "[s^-1]", minmax(dot_e_c));
+  add_limits("tau_eff", "[Pa]", minmax(tau_eff(N_m, J_2, T)));
+  add_limits("J_2", "[Pa^2]", minmax(J_2));
 
   for (unsigned int i = 0; i < N; ++i)
     {
-      output << '\t' << values_T[i] << '\t' << values_N_m[i] << '\t'
-             << values_dot_N_m[i] << '\t' << values_v[i];
+      const std::string k = std::to_string(i);
+
+      add("T_" + k + "[K]", values_T[i]);
+      add("N_m_" + k + "[m^-2]", values_N_m[i]);
+      add("dot_N_m_" + k + "[m^-2s^-1]", values_dot_N_m[i]);
+      add("v_" + k + "[ms^-1]", values_v[i]);
 
       for (unsigned int j = 0; j < d.n_blocks(); ++j)
-        output << '\t' << values_d[j][i];
+        add("displacement_" + std::to_string(j) + "_" + k + "[m]",
+            values_d[j][i]);
 
       for (unsigned int j = 0; j < s.n_blocks(); ++j)
-        output << '\t' << values_s[j][i];
+        add("stress_" + std::to_string(j) + "_" + k + "[Pa]", values_s[j][i]);
 
       for (unsigned int j = 0; j < S.n_blocks(); ++j)
-        output << '\t' << values_S[j][i];
+        add("stress_deviator_" + std::to_string(j) + "_" + k + "[Pa]",
+            values_S[j][i]);
 
       for (unsigned int j = 0; j < e_c.n_blocks(); ++j)
-        output << '\t' << values_e_c[j][i];
+        add("strain_c_" + std::to_string(j) + "_" + k + "[-]",
+            values_e_c[j][i]);
 
       for (unsigned int j = 0; j < e_c.n_blocks(); ++j)
-        output << '\t' << values_dot_e_c[j][i];
+        add("dot_strain_c_" + std::to_string(j) + "_" + k + "[s^-1]",
+            values_dot_e_c[j][i]);
 
-      output << '\t' << values_tau[i] << '\t' << values_J_2[i];
+      add("tau_eff_" + k + "[Pa]", values_tau[i]);
+      add("J_2_" + k + "[Pa^2]", values_J_2[i]);
     }
-  output << "\n";
-
-  std::cout << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
 std::vector<double>
 DislocationSolver<dim>::get_field_at_probes(const Vector<double> &source) const
 {
-  return get_field_at_points(source, probes);
+  return probe_evaluation.evaluate(source);
 }
 
 template <int dim>
 double
 DislocationSolver<dim>::calc_Q(const double T, const double tau_eff) const
 {
-  return m_Q.value(Point<1>(T)) + m_dQ.value(Point<1>(tau_eff));
+  return m_Q_table.value(T) + m_dQ.value(Point<1>(tau_eff));
 }
 
 template <int dim>
 double
 DislocationSolver<dim>::calc_D(const double T) const
 {
-  return m_D.value(Point<1>(T));
+  return m_D_table.value(T);
 }
 
 template <int dim>
 double
 DislocationSolver<dim>::calc_tau_crit(const double T) const
 {
-  return m_tau_crit.value(Point<1>(T));
+  return m_tau_crit_table.value(T);
 }
 
 template <int dim>
@@ -2031,8 +2993,14 @@ DislocationSolver<dim>::tau_eff(const Vector<double> &N_m,
 
   Vector<double> result(N);
 
-  for (unsigned int i = 0; i < N; ++i)
-    result[i] = tau_eff(N_m[i], J_2[i], T[i], with_tau_crit);
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        result[i] = tau_eff(N_m[i], J_2[i], T[i], with_tau_crit);
+    },
+    grain_size);
 
   return result;
 }
@@ -2090,8 +3058,14 @@ DislocationSolver<dim>::derivative_N_m(const Vector<double> &N_m,
 
   Vector<double> result(N);
 
-  for (unsigned int i = 0; i < N; ++i)
-    result[i] = derivative_N_m(N_m[i], J_2[i], T[i]);
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        result[i] = derivative_N_m(N_m[i], J_2[i], T[i]);
+    },
+    grain_size);
 
   return result;
 }
@@ -2161,12 +3135,90 @@ DislocationSolver<dim>::derivative_strain(const Vector<double> &N_m,
 
   Vector<double> result(N);
 
-  for (unsigned int i = 0; i < N; ++i)
-    result[i] = derivative_strain(N_m[i], J_2[i], T[i], S[i]);
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        result[i] = derivative_strain(N_m[i], J_2[i], T[i], S[i]);
+    },
+    grain_size);
 
   return result;
 }
 
+template <int dim>
+void
+DislocationSolver<dim>::derivatives(const double N_m,
+                                    const double J_2,
+                                    const double T,
+                                    double &     dot_N_m,
+                                    double &     dot_strain_factor) const
+{
+  // same as tau_eff, evaluating the material functions only once
+  const double tau_0    = m_S * std::sqrt(J_2) - calc_D(T) * std::sqrt(N_m);
+  const double tau_crit = calc_tau_crit(T);
+
+  const double tau_p = std::max(tau_0 - tau_crit, 0.0);
+  const double tau_l =
+    std::max(tau_0 - dot_N_m_with_tau_crit_l * tau_crit, 0.0);
+
+  // k_0 tau_eff^p exp(-Q / k_B T), see dislocation_velocity
+  const double v = m_k_0 * std::pow(tau_p, m_p) *
+                   std::exp(-calc_Q(T, tau_p) / (m_k_B * T));
+
+  dot_N_m = m_K * v * std::pow(tau_l, m_l) * N_m;
+
+  dot_strain_factor = J_2 == 0 ? 0 : m_b * v * N_m / (2 * m_F * std::sqrt(J_2));
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::derivatives(
+  const Vector<double> &     N_m,
+  const Vector<double> &     J_2,
+  const Vector<double> &     T,
+  const BlockVector<double> &s,
+  Vector<double> &           dot_N_m,
+  BlockVector<double> &      dot_strain_c) const
+{
+  const unsigned int N        = N_m.size();
+  const unsigned int n_blocks = s.n_blocks();
+
+  dot_N_m.reinit(N);
+  dot_strain_c.reinit(n_blocks, N);
+
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      double f;
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          derivatives(N_m[i], J_2[i], T[i], dot_N_m[i], f);
+
+          for (unsigned int j = 0; j < n_blocks; ++j)
+            dot_strain_c.block(j)[i] = f * deviator(s, j, i);
+        }
+    },
+    grain_size);
+}
+
+template <int dim>
+double
+DislocationSolver<dim>::deviator(const BlockVector<double> &s,
+                                 const unsigned int         j,
+                                 const unsigned int         i)
+{
+  // same as StressSolver::calculate_stress_from_strain
+  if (j >= 3)
+    return s.block(j)[i];
+
+  const double s_ave = (s.block(0)[i] + s.block(1)[i] + s.block(2)[i]) / 3;
+
+  return s.block(j)[i] - s_ave;
+}
+
 template <int dim>
 double
 DislocationSolver<dim>::dislocation_velocity(const double N_m,
@@ -2204,8 +3256,14 @@ DislocationSolver<dim>::dislocation_velocity(const Vector<double> &N_m,
 
   Vector<double> result(N);
 
-  for (unsigned int i = 0; i < N; ++i)
-    result[i] = dislocation_velocity(N_m[i], J_2[i], T[i]);
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        result[i] = dislocation_velocity(N_m[i], J_2[i], T[i]);
+    },
+    grain_size);
 
   return result;
 }
@@ -2219,9 +3277,8 @@ DislocationSolver<dim>::integrate_Euler()
 
   const Vector<double> &     T   = get_temperature();
   const Vector<double> &     J_2 = get_stress_J_2();
-  const BlockVector<double> &S   = get_stress_deviator();
+  const BlockVector<double> &s   = get_stress();
 
-  const unsigned int N     = N_m.size();
   const unsigned int n_sub = get_time_substeps();
   const double       dt    = get_time_step() / n_sub;
 
@@ -2231,18 +3288,16 @@ DislocationSolver<dim>::integrate_Euler()
 
   recalculate_stress_before();
 
+  Vector<double>      dot_N_m;
+  BlockVector<double> dot_epsilon_c;
+
   for (unsigned int n = 0; n < n_sub; ++n)
     {
-      for (unsigned int i = 0; i < N; ++i)
-        {
-          // update strains
-          for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-            epsilon_c.block(j)[i] +=
-              derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt;
+      derivatives(N_m, J_2, T, s, dot_N_m, dot_epsilon_c);
 
-          // update N_m
-          N_m[i] += derivative_N_m(N_m[i], J_2[i], T[i]) * dt;
-        }
+      // update strains and N_m
+      epsilon_c.add(dt, dot_epsilon_c);
+      N_m.add(dt, dot_N_m);
 
       if (update_stress && n + 1 < n_sub)
         stress_solver.solve(true);
@@ -2260,49 +3315,48 @@ DislocationSolver<dim>::integrate_midpoint()
 
   const Vector<double> &     T   = get_temperature();
   const Vector<double> &     J_2 = get_stress_J_2();
-  const BlockVector<double> &S   = get_stress_deviator();
+  const BlockVector<double> &s   = get_stress();
 
-  const unsigned int N  = N_m.size();
-  const double       dt = get_time_step();
+  const double dt = get_time_step();
 
   const unsigned int n_sub = get_time_substeps();
   AssertThrow(n_sub == 1,
               ExcMessage("integrate_midpoint: n_sub=" + std::to_string(n_sub) +
                          " is not supported"));
 
-  // save values at the beginning of time step
-  Vector<double>      N_m_0       = N_m;
-  BlockVector<double> epsilon_c_0 = epsilon_c;
+  // values at the beginning of time step, saved in solve()
+  const Vector<double> &     N_m_0       = dislocation_density_0;
+  const BlockVector<double> &epsilon_c_0 = strain_c_0;
 
   recalculate_stress_before();
 
+  Vector<double>      dot_N_m;
+  BlockVector<double> dot_epsilon_c;
+
   // first, take a half step
-  for (unsigned int i = 0; i < N; ++i)
-    {
-      // update strains
-      for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-        epsilon_c.block(j)[i] +=
-          derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt / 2;
+  derivatives(N_m, J_2, T, s, dot_N_m, dot_epsilon_c);
 
-      // update N_m
-      N_m[i] += derivative_N_m(N_m[i], J_2[i], T[i]) * dt / 2;
+  if (use_error_control())
+    {
+      // embedded forward Euler solution
+      dislocation_density_low = N_m_0;
+      dislocation_density_low.add(dt, dot_N_m);
+      strain_c_low = epsilon_c_0;
+      strain_c_low.add(dt, dot_epsilon_c);
     }
 
+  epsilon_c.add(dt / 2, dot_epsilon_c);
+  N_m.add(dt / 2, dot_N_m);
+
   // recalculate stresses
   stress_solver.solve();
 
   // now, take a full step with derivatives evaluated at the midpoint
-  for (unsigned int i = 0; i < N; ++i)
-    {
-      // update strains
-      for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-        epsilon_c.block(j)[i] =
-          epsilon_c_0.block(j)[i] +
-          derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt;
-
-      // update N_m
-      N_m[i] = N_m_0[i] + derivative_N_m(N_m[i], J_2[i], T[i]) * dt;
-    }
+  derivatives(N_m, J_2, T, s, dot_N_m, dot_epsilon_c);
+  epsilon_c = epsilon_c_0;
+  epsilon_c.add(dt, dot_epsilon_c);
+  N_m = N_m_0;
+  N_m.add(dt, dot_N_m);
 
   recalculate_stress_after();
 }
@@ -2316,7 +3370,7 @@ DislocationSolver<dim>::integrate_linearized_N_m()
 
   const Vector<double> &     T   = get_temperature();
   const Vector<double> &     J_2 = get_stress_J_2();
-  const BlockVector<double> &S   = get_stress_deviator();
+  const BlockVector<double> &s   = get_stress();
 
   const unsigned int N     = N_m.size();
   const unsigned int n_sub = get_time_substeps();
@@ -2328,25 +3382,34 @@ DislocationSolver<dim>::integrate_linearized_N_m()
 
   recalculate_stress_before();
 
+  const unsigned int n_blocks = epsilon_c.n_blocks();
+
   for (unsigned int n = 0; n < n_sub; ++n)
     {
-      for (unsigned int i = 0; i < N; ++i)
-        {
-          // linearize dot_N_m = a + b * (N_m-N_m_0)
-          const double a = derivative_N_m(N_m[i], J_2[i], T[i]);
-          const double b = derivative2_N_m_N_m(N_m[i], J_2[i], T[i]);
+      parallel::apply_to_subranges(
+        0U,
+        N,
+        [&](const unsigned int begin, const unsigned int end) {
+          double a, f;
+          for (unsigned int i = begin; i < end; ++i)
+            {
+              // linearize dot_N_m = a + b * (N_m-N_m_0)
+              derivatives(N_m[i], J_2[i], T[i], a, f);
+              const double b = derivative2_N_m_N_m(N_m[i], J_2[i], T[i]);
 
-          // integrate analytically, assuming constant stresses
-          const double d_N_m = dx_analytical(a, b, dt);
+              // integrate analytically, assuming constant stresses
+              const double d_N_m = dx_analytical(a, b, dt);
 
-          // update N_m
-          N_m[i] += d_N_m;
+              // update N_m
+              N_m[i] += d_N_m;
 
-          // update strains
-          for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-            epsilon_c.block(j)[i] +=
-              derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt;
-        }
+              // update strains
+              derivatives(N_m[i], J_2[i], T[i], a, f);
+              for (unsigned int j = 0; j < n_blocks; ++j)
+                epsilon_c.block(j)[i] += f * deviator(s, j, i) * dt;
+            }
+        },
+        grain_size);
 
       if (update_stress && n + 1 < n_sub)
         stress_solver.solve(true);
@@ -2364,7 +3427,7 @@ DislocationSolver<dim>::integrate_linearized_N_m_midpoint()
 
   const Vector<double> &     T   = get_temperature();
   const Vector<double> &     J_2 = get_stress_J_2();
-  const BlockVector<double> &S   = get_stress_deviator();
+  const BlockVector<double> &s   = get_stress();
 
   const unsigned int N  = N_m.size();
   const double       dt = get_time_step();
@@ -2374,51 +3437,169 @@ DislocationSolver<dim>::integrate_linearized_N_m_midpoint()
               ExcMessage("integrate_linearized_N_m_midpoint: n_sub=" +
                          std::to_string(n_sub) + " is not supported"));
 
-  // save values at the beginning of time step
-  const Vector<double>      N_m_0       = N_m;
-  const BlockVector<double> epsilon_c_0 = epsilon_c;
+  // values at the beginning of time step, saved in solve()
+  const Vector<double> &     N_m_0       = dislocation_density_0;
+  const BlockVector<double> &epsilon_c_0 = strain_c_0;
 
   recalculate_stress_before();
 
-  // first, take a half step
-  for (unsigned int i = 0; i < N; ++i)
+  const unsigned int n_blocks = epsilon_c.n_blocks();
+
+  const bool embedded = use_error_control();
+  if (embedded)
     {
-      // update strains
-      for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-        epsilon_c.block(j)[i] +=
-          derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt / 2;
+      dislocation_density_low.reinit(N);
+      strain_c_low.reinit(epsilon_c);
+    }
 
-      // linearize dot_N_m = a + b * (N_m-N_m_0)
-      const double a = derivative_N_m(N_m[i], J_2[i], T[i]);
-      const double b = derivative2_N_m_N_m(N_m[i], J_2[i], T[i]);
+  // first, take a half step
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      double a, f;
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          // linearize dot_N_m = a + b * (N_m-N_m_0)
+          derivatives(N_m[i], J_2[i], T[i], a, f);
+          const double b = derivative2_N_m_N_m(N_m[i], J_2[i], T[i]);
 
-      // integrate analytically, assuming constant stresses
-      N_m[i] += dx_analytical(a, b, dt / 2);
-    }
+          if (embedded)
+            {
+              // embedded full step with the initial stresses
+              for (unsigned int j = 0; j < n_blocks; ++j)
+                strain_c_low.block(j)[i] =
+                  epsilon_c_0.block(j)[i] + f * deviator(s, j, i) * dt;
+
+              dislocation_density_low[i] = N_m_0[i] + dx_analytical(a, b, dt);
+            }
+
+          // update strains
+          for (unsigned int j = 0; j < n_blocks; ++j)
+            epsilon_c.block(j)[i] += f * deviator(s, j, i) * dt / 2;
+
+          // integrate analytically, assuming constant stresses
+          N_m[i] += dx_analytical(a, b, dt / 2);
+        }
+    },
+    grain_size);
 
   // recalculate stresses
   stress_solver.solve();
 
   // now, take a full step with derivatives evaluated at the midpoint
-  for (unsigned int i = 0; i < N; ++i)
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      double a, f;
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          // update strains
+          derivatives(N_m[i], J_2[i], T[i], a, f);
+          for (unsigned int j = 0; j < n_blocks; ++j)
+            epsilon_c.block(j)[i] =
+              epsilon_c_0.block(j)[i] + f * deviator(s, j, i) * dt;
+
+          // linearize dot_N_m = a + b * (N_m-N_m_0)
+          derivatives(N_m_0[i], J_2[i], T[i], a, f);
+          const double b = derivative2_N_m_N_m(N_m_0[i], J_2[i], T[i]);
+
+          // update N_m
+          N_m[i] = N_m_0[i] + dx_analytical(a, b, dt);
+        }
+    },
+    grain_size);
+
+  recalculate_stress_after();
+}
+
+template <int dim>
+bool
+DislocationSolver<dim>::integrate_device()
+{
+#ifdef MACPLAS_WITH_KOKKOS
+  const Vector<double> &T = get_temperature();
+
+  const DeviceDislocationKernel dislocation_kernel = get_device_kernel();
+  const DeviceStressKernel<StressSolver<dim>::n_components> stress_kernel =
+    stress_solver.get_device_kernel();
+
+  // the device tables are clamped, the host evaluates the functions exactly
+  const auto T_range = minmax(T);
+  if (!dislocation_kernel.tables.contains(T_range.first, T_range.second) ||
+      !stress_kernel.tables.contains(T_range.first, T_range.second))
     {
-      // update strains
-      for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-        epsilon_c.block(j)[i] =
-          epsilon_c_0.block(j)[i] +
-          derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt;
-
-      // linearize dot_N_m = a + b * (N_m-N_m_0)
-      const double a = derivative_N_m(N_m_0[i], J_2[i], T[i]);
-      const double b = derivative2_N_m_N_m(N_m_0[i], J_2[i], T[i]);
-
-      // update N_m
-      N_m[i] = N_m_0[i] + dx_analytical(a, b, dt);
+      logger.warning() << solver_name() << "  T=" << T_range.first << ".."
+                       << T_range.second << " K is outside of the property "
+                       << "tables, integrating on the host\n";
+      return false;
     }
 
+  const unsigned int n_sub = get_time_substeps();
+  const double       dt    = get_time_step() / n_sub;
+
+  const bool update_stress = prm.get_bool("Refresh stress for substeps");
+
+  add_output("substeps", n_sub);
+
+  recalculate_stress_before();
+
+  device_integrator.upload(get_dislocation_density(),
+                           get_strain_c(),
+                           T,
+                           get_stress_J_2(),
+                           stress_solver.get_stress(),
+                           stress_solver.get_strain_e());
+  device_integrator.integrate(dislocation_kernel,
+                              stress_kernel,
+                              time_scheme == "Linearized N_m",
+                              dt,
+                              n_sub,
+                              update_stress);
+  device_integrator.download(get_dislocation_density(), get_strain_c());
+
+  // the refreshed stress is not copied, recalculate it if it is not done
+  // by recalculate_stress_after
+  if (update_stress && n_sub > 1 &&
+      prm.get("Stress recalculation strategy") == "before")
+    stress_solver.solve(true);
+
   recalculate_stress_after();
+
+  return true;
+#else
+  return false;
+#endif
 }
 
+#ifdef MACPLAS_WITH_KOKKOS
+template <int dim>
+DeviceDislocationKernel
+DislocationSolver<dim>::get_device_kernel() const
+{
+  DeviceDislocationKernel kernel;
+
+  kernel.tables.initialize({&m_Q_table, &m_D_table, &m_tau_crit_table},
+                           {1, 1, 1});
+
+  kernel.b   = m_b;
+  kernel.K   = m_K;
+  kernel.k_0 = m_k_0;
+  kernel.l   = m_l;
+  kernel.p   = m_p;
+  kernel.S   = m_S;
+  kernel.F   = m_F;
+  kernel.k_B = m_k_B;
+
+  // constant, checked in initialize_parameters
+  kernel.dQ              = m_dQ.value(Point<1>());
+  kernel.with_tau_crit_l = dot_N_m_with_tau_crit_l;
+
+  return kernel;
+}
+#endif
+
 template <int dim>
 void
 DislocationSolver<dim>::integrate_implicit()
@@ -2428,19 +3609,18 @@ DislocationSolver<dim>::integrate_implicit()
 
   const Vector<double> &     T   = get_temperature();
   const Vector<double> &     J_2 = get_stress_J_2();
-  const BlockVector<double> &S   = get_stress_deviator();
+  const BlockVector<double> &s   = get_stress();
 
-  const unsigned int N  = N_m.size();
-  const double       dt = get_time_step();
+  const double dt = get_time_step();
 
   const unsigned int n_sub = get_time_substeps();
   AssertThrow(n_sub == 1,
               ExcMessage("integrate_implicit: n_sub=" + std::to_string(n_sub) +
                          " is not supported"));
 
-  // save values at the beginning of time step
-  const Vector<double>      N_m_0       = N_m;
-  const BlockVector<double> epsilon_c_0 = epsilon_c;
+  // values at the beginning of time step, saved in solve()
+  const Vector<double> &     N_m_0       = dislocation_density_0;
+  const BlockVector<double> &epsilon_c_0 = strain_c_0;
 
   recalculate_stress_before();
 
@@ -2449,28 +3629,376 @@ DislocationSolver<dim>::integrate_implicit()
     Utilities::split_string_list(time_scheme, ' ');
   const unsigned int n_iterations = tmp.size() > 1 ? std::stoul(tmp.back()) : 1;
 
+  Vector<double>      dot_N_m;
+  BlockVector<double> dot_epsilon_c;
+
   for (unsigned int k = 0; k <= n_iterations; ++k)
     {
       // k=0: initial approximation (forward Euler)
 
-      std::cout << solver_name() << "  "
-                << "Fixed point iteration " << k << " of " << n_iterations
-                << "\n";
+      if (logger.is_enabled(Logger::Detail))
+        logger.detail() << solver_name() << "  "
+                        << "Fixed point iteration " << k << " of "
+                        << n_iterations << "\n";
+
+      // update strains and N_m
+      derivatives(N_m, J_2, T, s, dot_N_m, dot_epsilon_c);
+      epsilon_c = epsilon_c_0;
+      epsilon_c.add(dt, dot_epsilon_c);
+      N_m = N_m_0;
+      N_m.add(dt, dot_N_m);
+
+      if (k == 0 && use_error_control())
+        {
+          // embedded forward Euler solution
+          dislocation_density_low = N_m;
+          strain_c_low            = epsilon_c;
+        }
+
+      stress_solver.solve();
+    }
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::integrate_Newton()
+{
+  Vector<double> &     N_m       = get_dislocation_density();
+  BlockVector<double> &epsilon_c = get_strain_c();
+
+  const Vector<double> &     T   = get_temperature();
+  const Vector<double> &     J_2 = get_stress_J_2();
+  const BlockVector<double> &s   = get_stress();
+
+  const double dt = get_time_step();
+
+  const unsigned int n_sub = get_time_substeps();
+  AssertThrow(n_sub == 1,
+              ExcMessage("integrate_Newton: n_sub=" + std::to_string(n_sub) +
+                         " is not supported"));
+
+  const double tol_N_m      = prm.get_double("Newton tolerance");
+  const double tol_strain_c = prm.get_double("Newton strain tolerance");
+  const double N_0          = prm.get_double("Initial dislocation density");
+
+  const unsigned int n_iterations_max =
+    prm.get_integer("Max Newton iterations");
+  const unsigned int n_krylov_max = prm.get_integer("Max Krylov iterations");
+  const double       krylov_tolerance = prm.get_double("Krylov tolerance");
+
+  const unsigned int max_line_search_steps = 8;
+
+  // shortest step allowed by the N_m >= 0 limit, N_m is clipped at zero
+  // instead of stalling the iteration at DOFs where N_m = 0
+  const double min_positivity_step = 1e-2;
+
+  const unsigned int n_components = StressSolver<dim>::n_components;
+  const unsigned int N            = N_m.size();
+
+  // values at the beginning of time step, saved in solve()
+  const Vector<double> &     N_m_0       = dislocation_density_0;
+  const BlockVector<double> &epsilon_c_0 = strain_c_0;
+
+  recalculate_stress_before();
+
+  // initial approximation (forward Euler)
+  Vector<double>      dot_N_m;
+  BlockVector<double> dot_epsilon_c;
+  derivatives(N_m, J_2, T, s, dot_N_m, dot_epsilon_c);
+  epsilon_c = epsilon_c_0;
+  epsilon_c.add(dt, dot_epsilon_c);
+  N_m = N_m_0;
+  N_m.add(dt, dot_N_m);
+
+  if (use_error_control())
+    {
+      // embedded forward Euler solution
+      dislocation_density_low = N_m;
+      strain_c_low            = epsilon_c;
+    }
+
+  stress_solver.solve();
+
+  // The unknowns N_m (block 0) and epsilon_c (blocks 1..n_components) are
+  // scaled by the tolerances, the iteration has converged if all scaled
+  // residuals are below 1
+  BlockVector<double> weights(n_components + 1, N);
+  for (unsigned int i = 0; i < N; ++i)
+    weights.block(0)[i] = tol_N_m * std::max(std::abs(N_m_0[i]), N_0);
+  for (unsigned int j = 0; j < n_components; ++j)
+    weights.block(j + 1) = tol_strain_c;
+
+  // unscaled current state
+  BlockVector<double> x(n_components + 1, N);
+
+  // set N_m and epsilon_c to x + h * weights * dx
+  const auto set_state = [&](const double h, const BlockVector<double> &dx) {
+    parallel::apply_to_subranges(
+      0U,
+      N,
+      [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+          {
+            N_m[i] = std::max(x.block(0)[i] +
+                                h * weights.block(0)[i] * dx.block(0)[i],
+                              0.0);
+            for (unsigned int j = 0; j < n_components; ++j)
+              epsilon_c.block(j)[i] =
+                x.block(j + 1)[i] +
+                h * weights.block(j + 1)[i] * dx.block(j + 1)[i];
+          }
+      },
+      grain_size);
+  };
+
+  BlockVector<double> residual, residual_trial, dx, rhs;
+  calculate_Newton_residual(weights, residual);
+  double residual_norm = residual.l2_norm();
+  double residual_max  = residual.linfty_norm();
+
+  // Jacobian-vector product by finite differences of the residual,
+  // the scaled state norm is updated at each Newton iteration
+  double x_norm = 0;
+
+  LinearOperator<BlockVector<double>> jacobian;
+  jacobian.vmult = [&](BlockVector<double> &      dst,
+                       const BlockVector<double> &src) {
+    const double src_norm = src.l2_norm();
+    if (src_norm == 0)
+      {
+        dst.reinit(src);
+        return;
+      }
+
+    const double h = std::sqrt(std::numeric_limits<double>::epsilon()) *
+                     (1 + x_norm) / src_norm;
+
+    set_state(h, src);
+    stress_solver.solve();
+    calculate_Newton_residual(weights, dst);
+    dst -= residual;
+    dst /= h;
+  };
+  jacobian.reinit_range_vector = [&](BlockVector<double> &v,
+                                     const bool           omit_zeroing) {
+    v.reinit(weights, omit_zeroing);
+  };
+  jacobian.reinit_domain_vector = jacobian.reinit_range_vector;
+
+  // Inverse of the local Jacobian at frozen stresses, which is lower block
+  // triangular: block 0 holds 1/(dR_N/dN_m), the other blocks dR_strain/dN_m
+  BlockVector<double> local_jacobian(n_components + 1, N);
+
+  LinearOperator<BlockVector<double>> preconditioner;
+  preconditioner.vmult = [&](BlockVector<double> &      dst,
+                             const BlockVector<double> &src) {
+    dst.reinit(src, true);
+    parallel::apply_to_subranges(
+      0U,
+      N,
+      [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+          {
+            dst.block(0)[i] = local_jacobian.block(0)[i] * src.block(0)[i];
+            for (unsigned int j = 1; j <= n_components; ++j)
+              dst.block(j)[i] =
+                src.block(j)[i] - local_jacobian.block(j)[i] * dst.block(0)[i];
+          }
+      },
+      grain_size);
+  };
+  preconditioner.reinit_range_vector  = jacobian.reinit_range_vector;
+  preconditioner.reinit_domain_vector = jacobian.reinit_range_vector;
+
+  unsigned int k         = 0;
+  bool         converged = false;
+  for (;; ++k)
+    {
+      if (logger.is_enabled(Logger::Detail))
+        logger.detail() << solver_name() << "  "
+                        << "Newton iteration " << k << ", residual "
+                        << residual_max << "\n";
+
+      if (!std::isfinite(residual_norm))
+        break;
 
+      if (residual_max <= 1)
+        {
+          converged = true;
+          break;
+        }
+
+      if (k >= n_iterations_max)
+        break;
+
+      x.block(0) = N_m;
+      for (unsigned int j = 0; j < n_components; ++j)
+        x.block(j + 1) = epsilon_c.block(j);
+
+      x_norm = 0;
+      for (unsigned int i = 0; i < x.size(); ++i)
+        x_norm += std::pow(x[i] / weights[i], 2);
+      x_norm = std::sqrt(x_norm);
+
+      parallel::apply_to_subranges(
+        0U,
+        N,
+        [&](const unsigned int begin, const unsigned int end) {
+          for (unsigned int i = begin; i < end; ++i)
+            {
+              double a, f;
+              derivatives(N_m[i], J_2[i], T[i], a, f);
+
+              const double dR_N =
+                1 - dt * derivative2_N_m_N_m(N_m[i], J_2[i], T[i]);
+              local_jacobian.block(0)[i] =
+                std::abs(dR_N) > 1e-12 ? 1 / dR_N : 1;
+
+              // df/dN_m, neglecting the dependence of Q on tau_eff as in
+              // derivative2_N_m_N_m
+              const double tau = tau_eff(N_m[i], J_2[i], T[i]);
+              const double df =
+                f == 0 || N_m[i] <= 0 || tau == 0 ?
+                  0 :
+                  f * (1 / N_m[i] + m_p / tau *
+                                      derivative_tau_eff_N_m(N_m[i],
+                                                             J_2[i],
+                                                             T[i]));
+
+              for (unsigned int j = 1; j <= n_components; ++j)
+                local_jacobian.block(j)[i] = -dt * df * deviator(s, j - 1, i) *
+                                             weights.block(0)[i] /
+                                             weights.block(j)[i];
+            }
+        },
+        grain_size);
+
+      // inexact Newton step
+      rhs = residual;
+      rhs *= -1;
+      dx.reinit(residual);
+
+      SolverControl control(n_krylov_max,
+                            krylov_tolerance * residual_norm,
+                            false,
+                            false);
+      SolverGMRES<BlockVector<double>> solver(
+        control,
+        SolverGMRES<BlockVector<double>>::AdditionalData(
+          n_krylov_max + 2, true));
+
+      try
+        {
+          solver.solve(jacobian, dx, rhs, preconditioner);
+        }
+      catch (SolverControl::NoConvergence &)
+        {
+          // continue with the last Krylov iterate
+        }
+      profiler->add_count("dislocation/Krylov iterations", control.last_step());
+
+      // keep N_m non-negative, the DOFs which would limit the step below
+      // min_positivity_step are clipped at zero by set_state
+      double lambda = 1;
       for (unsigned int i = 0; i < N; ++i)
         {
-          // update strains
-          for (unsigned int j = 0; j < epsilon_c.n_blocks(); ++j)
-            epsilon_c.block(j)[i] =
-              epsilon_c_0.block(j)[i] +
-              derivative_strain(N_m[i], J_2[i], T[i], S.block(j)[i]) * dt;
+          const double d = weights.block(0)[i] * dx.block(0)[i];
+          if (x.block(0)[i] + lambda * d < 0)
+            lambda =
+              std::max(0.9 * x.block(0)[i] / -d, min_positivity_step);
+        }
 
-          // update N_m
-          N_m[i] = N_m_0[i] + derivative_N_m(N_m[i], J_2[i], T[i]) * dt;
+      // backtracking line search with the Armijo condition
+      bool descent = false;
+      for (unsigned int l = 0; l <= max_line_search_steps; ++l)
+        {
+          set_state(lambda, dx);
+          stress_solver.solve();
+          calculate_Newton_residual(weights, residual_trial);
+
+          const double r = residual_trial.l2_norm();
+          if (r <= (1 - 1e-4 * lambda) * residual_norm)
+            {
+              residual.swap(residual_trial);
+              residual_norm = r;
+              residual_max  = residual.linfty_norm();
+              descent       = true;
+              break;
+            }
+
+          lambda /= 2;
         }
 
-      stress_solver.solve();
+      profiler->add_count("dislocation/Newton iterations");
+
+      if (!descent)
+        {
+          // no sufficient decrease even with the shortest step: keep the
+          // last iterate instead of accepting a larger residual
+          set_state(0, dx);
+          stress_solver.solve();
+
+          logger.warning() << solver_name()
+                           << "  Warning: Newton line search failed after "
+                           << max_line_search_steps << " steps, residual "
+                           << residual_max << "\n";
+          break;
+        }
     }
+
+  newton_converged = converged;
+
+  add_output("newton_iterations", k);
+  add_output("newton_residual", residual_max);
+
+  if (!converged && std::isfinite(residual_norm))
+    logger.warning() << solver_name() << "  Warning: Newton iteration did not "
+                     << "converge, residual " << residual_max << "\n";
+}
+
+template <int dim>
+void
+DislocationSolver<dim>::calculate_Newton_residual(
+  const BlockVector<double> &weights,
+  BlockVector<double> &      residual) const
+{
+  const Vector<double> &     N_m       = get_dislocation_density();
+  const BlockVector<double> &epsilon_c = get_strain_c();
+
+  const Vector<double> &     T   = get_temperature();
+  const Vector<double> &     J_2 = get_stress_J_2();
+  const BlockVector<double> &s   = get_stress();
+
+  const Vector<double> &     N_m_0       = dislocation_density_0;
+  const BlockVector<double> &epsilon_c_0 = strain_c_0;
+
+  const double dt = get_time_step();
+
+  const unsigned int n_components = StressSolver<dim>::n_components;
+  const unsigned int N            = N_m.size();
+
+  residual.reinit(weights, true);
+
+  parallel::apply_to_subranges(
+    0U,
+    N,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          double a, f;
+          derivatives(N_m[i], J_2[i], T[i], a, f);
+
+          residual.block(0)[i] =
+            (N_m[i] - N_m_0[i] - dt * a) / weights.block(0)[i];
+
+          for (unsigned int j = 0; j < n_components; ++j)
+            residual.block(j + 1)[i] =
+              (epsilon_c.block(j)[i] - epsilon_c_0.block(j)[i] -
+               dt * f * deviator(s, j, i)) /
+              weights.block(j + 1)[i];
+        }
+    },
+    grain_size);
 }
 
 template <int dim>
@@ -2515,4 +4043,12 @@ DislocationSolver<dim>::output_name_suffix() const
   return ss.str();
 }
 
+template <int dim>
+std::string
+DislocationSolver<dim>::checkpoint_base_name() const
+{
+  return "checkpoint-dislocation-" + std::to_string(dim) + "d-order" +
+         std::to_string(get_degree());
+}
+
 #endif
@@ -0,0 +1,434 @@
+#ifndef macplas_ensemble_h
+#define macplas_ensemble_h
+
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parameter_handler.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/base/utilities.h>
+
+#if DEAL_II_VERSION_GTE(9, 4, 0) && defined(DEAL_II_WITH_TBB)
+#  include <tbb/task_arena.h>
+#  define MACPLAS_ENSEMBLE_TASK_ARENA
+#endif
+
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utilities.h"
+
+using namespace dealii;
+
+/** Parameter values of a single run of a parameter sweep
+ */
+struct ParameterVariant
+{
+  /** Name of the run, e.g. for the aggregated probe table
+   */
+  std::string name;
+
+  /** Parameter values, map key: \c "<prefix>:<entry>", where the prefix
+   * identifies the parameter handler (e.g. \c stress for \c stress.prm) and
+   * the entries in subsections are given as \c "Subsection/Entry"
+   */
+  std::map<std::string, std::string> values;
+};
+
+/** Read parameter variants from a tab-separated file. The header line
+ * contains \c name and the parameter keys (see ParameterVariant::values),
+ * each following line the name and the parameter values of one run.
+ * Lines starting with \c # are ignored.
+ */
+inline std::vector<ParameterVariant>
+read_parameter_variants(const std::string &file_name);
+
+/** Set parameter \c entry (subsections separated by \c /) to \c value
+ */
+inline void
+set_parameter(ParameterHandler & prm,
+              const std::string &entry,
+              const std::string &value);
+
+/** Set the parameters of \c variant in the corresponding parameter handlers,
+ * map key: prefix. Throws an exception if a prefix is unknown.
+ */
+inline void
+apply_parameter_variant(
+  const ParameterVariant &                         variant,
+  const std::map<std::string, ParameterHandler *> &handlers);
+
+/** Table of probe values of all runs of a parameter sweep written as a single
+ * tab-separated file. The first column contains the run name, the other
+ * columns are collected from all rows in the order of their first
+ * appearance, missing values are left empty. Rows can be added concurrently
+ * from several runs.
+ */
+class EnsembleTable
+{
+public:
+  /** Add a row of run \c run with the given column names and values
+   */
+  inline void
+  add_row(const std::string &             run,
+          const std::vector<std::string> &names,
+          const std::vector<double> &     values);
+
+  /** Number of rows
+   */
+  inline unsigned int
+  n_rows() const;
+
+  /** Write the table to disk
+   */
+  inline void
+  write(const std::string &file_name, const int precision = 8) const;
+
+private:
+  /** Row of the table: run name and values with column indices
+   */
+  struct Row
+  {
+    std::string                                  run;
+    std::vector<std::pair<unsigned int, double>> values;
+  };
+
+  /** Synchronization of \c add_row
+   */
+  mutable std::mutex mutex;
+
+  /** Column names
+   */
+  std::vector<std::string> columns;
+
+  /** Column indices, map key: column name
+   */
+  std::map<std::string, unsigned int> column_indices;
+
+  /** All rows in the order of addition
+   */
+  std::vector<Row> rows;
+};
+
+/** Runner of parameter sweeps, executes the runs of all variants
+ * concurrently on a pool of threads.
+ *
+ * The setup function creates the simulation of a variant, e.g. solvers with
+ * a copy of a shared mesh and modified parameters, and returns the function
+ * performing the run. The setup functions are called one at a time since
+ * the solver constructors read and write parameter files, the runs
+ * themselves are concurrent. Structures which depend on the mesh only can
+ * be shared in the setup, e.g. by StressSolver::share_sparsity_pattern.
+ * Files written by the runs, e.g. profiling reports, need names containing
+ * the run name. An exception in a run is logged and the remaining runs are
+ * continued.
+ *
+ * The global thread limit is fixed by ThreadLimit::fix before the runs
+ * start, the \c "Number of threads" parameters of the solvers are ignored.
+ * The thread budget is divided by the number of concurrent runs: with TBB
+ * (deal.II 9.4 or newer), each run executes its parallel tasks in a separate
+ * \c tbb::task_arena of this size, otherwise all runs share the global limit.
+ */
+class EnsembleRunner
+{
+public:
+  /** Function performing one run
+   */
+  using RunFunction = std::function<void()>;
+
+  /** Function creating the run of the given variant
+   */
+  using SetupFunction = std::function<RunFunction(const ParameterVariant &)>;
+
+  /** Constructor, \c n_concurrent runs are executed at a time (0 - number
+   * of cores) using \c n_threads threads in total (0 - number of cores)
+   */
+  inline explicit EnsembleRunner(const unsigned int n_concurrent = 0,
+                                 const unsigned int n_threads    = 0);
+
+  /** Set up and execute the runs of all \c variants
+   * @returns names of the failed runs
+   */
+  inline std::vector<std::string>
+  run(const std::vector<ParameterVariant> &variants,
+      const SetupFunction &                setup) const;
+
+private:
+  /** Number of concurrent runs (0 - number of cores)
+   */
+  unsigned int n_concurrent;
+
+  /** Total number of threads (0 - number of cores)
+   */
+  unsigned int n_threads;
+};
+
+
+// IMPLEMENTATION
+
+std::vector<ParameterVariant>
+read_parameter_variants(const std::string &file_name)
+{
+  std::ifstream in(file_name);
+  AssertThrow(in.good(), ExcFileNotOpen(file_name));
+
+  std::vector<ParameterVariant> variants;
+  std::vector<std::string>      keys;
+
+  std::string line;
+  while (std::getline(in, line))
+    {
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      const std::vector<std::string> l = Utilities::split_string_list(line,
+                                                                      '\t');
+
+      if (keys.empty())
+        {
+          AssertThrow(l.size() >= 2 && l[0] == "name",
+                      ExcMessage("read_parameter_variants: '" + file_name +
+                                 "' has no header 'name<TAB>parameters'"));
+          keys.assign(l.begin() + 1, l.end());
+          continue;
+        }
+
+      AssertThrow(l.size() == keys.size() + 1,
+                  ExcMessage("read_parameter_variants: '" + file_name +
+                             "' has " + std::to_string(l.size()) +
+                             " columns instead of " +
+                             std::to_string(keys.size() + 1) + " in row " +
+                             std::to_string(variants.size() + 1)));
+
+      ParameterVariant variant;
+      variant.name = l[0];
+      for (unsigned int i = 0; i < keys.size(); ++i)
+        variant.values[keys[i]] = l[i + 1];
+
+      variants.push_back(variant);
+    }
+
+  return variants;
+}
+
+void
+set_parameter(ParameterHandler & prm,
+              const std::string &entry,
+              const std::string &value)
+{
+  const std::vector<std::string> path =
+    Utilities::split_string_list(entry, '/');
+
+  AssertThrow(!path.empty(),
+              ExcMessage("set_parameter: empty parameter name"));
+
+  for (unsigned int i = 0; i + 1 < path.size(); ++i)
+    prm.enter_subsection(path[i]);
+
+  prm.set(path.back(), value);
+
+  for (unsigned int i = 0; i + 1 < path.size(); ++i)
+    prm.leave_subsection();
+}
+
+void
+apply_parameter_variant(
+  const ParameterVariant &                         variant,
+  const std::map<std::string, ParameterHandler *> &handlers)
+{
+  for (const auto &it : variant.values)
+    {
+      const auto pos = it.first.find(':');
+      AssertThrow(pos != std::string::npos,
+                  ExcMessage("apply_parameter_variant: parameter '" +
+                             it.first + "' has no prefix"));
+
+      const auto prm = handlers.find(it.first.substr(0, pos));
+      AssertThrow(prm != handlers.end(),
+                  ExcMessage("apply_parameter_variant: unknown prefix of "
+                             "parameter '" +
+                             it.first + "'"));
+
+      set_parameter(*prm->second, it.first.substr(pos + 1), it.second);
+    }
+}
+
+// EnsembleTable
+
+void
+EnsembleTable::add_row(const std::string &             run,
+                       const std::vector<std::string> &names,
+                       const std::vector<double> &     values)
+{
+  AssertDimension(names.size(), values.size());
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  Row row;
+  row.run = run;
+  row.values.reserve(values.size());
+
+  for (unsigned int i = 0; i < names.size(); ++i)
+    {
+      const auto it = column_indices.find(names[i]);
+
+      unsigned int k;
+      if (it == column_indices.end())
+        {
+          k = columns.size();
+          columns.push_back(names[i]);
+          column_indices[names[i]] = k;
+        }
+      else
+        k = it->second;
+
+      row.values.emplace_back(k, values[i]);
+    }
+
+  rows.push_back(std::move(row));
+}
+
+unsigned int
+EnsembleTable::n_rows() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return rows.size();
+}
+
+void
+EnsembleTable::write(const std::string &file_name, const int precision) const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::ofstream output(file_name);
+  output << std::setprecision(precision);
+
+  output << "run";
+  for (const auto &c : columns)
+    output << '\t' << c;
+  output << '\n';
+
+  std::vector<std::string> cells;
+  for (const auto &row : rows)
+    {
+      cells.assign(columns.size(), "");
+      for (const auto &v : row.values)
+        {
+          std::stringstream ss;
+          ss << std::setprecision(precision) << v.second;
+          cells[v.first] = ss.str();
+        }
+
+      output << row.run;
+      for (const auto &c : cells)
+        output << '\t' << c;
+      output << '\n';
+    }
+
+  AssertThrow(output.good(), ExcIO());
+}
+
+// EnsembleRunner
+
+EnsembleRunner::EnsembleRunner(const unsigned int n_concurrent,
+                               const unsigned int n_threads)
+  : n_concurrent(n_concurrent)
+  , n_threads(n_threads)
+{}
+
+std::vector<std::string>
+EnsembleRunner::run(const std::vector<ParameterVariant> &variants,
+                    const SetupFunction &                setup) const
+{
+  Timer timer;
+
+  const unsigned int n_variants = variants.size();
+  const unsigned int n_runs =
+    std::min(n_concurrent > 0 ? n_concurrent : MultithreadInfo::n_cores(),
+             n_variants);
+  const unsigned int n_threads_total =
+    n_threads > 0 ? n_threads : MultithreadInfo::n_cores();
+  const unsigned int n_threads_run =
+    std::max(1u, n_threads_total / std::max(1u, n_runs));
+
+  // set once, the solvers of the runs must not change the global limit
+  const bool was_fixed = ThreadLimit::is_fixed();
+  if (!was_fixed)
+    ThreadLimit::fix(n_threads_total);
+
+  // the default logger is separate for each thread, no locking needed
+  std::mutex setup_mutex;
+
+  Logger::get_default().info()
+    << "MACPLAS:Ensemble  Running " << n_variants << " variants, " << n_runs
+    << " at a time, " << n_threads_run << " threads per run\n";
+
+  std::atomic<unsigned int> next_variant(0);
+  std::vector<char>         failed(n_variants, 0);
+
+  const auto worker = [&]() {
+    for (unsigned int i = next_variant++; i < n_variants; i = next_variant++)
+      {
+        const ParameterVariant &variant = variants[i];
+
+        try
+          {
+            RunFunction run_variant;
+            {
+              std::lock_guard<std::mutex> lock(setup_mutex);
+              run_variant = setup(variant);
+            }
+
+#ifdef MACPLAS_ENSEMBLE_TASK_ARENA
+            tbb::task_arena arena(n_threads_run);
+            arena.execute(run_variant);
+#else
+            run_variant();
+#endif
+
+            Logger::get_default().info()
+              << "MACPLAS:Ensemble  Finished run '" << variant.name << "' ("
+              << i + 1 << "/" << n_variants << ")\n";
+          }
+        catch (std::exception &e)
+          {
+            failed[i] = 1;
+
+            Logger::get_default().error()
+              << "MACPLAS:Ensemble  Run '" << variant.name
+              << "' failed: " << e.what() << "\n";
+          }
+      }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int k = 0; k < n_runs; ++k)
+    threads.emplace_back(worker);
+  for (auto &t : threads)
+    t.join();
+
+  if (!was_fixed)
+    ThreadLimit::release();
+
+  std::vector<std::string> failed_names;
+  for (unsigned int i = 0; i < n_variants; ++i)
+    {
+      if (failed[i])
+        failed_names.push_back(variants[i].name);
+    }
+
+  Logger::get_default().info()
+    << "MACPLAS:Ensemble  " << n_variants - failed_names.size() << "/"
+    << n_variants << " runs finished " << format_time(timer) << "\n";
+
+  return failed_names;
+}
+
+#endif
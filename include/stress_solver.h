@@ -21,15 +21,21 @@
 #include <deal.II/lac/block_sparse_matrix.h>
 #include <deal.II/lac/block_sparsity_pattern.h>
 #include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/precondition.h>
 #include <deal.II/lac/precondition_selector.h>
+#include <deal.II/lac/solver_richardson.h>
 #include <deal.II/lac/solver_selector.h>
 #include <deal.II/lac/sparse_direct.h>
+#ifdef DEAL_II_WITH_TRILINOS
+#  include <deal.II/lac/trilinos_precondition.h>
+#endif
 #include <deal.II/lac/vector.h>
 
 #include <deal.II/numerics/data_out.h>
 #include <deal.II/numerics/matrix_tools.h>
 #include <deal.II/numerics/vector_tools.h>
 
+#include "device_kernels.h"
 #include "utilities.h"
 
 using namespace dealii;
@@ -113,13 +119,18 @@ public:
   get_stress() const;
 
   /** Get stress deviator \f$S_{ij} =
-   * \sigma_{ij} - \frac{1}{3} \delta_{ij} \sigma_{kk}\f$, Pa
+   * \sigma_{ij} - \frac{1}{3} \delta_{ij} \sigma_{kk}\f$, Pa. Calculated on
+   * demand if \c "Low memory" is set, see get_stress_hydrostatic.
    */
   const BlockVector<double> &
   get_stress_deviator() const;
 
   /** Get mean (hydrostatic) stress \f$\sigma_\mathrm{ave} =
-   * \frac{1}{3} \sigma_{kk}\f$, Pa
+   * \frac{1}{3} \sigma_{kk}\f$, Pa. Calculated on demand if
+   * \c "Low memory" is set. Despite being \c const, the first call after
+   * StressSolver::solve then fills the mutable \c stress_hydrostatic and
+   * \c stress_von_Mises vectors, so it must not be called concurrently
+   * with itself or with StressSolver::output_vtk.
    */
   const Vector<double> &
   get_stress_hydrostatic() const;
@@ -166,6 +177,18 @@ public:
   ParameterHandler &
   get_parameters();
 
+  /** Get profiler, shared with other solvers by set_profiler
+   */
+  std::shared_ptr<Profiler>
+  get_profiler() const;
+
+  /** Use \c profiler for performance measurements, e.g. to share a single
+   * report between several solvers. The report is set once by the solver
+   * which created \c profiler (its "Profiling report" parameter)
+   */
+  void
+  set_profiler(const std::shared_ptr<Profiler> &profiler);
+
   /** Initialize DOF handler and fields
    */
   void
@@ -186,6 +209,37 @@ public:
   const DoFHandler<dim> &
   get_dof_handler() const;
 
+  /** Get hanging node constraints of the DOFs for temperature
+   */
+  const HangingNodeConstraints &
+  get_hanging_node_constraints() const;
+
+  /** Prepare the transfer of the temperature, displacement and creep strain
+   * to the adapted mesh. Call after flagging the cells and before
+   * \c Triangulation::execute_coarsening_and_refinement.
+   */
+  void
+  prepare_for_refinement();
+
+  /** Distribute DOFs on the adapted mesh, interpolate the fields and rebuild
+   * the hanging node constraints, sparsity pattern and matrix at the next
+   * solve. The stresses are reset and have to be recalculated by \c solve.
+   * Boundary conditions set by \c set_bc1_dof have to be set again.
+   */
+  void
+  finish_refinement();
+
+  /** Use the sparsity pattern of \c other, e.g. for the runs of a parameter
+   * sweep on copies of the same mesh. Both solvers have to be initialized
+   * with identical meshes and finite elements, the pattern of \c other is
+   * built first if necessary (only built if \c other is this solver). Call
+   * before \c other is solved concurrently, the shared pattern is only read
+   * afterwards. StressSolver::initialize and \c finish_refinement stop
+   * sharing.
+   */
+  void
+  share_sparsity_pattern(StressSolver<dim> &other);
+
   /** Set first-type boundary condition at a boundary
    */
   void
@@ -215,6 +269,21 @@ public:
   void
   output_data() const;
 
+  /** Save mesh, temperature, displacement and creep strain to a single
+   * checkpoint file \c "checkpoint-stress-<dim>d-order<order>-0.bin", the
+   * previous checkpoints are rotated
+   */
+  void
+  output_checkpoint() const;
+
+  /** Restore mesh and fields from the newest valid checkpoint, calls
+   * StressSolver::initialize. The stresses are recalculated by the next
+   * StressSolver::solve.
+   * @returns \c false if no valid checkpoint was found
+   */
+  bool
+  load_checkpoint();
+
   /** Save results to disk in \c vtk format
    */
   void
@@ -232,6 +301,12 @@ public:
                          const double       T2 = 1700,
                          const unsigned int n  = 30) const;
 
+  /** Write memory consumption of the fields, matrices and recovery
+   * operators to the log
+   */
+  void
+  log_memory_consumption() const;
+
   /** Number of distinct elements of the stress tensor (3D: 6, 2D: 4)
    */
   static const unsigned int n_components = 2 * dim;
@@ -241,6 +316,21 @@ public:
   const std::vector<std::string>
   stress_component_names() const;
 
+  /** Initialize all parameters. Called by the constructor, call again after
+   * modifying the parameters returned by \c get_parameters
+   */
+  void
+  initialize_parameters();
+
+#ifdef MACPLAS_WITH_KOKKOS
+  /** Copy the property tables to the device for the calculation of stress
+   * from strain by DeviceDislocationIntegrator. Throws an exception if the
+   * tables are disabled (\c "Number of points" < 2).
+   */
+  DeviceStressKernel<n_components>
+  get_device_kernel() const;
+#endif
+
 private:
   /** Method of calculation of the elastic matrix
    */
@@ -257,10 +347,11 @@ private:
   void
   initialize_elastic_parameters();
 
-  /** Initialize all parameters. Called by the constructor
+  /** Tabulate temperature functions. Called by
+   * StressSolver::initialize_parameters
    */
   void
-  initialize_parameters();
+  initialize_property_tables();
 
   /** Initialize data before calculation.
    * Called by StressSolver::solve.
@@ -268,6 +359,13 @@ private:
   void
   prepare_for_solve();
 
+  /** Renumber the DOFs, calculate the hanging node constraints, build the
+   * sparsity pattern unless it is shared and initialized, and initialize the
+   * system matrix. Does nothing if the matrix is already initialized.
+   */
+  void
+  initialize_sparsity_pattern();
+
   /** Assemble the system matrix and right-hand-side vector (multithreaded).
    * Called by StressSolver::solve.
    */
@@ -290,6 +388,9 @@ private:
 
     std::vector<double>              T_q;
     std::vector<std::vector<double>> epsilon_c_q;
+
+    std::vector<Tensor<1, n_components>> strain_phi;
+    std::vector<Tensor<1, n_components>> stress_phi;
   };
 
   /** Structure that holds local contributions
@@ -311,13 +412,23 @@ private:
    */
   typedef SynchronousIterators<IteratorTuple> IteratorPair;
 
-  /** Local assembly function
+  /** Local assembly function, specialized for the FE \c degree (0 - any
+   * degree) and the \c type of the elastic matrix (\c Cij - cubic symmetry,
+   * also used for \c Enu). Called via \c local_assemble
    */
+  template <int degree, ElasticMatrixType type>
   void
   local_assemble_system(const IteratorPair & cell_pair,
                         AssemblyScratchData &scratch_data,
                         AssemblyCopyData &   copy_data);
 
+  /** Select the specialization of StressSolver::local_assemble_system for
+   * the FE degree and \c Cij_type. Called by
+   * StressSolver::initialize_parameters
+   */
+  void
+  select_local_assemble_system();
+
   /** Copy local contributions to global
    */
   void
@@ -329,6 +440,32 @@ private:
   void
   solve_system();
 
+  /** Store the hash and the probe product of the factorized system matrix
+   * of the given type. Called by StressSolver::solve_system.
+   */
+  void
+  store_factorized_matrix(const std::string &type);
+
+  /** Calculate the relative change of the system matrix since the last
+   * factorization \f$\|A - A_0\|_F / \|A_0\|_F\f$, infinity if no
+   * factorization of the given type is stored. Zero if the hash of the matrix
+   * is unchanged, otherwise estimated as \f$\|(A - A_0) r\| / \|A_0 r\|\f$
+   * with the random-sign probe vector \f$r\f$
+   * (\f$E\|B r\|^2 = \|B\|_F^2\f$), without storing \f$A_0\f$.
+   */
+  double
+  calc_matrix_change(const std::string &type) const;
+
+  /** Fill \c r with the random signs of the probe vector
+   */
+  void
+  get_probe_vector(BlockVector<double> &r) const;
+
+  /** Hash of the system matrix (sparsity pattern and values)
+   */
+  std::uint64_t
+  calc_matrix_hash() const;
+
   /** Calculate the second-order elastic constant (stiffness) \f$C_{11} =
    * E (1 - \nu) / ((1 + \nu) (1 - 2 \nu))\f$, Pa
    */
@@ -352,17 +489,28 @@ private:
   double
   calc_H(const double T) const;
 
+  /** Prepare the operators of stress recovery \c method: the projection
+   * from quadrature points and the number of cells sharing each DOF, the
+   * factorized or preconditioned mass matrix or the lumped mass matrix.
+   * The operators are reused while the mesh and the parameters of stress
+   * recovery are unchanged. Called by StressSolver::calculate_stress.
+   */
+  void
+  initialize_recovery(const std::string &method);
+
   /** Recover strain at DOFs via extrapolation from quadrature points.
    * Called by StressSolver::calculate_stress.
    */
   void
   recover_strain_extrapolation();
 
-  /** Recover strain at DOFs via global projection.
-   * Called by StressSolver::calculate_stress.
+  /** Recover strain at DOFs via global projection, with the consistent or
+   * \c lumped mass matrix. The components are solved concurrently by the
+   * iterative solvers and sequentially by \c UMFPACK, whose factorization is
+   * shared. Called by StressSolver::calculate_stress.
    */
   void
-  recover_strain_global();
+  recover_strain_global(const bool lumped = false);
 
   /** Calculate stress from the displacement field.
    * Called by StressSolver::solve.
@@ -370,17 +518,22 @@ private:
   void
   calculate_stress(const bool skip_recovery = false);
 
-  /** Helper function to calculate stress from strain.
+  /** Helper function to calculate stress from strain, its invariants and
+   * deviator in a single multithreaded pass over the DOFs. Pointwise
+   * refreshes during the time substeps of DislocationSolver can run on the
+   * device instead, see DeviceStressKernel. The hydrostatic and von Mises
+   * stresses and the deviator are not stored if \c "Low memory" is set.
    * Called by StressSolver::calculate_stress.
    */
   void
   calculate_stress_from_strain();
 
-  /** Helper function to calculate stress invariants.
-   * Called by StressSolver::calculate_stress.
+  /** Calculate the hydrostatic and von Mises stresses and the stress
+   * deviator from \c stress and \c stress_J_2 if they are not stored
+   * (\c "Low memory"). Modifies the mutable vectors, not thread-safe.
    */
   void
-  calculate_stress_invariants();
+  update_stress_invariants() const;
 
   /** Get stiffness tensor
    */
@@ -414,6 +567,12 @@ private:
   std::string
   output_name_suffix() const;
 
+  /** Helper method for creating checkpoint file name.
+   * @returns \c "checkpoint-stress-<dim>d-order<order>"
+   */
+  std::string
+  checkpoint_base_name() const;
+
   /** Mesh
    */
   Triangulation<dim> triangulation;
@@ -442,13 +601,30 @@ private:
    */
   BlockVector<double> displacement;
 
+  /** Hanging node constraints of \c dh_temp, empty without local refinement
+   */
+  HangingNodeConstraints hanging_node_constraints_temp;
+
+  /** Hanging node constraints of \c dh, empty without local refinement
+   */
+  HangingNodeConstraints hanging_node_constraints;
+
+  /** Transfer of the fields at \c dh_temp to the adapted mesh
+   */
+  FieldTransfer<dim> field_transfer_temp;
+
+  /** Transfer of the displacement to the adapted mesh
+   */
+  FieldTransfer<dim> field_transfer;
+
   /** Stress \f$\sigma_{ij}\f$, Pa
    */
   BlockVector<double> stress;
 
-  /** Stress deviator \f$S_{ij}\f$, Pa
+  /** Stress deviator \f$S_{ij}\f$, Pa. Empty until requested if
+   * \c "Low memory" is set
    */
-  BlockVector<double> stress_deviator;
+  mutable BlockVector<double> stress_deviator;
 
   /** Elastic strain \f$\varepsilon^e_{ij}\f$, dimensionless
    */
@@ -459,22 +635,31 @@ private:
   BlockVector<double> strain_c;
 
   /** Mean (hydrostatic) stress \f$\sigma_\mathrm{ave} =
-   * \frac{1}{3} \sigma_{kk}\f$, Pa
+   * \frac{1}{3} \sigma_{kk}\f$, Pa. Empty until requested if
+   * \c "Low memory" is set
    */
-  Vector<double> stress_hydrostatic;
+  mutable Vector<double> stress_hydrostatic;
 
   /** von Mises stress \f$\sigma_\mathrm{vM} =
-   * \sqrt{3 J_2}\f$, Pa
+   * \sqrt{3 J_2}\f$, Pa. Empty until requested if \c "Low memory" is set
    */
-  Vector<double> stress_von_Mises;
+  mutable Vector<double> stress_von_Mises;
 
   /** Second invariant of deviatoric stress \f$J_2\f$, Pa
    */
   Vector<double> stress_J_2;
 
-  /** Sparsity pattern
+  /** Local assembly function selected by
+   * StressSolver::select_local_assemble_system
+   */
+  void (StressSolver<dim>::*local_assemble)(const IteratorPair &,
+                                            AssemblyScratchData &,
+                                            AssemblyCopyData &);
+
+  /** Sparsity pattern, possibly shared with other solvers by
+   * StressSolver::share_sparsity_pattern
    */
-  BlockSparsityPattern sparsity_pattern;
+  std::shared_ptr<BlockSparsityPattern> sparsity_pattern;
 
   /** System matrix
    */
@@ -484,10 +669,91 @@ private:
    */
   BlockVector<double> system_rhs;
 
+  /** Hash of the system matrix at the time of the last factorization,
+   * stored only if factorization reuse is enabled
+   */
+  std::uint64_t factorized_hash = 0;
+
+  /** Product \f$A_0 r\f$ of the factorized system matrix with the probe
+   * vector, a single vector instead of a copy of the matrix
+   */
+  BlockVector<double> factorized_probe;
+
+  /** Type of the stored factorization ("UMFPACK", "block_amg" or empty)
+   */
+  std::string factorization_type;
+
+  /** LU factorization of the system matrix (reused if unchanged)
+   */
+  SparseDirectUMFPACK direct_solver;
+
+#ifdef DEAL_II_WITH_TRILINOS
+  /** AMG hierarchy of the system matrix (reused if unchanged)
+   */
+  BlockDiagonalPreconditioner<TrilinosWrappers::PreconditionAMG>
+    amg_preconditioner;
+#endif
+
+  /** Stress recovery method and parameters of the stored operators, empty
+   * if the operators have to be rebuilt
+   */
+  std::string recovery_key;
+
+  /** Mesh vertices at the time the recovery operators were built
+   */
+  std::vector<Point<dim>> recovery_vertices;
+
+  /** Projection from quadrature points to the DOFs of a cell (extrapolation)
+   */
+  FullMatrix<double> recovery_projection;
+
+  /** Inverse number of cells sharing each DOF (extrapolation) or inverse
+   * lumped mass matrix (lumped)
+   */
+  Vector<double> recovery_weights;
+
+  /** Sparsity pattern of the mass matrix (global)
+   */
+  SparsityPattern recovery_sparsity_pattern;
+
+  /** Mass matrix (global)
+   */
+  SparseMatrix<double> recovery_matrix;
+
+  /** LU factorization of \c recovery_matrix (global, UMFPACK)
+   */
+  SparseDirectUMFPACK recovery_direct_solver;
+
+  /** Preconditioner of \c recovery_matrix (global, iterative solvers)
+   */
+  std::unique_ptr<PreconditionSelector<>> recovery_preconditioner;
+
+  /** Minimal number of DoFs processed by one thread in pointwise
+   * calculations
+   */
+  constexpr static unsigned int grain_size = 256;
+
   /** Flag for checking simulation success
    */
   bool converged;
 
+  /** Writer for field output, keeps the time-series index
+   */
+  mutable DataOutWriter<dim> output_writer;
+
+  /** Writer of output files in a background thread. Declared after all data
+   * referenced by queued tasks, so it is destroyed (and flushed) first.
+   */
+  mutable BackgroundWriter background_writer;
+
+  /** Performance measurements
+   */
+  std::shared_ptr<Profiler> profiler;
+
+  /** Log output
+   */
+  mutable Logger logger;
+
   /** Data for first-type BC.
    * Map key: boundary id and component, value contains displacement.
    * This allows to apply BC to multiple components at the same boundary.
@@ -536,6 +802,30 @@ private:
    */
   FunctionParser<1> m_alpha;
 
+  /** Tabulated \c m_C_11
+   */
+  TabulatedFunction m_C_11_table;
+
+  /** Tabulated \c m_C_12
+   */
+  TabulatedFunction m_C_12_table;
+
+  /** Tabulated \c m_C_44
+   */
+  TabulatedFunction m_C_44_table;
+
+  /** Tabulated \c m_C_full, only the upper triangle is initialized
+   */
+  std::array<TabulatedFunction, n_components * n_components> m_C_full_table;
+
+  /** Tabulated \c m_E
+   */
+  TabulatedFunction m_E_table;
+
+  /** Tabulated \c m_alpha
+   */
+  TabulatedFunction m_alpha_table;
+
   /** Poisson's ratio \f$\nu\f$, dimensionless
    */
   double m_nu;
@@ -555,24 +845,29 @@ StressSolver<dim>::StressSolver(const unsigned int order,
   , dh_temp(triangulation)
   , fe(FE_Q<dim>(order), dim)
   , dh(triangulation)
+  , field_transfer_temp(dh_temp)
+  , field_transfer(dh)
+  , local_assemble(nullptr)
+  , sparsity_pattern(std::make_shared<BlockSparsityPattern>())
   , converged(false)
+  , profiler(std::make_shared<Profiler>())
   , Cij_type(ElasticMatrixType::Enu)
 {
-  std::cout << "Creating stress solver, order=" << order << ", dim=" << dim
-            << " ("
+  logger.info() << "Creating stress solver, order=" << order
+                << ", dim=" << dim << " ("
 #ifdef DEBUG
-               "Debug"
+                   "Debug"
 #else
-               "Release"
+                   "Release"
 #endif
-               ")\n";
+                   ")\n";
 
   AssertThrow(dim == 2 || dim == 3, ExcNotImplemented());
 
-  std::cout << "Stress components in Voigt notation:\n";
+  logger.info() << "Stress components in Voigt notation:\n";
   const auto names = stress_component_names();
   for (unsigned int i = 0; i < names.size(); ++i)
-    std::cout << i << " " << names[i] << "\n";
+    logger.info() << i << " " << names[i] << "\n";
 
   const std::string info_T = " (temperature function)";
 
@@ -623,9 +918,10 @@ StressSolver<dim>::StressSolver(const unsigned int order,
   {
     prm.declare_entry("Method",
                       "extrapolation",
-                      Patterns::Selection("extrapolation|global"),
+                      Patterns::Selection("extrapolation|global|lumped"),
                       "Method for stress postprocessing"
-                      " (extrapolation requires no additional parameters)");
+                      " (extrapolation requires no additional parameters,"
+                      " lumped - global with lumped mass matrix)");
 
     prm.declare_entry("Linear solver type",
                       "minres",
@@ -689,14 +985,41 @@ StressSolver<dim>::StressSolver(const unsigned int order,
 
   prm.declare_entry("Preconditioner type",
                     "jacobi",
-                    Patterns::Selection("none|jacobi"), // limited options
-                    "Name of preconditioner");
+                    Patterns::Selection("none|jacobi|block_ssor"
+#ifdef DEAL_II_WITH_TRILINOS
+                                        "|block_amg"
+#endif
+                                        ), // limited options
+                    "Name of preconditioner (block_*: block-diagonal)");
 
   prm.declare_entry("Preconditioner relaxation",
                     "1.0",
                     Patterns::Double(0),
                     "Relaxation factor of preconditioner");
 
+  prm.declare_entry("Preconditioner AMG threshold",
+                    "1e-4",
+                    Patterns::Double(0),
+                    "Aggregation threshold of AMG preconditioner");
+
+  prm.declare_entry("Preconditioner AMG sweeps",
+                    "2",
+                    Patterns::Integer(1),
+                    "Number of smoother sweeps of AMG preconditioner");
+
+  prm.declare_entry("Reuse factorization",
+                    "false",
+                    Patterns::Bool(),
+                    "Reuse LU factorization (UMFPACK) or AMG hierarchy while "
+                    "the system matrix does not change more than allowed");
+
+  prm.declare_entry("Reuse tolerance",
+                    "0",
+                    Patterns::Double(0),
+                    "Maximum relative change (Frobenius norm, estimated by a "
+                    "random probe vector) of the system matrix for reuse of "
+                    "factorization (0 - unchanged only)");
+
   prm.declare_entry("Log convergence full",
                     "false",
                     Patterns::Bool(),
@@ -720,7 +1043,8 @@ StressSolver<dim>::StressSolver(const unsigned int order,
   prm.declare_entry("Number of threads",
                     "0",
                     Patterns::Integer(0),
-                    "Maximum number of threads to be used (0 - autodetect)");
+                    "Maximum number of threads to be used (0 - autodetect, "
+                    "ignored if fixed, e.g. for ensemble runs)");
 
   prm.declare_entry("Output precision",
                     "8",
@@ -732,6 +1056,69 @@ StressSolver<dim>::StressSolver(const unsigned int order,
                     Patterns::Integer(0),
                     "Number of cell subdivisions for vtk output (0: order)");
 
+  prm.declare_entry("Output format",
+                    "vtk",
+                    Patterns::Selection(DataOutWriter<dim>::get_format_names()),
+                    "Format of field output (vtk - ASCII, vtu - compressed "
+                    "binary, hdf5 - HDF5 with XDMF index)");
+
+  prm.declare_entry("Output queue size",
+                    "0",
+                    Patterns::Integer(0),
+                    "Maximal number of output tasks queued for writing by a "
+                    "background thread (0 - write synchronously)");
+
+  prm.declare_entry("Number of checkpoints",
+                    "2",
+                    Patterns::Integer(1),
+                    "Number of rotated checkpoint files to keep");
+
+  prm.declare_entry("Low memory",
+                    "false",
+                    Patterns::Bool(),
+                    "Calculate the hydrostatic and von Mises stresses and the "
+                    "stress deviator on demand (for output) instead of "
+                    "storing them");
+
+  prm.declare_entry("Log level",
+                    "default",
+                    Patterns::Selection("default|" + Logger::get_level_names()),
+                    "Verbosity of the log output (default - value of the "
+                    "MACPLAS_LOG_LEVEL environment variable if set, detail "
+                    "otherwise)");
+
+  prm.declare_entry("Profiling report",
+                    "",
+                    Patterns::Anything(),
+                    "Base name of JSON and CSV performance reports written at "
+                    "exit (empty - no report)");
+
+  prm.declare_entry("Profiling per time step",
+                    "false",
+                    Patterns::Bool(),
+                    "Additionally report the times of all phases at each "
+                    "time step");
+
+  prm.enter_subsection("Property table");
+  {
+    prm.declare_entry("Number of points",
+                      "0",
+                      Patterns::Integer(0),
+                      "Number of points for tabulation of temperature functions"
+                      " (0 - disabled, exact evaluation)");
+
+    prm.declare_entry("Min temperature",
+                      "250",
+                      Patterns::Double(0),
+                      "Lower temperature bound of tabulation in K");
+
+    prm.declare_entry("Max temperature",
+                      "1700",
+                      Patterns::Double(0),
+                      "Upper temperature bound of tabulation in K");
+  }
+  prm.leave_subsection();
+
   if (use_default_prm)
     {
       std::ofstream of("stress.prm");
@@ -744,13 +1131,18 @@ StressSolver<dim>::StressSolver(const unsigned int order,
       }
     catch (std::exception &e)
       {
-        std::cout << e.what() << "\n";
+        logger.error() << e.what() << "\n";
 
         std::ofstream of("stress-default.prm");
         prm.print_parameters(of, ParameterHandler::Text);
       }
 
   initialize_parameters();
+
+  const std::string profiling_report = prm.get("Profiling report");
+  if (!profiling_report.empty())
+    profiler->set_report(profiling_report,
+                         prm.get_bool("Profiling per time step"));
 }
 
 template <int dim>
@@ -783,9 +1175,9 @@ StressSolver<dim>::initialize_elastic_parameters()
                         m_C_44_expression,
                         typename FunctionParser<1>::ConstMap());
 
-      std::cout << "C_11=" << m_C_11_expression << "\n"
-                << "C_12=" << m_C_12_expression << "\n"
-                << "C_44=" << m_C_44_expression << "\n";
+      logger.info() << "C_11=" << m_C_11_expression << "\n"
+                    << "C_12=" << m_C_12_expression << "\n"
+                    << "C_44=" << m_C_44_expression << "\n";
 
       return;
     }
@@ -794,7 +1186,7 @@ StressSolver<dim>::initialize_elastic_parameters()
   std::vector<std::string> Cij_split = Utilities::split_string_list(Cij_s, ',');
 
 #ifdef DEBUG
-  std::cout << Cij_split.size() << ' ' << m_C_full.size() << '\n';
+  logger.info() << Cij_split.size() << ' ' << m_C_full.size() << '\n';
 #endif
 
   const bool use_full_matix = Cij_split.size() == m_C_full.size();
@@ -814,11 +1206,11 @@ StressSolver<dim>::initialize_elastic_parameters()
               colum_widths[i]  = std::max(colum_widths[i], (int)Cij.size());
             }
 #ifdef DEBUG
-          std::cout << i << ' ' << colum_widths[i] << '\n';
+          logger.info() << i << ' ' << colum_widths[i] << '\n';
 #endif
         }
 
-      std::cout << "C_ij=\n";
+      logger.info() << "C_ij=\n";
       for (unsigned int j = 0; j < n_components; ++j)
         {
           for (unsigned int i = 0; i < n_components; ++i)
@@ -828,12 +1220,12 @@ StressSolver<dim>::initialize_elastic_parameters()
               if (Cij.empty())
                 Cij = "0";
 
-              std::cout << std::setw(colum_widths[i]) << Cij;
+              logger.info() << std::setw(colum_widths[i]) << Cij;
 
               if (i + 1 < n_components)
-                std::cout << ", ";
+                logger.info() << ", ";
               else
-                std::cout << '\n';
+                logger.info() << '\n';
             }
         }
 
@@ -859,17 +1251,52 @@ StressSolver<dim>::initialize_elastic_parameters()
       return;
     }
 
-  std::cout << "E=" << m_E_expression << "\n"
-            << "nu=" << m_nu << "\n";
+  logger.info() << "E=" << m_E_expression << "\n"
+                << "nu=" << m_nu << "\n";
+}
+
+template <int dim>
+void
+StressSolver<dim>::initialize_property_tables()
+{
+  prm.enter_subsection("Property table");
+  const unsigned int n_table = prm.get_integer("Number of points");
+  const double       T_min   = prm.get_double("Min temperature");
+  const double       T_max   = prm.get_double("Max temperature");
+  prm.leave_subsection();
+
+  m_E_table.initialize(m_E, T_min, T_max, n_table);
+  m_alpha_table.initialize(m_alpha, T_min, T_max, n_table);
+
+  if (Cij_type == ElasticMatrixType::Cij)
+    {
+      m_C_11_table.initialize(m_C_11, T_min, T_max, n_table);
+      m_C_12_table.initialize(m_C_12, T_min, T_max, n_table);
+      m_C_44_table.initialize(m_C_44, T_min, T_max, n_table);
+    }
+  else if (Cij_type == ElasticMatrixType::Full)
+    {
+      for (unsigned int j = 0; j < n_components; ++j)
+        {
+          for (unsigned int i = 0; i <= j; ++i)
+            {
+              const unsigned int k = i + j * n_components;
+              m_C_full_table[k].initialize(m_C_full[k], T_min, T_max, n_table);
+            }
+        }
+    }
+
+  logger.info() << "n_table=" << n_table << "\n";
 }
 
 template <int dim>
 void
 StressSolver<dim>::initialize_parameters()
 {
-  std::cout << solver_name() << "  Initializing parameters\n";
+  logger.info() << solver_name() << "  Initializing parameters\n";
 
   initialize_elastic_parameters();
+  select_local_assemble_system();
 
   const std::string m_alpha_expression =
     prm.get("Thermal expansion coefficient");
@@ -879,9 +1306,15 @@ StressSolver<dim>::initialize_parameters()
 
   m_T_ref = prm.get_double("Reference temperature");
 
-  const auto n_threads = prm.get_integer("Number of threads");
-  MultithreadInfo::set_thread_limit(n_threads > 0 ? n_threads :
-                                                    MultithreadInfo::n_cores());
+  initialize_property_tables();
+
+  ThreadLimit::set(prm.get_integer("Number of threads"));
+
+  background_writer.set_max_queued_tasks(prm.get_integer("Output queue size"));
+
+  const std::string log_level = prm.get("Log level");
+  if (log_level != "default")
+    logger.set_level(log_level);
 
   const long int n_q_default = get_degree() + 1;
 
@@ -901,16 +1334,16 @@ StressSolver<dim>::initialize_parameters()
   if (prm.get_integer("Output subdivisions") == 0)
     prm.set("Output subdivisions", n_vtk_default);
 
-  std::cout << "alpha=" << m_alpha_expression << "\n"
-            << "T_ref=" << m_T_ref << "\n";
+  logger.info() << "alpha=" << m_alpha_expression << "\n"
+                << "T_ref=" << m_T_ref << "\n";
 
-  std::cout << "n_q_cell=" << prm.get("Number of cell quadrature points")
-            << "\n"
-            << "n_q_face=" << prm.get("Number of face quadrature points")
-            << "\n";
+  logger.info() << "n_q_cell=" << prm.get("Number of cell quadrature points")
+                << "\n"
+                << "n_q_face=" << prm.get("Number of face quadrature points")
+                << "\n";
 
-  std::cout << "n_cores=" << MultithreadInfo::n_cores() << "\n"
-            << "n_threads=" << MultithreadInfo::n_threads() << "\n";
+  logger.info() << "n_cores=" << MultithreadInfo::n_cores() << "\n"
+                << "n_threads=" << MultithreadInfo::n_threads() << "\n";
 }
 
 template <int dim>
@@ -920,6 +1353,20 @@ StressSolver<dim>::solver_name() const
   return "MACPLAS:Stress";
 }
 
+template <int dim>
+std::shared_ptr<Profiler>
+StressSolver<dim>::get_profiler() const
+{
+  return profiler;
+}
+
+template <int dim>
+void
+StressSolver<dim>::set_profiler(const std::shared_ptr<Profiler> &profiler)
+{
+  this->profiler = profiler;
+}
+
 template <int dim>
 void
 StressSolver<dim>::solve(const bool postprocess_only)
@@ -937,14 +1384,15 @@ StressSolver<dim>::solve(const bool postprocess_only)
   try
     {
       solve_system();
+      hanging_node_constraints.distribute(displacement);
       calculate_stress();
     }
   catch (std::exception &e)
     {
-      std::cout << '\n'
-                << solver_name()
-                << "  Error occurred, outputting all data for diagnosis."
-                << e.what();
+      logger.error() << '\n'
+                     << solver_name()
+                     << "  Error occurred, outputting all data for diagnosis."
+                     << e.what();
       converged = false;
       output_mesh();
       output_data();
@@ -1012,6 +1460,8 @@ template <int dim>
 const BlockVector<double> &
 StressSolver<dim>::get_stress_deviator() const
 {
+  update_stress_invariants();
+
   return stress_deviator;
 }
 
@@ -1019,6 +1469,8 @@ template <int dim>
 const Vector<double> &
 StressSolver<dim>::get_stress_hydrostatic() const
 {
+  update_stress_invariants();
+
   return stress_hydrostatic;
 }
 
@@ -1070,30 +1522,38 @@ StressSolver<dim>::initialize()
 {
   Timer timer;
 
-  std::cout << solver_name() << "  Initializing finite element solution";
+  logger.info() << solver_name() << "  Initializing finite element solution";
 
   dh_temp.distribute_dofs(fe_temp);
   dh.distribute_dofs(fe);
 
+  calculate_hanging_node_constraints(dh_temp, hanging_node_constraints_temp);
+
+  // rebuilt by prepare_for_solve for the new DOFs
+  system_matrix.clear();
+  sparsity_pattern = std::make_shared<BlockSparsityPattern>();
+  recovery_key.clear();
+
   const unsigned int n_dofs_temp = dh_temp.n_dofs();
   temperature.reinit(n_dofs_temp);
   displacement.reinit(dim, n_dofs_temp);
   stress.reinit(n_components, n_dofs_temp);
-  stress_deviator.reinit(n_components, n_dofs_temp);
+  stress_deviator.reinit(n_components,
+                         prm.get_bool("Low memory") ? 0 : n_dofs_temp);
   strain_e.reinit(n_components, n_dofs_temp);
   strain_c.reinit(n_components, n_dofs_temp);
-  stress_hydrostatic.reinit(n_dofs_temp);
-  stress_von_Mises.reinit(n_dofs_temp);
+  stress_hydrostatic.reinit(prm.get_bool("Low memory") ? 0 : n_dofs_temp);
+  stress_von_Mises.reinit(prm.get_bool("Low memory") ? 0 : n_dofs_temp);
   stress_J_2.reinit(n_dofs_temp);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 
-  std::cout << solver_name() << "  "
-            << "Number of active cells: " << triangulation.n_active_cells()
-            << "\n"
-            << solver_name() << "  "
-            << "Number of degrees of freedom for temperature: " << n_dofs_temp
-            << "\n";
+  logger.info() << solver_name() << "  "
+                << "Number of active cells: " << triangulation.n_active_cells()
+                << "\n"
+                << solver_name() << "  "
+                << "Number of degrees of freedom for temperature: "
+                << n_dofs_temp << "\n";
 }
 
 template <int dim>
@@ -1149,6 +1609,87 @@ StressSolver<dim>::get_dof_handler() const
   return dh_temp;
 }
 
+template <int dim>
+const HangingNodeConstraints &
+StressSolver<dim>::get_hanging_node_constraints() const
+{
+  return hanging_node_constraints_temp;
+}
+
+template <int dim>
+void
+StressSolver<dim>::prepare_for_refinement()
+{
+  field_transfer_temp.clear();
+  field_transfer_temp.add(temperature);
+  for (unsigned int k = 0; k < n_components; ++k)
+    field_transfer_temp.add(strain_c.block(k));
+  field_transfer_temp.prepare();
+
+  // the DOFs of dh are numbered component-wise, same as the blocks
+  Vector<double> u(dh.n_dofs());
+  std::copy(displacement.begin(), displacement.end(), u.begin());
+
+  field_transfer.clear();
+  field_transfer.add(u);
+  field_transfer.prepare();
+}
+
+template <int dim>
+void
+StressSolver<dim>::finish_refinement()
+{
+  const Profiler::Scope scope(*profiler, "stress/refinement");
+
+  dh_temp.distribute_dofs(fe_temp);
+  dh.distribute_dofs(fe);
+  DoFRenumbering::component_wise(dh);
+
+  calculate_hanging_node_constraints(dh_temp, hanging_node_constraints_temp);
+  calculate_hanging_node_constraints(dh, hanging_node_constraints);
+
+  const unsigned int n_dofs_temp = dh_temp.n_dofs();
+
+  field_transfer_temp.interpolate(hanging_node_constraints_temp);
+  field_transfer_temp.get(0, temperature);
+  strain_c.reinit(n_components, n_dofs_temp);
+  for (unsigned int k = 0; k < n_components; ++k)
+    field_transfer_temp.get(1 + k, strain_c.block(k));
+  field_transfer_temp.clear();
+
+  Vector<double> u;
+  field_transfer.interpolate(hanging_node_constraints);
+  field_transfer.get(0, u);
+  field_transfer.clear();
+
+  displacement.reinit(dim, n_dofs_temp);
+  std::copy(u.begin(), u.end(), displacement.begin());
+
+  stress.reinit(n_components, n_dofs_temp);
+  stress_deviator.reinit(n_components,
+                         prm.get_bool("Low memory") ? 0 : n_dofs_temp);
+  strain_e.reinit(n_components, n_dofs_temp);
+  stress_hydrostatic.reinit(prm.get_bool("Low memory") ? 0 : n_dofs_temp);
+  stress_von_Mises.reinit(prm.get_bool("Low memory") ? 0 : n_dofs_temp);
+  stress_J_2.reinit(n_dofs_temp);
+
+  // rebuilt by prepare_for_solve, the factorization is recalculated
+  system_matrix.clear();
+  factorized_probe.reinit(0);
+  factorization_type.clear();
+  direct_solver.clear();
+  // a shared pattern is kept by the other solvers
+  sparsity_pattern = std::make_shared<BlockSparsityPattern>();
+  recovery_key.clear();
+
+  logger.info() << solver_name() << "  "
+                << "Number of active cells: " << triangulation.n_active_cells()
+                << "\n"
+                << solver_name() << "  "
+                << "Number of degrees of freedom for temperature: "
+                << n_dofs_temp << "\n";
+}
+
 template <int dim>
 void
 StressSolver<dim>::load_data()
@@ -1162,7 +1703,7 @@ StressSolver<dim>::load_data()
   read_data(get_strain_c(), "strain_c" + s);
   // skip calculated quantities (stresses)
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1172,76 +1713,145 @@ StressSolver<dim>::output_data() const
   Timer timer;
 
   const std::string s = output_name_suffix();
-
-  write_data(get_temperature(), "temperature" + s);
-  write_data(get_displacement(), "displacement" + s);
-  write_data(get_stress(), "stress" + s);
-  write_data(get_stress_deviator(), "stress_deviator" + s);
-  write_data(get_stress_hydrostatic(), "stress_hydrostatic" + s);
-  write_data(get_stress_J_2(), "stress_J_2" + s);
-  write_data(get_strain_e(), "strain_e" + s);
-  write_data(get_strain_c(), "strain_c" + s);
-
-  std::cout << " " << format_time(timer) << "\n";
+  BackgroundWriter &w = background_writer;
+
+  write_data(get_temperature(), "temperature" + s, w);
+  write_data(get_displacement(), "displacement" + s, w);
+  write_data(get_stress(), "stress" + s, w);
+  write_data(get_stress_deviator(), "stress_deviator" + s, w);
+  write_data(get_stress_hydrostatic(), "stress_hydrostatic" + s, w);
+  write_data(get_stress_J_2(), "stress_J_2" + s, w);
+  write_data(get_strain_e(), "strain_e" + s, w);
+  write_data(get_strain_c(), "strain_c" + s, w);
+
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
 void
-StressSolver<dim>::output_vtk() const
+StressSolver<dim>::output_checkpoint() const
 {
   Timer timer;
 
-  const std::string file_name = "result-stress" + output_name_suffix() + ".vtk";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
-
-  DataOut<dim> data_out;
+  const std::string base_name = checkpoint_base_name();
+  logger.info() << solver_name() << "  Saving checkpoint '"
+                << CheckpointArchive::get_file_name(base_name, 0) << "'";
 
-  data_out.attach_dof_handler(dh_temp);
-
-  output_data_vector(temperature, "T", data_out);
+  // finish the queued output, the checkpoint should not be newer than it
+  background_writer.flush();
 
-  Vector<double> E(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    E[i] = calc_E(temperature[i]);
-  output_data_vector(E, "E", data_out);
+  CheckpointArchive archive;
+  archive.add_mesh("mesh", triangulation);
+  archive.add_data("temperature", temperature);
+  archive.add_data("displacement", displacement);
+  archive.add_data("strain_c", strain_c);
 
-  Vector<double> C_11(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    C_11[i] = calc_C_11(temperature[i]);
-  output_data_vector(C_11, "C_11", data_out);
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  archive.add_string("parameters", ss.str());
 
-  Vector<double> C_12(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    C_12[i] = calc_C_12(temperature[i]);
-  output_data_vector(C_12, "C_12", data_out);
+  archive.write(base_name, prm.get_integer("Number of checkpoints"));
 
-  Vector<double> C_44(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    C_44[i] = calc_C_44(temperature[i]);
-  output_data_vector(C_44, "C_44", data_out);
+  logger.info() << " " << format_time(timer) << "\n";
+}
 
-  Vector<double> H(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    H[i] = calc_H(temperature[i]);
-  output_data_vector(H, "H", data_out);
+template <int dim>
+bool
+StressSolver<dim>::load_checkpoint()
+{
+  Timer timer;
 
-  Vector<double> alpha(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    alpha[i] = calc_alpha(temperature[i]);
-  output_data_vector(alpha, "alpha", data_out);
+  CheckpointArchive archive;
 
-  for (unsigned int i = 0; i < displacement.n_blocks(); ++i)
+  const std::string file_name =
+    archive.read(checkpoint_base_name(),
+                 prm.get_integer("Number of checkpoints"));
+  if (file_name.empty())
     {
-      const std::string name = "displacement_" + std::to_string(i);
-      output_data_vector(displacement.block(i), name, data_out);
+      logger.info() << solver_name() << "  No valid checkpoint found\n";
+      return false;
     }
 
-  for (unsigned int i = 0; i < stress.n_blocks(); ++i)
-    {
-      const std::string name = "stress_" + std::to_string(i);
-      output_data_vector(stress.block(i), name, data_out);
-    }
-  for (unsigned int i = 0; i < stress_deviator.n_blocks(); ++i)
+  logger.info() << solver_name() << "  Loading checkpoint '" << file_name
+                << "'\n";
+
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  if (archive.get_string("parameters") != ss.str())
+    logger.warning() << solver_name()
+                     << "  Warning: parameters differ from the checkpoint, "
+                        "using the current values\n";
+
+  archive.get_mesh("mesh", triangulation);
+  initialize();
+
+  archive.get_data("temperature", temperature);
+  archive.get_data("displacement", displacement);
+  archive.get_data("strain_c", strain_c);
+
+  logger.info() << solver_name() << "  Restored " << format_time(timer)
+                << "\n";
+
+  return true;
+}
+
+template <int dim>
+void
+StressSolver<dim>::output_vtk() const
+{
+  const Profiler::Scope scope(*profiler, "stress/output");
+
+  Timer timer;
+
+  const std::string format    = prm.get("Output format");
+  const std::string file_name = "result-stress" + output_name_suffix();
+  logger.info() << solver_name() << "  Saving to '" << file_name << "."
+                << DataOutWriter<dim>::get_extension(format) << "'";
+
+  BufferedDataOut<dim> data_out;
+
+  data_out.attach_dof_handler(dh_temp);
+
+  output_data_vector(temperature, "T", data_out);
+
+  const Vector<double> E = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_E(T); });
+  output_data_vector(E, "E", data_out);
+
+  const Vector<double> C_11 = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_C_11(T); });
+  output_data_vector(C_11, "C_11", data_out);
+
+  const Vector<double> C_12 = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_C_12(T); });
+  output_data_vector(C_12, "C_12", data_out);
+
+  const Vector<double> C_44 = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_C_44(T); });
+  output_data_vector(C_44, "C_44", data_out);
+
+  const Vector<double> H = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_H(T); });
+  output_data_vector(H, "H", data_out);
+
+  const Vector<double> alpha = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_alpha(T); });
+  output_data_vector(alpha, "alpha", data_out);
+
+  for (unsigned int i = 0; i < displacement.n_blocks(); ++i)
+    {
+      const std::string name = "displacement_" + std::to_string(i);
+      output_data_vector(displacement.block(i), name, data_out);
+    }
+
+  update_stress_invariants();
+
+  for (unsigned int i = 0; i < stress.n_blocks(); ++i)
+    {
+      const std::string name = "stress_" + std::to_string(i);
+      output_data_vector(stress.block(i), name, data_out);
+    }
+  for (unsigned int i = 0; i < stress_deviator.n_blocks(); ++i)
     {
       const std::string name = "stress_deviator_" + std::to_string(i);
       output_data_vector(stress_deviator.block(i), name, data_out);
@@ -1264,14 +1874,18 @@ StressSolver<dim>::output_vtk() const
 
   data_out.build_patches(prm.get_integer("Output subdivisions"));
 
-  std::ofstream output(file_name);
-
-  const int precision = prm.get_integer("Output precision");
-  output << std::setprecision(precision);
+  const std::string series_name = "result-stress-" + std::to_string(dim) +
+                                  "d-order" + std::to_string(get_degree());
 
-  data_out.write_vtk(output);
+  output_writer.write(data_out,
+                      file_name,
+                      series_name,
+                      format,
+                      0, // overwritten at each call, no time series
+                      prm.get_integer("Output precision"),
+                      background_writer);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1281,16 +1895,55 @@ StressSolver<dim>::output_mesh() const
   Timer timer;
 
   const std::string file_name = "mesh" + output_name_suffix() + ".msh";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  logger.info() << solver_name() << "  Saving to '" << file_name << "'";
 
-  std::ofstream output(file_name);
+  // format here, the mesh could be changed while the file is written
+  std::stringstream output;
   output << std::setprecision(16);
 
   GridOut grid_out;
   grid_out.set_flags(GridOutFlags::Msh(true));
   grid_out.write_msh(triangulation, output);
 
-  std::cout << " " << format_time(timer) << "\n";
+  background_writer.write_file(file_name, output.str());
+
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+void
+StressSolver<dim>::log_memory_consumption() const
+{
+  const std::vector<std::pair<std::string, std::size_t>> items = {
+    {"temperature", temperature.memory_consumption()},
+    {"displacement", displacement.memory_consumption()},
+    {"stress", stress.memory_consumption()},
+    {"stress_deviator", stress_deviator.memory_consumption()},
+    {"strain_e", strain_e.memory_consumption()},
+    {"strain_c", strain_c.memory_consumption()},
+    {"stress_hydrostatic", stress_hydrostatic.memory_consumption()},
+    {"stress_von_Mises", stress_von_Mises.memory_consumption()},
+    {"stress_J_2", stress_J_2.memory_consumption()},
+    {"sparsity_pattern", sparsity_pattern->memory_consumption()},
+    {"system_matrix", system_matrix.memory_consumption()},
+    {"factorized_probe", factorized_probe.memory_consumption()},
+    {"system_rhs", system_rhs.memory_consumption()},
+    {"recovery_projection", recovery_projection.memory_consumption()},
+    {"recovery_weights", recovery_weights.memory_consumption()},
+    {"recovery_matrix",
+     recovery_sparsity_pattern.memory_consumption() +
+       recovery_matrix.memory_consumption()},
+  };
+
+  std::size_t total = 0;
+  for (const auto &it : items)
+    total += it.second;
+
+  logger.info() << solver_name() << "  Memory usage " << total / 1e6
+                << " MB\n";
+  for (const auto &it : items)
+    logger.info() << solver_name() << "  " << it.first << "="
+                  << it.second / 1e6 << " MB\n";
 }
 
 template <int dim>
@@ -1300,8 +1953,8 @@ StressSolver<dim>::output_parameter_table(const double       T1,
                                           const unsigned int n) const
 {
   const std::string fname = "stress-parameter-table.tsv";
-  std::cout << solver_name() << "  Saving table '" << fname << "', T=" << T1
-            << "-" << T2 << " K, n=" << n << '\n';
+  logger.info() << solver_name() << "  Saving table '" << fname << "', T=" << T1
+                << "-" << T2 << " K, n=" << n << '\n';
 
   std::ofstream output(fname);
 
@@ -1330,29 +1983,65 @@ template <int dim>
 void
 StressSolver<dim>::prepare_for_solve()
 {
+  const Profiler::Scope scope(*profiler, "stress/prepare");
+
   const unsigned int n_dofs_temp = dh_temp.n_dofs();
 
   system_rhs.reinit(dim, n_dofs_temp);
 
+  initialize_sparsity_pattern();
+}
+
+template <int dim>
+void
+StressSolver<dim>::initialize_sparsity_pattern()
+{
   // check whether already initialized
-  if (!sparsity_pattern.empty() && !system_matrix.empty())
+  if (!sparsity_pattern->empty() && !system_matrix.empty())
     return;
 
-  BlockDynamicSparsityPattern dsp(dim, dim);
-  for (unsigned int i = 0; i < dim; ++i)
+  DoFRenumbering::component_wise(dh);
+  calculate_hanging_node_constraints(dh, hanging_node_constraints);
+
+  if (sparsity_pattern->empty())
     {
-      for (unsigned int j = 0; j < dim; ++j)
+      const unsigned int n_dofs_temp = dh_temp.n_dofs();
+
+      BlockDynamicSparsityPattern dsp(dim, dim);
+      for (unsigned int i = 0; i < dim; ++i)
         {
-          dsp.block(i, j).reinit(n_dofs_temp, n_dofs_temp);
+          for (unsigned int j = 0; j < dim; ++j)
+            {
+              dsp.block(i, j).reinit(n_dofs_temp, n_dofs_temp);
+            }
         }
+      dsp.collect_sizes();
+
+      DoFTools::make_sparsity_pattern(dh, dsp, hanging_node_constraints, false);
+
+      sparsity_pattern->copy_from(dsp);
     }
-  dsp.collect_sizes();
 
-  DoFRenumbering::component_wise(dh);
-  DoFTools::make_sparsity_pattern(dh, dsp);
+  system_matrix.reinit(*sparsity_pattern);
+}
 
-  sparsity_pattern.copy_from(dsp);
-  system_matrix.reinit(sparsity_pattern);
+template <int dim>
+void
+StressSolver<dim>::share_sparsity_pattern(StressSolver<dim> &other)
+{
+  AssertThrow(dh.n_dofs() == other.dh.n_dofs() &&
+                triangulation.n_active_cells() ==
+                  other.triangulation.n_active_cells(),
+              ExcMessage("StressSolver::share_sparsity_pattern: different "
+                         "meshes or finite elements"));
+
+  other.initialize_sparsity_pattern();
+  if (&other == this)
+    return;
+
+  // the matrix is initialized with the shared pattern by prepare_for_solve
+  system_matrix.clear();
+  sparsity_pattern = other.sparsity_pattern;
 }
 
 template <int dim>
@@ -1369,6 +2058,8 @@ StressSolver<dim>::AssemblyScratchData::AssemblyScratchData(
   , fe_face_values(fe, face_quadrature, update_values | update_JxW_values)
   , T_q(quadrature.size())
   , epsilon_c_q(n_components, std::vector<double>(quadrature.size()))
+  , strain_phi(fe.dofs_per_cell)
+  , stress_phi(fe.dofs_per_cell)
 {}
 
 template <int dim>
@@ -1385,15 +2076,19 @@ StressSolver<dim>::AssemblyScratchData::AssemblyScratchData(
                    scratch_data.fe_face_values.get_update_flags())
   , T_q(scratch_data.T_q)
   , epsilon_c_q(scratch_data.epsilon_c_q)
+  , strain_phi(scratch_data.strain_phi)
+  , stress_phi(scratch_data.stress_phi)
 {}
 
 template <int dim>
 void
 StressSolver<dim>::assemble_system()
 {
+  const Profiler::Scope scope(*profiler, "stress/assemble");
+
   Timer timer;
 
-  std::cout << solver_name() << "  Assembling system";
+  logger.info() << solver_name() << "  Assembling system";
 
   const QGauss<dim> quadrature(
     prm.get_integer("Number of cell quadrature points"));
@@ -1403,14 +2098,19 @@ StressSolver<dim>::assemble_system()
   system_matrix = 0;
   system_rhs    = 0;
 
-  WorkStream::run(IteratorPair(
-                    IteratorTuple(dh_temp.begin_active(), dh.begin_active())),
-                  IteratorPair(IteratorTuple(dh_temp.end(), dh.end())),
-                  *this,
-                  &StressSolver::local_assemble_system,
-                  &StressSolver::copy_local_to_global,
-                  AssemblyScratchData(quadrature, face_quadrature, fe_temp, fe),
-                  AssemblyCopyData());
+  WorkStream::run(
+    IteratorPair(IteratorTuple(dh_temp.begin_active(), dh.begin_active())),
+    IteratorPair(IteratorTuple(dh_temp.end(), dh.end())),
+    [this](const IteratorPair & cell_pair,
+           AssemblyScratchData &scratch_data,
+           AssemblyCopyData &   copy_data) {
+      (this->*local_assemble)(cell_pair, scratch_data, copy_data);
+    },
+    [this](const AssemblyCopyData &copy_data) {
+      copy_local_to_global(copy_data);
+    },
+    AssemblyScratchData(quadrature, face_quadrature, fe_temp, fe),
+    AssemblyCopyData());
 
   // Apply boundary conditions for displacement. Also check if BC was applied
   // for all displacement components; if not, set displacement=0 at single DOF.
@@ -1449,9 +2149,9 @@ StressSolver<dim>::assemble_system()
         {
           boundary_values[i * temperature.size()] = 0;
 #ifdef DEBUG
-          std::cout << '\n'
-                    << solver_name()
-                    << "  displacement=0 applied for dimension " << i;
+          logger.info() << '\n'
+                        << solver_name()
+                        << "  displacement=0 applied for dimension " << i;
 #endif
         }
     }
@@ -1461,10 +2161,57 @@ StressSolver<dim>::assemble_system()
                                      displacement,
                                      system_rhs);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+void
+StressSolver<dim>::select_local_assemble_system()
+{
+  const bool full = Cij_type == ElasticMatrixType::Full;
+
+  switch (get_degree())
+    {
+      case 1:
+        local_assemble =
+          full ? &StressSolver<dim>::template local_assemble_system<
+                   1,
+                   ElasticMatrixType::Full> :
+                 &StressSolver<dim>::template local_assemble_system<
+                   1,
+                   ElasticMatrixType::Cij>;
+        break;
+      case 2:
+        local_assemble =
+          full ? &StressSolver<dim>::template local_assemble_system<
+                   2,
+                   ElasticMatrixType::Full> :
+                 &StressSolver<dim>::template local_assemble_system<
+                   2,
+                   ElasticMatrixType::Cij>;
+        break;
+      case 3:
+        local_assemble =
+          full ? &StressSolver<dim>::template local_assemble_system<
+                   3,
+                   ElasticMatrixType::Full> :
+                 &StressSolver<dim>::template local_assemble_system<
+                   3,
+                   ElasticMatrixType::Cij>;
+        break;
+      default:
+        local_assemble =
+          full ? &StressSolver<dim>::template local_assemble_system<
+                   0,
+                   ElasticMatrixType::Full> :
+                 &StressSolver<dim>::template local_assemble_system<
+                   0,
+                   ElasticMatrixType::Cij>;
+    }
 }
 
 template <int dim>
+template <int degree, typename StressSolver<dim>::ElasticMatrixType type>
 void
 StressSolver<dim>::local_assemble_system(const IteratorPair & cell_pair,
                                          AssemblyScratchData &scratch_data,
@@ -1476,10 +2223,15 @@ StressSolver<dim>::local_assemble_system(const IteratorPair & cell_pair,
   const Quadrature<dim> &    quadrature      = fe_values.get_quadrature();
   const Quadrature<dim - 1> &face_quadrature = fe_face_values.get_quadrature();
 
-  const unsigned int dofs_per_cell   = fe.dofs_per_cell;
+  // known at compile time for the specialized degrees
+  const unsigned int dofs_per_cell =
+    degree > 0 ? dim * Utilities::fixed_power<dim>(degree + 1) :
+                 fe.dofs_per_cell;
   const unsigned int n_q_points      = quadrature.size();
   const unsigned int n_face_q_points = face_quadrature.size();
 
+  AssertDimension(dofs_per_cell, fe.dofs_per_cell);
+
   FullMatrix<double> &cell_matrix = copy_data.cell_matrix;
   Vector<double> &    cell_rhs    = copy_data.cell_rhs;
 
@@ -1490,13 +2242,14 @@ StressSolver<dim>::local_assemble_system(const IteratorPair & cell_pair,
   std::vector<double> &             T_q         = scratch_data.T_q;
   std::vector<std::vector<double>> &epsilon_c_q = scratch_data.epsilon_c_q;
 
+  std::vector<Tensor<1, n_components>> &strain_phi = scratch_data.strain_phi;
+  std::vector<Tensor<1, n_components>> &stress_phi = scratch_data.stress_phi;
+
   std::vector<types::global_dof_index> &local_dof_indices =
     copy_data.local_dof_indices;
 
   local_dof_indices.resize(dofs_per_cell);
 
-  std::vector<Tensor<1, n_components>> strains_ij(dofs_per_cell);
-
   Tensor<1, n_components> epsilon_T_q;
 
   const typename DoFHandler<dim>::active_cell_iterator &cell_temp =
@@ -1516,15 +2269,42 @@ StressSolver<dim>::local_assemble_system(const IteratorPair & cell_pair,
 
   for (unsigned int q = 0; q < n_q_points; ++q)
     {
-      const SymmetricTensor<2, n_components> stiffness =
-        get_stiffness_tensor(T_q[q]);
+      SymmetricTensor<2, n_components> stiffness;
+      double                           C_11 = 0, C_12 = 0, C_44 = 0;
+
+      if (type == ElasticMatrixType::Full)
+        stiffness = get_stiffness_tensor(T_q[q]);
+      else
+        {
+          C_11 = calc_C_11(T_q[q]);
+          C_12 = calc_C_12(T_q[q]);
+          C_44 = calc_C_44(T_q[q]);
+        }
+
+      // sparse product for cubic symmetry
+      const auto apply_stiffness =
+        [&](const Tensor<1, n_components> &e) -> Tensor<1, n_components> {
+        if (type == ElasticMatrixType::Full)
+          return e * stiffness;
+
+        Tensor<1, n_components> s;
+
+        const double e_kk = e[0] + e[1] + e[2];
+        for (unsigned int k = 0; k < 3; ++k)
+          s[k] = (C_11 - C_12) * e[k] + C_12 * e_kk;
+        for (unsigned int k = 3; k < n_components; ++k)
+          s[k] = C_44 * e[k];
+
+        return s;
+      };
 
       get_strain(T_q[q], epsilon_T_q);
 
       // precalculate
       for (unsigned int k = 0; k < dofs_per_cell; ++k)
         {
-          get_strain(fe_values, k, q, strains_ij[k]);
+          get_strain(fe_values, k, q, strain_phi[k]);
+          stress_phi[k] = apply_stiffness(strain_phi[k]);
         }
 
       const double weight =
@@ -1536,20 +2316,21 @@ StressSolver<dim>::local_assemble_system(const IteratorPair & cell_pair,
       for (unsigned int i = 0; i < n_components; ++i)
         epsilon_T_c_q[i] += epsilon_c_q[i][q];
 
+      // upper triangle, the matrix is symmetric
       for (unsigned int i = 0; i < dofs_per_cell; ++i)
         {
-          const Tensor<1, n_components> strain_i_stiffness =
-            strains_ij[i] * stiffness;
-
-          for (unsigned int j = 0; j < dofs_per_cell; ++j)
+          for (unsigned int j = i; j < dofs_per_cell; ++j)
             {
-              cell_matrix(i, j) +=
-                (strain_i_stiffness * strains_ij[j]) * weight;
+              cell_matrix(i, j) += (stress_phi[i] * strain_phi[j]) * weight;
             }
-          cell_rhs(i) += (strain_i_stiffness * epsilon_T_c_q) * weight;
+          cell_rhs(i) += (stress_phi[i] * epsilon_T_c_q) * weight;
         }
     }
 
+  for (unsigned int i = 0; i < dofs_per_cell; ++i)
+    for (unsigned int j = 0; j < i; ++j)
+      cell_matrix(i, j) = cell_matrix(j, i);
+
   for (unsigned int face_number = 0;
        face_number < GeometryInfo<dim>::faces_per_cell;
        ++face_number)
@@ -1589,33 +2370,89 @@ template <int dim>
 void
 StressSolver<dim>::copy_local_to_global(const AssemblyCopyData &copy_data)
 {
-  for (unsigned int i = 0; i < copy_data.local_dof_indices.size(); ++i)
-    {
-      for (unsigned int j = 0; j < copy_data.local_dof_indices.size(); ++j)
-        system_matrix.add(copy_data.local_dof_indices[i],
-                          copy_data.local_dof_indices[j],
-                          copy_data.cell_matrix(i, j));
-      system_rhs(copy_data.local_dof_indices[i]) += copy_data.cell_rhs(i);
-    }
+  hanging_node_constraints.distribute_local_to_global(
+    copy_data.cell_matrix,
+    copy_data.cell_rhs,
+    copy_data.local_dof_indices,
+    system_matrix,
+    system_rhs);
 }
 
 template <int dim>
 void
 StressSolver<dim>::solve_system()
 {
+  const Profiler::Scope scope(*profiler, "stress/linear solve");
+
   Timer timer;
 
-  std::cout << solver_name() << "  Solving system";
+  logger.info() << solver_name() << "  Solving system";
 
   const std::string solver_type = prm.get("Linear solver type");
 
+  const bool   reuse           = prm.get_bool("Reuse factorization");
+  const double reuse_tolerance = prm.get_double("Reuse tolerance");
+
   if (solver_type == "UMFPACK")
     {
-      std::cout << " (" << solver_type << ")";
+      logger.info() << " (" << solver_type;
+
+      const double matrix_change =
+        reuse ? calc_matrix_change(solver_type) :
+                std::numeric_limits<double>::infinity();
 
-      SparseDirectUMFPACK A;
-      A.initialize(system_matrix);
-      A.vmult(displacement, system_rhs);
+      bool solved = false;
+      if (matrix_change == 0)
+        {
+          logger.info() << ", reused";
+
+          direct_solver.vmult(displacement, system_rhs);
+          solved = true;
+        }
+      else if (matrix_change <= reuse_tolerance)
+        {
+          // iterative refinement with the factorization of the old matrix,
+          // the tolerance is relative to the norm of the right-hand side
+          const unsigned int max_refinement_steps = 10;
+
+          SolverControl control(max_refinement_steps,
+                                prm.get_double("Linear solver tolerance") *
+                                  system_rhs.l2_norm(),
+                                false,
+                                false);
+          SolverRichardson<BlockVector<double>> solver(control);
+
+          try
+            {
+              solver.solve(system_matrix,
+                           displacement,
+                           system_rhs,
+                           direct_solver);
+              solved = true;
+
+              profiler->add_count("stress/refinement steps",
+                                  control.last_step());
+              logger.info() << ", reused, " << control.last_step()
+                            << " refinement steps";
+            }
+          catch (SolverControl::NoConvergence &)
+            {
+              // factorize again
+            }
+        }
+
+      if (!solved)
+        {
+          direct_solver.initialize(system_matrix);
+          direct_solver.vmult(displacement, system_rhs);
+
+          if (reuse)
+            store_factorized_matrix(solver_type);
+          else
+            direct_solver.clear();
+        }
+
+      logger.info() << ")";
     }
   else
     {
@@ -1627,7 +2464,7 @@ StressSolver<dim>::solve_system()
       const bool log_result  = prm.get_bool("Log convergence final");
 
       if (log_history || log_result)
-        std::cout << "\n";
+        logger.info() << "\n";
 
       IterationNumberControl control(solver_iterations,
                                      solver_tolerance,
@@ -1650,6 +2487,60 @@ StressSolver<dim>::solve_system()
 
           solver.solve(system_matrix, displacement, system_rhs, preconditioner);
         }
+      else if (preconditioner_type == "block_ssor")
+        {
+          const double preconditioner_relaxation =
+            prm.get_double("Preconditioner relaxation");
+
+          BlockDiagonalPreconditioner<PreconditionSSOR<SparseMatrix<double>>>
+            preconditioner;
+          preconditioner.initialize(
+            system_matrix,
+            PreconditionSSOR<SparseMatrix<double>>::AdditionalData(
+              preconditioner_relaxation));
+
+          solver.solve(system_matrix, displacement, system_rhs, preconditioner);
+        }
+#ifdef DEAL_II_WITH_TRILINOS
+      else if (preconditioner_type == "block_amg")
+        {
+          // the diagonal blocks are scalar elliptic operators with constant
+          // near-null space, the rigid body rotations couple the blocks and
+          // are handled by the outer Krylov solver
+          TrilinosWrappers::PreconditionAMG::AdditionalData data;
+          data.elliptic              = true;
+          data.higher_order_elements = get_degree() > 1;
+          data.smoother_sweeps = prm.get_integer("Preconditioner AMG sweeps");
+          data.aggregation_threshold =
+            prm.get_double("Preconditioner AMG threshold");
+
+          // a stale hierarchy only affects the convergence rate
+          if (reuse &&
+              calc_matrix_change(preconditioner_type) <= reuse_tolerance)
+            {
+              // the line is already terminated if the convergence is logged
+              if (log_history || log_result)
+                logger.info() << solver_name() << "  Reusing AMG hierarchy\n";
+              else
+                logger.info() << " (AMG hierarchy reused)";
+            }
+          else
+            {
+              amg_preconditioner.initialize(system_matrix, data);
+
+              if (reuse)
+                store_factorized_matrix(preconditioner_type);
+            }
+
+          solver.solve(system_matrix,
+                       displacement,
+                       system_rhs,
+                       amg_preconditioner);
+
+          if (!reuse)
+            amg_preconditioner.clear();
+        }
+#endif
       else
         {
           PreconditionIdentity preconditioner;
@@ -1657,27 +2548,101 @@ StressSolver<dim>::solve_system()
           solver.solve(system_matrix, displacement, system_rhs, preconditioner);
         }
 
+      profiler->add_count("stress/linear iterations", control.last_step());
+
       if (control.last_step() >= solver_iterations ||
           control.last_value() >= solver_tolerance)
         {
           if (!(log_history || log_result))
-            std::cout << "\n";
+            logger.info() << "\n";
 
-          std::cout << solver_name() << "  Warning: not converged! Residual(0)="
-                    << control.initial_value() << " Residual("
-                    << control.last_step() << ")=" << control.last_value()
-                    << "\n";
+          logger.warning() << solver_name()
+                           << "  Warning: not converged! Residual(0)="
+                           << control.initial_value() << " Residual("
+                           << control.last_step()
+                           << ")=" << control.last_value() << "\n";
         }
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+void
+StressSolver<dim>::store_factorized_matrix(const std::string &type)
+{
+  BlockVector<double> r;
+  get_probe_vector(r);
+
+  factorized_probe.reinit(r);
+  system_matrix.vmult(factorized_probe, r);
+
+  factorized_hash    = calc_matrix_hash();
+  factorization_type = type;
+
+  // only one factorization is stored
+  if (type != "UMFPACK")
+    direct_solver.clear();
+#ifdef DEAL_II_WITH_TRILINOS
+  if (type != "block_amg")
+    amg_preconditioner.clear();
+#endif
+}
+
+template <int dim>
+double
+StressSolver<dim>::calc_matrix_change(const std::string &type) const
+{
+  if (factorization_type != type ||
+      factorized_probe.n_blocks() != system_matrix.n_block_rows() ||
+      factorized_probe.size() != system_matrix.m())
+    return std::numeric_limits<double>::infinity();
+
+  if (calc_matrix_hash() == factorized_hash)
+    return 0;
+
+  const double norm_old = factorized_probe.l2_norm();
+  if (norm_old == 0)
+    return std::numeric_limits<double>::infinity();
+
+  BlockVector<double> r, Ar;
+  get_probe_vector(r);
+  Ar.reinit(r);
+  system_matrix.vmult(Ar, r);
+  Ar -= factorized_probe;
+
+  return Ar.l2_norm() / norm_old;
+}
+
+template <int dim>
+void
+StressSolver<dim>::get_probe_vector(BlockVector<double> &r) const
+{
+  r.reinit(system_rhs);
+
+  for (unsigned int i = 0; i < r.size(); ++i)
+    r(i) = random_sign(i);
+}
+
+template <int dim>
+std::uint64_t
+StressSolver<dim>::calc_matrix_hash() const
+{
+  std::uint64_t h = 0;
+  for (unsigned int i = 0; i < system_matrix.n_block_rows(); ++i)
+    {
+      for (unsigned int j = 0; j < system_matrix.n_block_cols(); ++j)
+        h = matrix_hash(system_matrix.block(i, j), h);
+    }
+
+  return h;
 }
 
 template <int dim>
 double
 StressSolver<dim>::calc_E(const double T) const
 {
-  return m_E.value(Point<1>(T));
+  return m_E_table.value(T);
 }
 
 template <int dim>
@@ -1685,7 +2650,7 @@ double
 StressSolver<dim>::calc_C_11(const double T) const
 {
   if (Cij_type == ElasticMatrixType::Cij)
-    return m_C_11.value(Point<1>(T));
+    return m_C_11_table.value(T);
 
   return calc_E(T) * (1 - m_nu) / ((1 + m_nu) * (1 - 2 * m_nu));
 }
@@ -1695,7 +2660,7 @@ double
 StressSolver<dim>::calc_C_12(const double T) const
 {
   if (Cij_type == ElasticMatrixType::Cij)
-    return m_C_12.value(Point<1>(T));
+    return m_C_12_table.value(T);
 
   return calc_E(T) * m_nu / ((1 + m_nu) * (1 - 2 * m_nu));
 }
@@ -1705,7 +2670,7 @@ double
 StressSolver<dim>::calc_C_44(const double T) const
 {
   if (Cij_type == ElasticMatrixType::Cij)
-    return m_C_44.value(Point<1>(T));
+    return m_C_44_table.value(T);
 
   return calc_E(T) / (2 * (1 + m_nu));
 }
@@ -1724,7 +2689,160 @@ template <int dim>
 double
 StressSolver<dim>::calc_alpha(const double T) const
 {
-  return m_alpha.value(Point<1>(T));
+  return m_alpha_table.value(T);
+}
+
+template <int dim>
+void
+StressSolver<dim>::initialize_recovery(const std::string &method)
+{
+  prm.enter_subsection("Stress recovery");
+  const unsigned int n_q = prm.get_integer("Number of cell quadrature points");
+
+  const std::string solver_type         = prm.get("Linear solver type");
+  const std::string preconditioner_type = prm.get("Preconditioner type");
+  const double      preconditioner_relaxation =
+    prm.get_double("Preconditioner relaxation");
+
+  std::string key = method + "|" + std::to_string(n_q);
+  if (method == "global")
+    key += "|" + solver_type + "|" + preconditioner_type + "|" +
+           prm.get("Preconditioner relaxation");
+  prm.leave_subsection();
+
+  // the operators depend on the mesh only, vertices are moved in some cases
+  if (key == recovery_key && recovery_vertices == triangulation.get_vertices())
+    return;
+
+  logger.info() << " (new operators)";
+
+  recovery_preconditioner.reset();
+  recovery_direct_solver.clear();
+  recovery_matrix.clear();
+
+  const QGauss<dim> quadrature(n_q);
+
+  const unsigned int n_dofs_temp        = dh_temp.n_dofs();
+  const unsigned int dofs_per_cell_temp = fe_temp.dofs_per_cell;
+  const unsigned int n_q_points         = quadrature.size();
+
+  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell_temp);
+
+  recovery_weights.reinit(n_dofs_temp);
+
+  if (method == "extrapolation")
+    {
+      recovery_projection.reinit(dofs_per_cell_temp, n_q_points);
+      FETools::compute_projection_from_quadrature_points_matrix(
+        fe_temp, quadrature, quadrature, recovery_projection);
+
+      // count cells sharing each DOF
+      typename DoFHandler<dim>::active_cell_iterator
+        cell = dh_temp.begin_active(),
+        endc = dh_temp.end();
+      for (; cell != endc; ++cell)
+        {
+          cell->get_dof_indices(local_dof_indices);
+
+          for (unsigned int i = 0; i < dofs_per_cell_temp; ++i)
+            recovery_weights[local_dof_indices[i]] += 1;
+        }
+
+      for (unsigned int i = 0; i < n_dofs_temp; ++i)
+        {
+          AssertThrow(recovery_weights[i] > 0,
+                      ExcMessage("count[" + std::to_string(i) +
+                                 "]=" + std::to_string(recovery_weights[i]) +
+                                 ", positive value expected"));
+
+          recovery_weights[i] = 1 / recovery_weights[i];
+        }
+    }
+  else
+    {
+      const bool lumped = method == "lumped";
+
+      if (!lumped)
+        {
+          DynamicSparsityPattern dsp(n_dofs_temp);
+          DoFTools::make_sparsity_pattern(dh_temp,
+                                          dsp,
+                                          hanging_node_constraints_temp,
+                                          false);
+
+          recovery_sparsity_pattern.copy_from(dsp);
+          recovery_matrix.reinit(recovery_sparsity_pattern);
+        }
+
+      FEValues<dim> fe_values_temp(fe_temp,
+                                   quadrature,
+                                   update_quadrature_points | update_values |
+                                     update_JxW_values);
+
+      FullMatrix<double> cell_matrix(dofs_per_cell_temp, dofs_per_cell_temp);
+      Vector<double>     cell_mass(dofs_per_cell_temp);
+
+      typename DoFHandler<dim>::active_cell_iterator
+        cell = dh_temp.begin_active(),
+        endc = dh_temp.end();
+      for (; cell != endc; ++cell)
+        {
+          cell_matrix = 0;
+          cell_mass   = 0;
+
+          fe_values_temp.reinit(cell);
+
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              const double weight =
+                dim == 2 ? fe_values_temp.JxW(q) *
+                             fe_values_temp.quadrature_point(q)[0] :
+                           fe_values_temp.JxW(q);
+
+              for (unsigned int i = 0; i < dofs_per_cell_temp; ++i)
+                for (unsigned int j = 0; j < dofs_per_cell_temp; ++j)
+                  {
+                    const double m = fe_values_temp.shape_value(i, q) *
+                                     fe_values_temp.shape_value(j, q) *
+                                     weight;
+
+                    cell_matrix(i, j) += m;
+                    cell_mass(i) += m;
+                  }
+            }
+
+          cell->get_dof_indices(local_dof_indices);
+
+          if (lumped)
+            hanging_node_constraints_temp.distribute_local_to_global(
+              cell_mass, local_dof_indices, recovery_weights);
+          else
+            hanging_node_constraints_temp.distribute_local_to_global(
+              cell_matrix, local_dof_indices, recovery_matrix);
+        }
+
+      if (lumped)
+        {
+          // row sums of the mass matrix, zero at constrained DOFs
+          for (unsigned int i = 0; i < n_dofs_temp; ++i)
+            recovery_weights[i] =
+              recovery_weights[i] > 0 ? 1 / recovery_weights[i] : 0;
+        }
+      else if (solver_type == "UMFPACK")
+        {
+          recovery_direct_solver.initialize(recovery_matrix);
+        }
+      else
+        {
+          recovery_preconditioner.reset(
+            new PreconditionSelector<>(preconditioner_type,
+                                       preconditioner_relaxation));
+          recovery_preconditioner->use_matrix(recovery_matrix);
+        }
+    }
+
+  recovery_key      = key;
+  recovery_vertices = triangulation.get_vertices();
 }
 
 template <int dim>
@@ -1736,7 +2854,6 @@ StressSolver<dim>::recover_strain_extrapolation()
     prm.get_integer("Number of cell quadrature points"));
   prm.leave_subsection();
 
-  FEValues<dim> fe_values_temp(fe_temp, quadrature, update_default);
   FEValues<dim> fe_values(fe,
                           quadrature,
                           update_quadrature_points | update_values |
@@ -1748,12 +2865,6 @@ StressSolver<dim>::recover_strain_extrapolation()
 
   strain_e.reinit(n_components, n_dofs_temp);
 
-  std::vector<unsigned int> count(n_dofs_temp, 0);
-
-  FullMatrix<double> qpoint_to_dof_matrix(dofs_per_cell_temp, n_q_points);
-  FETools::compute_projection_from_quadrature_points_matrix(
-    fe_temp, quadrature, quadrature, qpoint_to_dof_matrix);
-
   // recover elastic strains
   std::vector<Vector<double>> displacement_q(n_q_points, Vector<double>(dim));
 
@@ -1776,7 +2887,6 @@ StressSolver<dim>::recover_strain_extrapolation()
                                                  endc = dh.end();
   for (; cell != endc; ++cell_temp, ++cell)
     {
-      fe_values_temp.reinit(cell_temp);
       fe_values.reinit(cell);
 
       fe_values.get_function_values(displacement, displacement_q);
@@ -1798,15 +2908,13 @@ StressSolver<dim>::recover_strain_extrapolation()
 
       for (unsigned int k = 0; k < n_components; ++k)
         {
-          qpoint_to_dof_matrix.vmult(strain_cell[k], strain_q[k]);
+          recovery_projection.vmult(strain_cell[k], strain_q[k]);
         }
 
       cell_temp->get_dof_indices(local_dof_indices);
 
       for (unsigned int i = 0; i < dofs_per_cell_temp; ++i)
         {
-          count[local_dof_indices[i]] += 1;
-
           for (unsigned int k = 0; k < n_components; ++k)
             {
               strain_e.block(k)[local_dof_indices[i]] += strain_cell[k][i];
@@ -1815,22 +2923,12 @@ StressSolver<dim>::recover_strain_extrapolation()
     }
 
   for (unsigned int k = 0; k < n_components; ++k)
-    {
-      for (unsigned int i = 0; i < n_dofs_temp; ++i)
-        {
-          AssertThrow(count[i] > 0,
-                      ExcMessage("count[" + std::to_string(i) +
-                                 "]=" + std::to_string(count[i]) +
-                                 ", positive value expected"));
-
-          strain_e.block(k)[i] /= count[i];
-        }
-    }
+    strain_e.block(k).scale(recovery_weights);
 }
 
 template <int dim>
 void
-StressSolver<dim>::recover_strain_global()
+StressSolver<dim>::recover_strain_global(const bool lumped)
 {
   prm.enter_subsection("Stress recovery");
   const QGauss<dim> quadrature(
@@ -1849,21 +2947,10 @@ StressSolver<dim>::recover_strain_global()
 
   strain_e.reinit(n_components, n_dofs_temp, true);
 
-  // prepare the global mass matrix and RHS
-  DynamicSparsityPattern dsp(n_dofs_temp);
-  DoFTools::make_sparsity_pattern(dh_temp, dsp);
-
-  SparsityPattern sp;
-  sp.copy_from(dsp);
-
-  SparseMatrix<double> global_matrix;
-  BlockVector<double>  global_rhs(n_components, n_dofs_temp);
-  global_matrix.reinit(sp);
-
-  FullMatrix<double>  cell_matrix(dofs_per_cell_temp, dofs_per_cell_temp);
+  // the mass matrix is prepared by initialize_recovery, assemble the RHS
+  BlockVector<double> global_rhs(n_components, n_dofs_temp);
   BlockVector<double> cell_rhs(n_components, dofs_per_cell_temp);
 
-  // assemble the system for elastic strains
   std::vector<Vector<double>> displacement_q(n_q_points, Vector<double>(dim));
 
   std::vector<std::vector<Tensor<1, dim>>> grad_displacement_q(
@@ -1879,8 +2966,7 @@ StressSolver<dim>::recover_strain_global()
                                                  endc = dh.end();
   for (; cell != endc; ++cell_temp, ++cell)
     {
-      cell_matrix.reinit(dofs_per_cell_temp, dofs_per_cell_temp);
-      cell_rhs.reinit(n_components, dofs_per_cell_temp);
+      cell_rhs = 0;
 
       fe_values_temp.reinit(cell_temp);
       fe_values.reinit(cell);
@@ -1902,13 +2988,6 @@ StressSolver<dim>::recover_strain_global()
 
           for (unsigned int i = 0; i < dofs_per_cell_temp; ++i)
             {
-              for (unsigned int j = 0; j < dofs_per_cell_temp; ++j)
-                {
-                  cell_matrix(i, j) += fe_values_temp.shape_value(i, q) *
-                                       fe_values_temp.shape_value(j, q) *
-                                       weight;
-                }
-
               for (unsigned int k = 0; k < n_components; ++k)
                 cell_rhs.block(k)(i) +=
                   fe_values_temp.shape_value(i, q) * epsilon_e_q[k] * weight;
@@ -1917,66 +2996,70 @@ StressSolver<dim>::recover_strain_global()
 
       cell_temp->get_dof_indices(local_dof_indices);
 
-      for (unsigned int i = 0; i < local_dof_indices.size(); ++i)
-        {
-          for (unsigned int j = 0; j < local_dof_indices.size(); ++j)
-            global_matrix.add(local_dof_indices[i],
-                              local_dof_indices[j],
-                              cell_matrix(i, j));
-          for (unsigned int k = 0; k < n_components; ++k)
-            global_rhs.block(k)(local_dof_indices[i]) += cell_rhs.block(k)(i);
-        }
+      for (unsigned int k = 0; k < n_components; ++k)
+        hanging_node_constraints_temp.distribute_local_to_global(
+          cell_rhs.block(k), local_dof_indices, global_rhs.block(k));
     }
 
   // solve the linear systems
-  prm.enter_subsection("Stress recovery");
-  const std::string solver_type = prm.get("Linear solver type");
-  prm.leave_subsection();
-
-  if (solver_type == "UMFPACK")
+  if (lumped)
     {
-      SparseDirectUMFPACK A;
-      A.initialize(global_matrix);
-
+      strain_e = global_rhs;
       for (unsigned int k = 0; k < n_components; ++k)
-        A.vmult(strain_e.block(k), global_rhs.block(k));
+        strain_e.block(k).scale(recovery_weights);
+
+      return;
     }
-  else
-    {
-      prm.enter_subsection("Stress recovery");
-      const unsigned int solver_iterations =
-        prm.get_integer("Linear solver iterations");
-      const double solver_tolerance = prm.get_double("Linear solver tolerance");
 
-      const bool log_history = prm.get_bool("Log convergence full");
-      const bool log_result  = prm.get_bool("Log convergence final");
+  prm.enter_subsection("Stress recovery");
+  const std::string solver_type = prm.get("Linear solver type");
 
-      if (log_history || log_result)
-        std::cout << "\n";
+  const unsigned int solver_iterations =
+    prm.get_integer("Linear solver iterations");
+  const double solver_tolerance = prm.get_double("Linear solver tolerance");
 
-      IterationNumberControl control(solver_iterations,
-                                     solver_tolerance,
-                                     log_history,
-                                     log_result);
+  const bool log_history = prm.get_bool("Log convergence full");
+  const bool log_result  = prm.get_bool("Log convergence final");
+  prm.leave_subsection();
 
-      SolverSelector<> solver;
-      solver.select(solver_type);
-      solver.set_control(control);
+  const auto solve_component = [&](const unsigned int k) {
+    if (solver_type == "UMFPACK")
+      {
+        recovery_direct_solver.vmult(strain_e.block(k), global_rhs.block(k));
+        return;
+      }
 
-      const std::string preconditioner_type = prm.get("Preconditioner type");
-      const double      preconditioner_relaxation =
-        prm.get_double("Preconditioner relaxation");
-      prm.leave_subsection();
+    IterationNumberControl control(solver_iterations,
+                                   solver_tolerance,
+                                   log_history,
+                                   log_result);
+
+    SolverSelector<> solver;
+    solver.select(solver_type);
+    solver.set_control(control);
+
+    solver.solve(recovery_matrix,
+                 strain_e.block(k),
+                 global_rhs.block(k),
+                 *recovery_preconditioner);
+  };
 
-      PreconditionSelector<> preconditioner(preconditioner_type,
-                                            preconditioner_relaxation);
-      preconditioner.use_matrix(global_matrix);
+  if (solver_type != "UMFPACK" && (log_history || log_result))
+    logger.info() << "\n";
 
+  // the components are independent, full convergence log is kept readable,
+  // the factorization is shared by all components, solve sequentially
+  if (solver_type == "UMFPACK" || log_history)
+    {
+      for (unsigned int k = 0; k < n_components; ++k)
+        solve_component(k);
+    }
+  else
+    {
+      Threads::TaskGroup<void> tasks;
       for (unsigned int k = 0; k < n_components; ++k)
-        solver.solve(global_matrix,
-                     strain_e.block(k),
-                     global_rhs.block(k),
-                     preconditioner);
+        tasks += Threads::new_task([&, k]() { solve_component(k); });
+      tasks.join_all();
     }
 }
 
@@ -1986,96 +3069,192 @@ StressSolver<dim>::calculate_stress_from_strain()
 {
   const unsigned int n_dofs_temp = dh_temp.n_dofs();
 
+  // with low memory, calculated on demand by update_stress_invariants
+  const bool store_invariants = !prm.get_bool("Low memory");
+
   stress.reinit(n_components, n_dofs_temp, true);
+  stress_deviator.reinit(n_components,
+                         store_invariants ? n_dofs_temp : 0,
+                         true);
+  stress_hydrostatic.reinit(store_invariants ? n_dofs_temp : 0, true);
+  stress_von_Mises.reinit(store_invariants ? n_dofs_temp : 0, true);
+  stress_J_2.reinit(n_dofs_temp, true);
 
-  Tensor<1, n_components> epsilon_i, epsilon_T_i;
+  // stress, invariants and deviator in a single pass, each DOF is read and
+  // written once
+  parallel::apply_to_subranges(
+    0U,
+    n_dofs_temp,
+    [&](const unsigned int begin, const unsigned int end) {
+      Tensor<1, n_components> epsilon_i, epsilon_T_i;
 
-  for (unsigned int i = 0; i < n_dofs_temp; ++i)
-    {
-      const SymmetricTensor<2, n_components> stiffness =
-        get_stiffness_tensor(temperature[i]);
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          const SymmetricTensor<2, n_components> stiffness =
+            get_stiffness_tensor(temperature[i]);
 
-      get_strain(temperature[i], epsilon_T_i);
+          get_strain(temperature[i], epsilon_T_i);
 
-      for (unsigned int k = 0; k < n_components; ++k)
-        {
-          epsilon_i[k] =
-            strain_e.block(k)[i] - epsilon_T_i[k] - strain_c.block(k)[i];
+          for (unsigned int k = 0; k < n_components; ++k)
+            {
+              epsilon_i[k] =
+                strain_e.block(k)[i] - epsilon_T_i[k] - strain_c.block(k)[i];
+            }
+
+          const Tensor<1, n_components> s = stiffness * epsilon_i;
+
+          for (unsigned int k = 0; k < n_components; ++k)
+            {
+              stress.block(k)[i] = s[k];
+            }
+
+          const double s_ave = (s[0] + s[1] + s[2]) / 3;
+
+          double s_vM = sqr(s[0] - s[1]) + sqr(s[1] - s[2]) + sqr(s[2] - s[0]);
+          for (unsigned int k = 3; k < n_components; ++k)
+            s_vM += 6 * sqr(s[k]);
+          s_vM = std::sqrt(s_vM / 2);
+
+          stress_J_2[i] = sqr(s_vM) / 3;
+
+          if (!store_invariants)
+            continue;
+
+          stress_hydrostatic[i] = s_ave;
+          stress_von_Mises[i]   = s_vM;
+
+          for (unsigned int k = 0; k < n_components; ++k)
+            {
+              stress_deviator.block(k)[i] = k < 3 ? s[k] - s_ave : s[k];
+            }
         }
+    },
+    grain_size);
+}
+
+#ifdef MACPLAS_WITH_KOKKOS
+template <int dim>
+DeviceStressKernel<StressSolver<dim>::n_components>
+StressSolver<dim>::get_device_kernel() const
+{
+  DeviceStressKernel<n_components> kernel;
+  kernel.full  = Cij_type == ElasticMatrixType::Full;
+  kernel.T_ref = m_T_ref;
 
-      const Tensor<1, n_components> s = stiffness * epsilon_i;
+  std::vector<const TabulatedFunction *> functions;
+  std::vector<double>                    scales;
 
-      for (unsigned int k = 0; k < n_components; ++k)
+  if (kernel.full)
+    {
+      // upper triangle, in the order of DeviceStressKernel::table_index
+      for (unsigned int j = 0; j < n_components; ++j)
         {
-          stress.block(k)[i] = s[k];
+          for (unsigned int i = 0; i <= j; ++i)
+            {
+              functions.push_back(&m_C_full_table[i + j * n_components]);
+              scales.push_back(1);
+            }
         }
     }
+  else if (Cij_type == ElasticMatrixType::Cij)
+    {
+      functions = {&m_C_11_table, &m_C_12_table, &m_C_44_table};
+      scales    = {1, 1, 1};
+    }
+  else
+    {
+      // see calc_C_11, calc_C_12 and calc_C_44
+      functions = {&m_E_table, &m_E_table, &m_E_table};
+      scales    = {(1 - m_nu) / ((1 + m_nu) * (1 - 2 * m_nu)),
+                m_nu / ((1 + m_nu) * (1 - 2 * m_nu)),
+                1 / (2 * (1 + m_nu))};
+    }
+
+  functions.push_back(&m_alpha_table);
+  scales.push_back(1);
+
+  kernel.tables.initialize(functions, scales);
+
+  return kernel;
 }
+#endif
 
 template <int dim>
 void
-StressSolver<dim>::calculate_stress(const bool skip_recovery)
+StressSolver<dim>::update_stress_invariants() const
 {
-  Timer timer;
+  const unsigned int n_dofs_temp = stress_J_2.size();
 
-  if (!skip_recovery)
-    {
-      prm.enter_subsection("Stress recovery");
-      const std::string method = prm.get("Method");
-      prm.leave_subsection();
+  if (stress_hydrostatic.size() == n_dofs_temp &&
+      stress_von_Mises.size() == n_dofs_temp &&
+      stress_deviator.size() == n_components * n_dofs_temp)
+    return;
 
-      std::cout << solver_name() << "  Postprocessing results (" << method
-                << ")";
+  stress_hydrostatic.reinit(n_dofs_temp, true);
+  stress_von_Mises.reinit(n_dofs_temp, true);
+  stress_deviator.reinit(n_components, n_dofs_temp, true);
 
-      if (method == "extrapolation")
-        recover_strain_extrapolation();
-      else if (method == "global")
-        recover_strain_global();
-      else
-        AssertThrow(false,
-                    ExcMessage("calculate_stress: stress recovery method '" +
-                               method + "' not supported."));
-    }
-  else
-    std::cout << solver_name() << "  Postprocessing results (w/o recovery)";
+  parallel::apply_to_subranges(
+    0U,
+    n_dofs_temp,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          const double s_ave =
+            (stress.block(0)[i] + stress.block(1)[i] + stress.block(2)[i]) /
+            3;
 
-  calculate_stress_from_strain();
-  calculate_stress_invariants();
+          stress_hydrostatic[i] = s_ave;
+          stress_von_Mises[i]   = std::sqrt(3 * stress_J_2[i]);
 
-  std::cout << " " << format_time(timer) << "\n";
+          for (unsigned int k = 0; k < n_components; ++k)
+            {
+              stress_deviator.block(k)[i] =
+                k < 3 ? stress.block(k)[i] - s_ave : stress.block(k)[i];
+            }
+        }
+    },
+    grain_size);
 }
 
 template <int dim>
 void
-StressSolver<dim>::calculate_stress_invariants()
+StressSolver<dim>::calculate_stress(const bool skip_recovery)
 {
-  const unsigned int n_dofs_temp = dh_temp.n_dofs();
+  const Profiler::Scope scope(*profiler, "stress/recovery");
 
-  stress_hydrostatic.reinit(n_dofs_temp, true);
-  stress_von_Mises.reinit(n_dofs_temp, true);
-  stress_J_2.reinit(n_dofs_temp, true);
+  Timer timer;
 
-  for (unsigned int i = 0; i < n_dofs_temp; ++i)
+  if (!skip_recovery)
     {
-      stress_hydrostatic[i] =
-        (stress.block(0)[i] + stress.block(1)[i] + stress.block(2)[i]) / 3;
+      prm.enter_subsection("Stress recovery");
+      const std::string method = prm.get("Method");
+      prm.leave_subsection();
+
+      logger.info() << solver_name() << "  Postprocessing results (" << method
+                    << ")";
 
-      stress_von_Mises[i] = sqr(stress.block(0)[i] - stress.block(1)[i]) +
-                            sqr(stress.block(1)[i] - stress.block(2)[i]) +
-                            sqr(stress.block(2)[i] - stress.block(0)[i]);
+      AssertThrow(method == "extrapolation" || method == "global" ||
+                    method == "lumped",
+                  ExcMessage("calculate_stress: stress recovery method '" +
+                             method + "' not supported."));
 
-      for (unsigned int k = 3; k < n_components; ++k)
-        stress_von_Mises[i] += 6 * sqr(stress.block(k)[i]);
+      initialize_recovery(method);
 
-      stress_von_Mises[i] = std::sqrt(stress_von_Mises[i] / 2);
+      if (method == "extrapolation")
+        recover_strain_extrapolation();
+      else
+        recover_strain_global(method == "lumped");
 
-      stress_J_2[i] = sqr(stress_von_Mises[i]) / 3;
+      for (unsigned int k = 0; k < n_components; ++k)
+        hanging_node_constraints_temp.distribute(strain_e.block(k));
     }
+  else
+    logger.info() << solver_name() << "  Postprocessing results (w/o recovery)";
 
-  stress_deviator = stress;
-  stress_deviator.block(0) -= stress_hydrostatic;
-  stress_deviator.block(1) -= stress_hydrostatic;
-  stress_deviator.block(2) -= stress_hydrostatic;
+  calculate_stress_from_strain();
+
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -2086,13 +3265,11 @@ StressSolver<dim>::get_stiffness_tensor(const double &T) const
 
   if (Cij_type == ElasticMatrixType::Full)
     {
-      const auto x = Point<1>(T);
-
       for (unsigned int j = 0; j < n_components; ++j)
         {
           for (unsigned int i = 0; i <= j; ++i)
             {
-              tmp[i][j] = m_C_full[i + j * n_components].value(x);
+              tmp[i][j] = m_C_full_table[i + j * n_components].value(T);
             }
         }
 
@@ -2118,32 +3295,49 @@ StressSolver<dim>::get_strain(const FEValues<dim> &    fe_values,
                               const unsigned int &     q,
                               Tensor<1, n_components> &strain) const
 {
-  if (dim == 2)
-    {
-      const auto grad_0 = fe_values.shape_grad_component(shape_func, q, 0);
-      const auto grad_1 = fe_values.shape_grad_component(shape_func, q, 1);
+  // the shape functions of FESystem<FE_Q> are primitive, only a single
+  // displacement component is nonzero
+  const unsigned int c =
+    fe_values.get_fe().system_to_component_index(shape_func).first;
 
-      strain[0] = grad_0[0];
-      strain[1] = grad_1[1];
+  const Tensor<1, dim> grad = fe_values.shape_grad(shape_func, q);
 
-      strain[2] = fe_values.shape_value_component(shape_func, q, 0) /
-                  fe_values.quadrature_point(q)[0];
+  strain = 0;
 
-      strain[3] = grad_1[0] + grad_0[1];
+  if (dim == 2)
+    {
+      if (c == 0)
+        {
+          strain[0] = grad[0];
+          strain[2] = fe_values.shape_value(shape_func, q) /
+                      fe_values.quadrature_point(q)[0];
+          strain[3] = grad[1];
+        }
+      else
+        {
+          strain[1] = grad[1];
+          strain[3] = grad[0];
+        }
     }
   else if (dim == 3)
     {
-      const auto grad_0 = fe_values.shape_grad_component(shape_func, q, 0);
-      const auto grad_1 = fe_values.shape_grad_component(shape_func, q, 1);
-      const auto grad_2 = fe_values.shape_grad_component(shape_func, q, 2);
-
-      strain[0] = grad_0[0];
-      strain[1] = grad_1[1];
-      strain[2] = grad_2[2];
+      strain[c] = grad[c];
 
-      strain[3] = grad_2[1] + grad_1[2];
-      strain[4] = grad_2[0] + grad_0[2];
-      strain[5] = grad_1[0] + grad_0[1];
+      if (c == 0)
+        {
+          strain[4] = grad[2];
+          strain[5] = grad[1];
+        }
+      else if (c == 1)
+        {
+          strain[3] = grad[2];
+          strain[5] = grad[0];
+        }
+      else
+        {
+          strain[3] = grad[1];
+          strain[4] = grad[0];
+        }
     }
 }
 
@@ -2200,6 +3394,14 @@ StressSolver<dim>::output_name_suffix() const
   return ss.str();
 }
 
+template <int dim>
+std::string
+StressSolver<dim>::checkpoint_base_name() const
+{
+  return "checkpoint-stress-" + std::to_string(dim) + "d-order" +
+         std::to_string(get_degree());
+}
+
 template <int dim>
 const std::vector<std::string>
 StressSolver<dim>::stress_component_names() const
@@ -20,13 +20,23 @@
 
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
 #include <deal.II/lac/full_matrix.h>
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+#  include <deal.II/lac/affine_constraints.h>
+#  include <deal.II/lac/diagonal_matrix.h>
+#  include <deal.II/lac/precondition.h>
+#endif
 #include <deal.II/lac/precondition_selector.h>
 #include <deal.II/lac/solver_selector.h>
 #include <deal.II/lac/sparse_direct.h>
 #include <deal.II/lac/sparse_matrix.h>
 
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+#  include <deal.II/matrix_free/fe_evaluation.h>
+#  include <deal.II/matrix_free/matrix_free.h>
+#endif
+
 #include <deal.II/numerics/data_out.h>
-#include <deal.II/numerics/fe_field_function.h>
+#include <deal.II/numerics/error_estimator.h>
 #include <deal.II/numerics/matrix_tools.h>
 #include <deal.II/numerics/vector_tools.h>
 
@@ -90,6 +100,180 @@ struct convective_cooling_data
 };
 
 
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+/** Matrix-free Jacobian of the heat equation for the Newton's method in
+ * TemperatureSolver.
+ *
+ * The coefficients at quadrature points are calculated by
+ * TemperatureSolver::assemble_system_matrix_free at each Newton iteration,
+ * the operator is applied on the fly with sum factorization instead of
+ * storing a sparse matrix. Constrained DoFs (first-type BC) are treated as
+ * identity. The same 1D quadrature is used for cells and boundary faces.
+ */
+template <int dim>
+class TemperatureJacobianOperator
+{
+public:
+  /** Vectorized data type
+   */
+  using VectorizedType = VectorizedArray<double>;
+
+  /** Coefficients of the linearized heat equation at a quadrature point,
+   * multiplied by the radius in 2D (axisymmetric case)
+   */
+  struct CellCoefficients
+  {
+    /** Thermal conductivity \f$\lambda(T)\f$
+     */
+    VectorizedType lambda;
+
+    /** \f$d\lambda(T)/dT \nabla T\f$
+     */
+    Tensor<1, dim, VectorizedType> lambda_grad_T;
+
+    /** \f$\rho c_p / \Delta t\f$
+     */
+    VectorizedType mass;
+
+    /** \f$\rho c_p V_z\f$
+     */
+    VectorizedType convection;
+  };
+
+  /** Constructor
+   */
+  TemperatureJacobianOperator();
+
+  /** Initialize MatrixFree data structures and resize the coefficient
+   * storage
+   */
+  void
+  reinit(const DoFHandler<dim> &          dof_handler,
+         const AffineConstraints<double> &constraints,
+         const unsigned int               n_q_points_1d);
+
+  /** Get MatrixFree data structures
+   */
+  const MatrixFree<dim, double> &
+  get_matrix_free() const;
+
+  /** Get coefficients at the given cell batch and quadrature point
+   */
+  CellCoefficients &
+  get_cell_coefficients(const unsigned int cell, const unsigned int q);
+
+  /** Get linearized boundary heat flux coefficient
+   * \f$dq/dT\f$ at the given boundary face batch and quadrature point
+   */
+  VectorizedType &
+  get_face_coefficient(const unsigned int face, const unsigned int q);
+
+  /** Number of rows
+   */
+  types::global_dof_index
+  m() const;
+
+  /** Number of columns
+   */
+  types::global_dof_index
+  n() const;
+
+  /** Diagonal element, available after
+   * TemperatureJacobianOperator::compute_diagonal
+   */
+  double
+  el(const types::global_dof_index i, const types::global_dof_index j) const;
+
+  /** Apply the operator
+   */
+  void
+  vmult(Vector<double> &dst, const Vector<double> &src) const;
+
+  /** Calculate the diagonal of the operator
+   */
+  void
+  compute_diagonal();
+
+  /** Get the diagonal of the operator
+   */
+  const Vector<double> &
+  get_diagonal() const;
+
+private:
+  /** Apply the quadrature point operation for the cell
+   */
+  void
+  do_cell_operation(FEEvaluation<dim, -1, 0, 1, double> &phi,
+                    const unsigned int                   cell) const;
+
+  /** Apply the quadrature point operation for the boundary face
+   */
+  void
+  do_face_operation(FEFaceEvaluation<dim, -1, 0, 1, double> &phi,
+                    const unsigned int                       face) const;
+
+  /** Cell contributions for TemperatureJacobianOperator::vmult
+   */
+  void
+  local_apply_cell(const MatrixFree<dim, double> &              data,
+                   Vector<double> &                             dst,
+                   const Vector<double> &                       src,
+                   const std::pair<unsigned int, unsigned int> &range) const;
+
+  /** Inner face contributions (none)
+   */
+  void
+  local_apply_inner_face(
+    const MatrixFree<dim, double> &,
+    Vector<double> &,
+    const Vector<double> &,
+    const std::pair<unsigned int, unsigned int> &) const;
+
+  /** Boundary face contributions for TemperatureJacobianOperator::vmult
+   */
+  void
+  local_apply_boundary_face(
+    const MatrixFree<dim, double> &              data,
+    Vector<double> &                             dst,
+    const Vector<double> &                       src,
+    const std::pair<unsigned int, unsigned int> &range) const;
+
+  /** Mapping, referenced by \c matrix_free
+   */
+  MappingQ1<dim> mapping;
+
+  /** MatrixFree data structures
+   */
+  MatrixFree<dim, double> matrix_free;
+
+  /** Constrained DoFs
+   */
+  std::vector<types::global_dof_index> constrained_dofs;
+
+  /** Cell coefficients, \c n_q_points_cell values for each cell batch
+   */
+  std::vector<CellCoefficients> cell_coefficients;
+
+  /** Boundary face coefficients, \c n_q_points_face values for each boundary
+   * face batch
+   */
+  std::vector<VectorizedType> face_coefficients;
+
+  /** Diagonal of the operator
+   */
+  Vector<double> diagonal;
+
+  /** Number of quadrature points per cell
+   */
+  unsigned int n_q_points_cell;
+
+  /** Number of quadrature points per face
+   */
+  unsigned int n_q_points_face;
+};
+#endif
+
+
 /** Class for calculation of the time-dependent temperature field
  */
 template <int dim>
@@ -187,11 +371,43 @@ public:
   ParameterHandler &
   get_parameters();
 
+  /** Get profiler, shared with other solvers by set_profiler
+   */
+  std::shared_ptr<Profiler>
+  get_profiler() const;
+
+  /** Use \c profiler for performance measurements, e.g. to share a single
+   * report between several solvers. The report is set once by the solver
+   * which created \c profiler (its "Profiling report" parameter)
+   */
+  void
+  set_profiler(const std::shared_ptr<Profiler> &profiler);
+
   /** Initialize DOF handler and fields
    */
   void
   initialize();
 
+  /** Estimate the error of the temperature field by the Kelly error
+   * estimator, one value for each active cell
+   */
+  void
+  estimate_error(Vector<float> &error) const;
+
+  /** Prepare the transfer of the temperature, heat source and user-defined
+   * fields to the adapted mesh. Call after flagging the cells and before
+   * \c Triangulation::execute_coarsening_and_refinement.
+   */
+  void
+  prepare_for_refinement();
+
+  /** Distribute DOFs on the adapted mesh, interpolate the fields and rebuild
+   * the hanging node constraints, sparsity pattern and matrix at the next
+   * solve. Boundary conditions given as DOF vectors have to be set again.
+   */
+  void
+  finish_refinement();
+
   /** Get coordinates of boundary DOFs
    */
   void
@@ -309,6 +525,16 @@ public:
   void
   add_field(const std::string &name, const Vector<double> &value);
 
+  /** Add user-defined field shared with the caller without copying
+   */
+  void
+  add_field(const std::string &name, const FieldStore::FieldPointer &value);
+
+  /** Get user-defined fields
+   */
+  const FieldStore &
+  get_fields() const;
+
   /** Read raw results from disk
    */
   void
@@ -319,6 +545,20 @@ public:
   void
   output_data() const;
 
+  /** Save mesh, fields and time-stepping state to a single checkpoint file
+   * \c "checkpoint-temperature-<dim>d-order<order>-0.bin", the previous
+   * checkpoints are rotated
+   */
+  void
+  output_checkpoint() const;
+
+  /** Restore mesh, fields and time-stepping state from the newest valid
+   * checkpoint, calls TemperatureSolver::initialize.
+   * @returns \c false if no valid checkpoint was found
+   */
+  bool
+  load_checkpoint();
+
   /** Save results to disk in \c vtk format
    */
   void
@@ -418,6 +658,17 @@ private:
   void
   solve_system();
 
+  /** Calculate the Newton residual and the coefficients of the matrix-free
+   * Jacobian TemperatureSolver::jacobian_operator
+   */
+  void
+  assemble_system_matrix_free();
+
+  /** Solve the system of linear equations with the matrix-free Jacobian
+   */
+  void
+  solve_system_matrix_free();
+
   /** Write temperature at probe points to disk.
    * File name \c "probes-temperature-<dim>d.txt"
    */
@@ -435,6 +686,12 @@ private:
   std::string
   output_name_suffix() const;
 
+  /** Helper method for creating checkpoint file name.
+   * @returns \c "checkpoint-temperature-<dim>d-order<order>"
+   */
+  std::string
+  checkpoint_base_name() const;
+
   /** Mesh
    */
   Triangulation<dim> triangulation;
@@ -447,6 +704,14 @@ private:
    */
   DoFHandler<dim> dh;
 
+  /** Hanging node constraints, empty without local refinement
+   */
+  HangingNodeConstraints hanging_node_constraints;
+
+  /** Transfer of the fields to the adapted mesh
+   */
+  FieldTransfer<dim> field_transfer;
+
   /** Sparsity pattern
    */
   SparsityPattern sparsity_pattern;
@@ -459,6 +724,21 @@ private:
    */
   Vector<double> system_rhs;
 
+  /** Use matrix-free Jacobian instead of \c system_matrix
+   */
+  bool use_matrix_free;
+
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+  /** Matrix-free Jacobian
+   */
+  TemperatureJacobianOperator<dim> jacobian_operator;
+
+  /** \c false if \c jacobian_operator has to be reinitialized (mesh or BC
+   * change), reset at each time step
+   */
+  bool jacobian_operator_initialized;
+#endif
+
 
   /** Temperature \f$T\f$, K
    */
@@ -494,6 +774,22 @@ private:
    */
   FunctionParser<1> m_derivative_lambda;
 
+  /** Tabulated \c m_rho
+   */
+  TabulatedFunction m_rho_table;
+
+  /** Tabulated \c m_c_p
+   */
+  TabulatedFunction m_c_p_table;
+
+  /** Tabulated \c m_lambda
+   */
+  TabulatedFunction m_lambda_table;
+
+  /** Tabulated \c m_derivative_lambda
+   */
+  TabulatedFunction m_derivative_lambda_table;
+
 
   /** Data for first-type BC
    */
@@ -511,12 +807,17 @@ private:
 
   /** User-defined fields
    */
-  std::map<std::string, Vector<double>> additional_fields;
+  FieldStore additional_fields;
 
   /** Locations of probe points
    */
   std::vector<Point<dim>> probes;
 
+  /** Cached cells and shape function values at probe points.
+   * Updated in \c solve before each call to \c output_probes.
+   */
+  DoFPointEvaluation<dim> probe_evaluation;
+
   /** User-defined output values
    */
   std::map<std::string, double> additional_output;
@@ -525,6 +826,23 @@ private:
    */
   bool probes_header_written;
 
+  /** Writer for field output, keeps the time-series index
+   */
+  mutable DataOutWriter<dim> output_writer;
+
+  /** Writer of output files in a background thread. Declared after all data
+   * referenced by queued tasks, so it is destroyed (and flushed) first.
+   */
+  mutable BackgroundWriter background_writer;
+
+  /** Performance measurements
+   */
+  std::shared_ptr<Profiler> profiler;
+
+  /** Log output
+   */
+  mutable Logger logger;
+
 
   /**  Parameter handler
    */
@@ -548,18 +866,24 @@ TemperatureSolver<dim>::TemperatureSolver(const unsigned int order,
                                           const bool         use_default_prm)
   : fe(order)
   , dh(triangulation)
+  , field_transfer(dh)
+  , use_matrix_free(false)
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+  , jacobian_operator_initialized(false)
+#endif
   , probes_header_written(false)
+  , profiler(std::make_shared<Profiler>())
   , current_time(0)
   , current_time_step(0)
 {
-  std::cout << "Creating temperature solver, order=" << order << ", dim=" << dim
-            << " ("
+  logger.info() << "Creating temperature solver, order=" << order
+                << ", dim=" << dim << " ("
 #ifdef DEBUG
-               "Debug"
+                   "Debug"
 #else
-               "Release"
+                   "Release"
 #endif
-               ")\n";
+                   ")\n";
 
   prm.declare_entry("Max absolute change",
                     "1e-3",
@@ -613,6 +937,32 @@ TemperatureSolver<dim>::TemperatureSolver(const unsigned int order,
                     Patterns::Double(0),
                     "Relaxation factor of preconditioner");
 
+  prm.enter_subsection("Matrix-free");
+  {
+    prm.declare_entry("Enabled",
+                      "false",
+                      Patterns::Bool(),
+                      "Use matrix-free Jacobian with sum factorization instead"
+                      " of sparse matrix (requires deal.II 9.3)");
+
+    prm.declare_entry("Preconditioner type",
+                      "jacobi",
+                      Patterns::Selection("jacobi|chebyshev"),
+                      "Name of preconditioner for matrix-free Jacobian");
+
+    prm.declare_entry("Chebyshev degree",
+                      "4",
+                      Patterns::Integer(1),
+                      "Degree of Chebyshev polynomial preconditioner");
+
+    prm.declare_entry("Chebyshev smoothing range",
+                      "20",
+                      Patterns::Double(1),
+                      "Ratio of the largest to the smallest eigenvalue "
+                      "treated by Chebyshev preconditioner");
+  }
+  prm.leave_subsection();
+
   prm.declare_entry("Log convergence full",
                     "false",
                     Patterns::Bool(),
@@ -636,7 +986,8 @@ TemperatureSolver<dim>::TemperatureSolver(const unsigned int order,
   prm.declare_entry("Number of threads",
                     "0",
                     Patterns::Integer(0),
-                    "Maximum number of threads to be used (0 - autodetect)");
+                    "Maximum number of threads to be used (0 - autodetect, "
+                    "ignored if fixed, e.g. for ensemble runs)");
 
   prm.declare_entry(
     "Output precision",
@@ -649,6 +1000,42 @@ TemperatureSolver<dim>::TemperatureSolver(const unsigned int order,
                     Patterns::Integer(0),
                     "Number of cell subdivisions for vtk output (0: order)");
 
+  prm.declare_entry("Output format",
+                    "vtk",
+                    Patterns::Selection(DataOutWriter<dim>::get_format_names()),
+                    "Format of field output (vtk - ASCII, vtu - compressed "
+                    "binary, hdf5 - HDF5 with XDMF index)");
+
+  prm.declare_entry("Output queue size",
+                    "0",
+                    Patterns::Integer(0),
+                    "Maximal number of output tasks queued for writing by a "
+                    "background thread (0 - write synchronously)");
+
+  prm.declare_entry("Log level",
+                    "default",
+                    Patterns::Selection("default|" + Logger::get_level_names()),
+                    "Verbosity of the log output (default - value of the "
+                    "MACPLAS_LOG_LEVEL environment variable if set, detail "
+                    "otherwise)");
+
+  prm.declare_entry("Profiling report",
+                    "",
+                    Patterns::Anything(),
+                    "Base name of JSON and CSV performance reports written at "
+                    "exit (empty - no report)");
+
+  prm.declare_entry("Profiling per time step",
+                    "false",
+                    Patterns::Bool(),
+                    "Additionally report the times of all phases at each "
+                    "time step");
+
+  prm.declare_entry("Number of checkpoints",
+                    "2",
+                    Patterns::Integer(1),
+                    "Number of rotated checkpoint files to keep");
+
 
   const std::string info_T = " (temperature function)";
 
@@ -678,6 +1065,26 @@ TemperatureSolver<dim>::TemperatureSolver(const unsigned int order,
                     Patterns::Double(),
                     "Vertical velocity in m/s");
 
+  prm.enter_subsection("Property table");
+  {
+    prm.declare_entry("Number of points",
+                      "0",
+                      Patterns::Integer(0),
+                      "Number of points for tabulation of temperature functions"
+                      " (0 - disabled, exact evaluation)");
+
+    prm.declare_entry("Min temperature",
+                      "250",
+                      Patterns::Double(0),
+                      "Lower temperature bound of tabulation in K");
+
+    prm.declare_entry("Max temperature",
+                      "1700",
+                      Patterns::Double(0),
+                      "Upper temperature bound of tabulation in K");
+  }
+  prm.leave_subsection();
+
   if (use_default_prm)
     {
       std::ofstream of("temperature.prm");
@@ -690,20 +1097,25 @@ TemperatureSolver<dim>::TemperatureSolver(const unsigned int order,
       }
     catch (std::exception &e)
       {
-        std::cout << e.what() << "\n";
+        logger.error() << e.what() << "\n";
 
         std::ofstream of("temperature-default.prm");
         prm.print_parameters(of, ParameterHandler::Text);
       }
 
   initialize_parameters();
+
+  const std::string profiling_report = prm.get("Profiling report");
+  if (!profiling_report.empty())
+    profiler->set_report(profiling_report,
+                         prm.get_bool("Profiling per time step"));
 }
 
 template <int dim>
 void
 TemperatureSolver<dim>::initialize_parameters()
 {
-  std::cout << solver_name() << "  Initializing parameters";
+  logger.info() << solver_name() << "  Initializing parameters";
 
   const std::string m_rho_expression = prm.get("Density");
   m_rho.initialize("T",
@@ -726,13 +1138,47 @@ TemperatureSolver<dim>::initialize_parameters()
                                  m_derivative_lambda_expression,
                                  typename FunctionParser<1>::ConstMap());
 
+  prm.enter_subsection("Property table");
+  const unsigned int n_table = prm.get_integer("Number of points");
+  const double       T_min   = prm.get_double("Min temperature");
+  const double       T_max   = prm.get_double("Max temperature");
+  prm.leave_subsection();
 
-  const auto n_threads = prm.get_integer("Number of threads");
-  MultithreadInfo::set_thread_limit(n_threads > 0 ? n_threads :
-                                                    MultithreadInfo::n_cores());
+  m_rho_table.initialize(m_rho, T_min, T_max, n_table);
+  m_c_p_table.initialize(m_c_p, T_min, T_max, n_table);
+  m_lambda_table.initialize(m_lambda, T_min, T_max, n_table);
+  m_derivative_lambda_table.initialize(m_derivative_lambda,
+                                       T_min,
+                                       T_max,
+                                       n_table);
+
+  ThreadLimit::set(prm.get_integer("Number of threads"));
+
+  background_writer.set_max_queued_tasks(prm.get_integer("Output queue size"));
+
+  const std::string log_level = prm.get("Log level");
+  if (log_level != "default")
+    logger.set_level(log_level);
 
   get_time_step() = prm.get_double("Time step");
 
+  prm.enter_subsection("Matrix-free");
+  use_matrix_free = prm.get_bool("Enabled");
+  prm.leave_subsection();
+
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+  AssertThrow(!use_matrix_free || dim > 1,
+              ExcMessage("TemperatureSolver: matrix-free Jacobian is not "
+                         "implemented in 1D"));
+#else
+  AssertThrow(!use_matrix_free,
+              ExcMessage("TemperatureSolver: matrix-free Jacobian requires "
+                         "deal.II 9.3 or later"));
+#endif
+  AssertThrow(!use_matrix_free || prm.get("Linear solver type") != "UMFPACK",
+              ExcMessage("TemperatureSolver: matrix-free Jacobian requires an "
+                         "iterative linear solver"));
+
   add_output("nNewton");
   add_output("Velocity[m/s]");
 
@@ -749,21 +1195,24 @@ TemperatureSolver<dim>::initialize_parameters()
   if (prm.get_integer("Output subdivisions") == 0)
     prm.set("Output subdivisions", n_vtk_default);
 
-  std::cout << "  done\n";
+  logger.info() << "  done\n";
 
-  std::cout << "rho=" << m_rho_expression << "\n"
-            << "c_p=" << m_c_p_expression << "\n"
-            << "lambda=" << m_lambda_expression << "\n"
-            << "derivative_lambda=" << m_derivative_lambda_expression << "\n"
-            << "V_z=" << calc_V_z() << "\n";
+  logger.info() << "rho=" << m_rho_expression << "\n"
+                << "c_p=" << m_c_p_expression << "\n"
+                << "lambda=" << m_lambda_expression << "\n"
+                << "derivative_lambda=" << m_derivative_lambda_expression
+                << "\n"
+                << "V_z=" << calc_V_z() << "\n"
+                << "n_table=" << n_table << "\n"
+                << "matrix_free=" << use_matrix_free << "\n";
 
-  std::cout << "n_q_cell=" << prm.get("Number of cell quadrature points")
-            << "\n"
-            << "n_q_face=" << prm.get("Number of face quadrature points")
-            << "\n";
+  logger.info() << "n_q_cell=" << prm.get("Number of cell quadrature points")
+                << "\n"
+                << "n_q_face=" << prm.get("Number of face quadrature points")
+                << "\n";
 
-  std::cout << "n_cores=" << MultithreadInfo::n_cores() << "\n"
-            << "n_threads=" << MultithreadInfo::n_threads() << "\n";
+  logger.info() << "n_cores=" << MultithreadInfo::n_cores() << "\n"
+                << "n_threads=" << MultithreadInfo::n_threads() << "\n";
 }
 
 template <int dim>
@@ -773,12 +1222,27 @@ TemperatureSolver<dim>::solver_name() const
   return "MACPLAS:Temperature";
 }
 
+template <int dim>
+std::shared_ptr<Profiler>
+TemperatureSolver<dim>::get_profiler() const
+{
+  return profiler;
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::set_profiler(const std::shared_ptr<Profiler> &profiler)
+{
+  this->profiler = profiler;
+}
+
 template <int dim>
 bool
 TemperatureSolver<dim>::solve(const bool skip_time_advance)
 {
   if (!probes_header_written)
     {
+      probe_evaluation.reinit(get_dof_handler(), probes);
       output_probes();
       // set here to keep const-ness of output_probes
       probes_header_written = true;
@@ -797,31 +1261,56 @@ TemperatureSolver<dim>::solve(const bool skip_time_advance)
 #ifdef DEBUG
   if (dt > 0 && V_z != 0)
     {
-      std::cout << solver_name() << "  Warning: non-zero velocity V_z=" << V_z
-                << " m/s specified in transient simulations\n";
+      logger.warning() << solver_name()
+                       << "  Warning: non-zero velocity V_z=" << V_z
+                       << " m/s specified in transient simulations\n";
     }
 #endif
 
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+  // the mesh might have been changed between time steps
+  jacobian_operator_initialized = false;
+#endif
+
+  // the matrix-free operator does not apply the hanging node constraints
+  AssertThrow(!use_matrix_free || hanging_node_constraints.n_constraints() == 0,
+              ExcMessage("TemperatureSolver: hanging nodes are not supported "
+                         "with the matrix-free Jacobian"));
+
   for (int i = 1;; ++i)
     {
       prepare_for_solve();
-      assemble_system();
-      solve_system();
+      if (use_matrix_free)
+        {
+          assemble_system_matrix_free();
+          solve_system_matrix_free();
+        }
+      else
+        {
+          assemble_system();
+          solve_system();
+          hanging_node_constraints.distribute(temperature_update);
+        }
 
       temperature.add(prm.get_double("Newton step length"), temperature_update);
 
       add_output("nNewton", i);
+      profiler->add_count("temperature/Newton iterations");
 
       // Check convergence
       const double max_abs_dT = temperature_update.linfty_norm();
 
-      std::cout.unsetf(std::ios_base::floatfield);
-      std::cout << std::setprecision(8);
-      std::cout << solver_name() << "  "
-                << "Time " << t << " s"
-                << " step " << dt << " s"
-                << "  Newton iteration " << i << "  max T change " << max_abs_dT
-                << " K\n";
+      if (logger.is_enabled(Logger::Detail))
+        {
+          std::ostream &out = logger.detail();
+          out.unsetf(std::ios_base::floatfield);
+          out << std::setprecision(8);
+          out << solver_name() << "  "
+              << "Time " << t << " s"
+              << " step " << dt << " s"
+              << "  Newton iteration " << i << "  max T change " << max_abs_dT
+              << " K\n";
+        }
       if (max_abs_dT < prm.get_double("Max absolute change"))
         break;
 
@@ -830,8 +1319,11 @@ TemperatureSolver<dim>::solve(const bool skip_time_advance)
         break;
     }
 
+  probe_evaluation.reinit(get_dof_handler(), probes);
   output_probes();
 
+  profiler->end_time_step(t);
+
   if (dt > 0 && t + 1e-4 * dt >= t_max)
     return false;
 
@@ -935,23 +1427,96 @@ TemperatureSolver<dim>::initialize()
 {
   Timer timer;
 
-  std::cout << solver_name() << "  Initializing finite element solution";
+  logger.info() << solver_name() << "  Initializing finite element solution";
 
   dh.distribute_dofs(fe);
   const unsigned int n_dofs = dh.n_dofs();
 
+  calculate_hanging_node_constraints(dh, hanging_node_constraints);
+
+  AssertThrow(!use_matrix_free || hanging_node_constraints.n_constraints() == 0,
+              ExcMessage("TemperatureSolver: hanging nodes are not supported "
+                         "with the matrix-free Jacobian"));
+
   temperature.reinit(n_dofs);
   temperature_update.reinit(n_dofs);
   vol_heat_source.reinit(n_dofs);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
+
+  logger.info() << solver_name() << "  "
+                << "Number of active cells: " << triangulation.n_active_cells()
+                << "\n"
+                << solver_name() << "  "
+                << "Number of degrees of freedom for temperature: " << n_dofs
+                << "\n";
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::estimate_error(Vector<float> &error) const
+{
+  error.reinit(triangulation.n_active_cells());
+
+  KellyErrorEstimator<dim>::estimate(
+    dh,
+    QGauss<dim - 1>(prm.get_integer("Number of face quadrature points")),
+    std::map<types::boundary_id, const Function<dim> *>(),
+    temperature,
+    error);
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::prepare_for_refinement()
+{
+  AssertThrow(!use_matrix_free,
+              ExcMessage("TemperatureSolver: mesh refinement is not "
+                         "supported with the matrix-free Jacobian"));
+
+  field_transfer.clear();
+  field_transfer.add(temperature);
+  field_transfer.add(vol_heat_source);
+  if (temperature_prev.size() == dh.n_dofs())
+    field_transfer.add(temperature_prev);
+  field_transfer.add(additional_fields);
+
+  field_transfer.prepare();
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::finish_refinement()
+{
+  const Profiler::Scope scope(*profiler, "temperature/refinement");
+
+  const bool has_prev = temperature_prev.size() == temperature.size();
+
+  dh.distribute_dofs(fe);
+  const unsigned int n_dofs = dh.n_dofs();
+
+  calculate_hanging_node_constraints(dh, hanging_node_constraints);
 
-  std::cout << solver_name() << "  "
-            << "Number of active cells: " << triangulation.n_active_cells()
-            << "\n"
-            << solver_name() << "  "
-            << "Number of degrees of freedom for temperature: " << n_dofs
-            << "\n";
+  field_transfer.interpolate(hanging_node_constraints);
+  field_transfer.get(0, temperature);
+  field_transfer.get(1, vol_heat_source);
+  if (has_prev)
+    field_transfer.get(2, temperature_prev);
+  field_transfer.get(additional_fields);
+  field_transfer.clear();
+
+  temperature_update.reinit(n_dofs);
+
+  // rebuilt by prepare_for_solve
+  system_matrix.clear();
+  sparsity_pattern.reinit(0, 0, 0);
+
+  logger.info() << solver_name() << "  "
+                << "Number of active cells: " << triangulation.n_active_cells()
+                << "\n"
+                << solver_name() << "  "
+                << "Number of degrees of freedom for temperature: " << n_dofs
+                << "\n";
 }
 
 template <int dim>
@@ -1002,34 +1567,10 @@ TemperatureSolver<dim>::get_field_at_points(
   const Vector<double> &         source,
   const std::vector<Point<dim>> &points) const
 {
-  Functions::FEFieldFunction<dim> ff(get_dof_handler(), source);
-
-  std::vector<double> values(points.size(), 0);
-
-  try
-    {
-      ff.value_list(points, values);
-    }
-  catch (std::exception &e)
-    {
-#ifdef DEBUG
-      std::cout << e.what() << "\n";
-#endif
-
-      for (unsigned int i = 0; i < points.size(); ++i)
-        {
-          try
-            {
-              values[i] = ff.value(points[i]);
-            }
-          catch (std::exception &e)
-            {
-              values[i] = 0;
-            }
-        }
-    }
+  DoFPointEvaluation<dim> point_evaluation;
+  point_evaluation.reinit(get_dof_handler(), points);
 
-  return values;
+  return point_evaluation.evaluate(source);
 }
 
 template <int dim>
@@ -1165,7 +1706,22 @@ void
 TemperatureSolver<dim>::add_field(const std::string &   name,
                                   const Vector<double> &value)
 {
-  additional_fields[name] = value;
+  additional_fields.set(name, value);
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::add_field(const std::string &              name,
+                                  const FieldStore::FieldPointer &value)
+{
+  additional_fields.set(name, value);
+}
+
+template <int dim>
+const FieldStore &
+TemperatureSolver<dim>::get_fields() const
+{
+  return additional_fields;
 }
 
 template <int dim>
@@ -1176,7 +1732,7 @@ TemperatureSolver<dim>::load_data()
 
   read_data(get_temperature(), "temperature" + output_name_suffix());
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1185,49 +1741,137 @@ TemperatureSolver<dim>::output_data() const
 {
   Timer timer;
 
-  write_data(get_temperature(), "temperature" + output_name_suffix());
+  write_data(get_temperature(),
+             "temperature" + output_name_suffix(),
+             background_writer);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
 void
-TemperatureSolver<dim>::output_vtk() const
+TemperatureSolver<dim>::output_checkpoint() const
 {
   Timer timer;
 
-  const std::string file_name =
-    "result-temperature" + output_name_suffix() + ".vtk";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  const std::string base_name = checkpoint_base_name();
+  logger.info() << solver_name() << "  Saving checkpoint '"
+                << CheckpointArchive::get_file_name(base_name, 0) << "'";
 
-  DataOut<dim> data_out;
+  // finish the queued output, the checkpoint should not be newer than it
+  background_writer.flush();
 
-  data_out.attach_dof_handler(dh);
-  data_out.add_data_vector(temperature, "T");
-  data_out.add_data_vector(temperature_update, "dT");
-  data_out.add_data_vector(vol_heat_source, "dot_q");
+  CheckpointArchive archive;
+  archive.add_mesh("mesh", triangulation);
+  archive.add_data("temperature", temperature);
+  archive.add_data("vol_heat_source", vol_heat_source);
+  for (const auto &it : additional_fields)
+    archive.add_data("field:" + it.first, *it.second);
+  for (const auto &it : additional_output)
+    archive.add_value("output:" + it.first, it.second);
 
-  Vector<double> rho(temperature.size()), c_p(temperature.size()),
-    l(temperature.size()), dl_dT(temperature.size());
-  for (unsigned int i = 0; i < temperature.size(); ++i)
-    {
-      rho[i]   = calc_rho(temperature[i]);
-      c_p[i]   = calc_c_p(temperature[i]);
-      l[i]     = calc_lambda(temperature[i]);
-      dl_dT[i] = calc_derivative_lambda(temperature[i]);
-    }
-  data_out.add_data_vector(rho, "rho");
-  data_out.add_data_vector(c_p, "c_p");
-  data_out.add_data_vector(l, "lambda");
-  data_out.add_data_vector(dl_dT, "derivative_lambda");
+  archive.add_value("time", current_time);
+  archive.add_value("time_step", current_time_step);
+  archive.add_value("probes_header_written", probes_header_written);
 
-  for (const auto &it : additional_fields)
-    {
-      if (it.second.size() == temperature.size())
-        data_out.add_data_vector(it.second, it.first);
-    }
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  archive.add_string("parameters", ss.str());
 
-  std::map<unsigned int, Vector<double>> q_rad, emissivity;
+  archive.write(base_name, prm.get_integer("Number of checkpoints"));
+
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+bool
+TemperatureSolver<dim>::load_checkpoint()
+{
+  Timer timer;
+
+  CheckpointArchive archive;
+
+  const std::string file_name =
+    archive.read(checkpoint_base_name(),
+                 prm.get_integer("Number of checkpoints"));
+  if (file_name.empty())
+    {
+      logger.info() << solver_name() << "  No valid checkpoint found\n";
+      return false;
+    }
+
+  logger.info() << solver_name() << "  Loading checkpoint '" << file_name
+                << "'\n";
+
+  std::stringstream ss;
+  prm.print_parameters(ss, ParameterHandler::ShortText);
+  if (archive.get_string("parameters") != ss.str())
+    logger.warning() << solver_name()
+                     << "  Warning: parameters differ from the checkpoint, "
+                        "using the current values\n";
+
+  archive.get_mesh("mesh", triangulation);
+  initialize();
+
+  archive.get_data("temperature", temperature);
+  archive.get_data("vol_heat_source", vol_heat_source);
+
+  for (const auto &name : archive.get_names("field:"))
+    archive.get_data("field:" + name, additional_fields.get_mutable(name));
+  for (const auto &name : archive.get_names("output:"))
+    additional_output[name] = archive.get_value("output:" + name);
+
+  current_time          = archive.get_value("time");
+  current_time_step     = archive.get_value("time_step");
+  probes_header_written = archive.get_value("probes_header_written") != 0;
+
+  logger.info() << solver_name() << "  Restored t=" << get_time()
+                << " s, dt=" << get_time_step() << " s " << format_time(timer)
+                << "\n";
+
+  return true;
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::output_vtk() const
+{
+  const Profiler::Scope scope(*profiler, "temperature/output");
+
+  Timer timer;
+
+  const std::string format    = prm.get("Output format");
+  const std::string file_name = "result-temperature" + output_name_suffix();
+  logger.info() << solver_name() << "  Saving to '" << file_name << "."
+                << DataOutWriter<dim>::get_extension(format) << "'";
+
+  BufferedDataOut<dim> data_out;
+
+  data_out.attach_dof_handler(dh);
+  data_out.add_data_vector(temperature, "T");
+  data_out.add_data_vector(temperature_update, "dT");
+  data_out.add_data_vector(vol_heat_source, "dot_q");
+
+  const Vector<double> rho = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_rho(T); });
+  const Vector<double> c_p = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_c_p(T); });
+  const Vector<double> l = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_lambda(T); });
+  const Vector<double> dl_dT = evaluate_pointwise(
+    temperature, [this](const double T) { return calc_derivative_lambda(T); });
+  data_out.add_data_vector(rho, "rho");
+  data_out.add_data_vector(c_p, "c_p");
+  data_out.add_data_vector(l, "lambda");
+  data_out.add_data_vector(dl_dT, "derivative_lambda");
+
+  for (const auto &it : additional_fields)
+    {
+      if (it.second->size() == temperature.size())
+        data_out.add_data_vector(*it.second, it.first);
+    }
+
+  std::map<unsigned int, Vector<double>> q_rad, emissivity;
   for (const auto &data : bc_rad_mixed_data)
     {
       Vector<double> &q = q_rad[data.first];
@@ -1283,14 +1927,18 @@ TemperatureSolver<dim>::output_vtk() const
 
   data_out.build_patches(prm.get_integer("Output subdivisions"));
 
-  std::ofstream output(file_name);
+  const std::string series_name = "result-temperature-" + std::to_string(dim) +
+                                  "d-order" + std::to_string(get_degree());
 
-  const int precision = prm.get_integer("Output precision");
-  output << std::setprecision(precision);
+  output_writer.write(data_out,
+                      file_name,
+                      series_name,
+                      format,
+                      get_time(),
+                      prm.get_integer("Output precision"),
+                      background_writer);
 
-  data_out.write_vtk(output);
-
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1307,15 +1955,15 @@ TemperatureSolver<dim>::output_boundary_values(const unsigned int id) const
                    boundary_dofs.cend(),
                    [](const bool b) { return b; }))
     {
-      std::cout << solver_name()
-                << "  output_boundary_values: skipping empty boundary " << id
-                << "\n";
+      logger.info() << solver_name()
+                    << "  output_boundary_values: skipping empty boundary "
+                    << id << "\n";
       return;
     }
 
   const std::string file_name = "result-temperature" + output_name_suffix() +
                                 "-boundary" + std::to_string(id) + ".dat";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  logger.info() << solver_name() << "  Saving to '" << file_name << "'";
 
   std::ofstream output(file_name);
 
@@ -1337,7 +1985,7 @@ TemperatureSolver<dim>::output_boundary_values(const unsigned int id) const
 
   for (const auto &it : additional_fields)
     {
-      if (it.second.size() == T.size())
+      if (it.second->size() == T.size())
         output << '\t' << it.first;
     }
 
@@ -1361,8 +2009,8 @@ TemperatureSolver<dim>::output_boundary_values(const unsigned int id) const
 
       for (const auto &it : additional_fields)
         {
-          if (it.second.size() == T.size())
-            output << '\t' << it.second[i];
+          if (it.second->size() == T.size())
+            output << '\t' << (*it.second)[i];
         }
 
       if (it_q_in != bc_rad_mixed_data.end())
@@ -1371,7 +2019,7 @@ TemperatureSolver<dim>::output_boundary_values(const unsigned int id) const
       output << '\n';
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 
 #ifdef DEBUG
   if (it_q_in != bc_rad_mixed_data.end())
@@ -1400,16 +2048,19 @@ TemperatureSolver<dim>::output_mesh() const
   Timer timer;
 
   const std::string file_name = "mesh" + output_name_suffix() + ".msh";
-  std::cout << solver_name() << "  Saving to '" << file_name << "'";
+  logger.info() << solver_name() << "  Saving to '" << file_name << "'";
 
-  std::ofstream output(file_name);
+  // format here, the mesh could be changed while the file is written
+  std::stringstream output;
   output << std::setprecision(16);
 
   GridOut grid_out;
   grid_out.set_flags(GridOutFlags::Msh(true));
   grid_out.write_msh(triangulation, output);
 
-  std::cout << " " << format_time(timer) << "\n";
+  background_writer.write_file(file_name, output.str());
+
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1419,8 +2070,8 @@ TemperatureSolver<dim>::output_parameter_table(const double       T1,
                                                const unsigned int n) const
 {
   const std::string fname = "temperature-parameter-table.tsv";
-  std::cout << solver_name() << "  Saving table '" << fname << "', T=" << T1
-            << "-" << T2 << " K, n=" << n << '\n';
+  logger.info() << solver_name() << "  Saving table '" << fname << "', T=" << T1
+                << "-" << T2 << " K, n=" << n << '\n';
 
   std::ofstream output(fname);
 
@@ -1446,36 +2097,35 @@ template <int dim>
 double
 TemperatureSolver<dim>::calc_lambda(const double T) const
 {
-  return m_lambda.value(Point<1>(T));
+  return m_lambda_table.value(T);
 }
 
 template <int dim>
 double
 TemperatureSolver<dim>::calc_derivative_lambda(const double T) const
 {
-  return m_derivative_lambda.value(Point<1>(T));
+  return m_derivative_lambda_table.value(T);
 }
 
 template <int dim>
 double
 TemperatureSolver<dim>::calc_rho(const double T) const
 {
-  return m_rho.value(Point<1>(T));
+  return m_rho_table.value(T);
 }
 
 template <int dim>
 double
 TemperatureSolver<dim>::calc_c_p(const double T) const
 {
-  return m_c_p.value(Point<1>(T));
+  return m_c_p_table.value(T);
 }
 
 template <int dim>
 double
 TemperatureSolver<dim>::calc_rho_c_p(const double T) const
 {
-  const Point<1> x(T);
-  return m_rho.value(x) * m_c_p.value(x);
+  return m_rho_table.value(T) * m_c_p_table.value(T);
 }
 
 template <int dim>
@@ -1495,18 +2145,28 @@ TemperatureSolver<dim>::output_name_suffix() const
   return ss.str();
 }
 
+template <int dim>
+std::string
+TemperatureSolver<dim>::checkpoint_base_name() const
+{
+  return "checkpoint-temperature-" + std::to_string(dim) + "d-order" +
+         std::to_string(get_degree());
+}
+
 template <int dim>
 void
 TemperatureSolver<dim>::output_probes() const
 {
+  const Profiler::Scope scope(*profiler, "temperature/output");
+
   Timer timer;
 
   std::stringstream ss;
   ss << "probes-temperature-" << dim << "d.txt";
   const std::string file_name = ss.str();
 
-  std::cout << solver_name() << "  "
-            << "Saving values at probe points to '" << file_name << "'";
+  logger.info() << solver_name() << "  "
+                << "Saving values at probe points to '" << file_name << "'";
 
   const unsigned int N = probes.size();
 
@@ -1516,7 +2176,7 @@ TemperatureSolver<dim>::output_probes() const
   if (!probes_header_written)
     {
       // write header at the first time step
-      std::ofstream output(file_name);
+      std::stringstream output;
 
       for (unsigned int i = 0; i < N; ++i)
         output << "# probe " << i << ":\t" << probes[i] << "\n";
@@ -1540,6 +2200,8 @@ TemperatureSolver<dim>::output_probes() const
       for (unsigned int i = 0; i < N; ++i)
         output << "\tderivative_lambda_" << i << "[Wm^-1K^-2]";
       output << "\n";
+
+      background_writer.write_file(file_name, output.str());
     }
 
   const std::vector<double> values = get_field_at_probes(temperature);
@@ -1547,7 +2209,7 @@ TemperatureSolver<dim>::output_probes() const
   const auto limits = minmax(temperature);
 
   // header is already written, append values at the current time step
-  std::ofstream output(file_name, std::ios::app);
+  std::stringstream output;
 
   const int precision = prm.get_integer("Output precision");
   output << std::setprecision(precision);
@@ -1571,20 +2233,24 @@ TemperatureSolver<dim>::output_probes() const
     output << '\t' << calc_derivative_lambda(v);
   output << "\n";
 
-  std::cout << " " << format_time(timer) << "\n";
+  background_writer.write_file(file_name, output.str(), std::ios::app);
+
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
 std::vector<double>
 TemperatureSolver<dim>::get_field_at_probes(const Vector<double> &source) const
 {
-  return get_field_at_points(source, probes);
+  return probe_evaluation.evaluate(source);
 }
 
 template <int dim>
 void
 TemperatureSolver<dim>::prepare_for_solve()
 {
+  const Profiler::Scope scope(*profiler, "temperature/prepare");
+
   const unsigned int n_dofs = dh.n_dofs();
 
   temperature_update.reinit(n_dofs);
@@ -1593,11 +2259,13 @@ TemperatureSolver<dim>::prepare_for_solve()
   // Apply Dirichlet boundary conditions
   apply_bc1();
 
-  if (!sparsity_pattern.empty() && !system_matrix.empty())
+  // the sparse matrix is not needed for matrix-free Jacobian
+  if (use_matrix_free ||
+      (!sparsity_pattern.empty() && !system_matrix.empty()))
     return;
 
   DynamicSparsityPattern dsp(n_dofs);
-  DoFTools::make_sparsity_pattern(dh, dsp);
+  DoFTools::make_sparsity_pattern(dh, dsp, hanging_node_constraints, false);
 
   sparsity_pattern.copy_from(dsp);
   system_matrix.reinit(sparsity_pattern);
@@ -1644,9 +2312,11 @@ template <int dim>
 void
 TemperatureSolver<dim>::assemble_system()
 {
+  const Profiler::Scope scope(*profiler, "temperature/assemble");
+
   Timer timer;
 
-  std::cout << solver_name() << "  Assembling system";
+  logger.info() << solver_name() << "  Assembling system";
 
   const QGauss<dim> quadrature(
     prm.get_integer("Number of cell quadrature points"));
@@ -1679,7 +2349,7 @@ TemperatureSolver<dim>::assemble_system()
                                      temperature_update,
                                      system_rhs);
 
-  std::cout << " " << format_time(timer) << "\n";
+  logger.info() << " " << format_time(timer) << "\n";
 }
 
 template <int dim>
@@ -1875,14 +2545,12 @@ template <int dim>
 void
 TemperatureSolver<dim>::copy_local_to_global(const AssemblyCopyData &copy_data)
 {
-  for (unsigned int i = 0; i < copy_data.local_dof_indices.size(); ++i)
-    {
-      for (unsigned int j = 0; j < copy_data.local_dof_indices.size(); ++j)
-        system_matrix.add(copy_data.local_dof_indices[i],
-                          copy_data.local_dof_indices[j],
-                          copy_data.cell_matrix(i, j));
-      system_rhs(copy_data.local_dof_indices[i]) += copy_data.cell_rhs(i);
-    }
+  hanging_node_constraints.distribute_local_to_global(
+    copy_data.cell_matrix,
+    copy_data.cell_rhs,
+    copy_data.local_dof_indices,
+    system_matrix,
+    system_rhs);
 }
 
 template <int dim>
@@ -1906,15 +2574,17 @@ template <int dim>
 void
 TemperatureSolver<dim>::solve_system()
 {
+  const Profiler::Scope scope(*profiler, "temperature/linear solve");
+
   Timer timer;
 
-  std::cout << solver_name() << "  Solving system";
+  logger.info() << solver_name() << "  Solving system";
 
   const std::string solver_type = prm.get("Linear solver type");
 
   if (solver_type == "UMFPACK")
     {
-      std::cout << " (" << solver_type << ")";
+      logger.info() << " (" << solver_type << ")";
 
       SparseDirectUMFPACK A;
       A.initialize(system_matrix);
@@ -1930,7 +2600,7 @@ TemperatureSolver<dim>::solve_system()
       const bool log_result  = prm.get_bool("Log convergence final");
 
       if (log_history || log_result)
-        std::cout << "\n";
+        logger.info() << "\n";
 
       IterationNumberControl control(solver_iterations,
                                      solver_tolerance,
@@ -1954,20 +2624,625 @@ TemperatureSolver<dim>::solve_system()
                    system_rhs,
                    preconditioner);
 
+      profiler->add_count("temperature/linear iterations", control.last_step());
+
       if (control.last_step() >= solver_iterations ||
           control.last_value() >= solver_tolerance)
         {
           if (!(log_history || log_result))
-            std::cout << "\n";
+            logger.info() << "\n";
+
+          logger.warning() << solver_name()
+                           << "  Warning: not converged! Residual(0)="
+                           << control.initial_value() << " Residual("
+                           << control.last_step()
+                           << ")=" << control.last_value() << "\n";
+        }
+    }
+
+  logger.info() << " " << format_time(timer) << "\n";
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::assemble_system_matrix_free()
+{
+  const Profiler::Scope scope(*profiler, "temperature/assemble");
+
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+  Timer timer;
+
+  logger.info() << solver_name() << "  Assembling system (matrix-free)";
+
+  if (!jacobian_operator_initialized)
+    {
+      // homogeneous constraints for Newton update
+      std::map<types::global_dof_index, double> boundary_values;
+      for (const auto &bc : bc1_data)
+        {
+          VectorTools::interpolate_boundary_values(dh,
+                                                   bc.first,
+                                                   ZeroFunction<dim>(),
+                                                   boundary_values);
+        }
+
+      AffineConstraints<double> constraints;
+      for (const auto &bv : boundary_values)
+        constraints.add_line(bv.first);
+      constraints.close();
+
+      jacobian_operator.reinit(
+        dh, constraints, prm.get_integer("Number of cell quadrature points"));
+      jacobian_operator_initialized = true;
+    }
+
+  using VectorizedType = VectorizedArray<double>;
+
+  // precalculate constant parameters
+  const double dt     = get_time_step();
+  const double inv_dt = dt == 0 ? 0 : 1 / dt;
+  const double V_z    = calc_V_z();
+
+  const auto local_cell =
+    [&](const MatrixFree<dim, double> &              data,
+        Vector<double> &                             dst,
+        const Vector<double> &                       src,
+        const std::pair<unsigned int, unsigned int> &range) {
+      FEEvaluation<dim, -1, 0, 1, double> T_eval(data);
+      FEEvaluation<dim, -1, 0, 1, double> T_prev_eval(data);
+      FEEvaluation<dim, -1, 0, 1, double> dot_q_eval(data);
+
+      for (unsigned int cell = range.first; cell < range.second; ++cell)
+        {
+          const unsigned int n_lanes =
+            data.n_active_entries_per_cell_batch(cell);
+
+          // BC values are needed, constraints are ignored
+          T_eval.reinit(cell);
+          T_eval.read_dof_values_plain(src);
+          T_eval.evaluate(EvaluationFlags::values | EvaluationFlags::gradients);
+
+          T_prev_eval.reinit(cell);
+          T_prev_eval.read_dof_values_plain(temperature_prev);
+          T_prev_eval.evaluate(EvaluationFlags::values);
+
+          dot_q_eval.reinit(cell);
+          dot_q_eval.read_dof_values_plain(vol_heat_source);
+          dot_q_eval.evaluate(EvaluationFlags::values);
+
+          for (unsigned int q = 0; q < T_eval.n_q_points; ++q)
+            {
+              const VectorizedType T      = T_eval.get_value(q);
+              const auto           grad_T = T_eval.get_gradient(q);
+              const VectorizedType T_prev = T_prev_eval.get_value(q);
+              const VectorizedType dot_q  = dot_q_eval.get_value(q);
+              const VectorizedType r =
+                dim == 2 ? T_eval.quadrature_point(q)[0] :
+                           make_vectorized_array(1.0);
+
+              VectorizedType lambda       = make_vectorized_array(0.0);
+              VectorizedType lambda_deriv = make_vectorized_array(0.0);
+              VectorizedType rho_c_p      = make_vectorized_array(0.0);
+              for (unsigned int v = 0; v < n_lanes; ++v)
+                {
+                  lambda[v]       = calc_lambda(T[v]);
+                  lambda_deriv[v] = calc_derivative_lambda(T[v]);
+                  rho_c_p[v]      = calc_rho_c_p(T[v]);
+                }
+
+              auto &c = jacobian_operator.get_cell_coefficients(cell, q);
+
+              c.lambda        = lambda * r;
+              c.lambda_grad_T = (lambda_deriv * r) * grad_T;
+              c.mass          = inv_dt * rho_c_p * r;
+              c.convection    = rho_c_p * V_z * r;
+
+              T_eval.submit_gradient(-c.lambda * grad_T, q);
+              T_eval.submit_value(-(c.mass * (T - T_prev) +
+                                    c.convection * grad_T[dim - 1] - dot_q * r),
+                                  q);
+            }
+
+          T_eval.integrate(EvaluationFlags::values |
+                           EvaluationFlags::gradients);
+          T_eval.distribute_local_to_global(dst);
+        }
+    };
+
+  const auto local_inner_face =
+    [](const MatrixFree<dim, double> &,
+       Vector<double> &,
+       const Vector<double> &,
+       const std::pair<unsigned int, unsigned int> &) {};
+
+  const auto local_boundary_face =
+    [&](const MatrixFree<dim, double> &              data,
+        Vector<double> &                             dst,
+        const Vector<double> &                       src,
+        const std::pair<unsigned int, unsigned int> &range) {
+      FEFaceEvaluation<dim, -1, 0, 1, double> T_eval(data, true);
+      FEFaceEvaluation<dim, -1, 0, 1, double> q_in_eval(data, true);
+
+      for (unsigned int face = range.first; face < range.second; ++face)
+        {
+          const unsigned int n_lanes =
+            data.n_active_entries_per_face_batch(face);
+
+          // all faces in a batch have the same boundary id
+          const auto boundary_id = data.get_boundary_id(face);
+
+          const auto it_rad  = bc_rad_mixed_data.find(boundary_id);
+          const auto it_conv = bc_convective_data.find(boundary_id);
+
+          const bool has_rad  = it_rad != bc_rad_mixed_data.end();
+          const bool has_conv = it_conv != bc_convective_data.end();
+
+          T_eval.reinit(face);
+
+          if (!has_rad && !has_conv)
+            {
+              for (unsigned int q = 0; q < T_eval.n_q_points; ++q)
+                jacobian_operator.get_face_coefficient(face, q) =
+                  make_vectorized_array(0.0);
+              continue;
+            }
+
+          T_eval.read_dof_values_plain(src);
+          T_eval.evaluate(EvaluationFlags::values);
+
+          if (has_rad)
+            {
+              q_in_eval.reinit(face);
+              q_in_eval.read_dof_values_plain(it_rad->second.q_in);
+              q_in_eval.evaluate(EvaluationFlags::values);
+            }
+
+          for (unsigned int q = 0; q < T_eval.n_q_points; ++q)
+            {
+              const VectorizedType T = T_eval.get_value(q);
+              const VectorizedType r =
+                dim == 2 ? T_eval.quadrature_point(q)[0] :
+                           make_vectorized_array(1.0);
+
+              VectorizedType derivative_heat_flux = make_vectorized_array(0.0);
+              VectorizedType net_heat_flux        = make_vectorized_array(0.0);
+
+              if (has_rad)
+                {
+                  const auto &         data_rad = it_rad->second;
+                  const VectorizedType q_in     = q_in_eval.get_value(q);
+                  const double T_amb_4 = std::pow(data_rad.T_amb, 4);
+
+                  for (unsigned int v = 0; v < n_lanes; ++v)
+                    {
+                      const double e   = data_rad.emissivity(T[v]);
+                      const double T_3 = std::pow(T[v], 3);
+
+                      net_heat_flux[v] +=
+                        sigma_SB * e * (T_3 * T[v] - T_amb_4) - q_in[v];
+                      derivative_heat_flux[v] +=
+                        sigma_SB *
+                        (e * 4.0 * T_3 + data_rad.emissivity_deriv(T[v]) *
+                                           (T_3 * T[v] - T_amb_4));
+                    }
+                }
+
+              if (has_conv)
+                {
+                  const double h     = it_conv->second.h;
+                  const double T_ref = it_conv->second.T_ref;
+
+                  net_heat_flux += h * (T - T_ref);
+                  derivative_heat_flux += make_vectorized_array(h);
+                }
+
+              jacobian_operator.get_face_coefficient(face, q) =
+                derivative_heat_flux * r;
+
+              T_eval.submit_value(-net_heat_flux * r, q);
+            }
+
+          T_eval.integrate(EvaluationFlags::values);
+          T_eval.distribute_local_to_global(dst);
+        }
+    };
+
+  // explicit template arguments for conversion of lambdas to std::function
+  jacobian_operator.get_matrix_free()
+    .template loop<Vector<double>, Vector<double>>(local_cell,
+                                                   local_inner_face,
+                                                   local_boundary_face,
+                                                   system_rhs,
+                                                   temperature,
+                                                   true);
+
+  jacobian_operator.compute_diagonal();
+
+  logger.info() << " " << format_time(timer) << "\n";
+#endif
+}
+
+template <int dim>
+void
+TemperatureSolver<dim>::solve_system_matrix_free()
+{
+  const Profiler::Scope scope(*profiler, "temperature/linear solve");
+
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+  Timer timer;
+
+  logger.info() << solver_name() << "  Solving system (matrix-free)";
+
+  const std::string solver_type = prm.get("Linear solver type");
+
+  const unsigned int solver_iterations =
+    prm.get_integer("Linear solver iterations");
+  const double solver_tolerance = prm.get_double("Linear solver tolerance");
+
+  const bool log_history = prm.get_bool("Log convergence full");
+  const bool log_result  = prm.get_bool("Log convergence final");
+
+  if (log_history || log_result)
+    logger.info() << "\n";
+
+  IterationNumberControl control(solver_iterations,
+                                 solver_tolerance,
+                                 log_history,
+                                 log_result);
+
+  SolverSelector<> solver;
+  solver.select(solver_type);
+  solver.set_control(control);
+
+  const double preconditioner_relaxation =
+    prm.get_double("Preconditioner relaxation");
+
+  auto inverse_diagonal = std::make_shared<DiagonalMatrix<Vector<double>>>();
+  inverse_diagonal->get_vector() = jacobian_operator.get_diagonal();
+  for (auto &x : inverse_diagonal->get_vector())
+    x = preconditioner_relaxation / x;
+
+  prm.enter_subsection("Matrix-free");
+  const std::string preconditioner_type = prm.get("Preconditioner type");
+  const unsigned int chebyshev_degree = prm.get_integer("Chebyshev degree");
+  const double chebyshev_range = prm.get_double("Chebyshev smoothing range");
+  prm.leave_subsection();
+
+  if (preconditioner_type == "chebyshev")
+    {
+      using Preconditioner =
+        PreconditionChebyshev<TemperatureJacobianOperator<dim>, Vector<double>>;
+
+      typename Preconditioner::AdditionalData data;
+      data.degree          = chebyshev_degree;
+      data.smoothing_range = chebyshev_range;
+      data.preconditioner  = inverse_diagonal;
+
+      Preconditioner preconditioner;
+      preconditioner.initialize(jacobian_operator, data);
+
+      solver.solve(jacobian_operator,
+                   temperature_update,
+                   system_rhs,
+                   preconditioner);
+    }
+  else
+    {
+      solver.solve(jacobian_operator,
+                   temperature_update,
+                   system_rhs,
+                   *inverse_diagonal);
+    }
+
+  profiler->add_count("temperature/linear iterations", control.last_step());
+
+  if (control.last_step() >= solver_iterations ||
+      control.last_value() >= solver_tolerance)
+    {
+      if (!(log_history || log_result))
+        logger.info() << "\n";
+
+      logger.warning() << solver_name()
+                       << "  Warning: not converged! Residual(0)="
+                       << control.initial_value() << " Residual("
+                       << control.last_step() << ")=" << control.last_value()
+                       << "\n";
+    }
+
+  logger.info() << " " << format_time(timer) << "\n";
+#endif
+}
+
+#if DEAL_II_VERSION_GTE(9, 3, 0)
+// TemperatureJacobianOperator
+
+template <int dim>
+TemperatureJacobianOperator<dim>::TemperatureJacobianOperator()
+  : n_q_points_cell(0)
+  , n_q_points_face(0)
+{}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::reinit(
+  const DoFHandler<dim> &          dof_handler,
+  const AffineConstraints<double> &constraints,
+  const unsigned int               n_q_points_1d)
+{
+  typename MatrixFree<dim, double>::AdditionalData data;
+  data.mapping_update_flags = update_values | update_gradients |
+                              update_JxW_values | update_quadrature_points;
+  data.mapping_update_flags_boundary_faces =
+    update_values | update_JxW_values | update_quadrature_points;
+
+  matrix_free.reinit(mapping,
+                     dof_handler,
+                     constraints,
+                     QGauss<1>(n_q_points_1d),
+                     data);
+
+  constrained_dofs.clear();
+  for (types::global_dof_index i = 0; i < dof_handler.n_dofs(); ++i)
+    {
+      if (constraints.is_constrained(i))
+        constrained_dofs.push_back(i);
+    }
+
+  n_q_points_cell = Utilities::pow(n_q_points_1d, dim);
+  n_q_points_face = Utilities::pow(n_q_points_1d, dim - 1);
+
+  cell_coefficients.resize(matrix_free.n_cell_batches() * n_q_points_cell);
+  face_coefficients.resize(matrix_free.n_boundary_face_batches() *
+                           n_q_points_face);
+
+  diagonal.reinit(dof_handler.n_dofs());
+}
+
+template <int dim>
+const MatrixFree<dim, double> &
+TemperatureJacobianOperator<dim>::get_matrix_free() const
+{
+  return matrix_free;
+}
+
+template <int dim>
+typename TemperatureJacobianOperator<dim>::CellCoefficients &
+TemperatureJacobianOperator<dim>::get_cell_coefficients(const unsigned int cell,
+                                                        const unsigned int q)
+{
+  AssertIndexRange(cell * n_q_points_cell + q, cell_coefficients.size());
+
+  return cell_coefficients[cell * n_q_points_cell + q];
+}
+
+template <int dim>
+typename TemperatureJacobianOperator<dim>::VectorizedType &
+TemperatureJacobianOperator<dim>::get_face_coefficient(const unsigned int face,
+                                                       const unsigned int q)
+{
+  const unsigned int k =
+    (face - matrix_free.n_inner_face_batches()) * n_q_points_face + q;
+
+  AssertIndexRange(k, face_coefficients.size());
+
+  return face_coefficients[k];
+}
+
+template <int dim>
+types::global_dof_index
+TemperatureJacobianOperator<dim>::m() const
+{
+  return diagonal.size();
+}
+
+template <int dim>
+types::global_dof_index
+TemperatureJacobianOperator<dim>::n() const
+{
+  return diagonal.size();
+}
 
-          std::cout << solver_name() << "  Warning: not converged! Residual(0)="
-                    << control.initial_value() << " Residual("
-                    << control.last_step() << ")=" << control.last_value()
-                    << "\n";
+template <int dim>
+double
+TemperatureJacobianOperator<dim>::el(const types::global_dof_index i,
+                                     const types::global_dof_index j) const
+{
+  Assert(i == j, ExcNotImplemented());
+  (void)j;
+
+  return diagonal(i);
+}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::vmult(Vector<double> &      dst,
+                                        const Vector<double> &src) const
+{
+  matrix_free.loop(&TemperatureJacobianOperator::local_apply_cell,
+                   &TemperatureJacobianOperator::local_apply_inner_face,
+                   &TemperatureJacobianOperator::local_apply_boundary_face,
+                   this,
+                   dst,
+                   src,
+                   true);
+
+  for (const auto i : constrained_dofs)
+    dst(i) = src(i);
+}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::compute_diagonal()
+{
+  const auto local_cell =
+    [&](const MatrixFree<dim, double> &data,
+        Vector<double> &               dst,
+        const Vector<double> &,
+        const std::pair<unsigned int, unsigned int> &range) {
+      FEEvaluation<dim, -1, 0, 1, double> phi(data);
+      std::vector<VectorizedType>         local_diagonal(phi.dofs_per_cell);
+
+      for (unsigned int cell = range.first; cell < range.second; ++cell)
+        {
+          phi.reinit(cell);
+
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            {
+              for (unsigned int j = 0; j < phi.dofs_per_cell; ++j)
+                phi.begin_dof_values()[j] = make_vectorized_array(0.0);
+              phi.begin_dof_values()[i] = make_vectorized_array(1.0);
+
+              do_cell_operation(phi, cell);
+
+              local_diagonal[i] = phi.begin_dof_values()[i];
+            }
+
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            phi.begin_dof_values()[i] = local_diagonal[i];
+          phi.distribute_local_to_global(dst);
+        }
+    };
+
+  const auto local_inner_face =
+    [](const MatrixFree<dim, double> &,
+       Vector<double> &,
+       const Vector<double> &,
+       const std::pair<unsigned int, unsigned int> &) {};
+
+  const auto local_boundary_face =
+    [&](const MatrixFree<dim, double> &data,
+        Vector<double> &               dst,
+        const Vector<double> &,
+        const std::pair<unsigned int, unsigned int> &range) {
+      FEFaceEvaluation<dim, -1, 0, 1, double> phi(data, true);
+      std::vector<VectorizedType>             local_diagonal(phi.dofs_per_cell);
+
+      for (unsigned int face = range.first; face < range.second; ++face)
+        {
+          phi.reinit(face);
+
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            {
+              for (unsigned int j = 0; j < phi.dofs_per_cell; ++j)
+                phi.begin_dof_values()[j] = make_vectorized_array(0.0);
+              phi.begin_dof_values()[i] = make_vectorized_array(1.0);
+
+              do_face_operation(phi, face);
+
+              local_diagonal[i] = phi.begin_dof_values()[i];
+            }
+
+          for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            phi.begin_dof_values()[i] = local_diagonal[i];
+          phi.distribute_local_to_global(dst);
         }
+    };
+
+  const Vector<double> dummy;
+  matrix_free.template loop<Vector<double>, Vector<double>>(local_cell,
+                                                            local_inner_face,
+                                                            local_boundary_face,
+                                                            diagonal,
+                                                            dummy,
+                                                            true);
+
+  for (const auto i : constrained_dofs)
+    diagonal(i) = 1;
+}
+
+template <int dim>
+const Vector<double> &
+TemperatureJacobianOperator<dim>::get_diagonal() const
+{
+  return diagonal;
+}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::do_cell_operation(
+  FEEvaluation<dim, -1, 0, 1, double> &phi,
+  const unsigned int                   cell) const
+{
+  phi.evaluate(EvaluationFlags::values | EvaluationFlags::gradients);
+
+  const CellCoefficients *c = &cell_coefficients[cell * n_q_points_cell];
+
+  for (unsigned int q = 0; q < phi.n_q_points; ++q)
+    {
+      const VectorizedType v      = phi.get_value(q);
+      const auto           grad_v = phi.get_gradient(q);
+
+      phi.submit_gradient(c[q].lambda * grad_v + c[q].lambda_grad_T * v, q);
+      phi.submit_value(c[q].mass * v + c[q].convection * grad_v[dim - 1], q);
+    }
+
+  phi.integrate(EvaluationFlags::values | EvaluationFlags::gradients);
+}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::do_face_operation(
+  FEFaceEvaluation<dim, -1, 0, 1, double> &phi,
+  const unsigned int                       face) const
+{
+  phi.evaluate(EvaluationFlags::values);
+
+  const VectorizedType *c =
+    &face_coefficients[(face - matrix_free.n_inner_face_batches()) *
+                       n_q_points_face];
+
+  for (unsigned int q = 0; q < phi.n_q_points; ++q)
+    phi.submit_value(c[q] * phi.get_value(q), q);
+
+  phi.integrate(EvaluationFlags::values);
+}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::local_apply_cell(
+  const MatrixFree<dim, double> &              data,
+  Vector<double> &                             dst,
+  const Vector<double> &                       src,
+  const std::pair<unsigned int, unsigned int> &range) const
+{
+  FEEvaluation<dim, -1, 0, 1, double> phi(data);
+
+  for (unsigned int cell = range.first; cell < range.second; ++cell)
+    {
+      phi.reinit(cell);
+      phi.read_dof_values(src);
+      do_cell_operation(phi, cell);
+      phi.distribute_local_to_global(dst);
     }
+}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::local_apply_inner_face(
+  const MatrixFree<dim, double> &,
+  Vector<double> &,
+  const Vector<double> &,
+  const std::pair<unsigned int, unsigned int> &) const
+{}
+
+template <int dim>
+void
+TemperatureJacobianOperator<dim>::local_apply_boundary_face(
+  const MatrixFree<dim, double> &              data,
+  Vector<double> &                             dst,
+  const Vector<double> &                       src,
+  const std::pair<unsigned int, unsigned int> &range) const
+{
+  FEFaceEvaluation<dim, -1, 0, 1, double> phi(data, true);
 
-  std::cout << " " << format_time(timer) << "\n";
+  for (unsigned int face = range.first; face < range.second; ++face)
+    {
+      phi.reinit(face);
+      phi.read_dof_values(src);
+      do_face_operation(phi, face);
+      phi.distribute_local_to_global(dst);
+    }
 }
+#endif
 
-#endif
\ No newline at end of file
+#endif
@@ -3,37 +3,99 @@
 
 #include <deal.II/base/function_lib.h>
 #include <deal.II/base/function_parser.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parallel.h>
 #include <deal.II/base/point.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/thread_management.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/work_stream.h>
 
+#include <deal.II/dofs/dof_handler.h>
 #include <deal.II/dofs/dof_tools.h>
 
+#include <deal.II/fe/fe_q.h>
 #include <deal.II/fe/fe_tools.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/fe/mapping_q1.h>
 
+#include <deal.II/grid/grid_refinement.h>
+#include <deal.II/grid/grid_tools.h>
+#if DEAL_II_VERSION_GTE(9, 2, 0)
+#  include <deal.II/grid/grid_tools_cache.h>
+#endif
+
+#include <deal.II/lac/block_sparse_matrix.h>
+#include <deal.II/lac/block_vector.h>
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
 #if !DEAL_II_VERSION_GTE(9, 1, 0)
+#  include <deal.II/lac/constraint_matrix.h>
 #  include <deal.II/lac/filtered_matrix.h>
 #else
+#  include <deal.II/lac/affine_constraints.h>
 #  include <deal.II/lac/constrained_linear_operator.h>
 #endif
+#include <deal.II/lac/precondition.h>
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/sparse_direct.h>
+#include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/vector.h>
 
+#include <deal.II/numerics/data_out.h>
 #include <deal.II/numerics/matrix_tools.h>
+#include <deal.II/numerics/solution_transfer.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include <sys/stat.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define MACPLAS_HAVE_MMAP
+#endif
+
+#ifdef DEAL_II_WITH_ZLIB
+#  include <zlib.h>
+#endif
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <streambuf>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace dealii;
 
+/** Hanging node constraints of locally refined meshes
+ */
+#if DEAL_II_VERSION_GTE(9, 1, 0)
+using HangingNodeConstraints = AffineConstraints<double>;
+#else
+using HangingNodeConstraints = ConstraintMatrix;
+#endif
+
 // helper functions
 
 /** Calculate the square \f$x^2\f$
@@ -54,6 +116,13 @@ output_data_vector(const Vector<double> &data,
                    const std::string &   name,
                    DataOut<dim> &        data_out);
 
+/** Evaluate \c f at all values of \c x in parallel.
+ * @returns vector of \f$f(x_i)\f$
+ */
+template <typename F>
+inline Vector<double>
+evaluate_pointwise(const Vector<double> &x, const F &f);
+
 /** Convert string to a vector of double
  */
 inline std::vector<double>
@@ -122,6 +191,18 @@ template <typename T>
 inline void
 write_data(const T &data, const std::string &file_name);
 
+class BackgroundWriter;
+
+class Profiler;
+
+/** Same as above, a copy of \c data is saved by \c writer
+ */
+template <typename T>
+inline void
+write_data(const T &          data,
+           const std::string &file_name,
+           BackgroundWriter & writer);
+
 /** Load data (\c Vector, \c BlockVector) from disk.
  * Internally calls \c block_read
  */
@@ -129,6 +210,74 @@ template <typename T>
 inline void
 read_data(T &data, const std::string &file_name);
 
+/** Identity of the contents of a file, see file_signature
+ */
+struct FileSignature
+{
+  /** Modification time, ns
+   */
+  long long mtime = 0;
+
+  /** Status change time, ns
+   */
+  long long ctime = 0;
+
+  /** Size, bytes
+   */
+  long long size = 0;
+
+  /** Device and inode numbers, change if the file is replaced
+   */
+  unsigned long long device = 0, inode = 0;
+
+  /** Hash of the contents
+   */
+  std::uint64_t hash = 0;
+
+  /** Returns \c true if all members are equal
+   */
+  inline bool
+  operator==(const FileSignature &other) const;
+
+  /** Returns \c true if any member differs
+   */
+  inline bool
+  operator!=(const FileSignature &other) const;
+};
+
+/** Modification and status change times, size, device and inode numbers and
+ * the hash of the contents of a file, used to detect changes of input files.
+ * The file system timestamps come from a coarse clock, the hash detects a
+ * file rewritten in place with the same size within one clock tick. All
+ * members are zero if the file does not exist.
+ */
+inline FileSignature
+file_signature(const std::string &file_name);
+
+/** Hash of the sparsity pattern and values of \c matrix combined with
+ * \c seed, e.g. to detect an unchanged matrix without storing a copy
+ */
+inline std::uint64_t
+matrix_hash(const SparseMatrix<double> &matrix, const std::uint64_t seed = 0);
+
+/** Deterministic pseudo-random sign (\f$\pm 1\f$) of index \c i, e.g. for
+ * probe vectors of randomized norm estimates
+ */
+inline double
+random_sign(const std::uint64_t i);
+
+/** Encode \c n bytes of \c data in base64
+ */
+inline std::string
+base64_encode(const char *data, const std::size_t n);
+
+/** Decode base64 text <tt>[begin,end)</tt> and append the bytes to \c out.
+ * Whitespace is skipped, concatenated separately padded blocks (e.g. the
+ * header and data of compressed \c vtu arrays) are supported.
+ */
+inline void
+base64_decode(const char *begin, const char *end, std::vector<char> &out);
+
 /** Count boundary faces
  */
 template <int dim>
@@ -160,6 +309,35 @@ output_boundary_field_at_quadrature_points(
   const unsigned int     boundary_id = 0,
   const std::string &    file_name   = "values_q.txt");
 
+/** Calculate the hanging node constraints of \c dh, empty if the mesh has
+ * no hanging nodes
+ */
+template <int dim>
+inline void
+calculate_hanging_node_constraints(const DoFHandler<dim> & dh,
+                                   HangingNodeConstraints &constraints);
+
+/** Flag the cells with the largest errors for refinement and the cells with
+ * the smallest errors for coarsening, such that they account for the given
+ * fractions of the total error. Cells at \c max_level are not refined further
+ * (0 - no limit).
+ */
+template <int dim>
+inline void
+mark_cells_for_refinement(Triangulation<dim> &triangulation,
+                          const Vector<float> &error,
+                          const double         refine_fraction,
+                          const double         coarsen_fraction,
+                          const unsigned int   max_level = 0);
+
+/** Copy the refinement and coarsening flags to a mesh with the same cells,
+ * e.g. created by \c copy_triangulation, so that both meshes stay identical
+ */
+template <int dim>
+inline void
+copy_refinement_flags(const Triangulation<dim> &source,
+                      Triangulation<dim> &      target);
+
 /** Get point on a line segment which is closest to the given point \f$p\f$
  */
 template <int dim>
@@ -178,6 +356,92 @@ barycentric_coordinates(const Point<dim> &p,
 
 // helper classes
 
+/** Piecewise linear approximation of a function of one variable.
+ * The function is tabulated on a uniform grid of \c n points in
+ * \f$[x_\min, x_\max]\f$, outside this range (or if the table is empty) the
+ * original function is evaluated. Used for fast and thread-safe evaluation
+ * of temperature-dependent material properties given as \c FunctionParser.
+ */
+class TabulatedFunction : public Function<1>
+{
+public:
+  /** Constructor, creates an empty table
+   */
+  inline TabulatedFunction();
+
+  /** Tabulate function \c f. The function must outlive the table.
+   * No table is created if \f$n<2\f$, all values are then calculated by \c f.
+   */
+  inline void
+  initialize(const Function<1> &f,
+             const double       x_min,
+             const double       x_max,
+             const unsigned int n);
+
+  /** Returns \c true if no table is present
+   */
+  inline bool
+  empty() const;
+
+  /** Get lower bound \f$x_\min\f$
+   */
+  inline double
+  get_x_min() const;
+
+  /** Get upper bound \f$x_\max\f$
+   */
+  inline double
+  get_x_max() const;
+
+  /** Get tabulated values, empty if no table is present
+   */
+  inline const std::vector<double> &
+  get_table() const;
+
+  /** Get value at \f$x\f$
+   */
+  inline double
+  value(const double x) const;
+
+  /** Same as above, for \c Function<1> interface
+   */
+  inline virtual double
+  value(const Point<1> &p, const unsigned int component = 0) const override;
+
+  /** Get values at a batch of points
+   */
+  inline virtual void
+  value_list(const std::vector<Point<1>> &points,
+             std::vector<double> &        values,
+             const unsigned int           component = 0) const override;
+
+  /** Same as above, for \c double arguments
+   */
+  inline void
+  value_list(const std::vector<double> &x, std::vector<double> &values) const;
+
+private:
+  /** Original function
+   */
+  SmartPointer<const Function<1>> f;
+
+  /** Lower bound \f$x_\min\f$
+   */
+  double x_min;
+
+  /** Upper bound \f$x_\max\f$
+   */
+  double x_max;
+
+  /** Inverse of the grid step, \f$1/\Delta x\f$
+   */
+  double inv_dx;
+
+  /** Tabulated values
+   */
+  std::vector<double> table;
+};
+
 /** Class for storing and quering geometrical information of a single triangle
  */
 template <int dim>
@@ -261,2199 +525,7153 @@ private:
 };
 
 
-/** Class for interpolation of 3D surface fields from external data.
- * Used for interpolation of boundary conditions to the simulation mesh.
- * The source cell or point data are defined on a triangulated surface.
+/** Precalculated transfer operator for interpolation of surface fields.
+ * For each target point the source indices and weights are stored, so that
+ * the interpolation of any field reduces to a sparse gather-multiply.
+ * Created by SurfaceInterpolator3D::create_plan and
+ * SurfaceInterpolator2D::create_plan.
  */
-class SurfaceInterpolator3D
+template <int dim>
+class InterpolationPlan
 {
-private:
-  /** Only 3D meshes are supported
-   */
-  constexpr static unsigned int dim = 3;
-
 public:
-  /** Field type
+  /** Constructor, creates an empty plan
    */
-  enum FieldType
-  {
-    CellField, ///< Cell field
-    PointField ///< Point field
-  };
+  inline InterpolationPlan();
 
-  /** Read mesh and fields from \c vtk file
+  /** Delete all data
    */
   inline void
-  read_vtk(const std::string &file_name);
+  clear();
 
-  /** Read mesh and fields from \c vtu file
+  /** Returns \c true if the plan has not been created
    */
-  inline void
-  read_vtu(const std::string &file_name);
+  inline bool
+  empty() const;
 
-  /** Write mesh and fields to \c vtu file
+  /** Start a new plan for the given target points and source data
    */
   inline void
-  write_vtu(const std::string &file_name) const;
+  reinit(const std::vector<Point<dim>> &target_points,
+         const std::vector<bool> &      markers,
+         const unsigned long            source_revision,
+         const unsigned int             source_type = 0);
 
-  /** Interpolate field to the specified points
+  /** Add the contribution \f$w f_j\f$ of source value \f$j\f$ to target
+   * value \f$i\f$
    */
   inline void
-  interpolate(const FieldType &              field_type,
-              const std::string &            field_name,
-              const std::vector<Point<dim>> &target_points,
-              const std::vector<bool> &      markers,
-              Vector<double> &               target_values) const;
+  add(const unsigned int i, const unsigned int j, const double w);
 
-  /** Same as above, for target points in 2D
+  /** Returns \c true if the plan was created for the same target points,
+   * markers and source data. Any change of the target point coordinates (e.g.
+   * due to mesh motion) invalidates the plan.
    */
-  inline void
-  interpolate(const FieldType &                  field_type,
-              const std::string &                field_name,
-              const std::vector<Point<dim - 1>> &target_points,
-              const std::vector<bool> &          markers,
-              Vector<double> &                   target_values) const;
+  inline bool
+  matches(const std::vector<Point<dim>> &target_points,
+          const std::vector<bool> &      markers,
+          const unsigned long            source_revision,
+          const unsigned int             source_type = 0) const;
 
-  /** Convert between cell and point fields.
-   * If target_name is not specified it is set to source_name.
+  /** Calculate target values from the source field values
    */
   inline void
-  convert(const FieldType &  source_type,
-          const std::string &source_name,
-          const FieldType &  target_type,
-          const std::string &target_name = "");
+  apply(const std::vector<double> &source_field,
+        Vector<double> &           target_values) const;
 
-  /** Returns \c true if no data is present
+  /** Revision of the source data the plan was created for
    */
-  inline bool
-  empty() const;
+  inline unsigned long
+  get_source_revision() const;
+
+  /** Type of the source field the plan was created for
+   */
+  inline unsigned int
+  get_source_type() const;
+
+  /** Get a new unique revision number.
+   * Interpolators change their revision each time the source mesh is
+   * modified, which invalidates all existing plans.
+   */
+  inline static unsigned long
+  new_revision();
 
 private:
-  /** Points \c (x,y,z)
+  /** Target points for which the plan was created
    */
-  std::vector<Point<dim>> points;
+  std::vector<Point<dim>> m_target_points;
 
-  /** Connectivity matrix \c (v0,v1,v2) - only triangles
+  /** Target point markers for which the plan was created
    */
-  std::vector<std::array<unsigned long, 3>> triangles;
+  std::vector<bool> m_markers;
 
-  /** Fields defined on cells
+  /** Revision of the source data
    */
-  std::map<std::string, std::vector<double>> cell_fields;
+  unsigned long m_source_revision;
 
-  /** Fields defined on points
+  /** Type of the source field
    */
-  std::map<std::string, std::vector<double>> point_fields;
+  unsigned int m_source_type;
 
-  /** Vector fields defined on cells
+  /** Target value indices \f$i\f$
    */
-  std::map<std::string, std::vector<Point<dim>>> cell_vector_fields;
+  std::vector<unsigned int> m_target_indices;
 
-  /** Precalculated triangle areas, normals, centers etc.
+  /** Source value indices \f$j\f$
    */
-  std::vector<Triangle<dim>> triangle_cache;
+  std::vector<unsigned int> m_source_indices;
 
+  /** Weights \f$w\f$
+   */
+  std::vector<double> m_weights;
+};
 
-  /** Get field
+
+/** Read-only view of the contents of a file. The file is memory-mapped if
+ * supported by the system, otherwise it is read into memory. Used for
+ * parsing large input files without copying them to a stream.
+ */
+class MappedFile
+{
+public:
+  /** Constructor, opens the file
    */
-  inline const std::vector<double> &
-  field(const FieldType &field_type, const std::string &field_name) const;
+  inline explicit MappedFile(const std::string &file_name);
 
-  /** Get field
+  /** Destructor, unmaps the file
    */
-  inline std::vector<double> &
-  field(const FieldType &field_type, const std::string &field_name);
+  inline ~MappedFile();
 
-  /** Get vector field
+  /** Not copyable, the mapping is owned by the object
    */
-  inline const std::vector<Point<dim>> &
-  vector_field(const FieldType &  field_type,
-               const std::string &field_name) const;
+  MappedFile(const MappedFile &) = delete;
 
-  /** Convert cell field to point field
+  MappedFile &
+  operator=(const MappedFile &) = delete;
+
+  /** Returns \c true if the file could be opened
    */
-  inline void
-  cell_to_point(const std::string &source_name, const std::string &target_name);
+  inline bool
+  is_open() const;
 
-  /** Convert point field to cell field
+  /** Beginning of the file contents
    */
-  inline void
-  point_to_cell(const std::string &source_name, const std::string &target_name);
+  inline const char *
+  begin() const;
 
-  /** Clear all data
+  /** End of the file contents
    */
-  inline void
-  clear();
+  inline const char *
+  end() const;
 
-  /** Print mesh and field information
+  /** File size, bytes
    */
-  inline void
-  info() const;
+  inline std::size_t
+  size() const;
 
-  /** Precalculate auxiliary data (cell areas, centers, normals)
+private:
+  /** File contents, mapped or in \c buffer
    */
-  inline void
-  preprocess();
-};
+  const char *data;
 
-/** Helper error message for failed interpolation
- */
-template <int dim>
-DeclException1(ExcInterpolationFailed,
-               Point<dim>,
-               << "Interpolation at point " << arg1 << " failed.");
+  /** File size
+   */
+  std::size_t n_bytes;
 
-/** Class for interpolation of 2D surface fields from external data.
- * Used for interpolation of boundary conditions to the simulation mesh.
- * The source point data are defined on a polyline.
+  /** Whether the file is mapped to memory
+   */
+  bool mapped;
+
+  /** Whether the file could be opened
+   */
+  bool opened;
+
+  /** File contents if memory mapping is not available
+   */
+  std::string buffer;
+};
+
+/** Parser of whitespace-separated text in a memory buffer, e.g. of
+ * MappedFile. Numbers are converted directly from the buffer, which is much
+ * faster than reading from a stream.
  */
-class SurfaceInterpolator2D
+class TextParser
 {
-private:
-  /** Only 2D meshes are supported
+public:
+  /** Constructor, parses <tt>[begin,end)</tt>
    */
-  constexpr static unsigned int dim = 2;
+  inline TextParser(const char *begin, const char *end);
 
-public:
-  /** Read mesh and fields from plain text file
+  /** Returns \c true if only whitespace is left
    */
-  inline void
-  read_txt(const std::string &file_name);
+  inline bool
+  at_end();
 
-  /** Set mesh
+  /** Get the next line, skipping empty ones.
+   * @returns \c false if the end is reached
    */
-  inline void
-  set_points(const std::vector<Point<dim>> &new_points);
+  inline bool
+  get_line(TextParser &line);
 
-  inline void
-  set_points(const std::vector<Point<dim + 1>> &new_points);
+  /** Get the next token, empty if the end is reached
+   */
+  inline std::string
+  get_token();
 
-  /** Get mesh
+  /** Get the next token as a number, throws an exception if it is missing
+   * or not a number
    */
-  inline const std::vector<Point<dim>> &
-  get_points() const;
+  inline double
+  get_double();
 
-  /** Get all field names, not necessarily in the original order
+  /** Same as above, for integers
    */
-  inline const std::vector<std::string>
-  get_field_names() const;
+  inline unsigned long
+  get_ulong();
 
-  /** Interpolate field to the specified points
+private:
+  /** Skip whitespace (including newlines)
    */
   inline void
-  interpolate(const std::string &            field_name,
-              const std::vector<Point<dim>> &target_points,
-              const std::vector<bool> &      markers,
-              Vector<double> &               target_values) const;
+  skip_whitespace();
 
-  /** Same as above, for target points in 3D
+  /** Find the next token <tt>[begin,end)</tt>
    */
   inline void
-  interpolate(const std::string &                field_name,
-              const std::vector<Point<dim + 1>> &target_points,
-              const std::vector<bool> &          markers,
-              Vector<double> &                   target_values) const;
+  next_token(const char *&begin, const char *&end);
 
-  /** Project a specific point onto the mesh
+  /** Current position
    */
-  inline Point<dim>
-  project(const Point<dim> &p) const;
+  const char *position;
 
-  /** Returns \c true if no data is present
+  /** End of the buffer
    */
-  inline bool
-  empty() const;
+  const char *buffer_end;
+};
 
-private:
-  /** Points \c (x,y)
+/** Process-wide cache of objects read from files, e.g. interpolators of
+ * large boundary data reloaded by every run of a parameter sweep. An entry
+ * is only used if the signature of the file (file_signature: timestamps,
+ * size, inode and contents) has not changed since it was read. The cache
+ * keeps up to 8 files by default, see FileCache::set_capacity.
+ * Thread-safe.
+ */
+template <typename T>
+class FileCache
+{
+public:
+  /** Copy the cached object of \c file_name to \c object.
+   * @returns \c false if not cached or the file has changed
    */
-  std::vector<Point<dim>> points;
-
-  /** Fields defined on points
+  static bool
+  get(const std::string &  file_name,
+      const FileSignature &signature,
+      T &                  object);
+
+  /** Cache a copy of \c object read from \c file_name with the given
+   * signature (obtained before reading, so that changes during reading are
+   * detected), the least recently used entry is dropped if the cache is full.
+   * Nothing is copied if caching is disabled.
    */
-  std::map<std::string, std::vector<double>> fields;
+  static void
+  add(const std::string &  file_name,
+      const FileSignature &signature,
+      const T &            object);
 
-  /** Get field
+  /** Set the maximal number of cached files (0 - disable caching),
+   * default 8
    */
-  inline const std::vector<double> &
-  field(const std::string &field_name) const;
+  static void
+  set_capacity(const unsigned int n);
 
-  /** Clear all data
+  /** Remove all entries
    */
-  inline void
+  static void
   clear();
 
-  /** Print mesh and field information
+private:
+  /** Cached object
    */
-  inline void
-  info() const;
-};
+  struct Entry
+  {
+    FileSignature            signature;
+    std::shared_ptr<const T> object;
+    unsigned long            last_use;
+  };
 
+  /** Entries and their synchronization, map key: file name
+   */
+  struct Data
+  {
+    std::mutex                   mutex;
+    std::map<std::string, Entry> entries;
+    unsigned int                 capacity = 8;
+    unsigned long                counter  = 0;
+  };
 
-/** Class for calculating field gradients
+  /** Single instance of the cache data
+   */
+  static Data &
+  data();
+};
+
+/** Class for interpolation of 3D surface fields from external data.
+ * Used for interpolation of boundary conditions to the simulation mesh.
+ * The source cell or point data are defined on a triangulated surface.
  */
-template <int dim>
-class DoFGradientEvaluation
+class SurfaceInterpolator3D
 {
+private:
+  /** Only 3D meshes are supported
+   */
+  constexpr static unsigned int dim = 3;
+
 public:
-  /** Delete all data
+  /** Field type
+   */
+  enum FieldType
+  {
+    CellField, ///< Cell field
+    PointField ///< Point field
+  };
+
+  /** Data format of \c vtu files
+   */
+  enum VTUFormat
+  {
+    AsciiVTU,      ///< Plain text
+    BinaryVTU,     ///< Base64-encoded binary data
+    CompressedVTU, ///< zlib-compressed, base64-encoded binary data
+    AppendedVTU    ///< Raw binary data appended to the XML, fastest to read
+  };
+
+  /** Constructor, creates an empty interpolator
+   */
+  inline SurfaceInterpolator3D();
+
+  /** Read mesh and fields from \c vtk file (ASCII). Unchanged files are
+   * taken from FileCache.
    */
   inline void
-  clear();
+  read_vtk(const std::string &file_name);
 
-  /** Add a FE field
+  /** Read mesh and fields from \c vtu file in any VTUFormat (all data
+   * arrays of one file in the same format). Unchanged files are taken from
+   * FileCache.
    */
   inline void
-  add_field(const std::string &name, const Vector<double> &field);
+  read_vtu(const std::string &file_name);
 
-  /** Attach a DoF handler corresponding to the added FE fields
+  /** Write mesh and fields to \c vtu file
    */
   inline void
-  attach_dof_handler(const DoFHandler<dim> &dof_handler);
+  write_vtu(const std::string &file_name,
+            const VTUFormat    format = AsciiVTU) const;
 
-  /** Calculate gradients of all fields.
-   * Currently only extrapolation from quadrature points is implemented
-   * (see StressSolver::recover_strain_extrapolation).
-   * @param n_quadrature_points number of QGauss quadrature points. The default
-   * value of 0 corresponds to order+1.
+  /** Interpolate field to the specified points
    */
   inline void
-  calculate(const unsigned int n_quadrature_points = 0);
+  interpolate(const FieldType &              field_type,
+              const std::string &            field_name,
+              const std::vector<Point<dim>> &target_points,
+              const std::vector<bool> &      markers,
+              Vector<double> &               target_values) const;
 
-  /** Get calculated gradients by field name
+  /** Same as above, for target points in 2D
    */
-  inline const std::vector<Tensor<1, dim>> &
-  get_gradient(const std::string &name) const;
+  inline void
+  interpolate(const FieldType &                  field_type,
+              const std::string &                field_name,
+              const std::vector<Point<dim - 1>> &target_points,
+              const std::vector<bool> &          markers,
+              Vector<double> &                   target_values) const;
+
+  /** Same as above, reusing the interpolation \c plan.
+   * The plan is recreated if the target points, markers or source mesh have
+   * changed since the last call.
+   */
+  inline void
+  interpolate(const FieldType &              field_type,
+              const std::string &            field_name,
+              const std::vector<Point<dim>> &target_points,
+              const std::vector<bool> &      markers,
+              Vector<double> &               target_values,
+              InterpolationPlan<dim> &       plan) const;
+
+  /** Same as above, for target points in 2D
+   */
+  inline void
+  interpolate(const FieldType &                  field_type,
+              const std::string &                field_name,
+              const std::vector<Point<dim - 1>> &target_points,
+              const std::vector<bool> &          markers,
+              Vector<double> &                   target_values,
+              InterpolationPlan<dim> &           plan) const;
+
+  /** Interpolate field using the precalculated \c plan
+   */
+  inline void
+  interpolate(const InterpolationPlan<dim> &plan,
+              const std::string &           field_name,
+              Vector<double> &              target_values) const;
+
+  /** Calculate the interpolation plan (closest triangles and barycentric
+   * weights) for the specified points
+   */
+  inline void
+  create_plan(const FieldType &              field_type,
+              const std::vector<Point<dim>> &target_points,
+              const std::vector<bool> &      markers,
+              InterpolationPlan<dim> &       plan) const;
+
+  /** Same as above, for target points in 2D
+   */
+  inline void
+  create_plan(const FieldType &                  field_type,
+              const std::vector<Point<dim - 1>> &target_points,
+              const std::vector<bool> &          markers,
+              InterpolationPlan<dim> &           plan) const;
+
+  /** Convert between cell and point fields.
+   * If target_name is not specified it is set to source_name.
+   */
+  inline void
+  convert(const FieldType &  source_type,
+          const std::string &source_name,
+          const FieldType &  target_type,
+          const std::string &target_name = "");
+
+  /** Returns \c true if no data is present
+   */
+  inline bool
+  empty() const;
+
+  /** Get profiler, measures \c create_plan and \c interpolate
+   */
+  inline std::shared_ptr<Profiler>
+  get_profiler() const;
+
+  /** Set profiler, e.g. shared with the solver using the interpolated data
+   */
+  inline void
+  set_profiler(const std::shared_ptr<Profiler> &profiler);
 
 private:
-  /** All FE fields
+  /** Points \c (x,y,z)
    */
-  std::map<std::string, Vector<double>> fields;
+  std::vector<Point<dim>> points;
 
-  /** All calculated gradients
+  /** Connectivity matrix \c (v0,v1,v2) - only triangles
    */
-  std::map<std::string, std::vector<Tensor<1, dim>>> gradients;
+  std::vector<std::array<unsigned long, 3>> triangles;
 
-  /** DoF handler
+  /** Fields defined on cells
    */
-  SmartPointer<const DoFHandler<dim>> dh;
-};
+  std::map<std::string, std::vector<double>> cell_fields;
 
-/** Class for smoothing fields
- */
-template <int dim>
-class DoFFieldSmoother
-{
-public:
-  /** Smoothing type
+  /** Fields defined on points
    */
-  enum SmoothType
+  std::map<std::string, std::vector<double>> point_fields;
+
+  /** Vector fields defined on cells
+   */
+  std::map<std::string, std::vector<Point<dim>>> cell_vector_fields;
+
+  /** Precalculated triangle areas, normals, centers etc.
+   */
+  std::vector<Triangle<dim>> triangle_cache;
+
+  /** Revision of the mesh, see InterpolationPlan::new_revision
+   */
+  unsigned long revision;
+
+  /** Profiler
+   */
+  std::shared_ptr<Profiler> profiler;
+
+  /** Node of the bounding volume hierarchy over \c triangle_cache
+   */
+  struct BVHNode
   {
-    Cell, ///< Cell-based
-    None  ///< No smoothing
+    /** Lower corner of the axis-aligned bounding box
+     */
+    Point<dim> box_min;
+
+    /** Upper corner of the axis-aligned bounding box
+     */
+    Point<dim> box_max;
+
+    /** Range of triangles <tt>[begin,end)</tt> in \c bvh_triangles
+     */
+    unsigned int begin;
+
+    /** See \c begin
+     */
+    unsigned int end;
+
+    /** Index of the first child node, the second one is \c child+1.
+     * Zero for leaf nodes.
+     */
+    unsigned int child;
   };
 
-  /** Delete all data
+  /** Maximum number of triangles in a leaf node of the hierarchy
    */
-  inline void
-  clear();
+  constexpr static unsigned int bvh_leaf_size = 4;
 
-  /** Set first-type boundary condition \f$f = f_0\f$.
-   * The value does not need to be specified.
+  /** Bounding volume hierarchy, the root node is the first one
    */
-  void
-  set_bc1(const unsigned int id);
+  std::vector<BVHNode> bvh_nodes;
 
-  /** Add a FE field
+  /** Triangle indices, ordered so that each node covers a contiguous range
+   */
+  std::vector<unsigned int> bvh_triangles;
+
+
+  /** Get field
+   */
+  inline const std::vector<double> &
+  field(const FieldType &field_type, const std::string &field_name) const;
+
+  /** Get field
+   */
+  inline std::vector<double> &
+  field(const FieldType &field_type, const std::string &field_name);
+
+  /** Get vector field
+   */
+  inline const std::vector<Point<dim>> &
+  vector_field(const FieldType &  field_type,
+               const std::string &field_name) const;
+
+  /** Convert cell field to point field
    */
   inline void
-  add_field(const std::string &name, const Vector<double> &field);
+  cell_to_point(const std::string &source_name, const std::string &target_name);
 
-  /** Attach a DoF handler corresponding to the added FE fields
+  /** Convert point field to cell field
    */
   inline void
-  attach_dof_handler(const DoFHandler<dim> &dof_handler);
+  point_to_cell(const std::string &source_name, const std::string &target_name);
 
-  /** Smooth all fields.
+  /** Clear all data
    */
   inline void
-  calculate(const double relax          = 0.5,
-            const double relax_boundary = 0.5,
-            SmoothType   st             = Cell);
+  clear();
 
-  /** Get field by name
+  /** Print mesh and field information
    */
-  inline const Vector<double> &
-  get_field(const std::string &name) const;
+  inline void
+  info() const;
 
-private:
-  /** Smooth using cell-based method
+  /** Write mesh and fields to \c vtu file in a binary \c format.
+   * Called by \c write_vtu.
    */
   inline void
-  smooth_cell(const double relax, const double relax_boundary);
+  write_vtu_binary(const std::string &file_name,
+                   const VTUFormat    format) const;
 
-  /** All FE fields
+  /** Take the data from FileCache if \c file_name has not changed.
+   * Called by \c read_vtk and \c read_vtu.
    */
-  std::map<std::string, Vector<double>> fields;
+  inline bool
+  read_cached(const std::string &file_name, const FileSignature &signature);
 
-  /** Boundary IDs for first-type BC
+  /** Decode binary \c vtu data array <tt>[begin,end)</tt> (raw, without
+   * base64 encoding) with a header of integers of \c header_size bytes and
+   * optional zlib compression.
+   * @returns pointer to the uncompressed data and its size in bytes, either
+   * inside <tt>[begin,end)</tt> or stored in \c buffer
    */
-  std::set<unsigned int> bc1;
+  inline static std::pair<const char *, std::size_t>
+  decode_vtu_block(const char *       begin,
+                   const char *       end,
+                   const unsigned int header_size,
+                   const bool         compressed,
+                   std::vector<char> &buffer);
+
+  /** Convert binary data of \c vtu type (e.g. \c Float32, \c Int64) to
+   * \c values
+   */
+  inline static void
+  convert_vtu_values(const char *         data,
+                     const std::size_t    n_bytes,
+                     const std::string &  type,
+                     std::vector<double> &values);
 
-  /** DoF handler
+  /** Same as above, for values of type \c S
    */
-  SmartPointer<const DoFHandler<dim>> dh;
+  template <typename S>
+  static void
+  copy_vtu_values(const char *         data,
+                  const std::size_t    n_bytes,
+                  std::vector<double> &values);
+
+  /** Encode binary data of a \c vtu array in the specified \c format
+   * (except AsciiVTU) with a \c UInt64 header
+   */
+  inline static std::string
+  encode_vtu_block(const std::string &data, const VTUFormat format);
+
+  /** Precalculate auxiliary data (cell areas, centers, normals)
+   */
+  inline void
+  preprocess();
+
+  /** Build the bounding volume hierarchy. Called by \c preprocess
+   */
+  inline void
+  build_bvh();
+
+  /** Find the triangle which is closest to the given point \f$p\f$.
+   * @returns triangle index, \c p_closest is set to the closest point
+   */
+  inline unsigned int
+  closest_triangle(const Point<dim> &p, Point<dim> &p_closest) const;
 };
 
-/**
- * Transform the given triangulation smoothly to a different domain where,
- * typically, each of the vertices at the boundary of the triangulation is
- * mapped to the corresponding points in the @p new_points map.
- *
- * The unknown displacement field \f$u_d(\mathbf x)\f$ in direction \f$d\f$ is
- * obtained from the minimization problem \f[ \min\, \int \frac{1}{2} c(\mathbf
- * x) \mathbf \nabla u_d(\mathbf x) \cdot \mathbf \nabla u_d(\mathbf x)
- *   \,\rm d x
- * \f]
- * subject to prescribed constraints. The minimizer is obtained by solving the
- * Laplace equation of the dim components of a displacement field that maps the
- * current
- * domain into one described by @p new_points . Linear finite elements with
- * four Gaussian quadrature points in each direction are used. The difference
- * between the vertex positions specified in @p new_points and their current
- * value in @p tria therefore represents the prescribed values of this
- * displacement field at the boundary of the domain, or more precisely at all
- * of those locations for which @p new_points provides values (which may be
- * at part of the boundary, or even in the interior of the domain). The
- * function then evaluates this displacement field at each unconstrained
- * vertex and uses it to place the mapped vertex where the displacement
- * field locates it. Because the solution of the Laplace equation is smooth,
- * this guarantees a smooth mapping from the old domain to the new one.
- *
- * @param[in] new_points The locations where a subset of the existing
- * vertices are to be placed. Typically, this would be a map from the vertex
- * indices of all nodes on the boundary to their new locations, thus
- * completely specifying the geometry of the mapped domain. However, it may
- * also include interior points if necessary and it does not need to include
- * all boundary vertices (although you then lose control over the exact
- * shape of the mapped domain).
- *
- * @param[in,out] tria The Triangulation object. This object is changed in-
- * place, i.e., the previous locations of vertices are overwritten.
- *
- * @param[in] coefficient An optional coefficient for the Laplace problem.
- * Larger values make cells less prone to deformation (effectively
- * increasing their stiffness). The coefficient is evaluated in the
- * coordinate system of the old, undeformed configuration of the
- * triangulation as input, i.e., before the transformation is applied.
- * Should this function be provided, sensible results can only be expected
- * if all coefficients are positive.
- *
- * @param[in] solve_for_absolute_positions If set to <code>true</code>, the
- * minimization problem is formulated with respect to the final vertex positions
- * as opposed to their displacement. The two formulations are equivalent for
- * the homogeneous problem (default value of @p coefficient), but they
- * result in very different mesh motion otherwise. Since in most cases one will
- * be using a non-constant coefficient in displacement formulation, the default
- * value of this parameter is <code>false</code>.
- *
- * @param[in] tol Tolerance for solving the system of linear equations.
- *
- * @note This function is not currently implemented for the 1d case.
- * @note The code is taken from deal.II sources and user-specified solver tolerance added.
+/** Helper error message for failed interpolation
  */
 template <int dim>
-inline void
-laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
-                  Triangulation<dim> &                      tria,
-                  const Function<dim, double> *             coefficient = 0,
-                  const bool   solve_for_absolute_positions             = false,
-                  const double tol = 1.e-10);
+DeclException1(ExcInterpolationFailed,
+               Point<dim>,
+               << "Interpolation at point " << arg1 << " failed.");
 
+/** Class for interpolation of 2D surface fields from external data.
+ * Used for interpolation of boundary conditions to the simulation mesh.
+ * The source point data are defined on a polyline.
+ */
+class SurfaceInterpolator2D
+{
+private:
+  /** Only 2D meshes are supported
+   */
+  constexpr static unsigned int dim = 2;
 
-// IMPLEMENTATION
+public:
+  /** Constructor, creates an empty interpolator
+   */
+  inline SurfaceInterpolator2D();
 
-double
-sqr(const double x)
+  /** Read mesh and fields from plain text file. Unchanged files are taken
+   * from FileCache.
+   */
+  inline void
+  read_txt(const std::string &file_name);
+
+  /** Set mesh
+   */
+  inline void
+  set_points(const std::vector<Point<dim>> &new_points);
+
+  inline void
+  set_points(const std::vector<Point<dim + 1>> &new_points);
+
+  /** Get mesh
+   */
+  inline const std::vector<Point<dim>> &
+  get_points() const;
+
+  /** Get all field names, not necessarily in the original order
+   */
+  inline const std::vector<std::string>
+  get_field_names() const;
+
+  /** Interpolate field to the specified points
+   */
+  inline void
+  interpolate(const std::string &            field_name,
+              const std::vector<Point<dim>> &target_points,
+              const std::vector<bool> &      markers,
+              Vector<double> &               target_values) const;
+
+  /** Same as above, for target points in 3D
+   */
+  inline void
+  interpolate(const std::string &                field_name,
+              const std::vector<Point<dim + 1>> &target_points,
+              const std::vector<bool> &          markers,
+              Vector<double> &                   target_values) const;
+
+  /** Same as above, reusing the interpolation \c plan.
+   * The plan is recreated if the target points, markers or source mesh have
+   * changed since the last call.
+   */
+  inline void
+  interpolate(const std::string &            field_name,
+              const std::vector<Point<dim>> &target_points,
+              const std::vector<bool> &      markers,
+              Vector<double> &               target_values,
+              InterpolationPlan<dim> &       plan) const;
+
+  /** Same as above, for target points in 3D
+   */
+  inline void
+  interpolate(const std::string &                field_name,
+              const std::vector<Point<dim + 1>> &target_points,
+              const std::vector<bool> &          markers,
+              Vector<double> &                   target_values,
+              InterpolationPlan<dim> &           plan) const;
+
+  /** Interpolate field using the precalculated \c plan
+   */
+  inline void
+  interpolate(const InterpolationPlan<dim> &plan,
+              const std::string &           field_name,
+              Vector<double> &              target_values) const;
+
+  /** Calculate the interpolation plan (closest segments and barycentric
+   * weights) for the specified points
+   */
+  inline void
+  create_plan(const std::vector<Point<dim>> &target_points,
+              const std::vector<bool> &      markers,
+              InterpolationPlan<dim> &       plan) const;
+
+  /** Project a specific point onto the mesh
+   */
+  inline Point<dim>
+  project(const Point<dim> &p) const;
+
+  /** Returns \c true if no data is present
+   */
+  inline bool
+  empty() const;
+
+  /** Get profiler, measures \c create_plan and \c interpolate
+   */
+  inline std::shared_ptr<Profiler>
+  get_profiler() const;
+
+  /** Set profiler, e.g. shared with the solver using the interpolated data
+   */
+  inline void
+  set_profiler(const std::shared_ptr<Profiler> &profiler);
+
+private:
+  /** Points \c (x,y)
+   */
+  std::vector<Point<dim>> points;
+
+  /** Fields defined on points
+   */
+  std::map<std::string, std::vector<double>> fields;
+
+  /** Revision of the mesh, see InterpolationPlan::new_revision
+   */
+  unsigned long revision;
+
+  /** Profiler
+   */
+  std::shared_ptr<Profiler> profiler;
+
+  /** Get field
+   */
+  inline const std::vector<double> &
+  field(const std::string &field_name) const;
+
+  /** Find the segment which is closest to the given point \f$p\f$.
+   * @returns index of the first segment point, \c p_closest is set to the
+   * closest point
+   */
+  inline unsigned int
+  closest_segment(const Point<dim> &p, Point<dim> &p_closest) const;
+
+  /** Clear all data
+   */
+  inline void
+  clear();
+
+  /** Print mesh and field information
+   */
+  inline void
+  info() const;
+};
+
+
+/** Class for calculating field gradients
+ */
+template <int dim>
+class DoFGradientEvaluation
 {
-  return x * x;
-}
+public:
+  /** Delete all data
+   */
+  inline void
+  clear();
+
+  /** Add a FE field
+   */
+  inline void
+  add_field(const std::string &name, const Vector<double> &field);
+
+  /** Attach a DoF handler corresponding to the added FE fields
+   */
+  inline void
+  attach_dof_handler(const DoFHandler<dim> &dof_handler);
+
+  /** Calculate gradients of all fields.
+   * Currently only extrapolation from quadrature points is implemented
+   * (see StressSolver::recover_strain_extrapolation).
+   * @param n_quadrature_points number of QGauss quadrature points. The default
+   * value of 0 corresponds to order+1.
+   */
+  inline void
+  calculate(const unsigned int n_quadrature_points = 0);
+
+  /** Get calculated gradients by field name
+   */
+  inline const std::vector<Tensor<1, dim>> &
+  get_gradient(const std::string &name) const;
+
+private:
+  /** Structure that holds scratch data for the cell sweep
+   */
+  struct ScratchData
+  {
+    inline ScratchData(const FiniteElement<dim> &fe,
+                       const Quadrature<dim> &   quadrature,
+                       const unsigned int        n_fields);
+    inline ScratchData(const ScratchData &scratch_data);
+
+    FEValues<dim> fe_values;
+
+    /** Values of all fields at the DoFs of the cell, field by field
+     */
+    std::vector<double> values_cell;
+
+    /** Gradients of all fields at the quadrature points, field by field
+     */
+    std::vector<Tensor<1, dim>> grad_q;
+  };
+
+  /** Structure that holds local contributions
+   */
+  struct CopyData
+  {
+    /** Gradients of all fields at the DoFs of the cell, field by field
+     */
+    std::vector<Tensor<1, dim>>          grad_cell;
+    std::vector<types::global_dof_index> local_dof_indices;
+  };
+
+  /** Index of each field in \c fields and \c gradients
+   */
+  std::map<std::string, unsigned int> field_indices;
+
+  /** All FE fields
+   */
+  std::vector<Vector<double>> fields;
+
+  /** All calculated gradients
+   */
+  std::vector<std::vector<Tensor<1, dim>>> gradients;
+
+  /** DoF handler
+   */
+  SmartPointer<const DoFHandler<dim>> dh;
+};
+
+/** Class for smoothing fields
+ */
+template <int dim>
+class DoFFieldSmoother
+{
+public:
+  /** Smoothing type
+   */
+  enum SmoothType
+  {
+    Cell, ///< Cell-based
+    None  ///< No smoothing
+  };
+
+  /** Delete all data
+   */
+  inline void
+  clear();
+
+  /** Set first-type boundary condition \f$f = f_0\f$.
+   * The value does not need to be specified.
+   */
+  void
+  set_bc1(const unsigned int id);
+
+  /** Add a FE field
+   */
+  inline void
+  add_field(const std::string &name, const Vector<double> &field);
+
+  /** Attach a DoF handler corresponding to the added FE fields
+   */
+  inline void
+  attach_dof_handler(const DoFHandler<dim> &dof_handler);
+
+  /** Smooth all fields.
+   */
+  inline void
+  calculate(const double relax          = 0.5,
+            const double relax_boundary = 0.5,
+            SmoothType   st             = Cell);
+
+  /** Get field by name
+   */
+  inline const Vector<double> &
+  get_field(const std::string &name) const;
+
+private:
+  /** Smooth using cell-based method
+   */
+  inline void
+  smooth_cell(const double relax, const double relax_boundary);
+
+  /** Structure that holds local contributions
+   */
+  struct CopyData
+  {
+    /** Smoothed values of all fields at the DoFs of the cell, field by field
+     */
+    std::vector<double>                  values_cell;
+    std::vector<types::global_dof_index> local_dof_indices;
+  };
+
+  /** Index of each field in \c fields
+   */
+  std::map<std::string, unsigned int> field_indices;
+
+  /** All FE fields
+   */
+  std::vector<Vector<double>> fields;
+
+  /** Boundary IDs for first-type BC
+   */
+  std::set<unsigned int> bc1;
+
+  /** DoF handler
+   */
+  SmartPointer<const DoFHandler<dim>> dh;
+};
+
+/** Class for evaluating FE fields at arbitrary points (e.g. probes).
+ * The cells containing the points and the corresponding reference points are
+ * located once and cached together with the shape function values, so that
+ * the evaluation of any number of fields reduces to a multithreaded
+ * gather-multiply. Values at points outside the mesh are set to zero.
+ */
+template <int dim>
+class DoFPointEvaluation
+{
+public:
+  /** Delete all data
+   */
+  inline void
+  clear();
+
+  /** Set the DoF handler and points.
+   * The points are located only if the points or the mesh (number of cells and
+   * DoFs, vertex positions) have changed since the last call, including the
+   * points which were outside the mesh.
+   */
+  inline void
+  reinit(const DoFHandler<dim> &dof_handler, const std::vector<Point<dim>> &p);
+
+  /** Evaluate the given field at the points
+   */
+  inline std::vector<double>
+  evaluate(const Vector<double> &field) const;
+
+  /** Evaluate all given fields at the points in one pass.
+   * @returns values[field][point]
+   */
+  inline std::vector<std::vector<double>>
+  evaluate(const std::vector<const Vector<double> *> &fields) const;
+
+private:
+  /** Returns \c true if the cached data correspond to the given DoF handler
+   * and points
+   */
+  inline bool
+  is_up_to_date(const DoFHandler<dim> &        dof_handler,
+                const std::vector<Point<dim>> &p) const;
+
+  /** Find the cells containing the points, calculate the shape function
+   * values
+   */
+  inline void
+  locate_points();
+
+  /** DoF handler
+   */
+  SmartPointer<const DoFHandler<dim>> dh;
+
+  /** Points
+   */
+  std::vector<Point<dim>> points;
+
+  /** Cells containing the points
+   */
+  std::vector<typename DoFHandler<dim>::active_cell_iterator> cells;
+
+  /** Points in the reference cell
+   */
+  std::vector<Point<dim>> reference_points;
+
+  /** \c false for points outside the mesh
+   */
+  std::vector<bool> found;
+
+  /** DoF indices of the cells, \c dofs_per_cell values for each point
+   */
+  std::vector<types::global_dof_index> dof_indices;
+
+  /** Shape function values, \c dofs_per_cell values for each point
+   */
+  std::vector<double> shape_values;
+
+  /** Number of DoFs at the time of point location
+   */
+  types::global_dof_index n_dofs = 0;
+
+  /** Number of active cells at the time of point location
+   */
+  unsigned int n_active_cells = 0;
+
+  /** Mesh vertices at the time of point location, stored only if some
+   * points are outside the mesh, to locate them again after mesh motion
+   */
+  std::vector<Point<dim>> vertices;
+};
+
+/** Block-diagonal preconditioner for a BlockSparseMatrix.
+ *
+ * Each diagonal block is preconditioned separately by \c PreconditionerType,
+ * the coupling between blocks is neglected. For the component-wise numbered
+ * elasticity problem the diagonal blocks are scalar Laplace-like operators,
+ * well suited for SSOR or algebraic multigrid.
+ */
+template <typename PreconditionerType>
+class BlockDiagonalPreconditioner
+{
+public:
+  /** Delete all data
+   */
+  inline void
+  clear();
+
+  /** Initialize preconditioners of all diagonal blocks
+   */
+  template <typename AdditionalData>
+  inline void
+  initialize(const BlockSparseMatrix<double> &matrix,
+             const AdditionalData &           data);
+
+  /** Apply the preconditioner
+   */
+  inline void
+  vmult(BlockVector<double> &dst, const BlockVector<double> &src) const;
+
+  /** Apply the transposed preconditioner, the same as
+   * BlockDiagonalPreconditioner::vmult for symmetric blocks
+   */
+  inline void
+  Tvmult(BlockVector<double> &dst, const BlockVector<double> &src) const;
+
+private:
+  /** Preconditioners of the diagonal blocks
+   */
+  std::vector<std::unique_ptr<PreconditionerType>> preconditioners;
+};
+
+/** Named fields with shared ownership and copy-on-write.
+ *
+ * The vectors are held by \c std::shared_ptr, copies of the store (see
+ * FieldStore::snapshot) and fields added by FieldStore::set from a shared
+ * pointer do not copy the data. A vector is copied only when it is modified
+ * by FieldStore::get_mutable while it is shared; the vectors returned by
+ * FieldStore::get_shared therefore never change. Shared vectors which are
+ * still held by the caller must not be modified by the caller.
+ */
+class FieldStore
+{
+public:
+  /** Shared read-only field
+   */
+  using FieldPointer = std::shared_ptr<const Vector<double>>;
+
+  /** Container of the fields, iterated by FieldStore::begin and
+   * FieldStore::end
+   */
+  using Container = std::map<std::string, FieldPointer>;
+
+  /** Set field \c name to a copy of \c value. The existing storage is reused
+   * if the field is not shared and the size is unchanged.
+   */
+  inline void
+  set(const std::string &name, const Vector<double> &value);
+
+  /** Set field \c name to \c value without copying
+   */
+  inline void
+  set(const std::string &name, Vector<double> &&value);
+
+  /** Share field \c name with the owners of \c value without copying
+   */
+  inline void
+  set(const std::string &name, const FieldPointer &value);
+
+  /** Returns \c true if field \c name exists
+   */
+  inline bool
+  has(const std::string &name) const;
+
+  /** Field \c name
+   */
+  inline const Vector<double> &
+  get(const std::string &name) const;
+
+  /** Field \c name for sharing with other stores or solvers
+   */
+  inline FieldPointer
+  get_shared(const std::string &name) const;
+
+  /** Field \c name for modification, copied first if it is shared. An empty
+   * field is created if it does not exist.
+   */
+  inline Vector<double> &
+  get_mutable(const std::string &name);
+
+  /** Copy of the store sharing all fields, the fields are copied only when
+   * modified in either store
+   */
+  inline FieldStore
+  snapshot() const;
+
+  /** Remove field \c name
+   */
+  inline void
+  erase(const std::string &name);
+
+  /** Remove all fields
+   */
+  inline void
+  clear();
+
+  /** Number of fields
+   */
+  inline unsigned int
+  size() const;
+
+  /** Names of all fields in alphabetical order
+   */
+  inline std::vector<std::string>
+  get_names() const;
+
+  /** Iterator to the first field
+   */
+  inline Container::const_iterator
+  begin() const;
+
+  /** Iterator past the last field
+   */
+  inline Container::const_iterator
+  end() const;
+
+private:
+  /** All fields
+   */
+  Container fields;
+
+  /** Names of the fields allocated by this store, which can be modified if
+   * not shared
+   */
+  std::set<std::string> owned;
+};
+
+/** Global thread limit of the solvers.
+ *
+ * The solvers set the limit of \c MultithreadInfo from their parameter
+ * \c "Number of threads" by ThreadLimit::set. Several solvers running
+ * concurrently in one process (e.g. the runs of EnsembleRunner) must not
+ * change the limit of the others, hence ThreadLimit::fix sets the limit once
+ * and the following ThreadLimit::set calls are ignored until
+ * ThreadLimit::release.
+ */
+class ThreadLimit
+{
+public:
+  /** Set the thread limit (0 - number of cores) unless it is fixed
+   */
+  inline static void
+  set(const unsigned int n_threads);
+
+  /** Set the thread limit (0 - number of cores) and ignore ThreadLimit::set
+   * until ThreadLimit::release
+   */
+  inline static void
+  fix(const unsigned int n_threads);
+
+  /** Allow ThreadLimit::set again, the current limit is kept
+   */
+  inline static void
+  release();
+
+  /** Check whether the limit is fixed
+   */
+  inline static bool
+  is_fixed();
+
+private:
+  /** Flag set by ThreadLimit::fix
+   */
+  inline static std::atomic<bool> &
+  fixed();
+};
+
+/** Log output with verbosity levels.
+ *
+ * Messages are collected line by line and passed to a buffer shared by all
+ * loggers, which is written to \c std::cout when it exceeds the size set by
+ * Logger::set_buffer_size (0 - immediately, default), by Logger::flush and
+ * at program exit. The initial level and buffer size can be set by the
+ * environment variables \c MACPLAS_LOG_LEVEL and \c MACPLAS_LOG_BUFFER_SIZE.
+ * Output below the current level is discarded; to avoid the formatting
+ * costs completely, expensive messages should be guarded by
+ * Logger::is_enabled. If \c MACPLAS_DISABLE_LOGGING is defined at compile
+ * time, all output is discarded and Logger::is_enabled is always \c false.
+ * The lines of different loggers are never mixed, an incomplete line is
+ * terminated when another logger writes on the same thread. A single logger
+ * must not be used concurrently from several threads, Logger::get_default
+ * returns a separate logger for each thread.
+ */
+class Logger
+{
+public:
+  /** Verbosity levels
+   */
+  enum Level
+  {
+    Quiet,   ///< No output
+    Error,   ///< Errors only
+    Warning, ///< Errors and warnings
+    Info,    ///< Progress messages
+    Detail   ///< Messages in iterations (default)
+  };
+
+  /** Constructor, the level is read from \c MACPLAS_LOG_LEVEL if set
+   */
+  inline Logger();
+
+  /** Destructor, passes the incomplete line to the shared buffer
+   */
+  inline ~Logger();
+
+  /** Set the verbosity level
+   */
+  inline void
+  set_level(const Level level);
+
+  /** Set the verbosity level by name, see Logger::get_level_names
+   */
+  inline void
+  set_level(const std::string &level);
+
+  /** Verbosity level
+   */
+  inline Level
+  get_level() const;
+
+  /** Names of the levels separated by \c "|", for \c Patterns::Selection
+   */
+  static inline std::string
+  get_level_names();
+
+  /** Returns \c true if messages of \c level are written
+   */
+  inline bool
+  is_enabled(const Level level) const;
+
+  /** Stream for messages of \c level
+   */
+  inline std::ostream &
+  stream(const Level level);
+
+  /** Stream for error messages
+   */
+  inline std::ostream &
+  error();
+
+  /** Stream for warnings
+   */
+  inline std::ostream &
+  warning();
+
+  /** Stream for progress messages
+   */
+  inline std::ostream &
+  info();
+
+  /** Stream for messages in iterations
+   */
+  inline std::ostream &
+  detail();
+
+  /** Set the size of the shared buffer in bytes, 0 - no buffering
+   */
+  static inline void
+  set_buffer_size(const std::size_t n);
+
+  /** Write the shared buffer to \c std::cout
+   */
+  static inline void
+  flush();
+
+  /** Logger for the utility functions and classes, one for each thread.
+   * Utilities called in concurrent tasks (e.g. the interpolation of boundary
+   * conditions while another solver runs) can thus log without locking.
+   */
+  static inline Logger &
+  get_default();
+
+private:
+  /** Collects complete lines. The text is collected in the incomplete line
+   * of the calling thread, the shared buffer is locked only when a line is
+   * complete
+   */
+  class LineBuffer : public std::streambuf
+  {
+  public:
+    /** Pass the incomplete line written on the calling thread to the shared
+     * buffer
+     */
+    inline void
+    commit();
+
+  protected:
+    inline int
+    overflow(int c) override;
+
+    inline std::streamsize
+    xsputn(const char *s, std::streamsize n) override;
+
+    inline int
+    sync() override;
+  };
+
+  /** Buffer shared by all loggers
+   */
+  struct SharedBuffer
+  {
+    /** Constructor, the size is read from \c MACPLAS_LOG_BUFFER_SIZE if set
+     */
+    inline SharedBuffer();
+
+    /** Destructor, writes the buffered data
+     */
+    inline ~SharedBuffer();
+
+    /** Append \c s, write the buffer if full or if \c flush is \c true.
+     * The mutex must be locked
+     */
+    inline void
+    write(const std::string &s, const bool flush);
+
+    /** Append \c s with the mutex locked
+     */
+    inline void
+    write_locked(const std::string &s, const bool flush);
+
+    /** Buffered data
+     */
+    std::string data;
+
+    /** Maximal size of buffered data
+     */
+    std::size_t max_size;
+
+    /** Mutex protecting \c data and \c max_size
+     */
+    std::mutex mutex;
+  };
+
+  /** Incomplete line of a thread. Only one logger at a time has an incomplete
+   * line on a thread, it is terminated when another logger writes.
+   */
+  struct PendingLine
+  {
+    /** Destructor, passes the line to the shared buffer at thread exit
+     */
+    inline ~PendingLine();
+
+    /** Line buffer which wrote \c text, only compared
+     */
+    const LineBuffer *owner = nullptr;
+
+    /** Text of the incomplete line
+     */
+    std::string text;
+  };
+
+  /** The shared buffer
+   */
+  static inline SharedBuffer &
+  shared_buffer();
+
+  /** Incomplete line of the calling thread
+   */
+  static inline PendingLine &
+  pending_line();
+
+  /** Verbosity level
+   */
+  Level level;
+
+  /** Line buffer of enabled messages
+   */
+  LineBuffer buffer;
+
+  /** Stream writing to \c buffer
+   */
+  std::ostream output;
+
+  /** Stream discarding all output
+   */
+  std::ostream null_output;
+};
+
+/** Bounded queue of output tasks, executed in the order of submission by a
+ * dedicated I/O thread. If the queue is full, BackgroundWriter::submit waits
+ * until the oldest task is started. The destructor waits until all queued
+ * tasks are finished. If the queue size is zero (default), the tasks are
+ * executed synchronously on the calling thread.
+ */
+class BackgroundWriter
+{
+public:
+  /** Constructor, synchronous output
+   */
+  inline BackgroundWriter();
+
+  /** Destructor, finishes all queued tasks and stops the I/O thread
+   */
+  inline ~BackgroundWriter();
+
+  /** Set the maximal number of queued tasks, 0 - synchronous output.
+   * Waits until all previously queued tasks are finished.
+   */
+  inline void
+  set_max_queued_tasks(const unsigned int n);
+
+  /** Returns \c true if the tasks are executed on the calling thread
+   */
+  inline bool
+  is_synchronous() const;
+
+  /** Queue \c task for execution. The task must own (a copy of) all data it
+   * writes, exceptions thrown by the task are reported as errors.
+   */
+  inline void
+  submit(std::function<void()> task);
+
+  /** Write \c contents to file \c file_name opened in \c mode, failures to
+   * open or write the file are reported as errors
+   */
+  inline void
+  write_file(const std::string &      file_name,
+             std::string              contents,
+             const std::ios::openmode mode = std::ios::out);
+
+  /** Wait until all queued tasks are finished
+   */
+  inline void
+  flush();
+
+private:
+  /** Main loop of the I/O thread
+   */
+  inline void
+  run();
+
+  /** Maximal number of queued tasks
+   */
+  unsigned int max_queued_tasks;
+
+  /** Queued tasks
+   */
+  std::deque<std::function<void()>> tasks;
+
+  /** \c true while a task is executed
+   */
+  bool busy;
+
+  /** Flag for stopping the I/O thread
+   */
+  bool stop;
+
+  /** Mutex protecting \c tasks, \c busy and \c stop
+   */
+  std::mutex mutex;
+
+  /** Signals changes of the queue state
+   */
+  std::condition_variable condition;
+
+  /** I/O thread, started at the first asynchronous task
+   */
+  std::thread thread;
+};
+
+/** Standalone copy of the patches built by \c DataOut. Does not reference the
+ * DoF handler and data vectors, hence can be written in a background task
+ * while the fields are updated.
+ */
+template <int dim>
+class DataOutSnapshot : public DataOutInterface<dim>
+{
+public:
+#if DEAL_II_VERSION_GTE(9, 0, 0)
+  /** Type of the descriptions of vector-valued data
+   */
+  using DataRanges = std::vector<
+    std::tuple<unsigned int,
+               unsigned int,
+               std::string,
+               DataComponentInterpretation::DataComponentInterpretation>>;
+#else
+  using DataRanges =
+    std::vector<std::tuple<unsigned int, unsigned int, std::string>>;
+#endif
+
+  /** Constructor, copies all data
+   */
+  inline DataOutSnapshot(const std::vector<DataOutBase::Patch<dim>> &patches,
+                         const std::vector<std::string> &dataset_names,
+                         const DataRanges &              data_ranges);
+
+protected:
+  /** Get the stored patches
+   */
+  inline virtual const std::vector<DataOutBase::Patch<dim>> &
+  get_patches() const override;
+
+  /** Get names of the stored data sets
+   */
+  inline virtual std::vector<std::string>
+  get_dataset_names() const override;
+
+  /** Get descriptions of the stored vector-valued data
+   */
+#if DEAL_II_VERSION_GTE(9, 0, 0)
+  inline virtual DataRanges
+  get_nonscalar_data_ranges() const override;
+#else
+  inline virtual DataRanges
+  get_vector_data_ranges() const override;
+#endif
+
+private:
+  /** Patches
+   */
+  std::vector<DataOutBase::Patch<dim>> patches;
+
+  /** Names of data sets
+   */
+  std::vector<std::string> dataset_names;
+
+  /** Descriptions of vector-valued data
+   */
+  DataRanges data_ranges;
+};
+
+/** \c DataOut which can copy its built patches to a DataOutSnapshot
+ */
+template <int dim>
+class BufferedDataOut : public DataOut<dim>
+{
+public:
+  /** Copy the patches, must be called after \c build_patches
+   */
+  inline std::shared_ptr<DataOutSnapshot<dim>>
+  snapshot() const;
+};
+
+/** Writer of DataOut results in different formats:
+ * - \c vtk: legacy ASCII VTK, one file per snapshot,
+ * - \c vtu: zlib-compressed binary VTU, one file per snapshot, with a \c pvd
+ * time-series index,
+ * - \c hdf5: HDF5 with an \c xdmf time-series index. The mesh is written to a
+ * separate file only when the node coordinates have changed, the later
+ * snapshots contain only fields (requires deal.II with HDF5).
+ */
+template <int dim>
+class DataOutWriter
+{
+public:
+  /** Names of supported formats for \c Patterns::Selection
+   */
+  inline static std::string
+  get_format_names();
+
+  /** File name extension of the given format
+   */
+  inline static std::string
+  get_extension(const std::string &format);
+
+  /** Write \c data_out to \c "<file_name>.<extension>".
+   *
+   * @param series_name Base name of the time-series index file and of the
+   * mesh files (without time, the same for all snapshots)
+   */
+  inline void
+  write(DataOutInterface<dim> &data_out,
+        const std::string &    file_name,
+        const std::string &    series_name,
+        const std::string &    format,
+        const double           time,
+        const int              precision);
+
+  /** Same as above, but the snapshot of \c data_out is written by \c writer.
+   * The DataOutWriter must outlive all tasks queued in \c writer.
+   */
+  inline void
+  write(BufferedDataOut<dim> &data_out,
+        const std::string &   file_name,
+        const std::string &   series_name,
+        const std::string &   format,
+        const double          time,
+        const int             precision,
+        BackgroundWriter &    writer);
+
+private:
+  /** Write the \c vtu file and update the \c pvd index
+   */
+  inline void
+  write_vtu(DataOutInterface<dim> &data_out,
+            const std::string &    file_name,
+            const std::string &    series_name,
+            const double           time);
+
+  /** Write the \c h5 files and update the \c xdmf index
+   */
+  inline void
+  write_hdf5(DataOutInterface<dim> &data_out,
+             const std::string &    file_name,
+             const std::string &    series_name,
+             const double           time);
+
+  /** Time and file name of all written \c vtu snapshots
+   */
+  std::vector<std::pair<double, std::string>> vtu_records;
+
+  /** Time of all written \c hdf5 snapshots
+   */
+  std::vector<double> xdmf_times;
+
+#ifdef DEAL_II_WITH_HDF5
+  /** Entries of all written \c hdf5 snapshots
+   */
+  std::vector<XDMFEntry> xdmf_entries;
+#endif
+
+  /** Name of the last written \c hdf5 mesh file
+   */
+  std::string mesh_file_name;
+
+  /** Node coordinates in the last written \c hdf5 mesh file
+   */
+  std::vector<double> mesh_nodes;
+};
+
+/** Performance instrumentation, can be shared between several solvers.
+ *
+ * Wall and CPU times and call counts of named phases are measured by
+ * \c TimerOutput, the names are hierarchical, e.g. \c "stress/assemble"
+ * (nested phases are contained in the time of the enclosing phase). In
+ * addition, counters (e.g. linear or Newton iterations) and the peak resident
+ * memory at the end of each phase are recorded. The phases must not be
+ * entered concurrently from several threads.
+ */
+class Profiler
+{
+public:
+  /** Measures a single phase from construction to destruction
+   */
+  class Scope
+  {
+  public:
+    /** Enter phase \c name
+     */
+    inline Scope(Profiler &profiler, const std::string &name);
+
+    /** Leave the phase
+     */
+    inline ~Scope();
+
+  private:
+    /** Profiler
+     */
+    Profiler &profiler;
+
+    /** Phase name
+     */
+    const std::string name;
+  };
+
+  /** Constructor, no report is written by default
+   */
+  inline Profiler();
+
+  /** Destructor, writes the report if Profiler::set_report was called
+   */
+  inline ~Profiler();
+
+  /** Write the summary to \c "<base_name>.json" and \c "<base_name>.csv" at
+   * destruction. If \c per_time_step is \c true, the phase times between the
+   * calls of Profiler::end_time_step are appended to
+   * \c "<base_name>-steps.csv"
+   */
+  inline void
+  set_report(const std::string &base_name, const bool per_time_step);
+
+  /** Start measuring phase \c name
+   */
+  inline void
+  enter(const std::string &name);
+
+  /** Stop measuring phase \c name
+   */
+  inline void
+  leave(const std::string &name);
+
+  /** Add \c value to counter \c name
+   */
+  inline void
+  add_count(const std::string &name, const double value = 1);
+
+  /** Mark the end of the time step at time \c t. Writes the per-step report
+   * if enabled, repeated calls with the same \c t (e.g. by several solvers
+   * sharing the profiler) are ignored
+   */
+  inline void
+  end_time_step(const double t);
+
+  /** Total wall times of all phases, s
+   */
+  inline std::map<std::string, double>
+  get_wall_times() const;
+
+  /** Values of all counters
+   */
+  inline std::map<std::string, double>
+  get_counters() const;
+
+  /** Write the summary in JSON format
+   */
+  inline void
+  write_json(std::ostream &out) const;
+
+  /** Write the summary in CSV format
+   */
+  inline void
+  write_csv(std::ostream &out) const;
+
+private:
+  /** Wall and CPU times and call counts of all phases
+   */
+  TimerOutput timer_output;
+
+  /** Counters
+   */
+  std::map<std::string, double> counters;
+
+  /** Peak resident memory at the end of each phase, MB
+   */
+  std::map<std::string, double> memory;
+
+  /** Wall times of all phases at the end of the last time step
+   */
+  std::map<std::string, double> last_wall_times;
+
+  /** Time of the last Profiler::end_time_step call
+   */
+  double last_time;
+
+  /** Base name of the report files, empty - no report
+   */
+  std::string report_name;
+
+  /** Write the per-step report
+   */
+  bool per_time_step;
+
+  /** Mutex protecting the counters
+   */
+  mutable std::mutex mutex;
+};
+
+/** Single-file binary archive of named sections (mesh, fields, time-stepping
+ * state, parameters) for restarting simulations.
+ *
+ * The file contains a header with the format version and the FNV-1a checksum
+ * of the payload, truncated or corrupted files are rejected by
+ * CheckpointArchive::read. A new checkpoint is written to a temporary file
+ * and renamed, older checkpoints are rotated: \c "<base>-0.bin" is the
+ * newest, \c "<base>-1.bin" the previous one etc. The data are stored in the
+ * native binary representation, the files are not portable between
+ * platforms.
+ */
+class CheckpointArchive
+{
+public:
+  /** Current file format version, incremented on incompatible changes
+   */
+  inline static unsigned int
+  get_format_version();
+
+  /** File name of the checkpoint \c i, 0 - newest
+   */
+  inline static std::string
+  get_file_name(const std::string &base_name, const unsigned int i);
+
+  /** Delete all sections
+   */
+  inline void
+  clear();
+
+  /** Returns \c true if section \c name is present
+   */
+  inline bool
+  has(const std::string &name) const;
+
+  /** Names of all sections starting with \c prefix, without the prefix
+   */
+  inline std::vector<std::string>
+  get_names(const std::string &prefix) const;
+
+  /** Add raw data as section \c name
+   */
+  inline void
+  add_string(const std::string &name, const std::string &data);
+
+  /** Get raw data of section \c name
+   */
+  inline const std::string &
+  get_string(const std::string &name) const;
+
+  /** Add a single value
+   */
+  inline void
+  add_value(const std::string &name, const double value);
+
+  /** Get a single value
+   */
+  inline double
+  get_value(const std::string &name) const;
+
+  /** Add data (\c Vector, \c BlockVector). Internally calls \c block_write
+   */
+  template <typename T>
+  inline void
+  add_data(const std::string &name, const T &data);
+
+  /** Get data (\c Vector, \c BlockVector). Internally calls \c block_read
+   */
+  template <typename T>
+  inline void
+  get_data(const std::string &name, T &data) const;
+
+  /** Add triangulation, including the refinement hierarchy. Manifold
+   * descriptions are not stored
+   */
+  template <int dim>
+  inline void
+  add_mesh(const std::string &name, const Triangulation<dim> &triangulation);
+
+  /** Replace \c triangulation with the stored one
+   */
+  template <int dim>
+  inline void
+  get_mesh(const std::string &name, Triangulation<dim> &triangulation) const;
+
+  /** Write all sections to \c "<base_name>-0.bin", keeping at most \c n_keep
+   * checkpoint files. Throws an exception if writing fails.
+   */
+  inline void
+  write(const std::string &base_name, const unsigned int n_keep) const;
+
+  /** Read the newest valid checkpoint of at most \c n_keep files. Invalid
+   * files are reported and skipped. Returns the name of the file read or an
+   * empty string if no valid checkpoint was found.
+   */
+  inline std::string
+  read(const std::string &base_name, const unsigned int n_keep);
+
+private:
+  /** Read a single file, returns an error message or an empty string
+   */
+  inline std::string
+  read_file(const std::string &file_name);
+
+  /** 64-bit FNV-1a hash of \c data
+   */
+  inline static std::uint64_t
+  checksum(const std::string &data);
+
+  /** Sections, map key: section name, value: raw data
+   */
+  std::map<std::string, std::string> sections;
+};
+
+/** Mesh motion by the Laplace equation for the vertex displacements, same as
+ * \c laplace_transform but for repeated deformations of the same mesh.
+ * The Q1 DoF numbering, the sparsity pattern and the Laplace matrix are
+ * kept between the calls, together with its factorization (\c UMFPACK) or
+ * preconditioner (\c CG, warm-started from the previous displacement). They
+ * are recalculated only if the number of vertices or the set of vertices with
+ * prescribed positions change. Hence, the Laplace matrix corresponds to the
+ * mesh at the first call, which does not affect the prescribed positions.
+ * The vertices are moved in place, the topology is not changed and DoF
+ * handlers attached to the triangulation stay valid. On locally refined
+ * meshes, the hanging vertices follow the edges (faces) they lie on, also if
+ * their positions are prescribed.
+ */
+template <int dim>
+class MeshMotion
+{
+public:
+  inline MeshMotion();
+
+  /** Delete all data, the Laplace matrix will be assembled at the next call
+   * of MeshMotion::move
+   */
+  inline void
+  clear();
+
+  /** Set the linear solver: \c UMFPACK or \c CG with the given tolerance
+   */
+  inline void
+  set_solver(const std::string &type, const double tol = 1e-10);
+
+  /** Move the vertices of \c triangulation, \c new_points contains the new
+   * positions of the prescribed vertices (map key: vertex index)
+   */
+  inline void
+  move(const std::map<unsigned int, Point<dim>> &new_points,
+       Triangulation<dim> &                      triangulation);
+
+  /** Set the vertex positions of \c triangulation, e.g. to apply the motion
+   * to a copy with the same vertex numbering
+   */
+  inline static void
+  set_vertices(Triangulation<dim> &           triangulation,
+               const std::vector<Point<dim>> &vertices);
+
+private:
+  /** Distribute Q1 DoFs, assemble the Laplace matrix, eliminate the
+   * prescribed DoFs and initialize the linear solver
+   */
+  inline void
+  setup(const std::map<unsigned int, Point<dim>> &new_points,
+        const Triangulation<dim> &                triangulation);
+
+  /** Returns \c true if the Laplace matrix was assembled for the number of
+   * vertices and prescribed vertices as given
+   */
+  inline bool
+  is_up_to_date(const std::map<unsigned int, Point<dim>> &new_points,
+                const Triangulation<dim> &                triangulation) const;
+
+  /** Linear solver type
+   */
+  std::string solver_type;
+
+  /** Tolerance of the \c CG solver
+   */
+  double tolerance;
+
+  /** DoF index of each vertex
+   */
+  std::vector<types::global_dof_index> vertex_dofs;
+
+  /** Indices of the prescribed vertices
+   */
+  std::vector<unsigned int> fixed_vertices;
+
+  /** Hanging node constraints of the Q1 DoFs
+   */
+  HangingNodeConstraints hanging_node_constraints;
+
+  /** Sparsity pattern of the Laplace matrix
+   */
+  SparsityPattern sparsity_pattern;
+
+  /** Laplace matrix
+   */
+  SparseMatrix<double> laplace_matrix;
+
+  /** Laplace matrix with eliminated rows and columns of the prescribed DoFs
+   */
+  SparseMatrix<double> system_matrix;
+
+  /** Factorization of \c system_matrix for \c UMFPACK
+   */
+  SparseDirectUMFPACK direct_solver;
+
+  /** Preconditioner of \c system_matrix for \c CG
+   */
+  PreconditionSSOR<SparseMatrix<double>> preconditioner;
+
+  /** Displacements of the last call of MeshMotion::move for each direction,
+   * initial guess for \c CG
+   */
+  std::array<Vector<double>, dim> displacement;
+};
+
+/** Transfer of DoF fields to an adaptively refined or coarsened mesh by
+ * \c SolutionTransfer. Copies of the fields on the old mesh are kept until
+ * the interpolation, the user-defined fields of FieldStore are transferred
+ * by name.
+ *
+ * Usage: FieldTransfer::add the fields, call FieldTransfer::prepare before
+ * \c Triangulation::execute_coarsening_and_refinement, distribute DoFs on the
+ * new mesh, call FieldTransfer::interpolate and FieldTransfer::get the fields.
+ */
+template <int dim>
+class FieldTransfer
+{
+public:
+  /** Constructor, the fields have to be defined at the DoFs of \c dh
+   */
+  inline explicit FieldTransfer(const DoFHandler<dim> &dh);
+
+  /** Add \c field for the transfer
+   * @returns index of the field for FieldTransfer::get
+   */
+  inline unsigned int
+  add(const Vector<double> &field);
+
+  /** Add all fields of \c store defined at the DoFs, the other fields are
+   * removed from the store by FieldTransfer::get
+   */
+  inline void
+  add(const FieldStore &store);
+
+  /** Prepare the transfer, call before
+   * \c Triangulation::execute_coarsening_and_refinement
+   */
+  inline void
+  prepare();
+
+  /** Interpolate all fields to the new DoFs and make them conforming with
+   * \c constraints. Call after distributing (and renumbering) the DoFs.
+   */
+  inline void
+  interpolate(const HangingNodeConstraints &constraints);
+
+  /** Move the interpolated field \c i to \c field
+   */
+  inline void
+  get(const unsigned int i, Vector<double> &field);
+
+  /** Replace the fields of \c store by the interpolated ones
+   */
+  inline void
+  get(FieldStore &store);
+
+  /** Delete all fields
+   */
+  inline void
+  clear();
+
+  /** Returns \c true between FieldTransfer::prepare and FieldTransfer::clear
+   */
+  inline bool
+  is_prepared() const;
+
+private:
+  /** Degrees of freedom of the fields
+   */
+  const DoFHandler<dim> &dh;
+
+  /** Transfer of the fields, created by FieldTransfer::prepare
+   */
+  std::unique_ptr<SolutionTransfer<dim, Vector<double>>> solution_transfer;
+
+  /** Fields on the old mesh
+   */
+  std::vector<Vector<double>> fields_old;
+
+  /** Fields on the new mesh
+   */
+  std::vector<Vector<double>> fields_new;
+
+  /** Names of the fields added from FieldStore
+   */
+  std::vector<std::string> store_names;
+
+  /** Indices of the fields added from FieldStore
+   */
+  std::vector<unsigned int> store_indices;
+};
+
+/**
+ * Transform the given triangulation smoothly to a different domain where,
+ * typically, each of the vertices at the boundary of the triangulation is
+ * mapped to the corresponding points in the @p new_points map.
+ *
+ * The unknown displacement field \f$u_d(\mathbf x)\f$ in direction \f$d\f$ is
+ * obtained from the minimization problem \f[ \min\, \int \frac{1}{2} c(\mathbf
+ * x) \mathbf \nabla u_d(\mathbf x) \cdot \mathbf \nabla u_d(\mathbf x)
+ *   \,\rm d x
+ * \f]
+ * subject to prescribed constraints. The minimizer is obtained by solving the
+ * Laplace equation of the dim components of a displacement field that maps the
+ * current
+ * domain into one described by @p new_points . Linear finite elements with
+ * four Gaussian quadrature points in each direction are used. The difference
+ * between the vertex positions specified in @p new_points and their current
+ * value in @p tria therefore represents the prescribed values of this
+ * displacement field at the boundary of the domain, or more precisely at all
+ * of those locations for which @p new_points provides values (which may be
+ * at part of the boundary, or even in the interior of the domain). The
+ * function then evaluates this displacement field at each unconstrained
+ * vertex and uses it to place the mapped vertex where the displacement
+ * field locates it. Because the solution of the Laplace equation is smooth,
+ * this guarantees a smooth mapping from the old domain to the new one.
+ *
+ * @param[in] new_points The locations where a subset of the existing
+ * vertices are to be placed. Typically, this would be a map from the vertex
+ * indices of all nodes on the boundary to their new locations, thus
+ * completely specifying the geometry of the mapped domain. However, it may
+ * also include interior points if necessary and it does not need to include
+ * all boundary vertices (although you then lose control over the exact
+ * shape of the mapped domain).
+ *
+ * @param[in,out] tria The Triangulation object. This object is changed in-
+ * place, i.e., the previous locations of vertices are overwritten.
+ *
+ * @param[in] coefficient An optional coefficient for the Laplace problem.
+ * Larger values make cells less prone to deformation (effectively
+ * increasing their stiffness). The coefficient is evaluated in the
+ * coordinate system of the old, undeformed configuration of the
+ * triangulation as input, i.e., before the transformation is applied.
+ * Should this function be provided, sensible results can only be expected
+ * if all coefficients are positive.
+ *
+ * @param[in] solve_for_absolute_positions If set to <code>true</code>, the
+ * minimization problem is formulated with respect to the final vertex positions
+ * as opposed to their displacement. The two formulations are equivalent for
+ * the homogeneous problem (default value of @p coefficient), but they
+ * result in very different mesh motion otherwise. Since in most cases one will
+ * be using a non-constant coefficient in displacement formulation, the default
+ * value of this parameter is <code>false</code>.
+ *
+ * @param[in] tol Tolerance for solving the system of linear equations.
+ *
+ * @note This function is not currently implemented for the 1d case.
+ * @note The code is taken from deal.II sources and user-specified solver tolerance added.
+ */
+template <int dim>
+inline void
+laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
+                  Triangulation<dim> &                      tria,
+                  const Function<dim, double> *             coefficient = 0,
+                  const bool   solve_for_absolute_positions             = false,
+                  const double tol = 1.e-10);
+
+
+// IMPLEMENTATION
+
+double
+sqr(const double x)
+{
+  return x * x;
+}
+
+bool
+isfinite(const Vector<double> &data)
+{
+  for (const auto &x : data)
+    {
+      if (!std::isfinite(x))
+        return false;
+    }
+  return true;
+}
+
+template <int dim>
+void
+output_data_vector(const Vector<double> &data,
+                   const std::string &   name,
+                   DataOut<dim> &        data_out)
+{
+  if (isfinite(data))
+    data_out.add_data_vector(data, name);
+  else
+    Logger::get_default().warning()
+      << name << " contains invalid data, skipping\n";
+  ;
+}
+
+template <typename F>
+Vector<double>
+evaluate_pointwise(const Vector<double> &x, const F &f)
+{
+  Vector<double> y(x.size());
+
+  parallel::apply_to_subranges(
+    0U,
+    x.size(),
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        y[i] = f(x[i]);
+    },
+    1024);
+
+  return y;
+}
+
+std::vector<double>
+split_string(const std::string &s, const char delimiter)
+{
+  const auto s_split = Utilities::split_string_list(s, delimiter);
+  return Utilities::string_to_double(s_split);
+}
+
+void
+initialize_function(std::unique_ptr<Function<1>> &f,
+                    const std::string &           expression,
+                    const std::string &           vars)
+{
+  if (expression.empty())
+    return;
+
+  const std::string ext =
+    expression.size() <= 4 ? "" : expression.substr(expression.size() - 4);
+
+  if (ext == ".txt" || ext == ".dat" || ext == ".tsv")
+    {
+      using Table1D = std::pair<std::vector<double>, std::vector<double>>;
+
+      Table1D              table;
+      std::vector<double> &points = table.first;
+      std::vector<double> &data   = table.second;
+
+      const auto signature = file_signature(expression);
+      if (!FileCache<Table1D>::get(expression, signature, table))
+        {
+          const MappedFile infile(expression);
+          AssertThrow(infile.is_open(), ExcFileNotOpen(expression.c_str()));
+
+          TextParser file(infile.begin(), infile.end());
+          TextParser line(nullptr, nullptr);
+          while (file.get_line(line))
+            {
+              points.push_back(line.get_double());
+              data.push_back(line.get_double());
+            }
+
+          FileCache<Table1D>::add(expression, signature, table);
+        }
+
+      if (points.empty())
+        {
+          Logger::get_default().warning()
+            << expression << " contains no data\n";
+        }
+      else
+        {
+          std::ostream &out = Logger::get_default().detail();
+
+          out << expression << " contains " << points.size()
+              << " datapoints\n";
+
+          out << expression << " f(" << points.front() << ")=" << data.front()
+              << '\n';
+          if (points.size() > 1)
+            out << expression << " f(" << points.back() << ")=" << data.back()
+                << '\n';
+        }
+
+      using F = Functions::InterpolatedTensorProductGridData<1>;
+
+      const unsigned int n = points.size();
+
+#ifdef DEAL_II_WITH_CXX14
+      f = std::make_unique<F>(std::array<std::vector<double>, 1>{{points}},
+                              Table<1, double>{n, data.begin()});
+#else
+      f = std::unique_ptr<F>(new F(std::array<std::vector<double>, 1>{{points}},
+                                   Table<1, double>{n, data.begin()}));
+#endif
+    }
+  else
+    {
+      using F = FunctionParser<1>;
+
+#ifdef DEAL_II_WITH_CXX14
+      f = std::make_unique<F>();
+#else
+      f = std::unique_ptr<F>(new F());
+#endif
+
+      auto *fp = dynamic_cast<F *>(f.get());
+      fp->initialize(vars, expression, F::ConstMap());
+    }
+}
+
+void
+initialize_function(std::unique_ptr<Function<2>> &f,
+                    const std::string &           expression,
+                    const std::string &           vars)
+{
+  const std::string ext =
+    expression.size() <= 4 ? "" : expression.substr(expression.size() - 4);
+
+  if (ext == ".txt" || ext == ".dat" || ext == ".tsv")
+    {
+      using Table2D =
+        std::pair<std::array<std::vector<double>, 2>, Table<2, double>>;
+
+      Table2D                             table;
+      std::array<std::vector<double>, 2> &points = table.first;
+      Table<2, double> &                  data   = table.second;
+
+      const auto signature = file_signature(expression);
+      if (!FileCache<Table2D>::get(expression, signature, table))
+        {
+          const MappedFile infile(expression);
+          AssertThrow(infile.is_open(), ExcFileNotOpen(expression.c_str()));
+
+          TextParser file(infile.begin(), infile.end());
+
+          for (unsigned int k = 0; k < 2; ++k)
+            points[k].resize(file.get_ulong());
+
+          data.reinit(points[0].size(), points[1].size());
+
+          file.get_double(); // read dummy value
+
+          for (unsigned int i = 0; i < points[0].size(); ++i)
+            points[0][i] = file.get_double();
+
+          for (unsigned int j = 0; j < points[1].size(); ++j)
+            {
+              points[1][j] = file.get_double();
+
+              for (unsigned int i = 0; i < points[0].size(); ++i)
+                {
+                  data[i][j] = file.get_double();
+                }
+            }
+
+          FileCache<Table2D>::add(expression, signature, table);
+        }
+
+      if (points[0].empty())
+        {
+          Logger::get_default().warning()
+            << expression << " contains no data\n";
+        }
+      else
+        {
+          std::ostream &out = Logger::get_default().detail();
+
+          out << expression << " contains " << points[0].size() << " x "
+              << points[1].size() << " datapoints\n";
+
+          out << expression << " points[0]=" << points[0].front() << " .. "
+              << points[0].back() << '\n';
+          out << expression << " points[1]=" << points[1].front() << " .. "
+              << points[1].back() << '\n';
+        }
+
+      using F = Functions::InterpolatedTensorProductGridData<2>;
+
+#ifdef DEAL_II_WITH_CXX14
+      f = std::make_unique<F>(points, data);
+#else
+      f = std::unique_ptr<F>(new F(points, data));
+#endif
+    }
+  else
+    {
+      using F = FunctionParser<2>;
+
+#ifdef DEAL_II_WITH_CXX14
+      f = std::make_unique<F>();
+#else
+      f = std::unique_ptr<F>(new F());
+#endif
+
+      auto *fp = dynamic_cast<F *>(f.get());
+      fp->initialize(vars, expression, F::ConstMap());
+    }
+}
+
+template <class T>
+std::pair<T, T>
+minmax(const Vector<T> &x)
+{
+  const auto mm = std::minmax_element(x.begin(), x.end());
+  return std::make_pair(*mm.first, *mm.second);
+}
+
+template <class T>
+std::pair<T, T>
+minmax(const BlockVector<T> &x)
+{
+  std::vector<T> data;
+
+  for (unsigned int i = 0; i < x.n_blocks(); ++i)
+    {
+      const auto mm = std::minmax_element(x.block(i).begin(), x.block(i).end());
+      data.push_back(*mm.first);
+      data.push_back(*mm.second);
+    }
+  const auto mm = std::minmax_element(data.begin(), data.end());
+  return std::make_pair(*mm.first, *mm.second);
+}
+
+double
+dx_analytical(const double a, const double b, const double dt)
+{
+  if (b == 0)
+    return a * dt; // a*dt + b*sqr(dt)/2
+
+  return a / b * (std::exp(b * dt) - 1);
+}
+
+std::vector<std::array<double, 2>>
+get_interpolation_weights(const std::vector<double> &times, const double t)
+{
+  AssertThrow(!times.empty(),
+              ExcMessage("get_interpolation_weights: empty array passed"));
+
+  // early return 1
+  if (times.size() == 1)
+    return {{{times[0], 1}}};
+
+  std::vector<double> T = times;
+  std::sort(T.begin(), T.end());
+
+  // early return 2
+  if (t <= T.front())
+    return {{{T.front(), 1}}};
+
+  // early return 2
+  if (t >= T.back())
+    return {{{T.back(), 1}}};
+
+  // find t1 and t2
+  for (unsigned int i = 0; i < T.size() - 1; ++i)
+    {
+      const double t1 = T[i];
+      const double t2 = T[i + 1];
+
+      if (t == t1 || t == t2)
+        return {{{t, 1}}};
+
+      if (t1 <= t && t <= t2)
+        {
+          const double dt = t2 - t1;
+          const double w1 = (t2 - t) / dt;
+          const double w2 = 1 - w1;
+
+          return {{{t1, w1}}, {{t2, w2}}};
+        }
+    }
+
+  // this should never occur
+  AssertThrow(false, ExcMessage("get_interpolation_weights: failed"));
+}
+
+std::string
+format_time(const double x)
+{
+  return "(" + std::to_string(x) + " s)";
+}
+
+std::string
+format_time(const Timer &timer)
+{
+  return format_time(timer.wall_time());
+}
+
+std::vector<std::string>
+coordinate_names(const unsigned int dim)
+{
+  if (dim == 1)
+    return {"x"};
+  if (dim == 2)
+    return {"r", "z"};
+  if (dim == 3)
+    return {"x", "y", "z"};
+
+  AssertThrow(false, ExcNotImplemented());
+  return {};
+}
+
+template <typename T>
+void
+write_data(const T &data, const std::string &file_name)
+{
+  try
+    {
+      Logger::get_default().info() << "Saving to '" << file_name << "'\n";
+      std::ofstream f(file_name);
+      AssertThrow(f.is_open(), ExcFileNotOpen(file_name));
+      data.block_write(f);
+      AssertThrow(f.good(), ExcIO());
+    }
+  catch (std::exception &e)
+    {
+      Logger::get_default().error() << e.what() << "\n";
+    }
+}
+
+template <typename T>
+void
+write_data(const T &          data,
+           const std::string &file_name,
+           BackgroundWriter & writer)
+{
+  if (writer.is_synchronous())
+    {
+      write_data(data, file_name);
+      return;
+    }
+
+  Logger::get_default().info() << "Queueing '" << file_name << "'\n";
+  writer.submit([data, file_name]() {
+    std::ofstream f(file_name);
+    AssertThrow(f.is_open(), ExcFileNotOpen(file_name));
+    data.block_write(f);
+    AssertThrow(f.good(), ExcIO());
+  });
+}
+
+template <typename T>
+void
+read_data(T &data, const std::string &file_name)
+{
+  try
+    {
+      std::ifstream f(file_name);
+      if (f.is_open())
+        {
+          Logger::get_default().info()
+            << "Reading from '" << file_name << "'\n";
+          data.block_read(f);
+        }
+      else
+        {
+          Logger::get_default().info()
+            << "Skipping reading from '" << file_name << "'\n";
+        }
+    }
+  catch (std::exception &e)
+    {
+      Logger::get_default().error() << e.what() << "\n";
+    }
+}
+
+namespace
+{
+  /** Mix \c value into hash \c h (splitmix64 finalizer)
+   */
+  inline std::uint64_t
+  hash_combine(std::uint64_t h, const std::uint64_t value)
+  {
+    h ^= value + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+  }
+} // namespace
+
+// FileSignature
+
+bool
+FileSignature::operator==(const FileSignature &other) const
+{
+  return mtime == other.mtime && ctime == other.ctime && size == other.size &&
+         device == other.device && inode == other.inode && hash == other.hash;
+}
+
+bool
+FileSignature::operator!=(const FileSignature &other) const
+{
+  return !(*this == other);
+}
+
+FileSignature
+file_signature(const std::string &file_name)
+{
+  FileSignature signature;
+
+  struct stat st;
+  if (stat(file_name.c_str(), &st) != 0)
+    return signature;
+
+#ifdef __linux__
+  signature.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  signature.ctime = st.st_ctim.tv_sec * 1000000000LL + st.st_ctim.tv_nsec;
+#else
+  signature.mtime = st.st_mtime * 1000000000LL;
+  signature.ctime = st.st_ctime * 1000000000LL;
+#endif
+  signature.size   = st.st_size;
+  signature.device = st.st_dev;
+  signature.inode  = st.st_ino;
+
+  const MappedFile file(file_name);
+  if (!file.is_open())
+    return signature;
+
+  // 8 bytes at a time, the tail is padded with zeros
+  const std::size_t n_words = file.size() / sizeof(std::uint64_t);
+  const char *      p       = file.begin();
+
+  std::uint64_t h = hash_combine(0, file.size());
+  for (std::size_t i = 0; i < n_words; ++i, p += sizeof(std::uint64_t))
+    {
+      std::uint64_t word;
+      std::memcpy(&word, p, sizeof(word));
+      h = hash_combine(h, word);
+    }
+
+  std::uint64_t tail = 0;
+  if (p != file.end())
+    std::memcpy(&tail, p, file.end() - p);
+  signature.hash = hash_combine(h, tail);
+
+  return signature;
+}
+
+std::uint64_t
+matrix_hash(const SparseMatrix<double> &matrix, const std::uint64_t seed)
+{
+  std::uint64_t h = hash_combine(seed, matrix.m());
+  h               = hash_combine(h, matrix.n_nonzero_elements());
+
+  for (auto it = matrix.begin(); it != matrix.end(); ++it)
+    {
+      const double  v = it->value();
+      std::uint64_t bits;
+      std::memcpy(&bits, &v, sizeof(bits));
+
+      h = hash_combine(h, it->column());
+      h = hash_combine(h, bits);
+    }
+
+  return h;
+}
+
+double
+random_sign(const std::uint64_t i)
+{
+  return hash_combine(0, i) >> 63 ? 1 : -1;
+}
+
+std::string
+base64_encode(const char *data, const std::size_t n)
+{
+  static const char table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  std::string out;
+  out.reserve(4 * ((n + 2) / 3));
+
+  const unsigned char *d = reinterpret_cast<const unsigned char *>(data);
+
+  std::size_t i = 0;
+  for (; i + 2 < n; i += 3)
+    {
+      const unsigned int x = (d[i] << 16) | (d[i + 1] << 8) | d[i + 2];
+      out += table[(x >> 18) & 63];
+      out += table[(x >> 12) & 63];
+      out += table[(x >> 6) & 63];
+      out += table[x & 63];
+    }
+
+  if (i < n)
+    {
+      const unsigned int x = (d[i] << 16) | (i + 1 < n ? d[i + 1] << 8 : 0);
+      out += table[(x >> 18) & 63];
+      out += table[(x >> 12) & 63];
+      out += i + 1 < n ? table[(x >> 6) & 63] : '=';
+      out += '=';
+    }
+
+  return out;
+}
+
+void
+base64_decode(const char *begin, const char *end, std::vector<char> &out)
+{
+  const auto value = [](const char c) -> int {
+    if (c >= 'A' && c <= 'Z')
+      return c - 'A';
+    if (c >= 'a' && c <= 'z')
+      return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+      return c - '0' + 52;
+    if (c == '+')
+      return 62;
+    if (c == '/')
+      return 63;
+    if (c == '=')
+      return -1;
+    return -2;
+  };
+
+  out.reserve(out.size() + 3 * ((end - begin) / 4));
+
+  // decode quadruples of characters, padding ends the current block
+  int          quad[4];
+  unsigned int n = 0;
+
+  for (const char *c = begin; c < end; ++c)
+    {
+      const int v = value(*c);
+      if (v == -2)
+        {
+          AssertThrow(std::isspace(static_cast<unsigned char>(*c)),
+                      ExcMessage(std::string("base64_decode: invalid "
+                                             "character '") +
+                                 *c + "'"));
+          continue;
+        }
+
+      quad[n++] = v;
+      if (n < 4)
+        continue;
+      n = 0;
+
+      AssertThrow(quad[0] >= 0 && quad[1] >= 0,
+                  ExcMessage("base64_decode: invalid padding"));
+
+      out.push_back(static_cast<char>((quad[0] << 2) | (quad[1] >> 4)));
+      if (quad[2] >= 0)
+        out.push_back(
+          static_cast<char>(((quad[1] & 15) << 4) | (quad[2] >> 2)));
+      if (quad[2] >= 0 && quad[3] >= 0)
+        out.push_back(static_cast<char>(((quad[2] & 3) << 6) | quad[3]));
+    }
+
+  AssertThrow(n == 0, ExcMessage("base64_decode: truncated data"));
+}
+
+template <int dim>
+inline std::map<unsigned int, unsigned int>
+get_boundary_summary(const Triangulation<dim> &mesh)
+{
+  std::map<unsigned int, unsigned int> info;
+
+  typename Triangulation<dim>::active_cell_iterator cell = mesh.begin_active(),
+                                                    endc = mesh.end();
+
+  for (; cell != endc; ++cell)
+    {
+      for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
+        {
+          const auto &face = cell->face(i);
+
+          if (face->at_boundary())
+            {
+              info[face->boundary_id()]++;
+            }
+        }
+    }
+
+  return info;
+}
+
+template <int dim>
+std::map<unsigned int, Point<dim>>
+get_boundary_points(const Triangulation<dim> &mesh,
+                    const unsigned int        boundary_id)
+{
+  std::map<unsigned int, Point<dim>> points;
+
+  typename Triangulation<dim>::active_cell_iterator cell = mesh.begin_active(),
+                                                    endc = mesh.end();
+
+  for (; cell != endc; ++cell)
+    {
+      for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
+        {
+          const auto &face = cell->face(i);
+
+          if (face->at_boundary() && face->boundary_id() == boundary_id)
+            {
+              for (unsigned int j = 0; j < GeometryInfo<dim>::vertices_per_face;
+                   ++j)
+                {
+                  points[face->vertex_index(j)] = face->vertex(j);
+                }
+            }
+        }
+    }
+  return points;
+}
+
+template <int dim>
+void
+update_boundary_points(const Triangulation<dim> &                mesh,
+                       const std::map<unsigned int, Point<dim>> &new_points)
+{
+  typename Triangulation<dim>::active_cell_iterator cell = mesh.begin_active(),
+                                                    endc = mesh.end();
+
+  for (; cell != endc; ++cell)
+    {
+      for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
+        {
+          const auto &face = cell->face(i);
+
+          if (face->at_boundary())
+            {
+              for (unsigned int j = 0; j < GeometryInfo<dim>::vertices_per_face;
+                   ++j)
+                {
+                  const unsigned int k  = face->vertex_index(j);
+                  const auto         it = new_points.find(k);
+
+                  if (it != new_points.end())
+                    face->vertex(j) = it->second;
+                }
+            }
+        }
+    }
+}
+
+template <int dim>
+void
+output_boundary_field_at_quadrature_points(const DoFHandler<dim> &dh,
+                                           FEFaceValues<dim> &   fe_face_values,
+                                           const Vector<double> &field,
+                                           const unsigned int    boundary_id,
+                                           const std::string &   file_name)
+{
+  try
+    {
+      Timer timer;
+      Logger::get_default().info() << "Saving to '" << file_name;
+      std::ofstream output(file_name);
+
+      const auto dims = coordinate_names(dim);
+      for (const auto &d : dims)
+        output << d << "[m]\t";
+
+      output << "f\n";
+
+
+      const Quadrature<dim - 1> &face_quadrature =
+        fe_face_values.get_quadrature();
+      const unsigned int n_face_q_points = face_quadrature.size();
+
+      std::vector<double> field_face_q(n_face_q_points);
+
+      typename DoFHandler<dim>::active_cell_iterator cell = dh.begin_active(),
+                                                     endc = dh.end();
+      for (; cell != endc; ++cell)
+        {
+          for (unsigned int face_number = 0;
+               face_number < GeometryInfo<dim>::faces_per_cell;
+               ++face_number)
+            {
+              if (!cell->face(face_number)->at_boundary())
+                continue;
+
+              if (cell->face(face_number)->boundary_id() != boundary_id)
+                continue;
+
+              fe_face_values.reinit(cell, face_number);
+              fe_face_values.get_function_values(field, field_face_q);
+
+              for (unsigned int q = 0; q < n_face_q_points; ++q)
+                {
+                  const Point<dim> &p = fe_face_values.quadrature_point(q);
+
+                  for (unsigned int d = 0; d < dim; ++d)
+                    output << p[d] << '\t';
+
+                  output << field_face_q[q] << '\n';
+                }
+            }
+        }
+      Logger::get_default().info() << " " << format_time(timer) << "\n";
+    }
+  catch (std::exception &e)
+    {
+      Logger::get_default().error() << e.what() << "\n";
+    }
+}
+
+template <int dim>
+void
+calculate_hanging_node_constraints(const DoFHandler<dim> & dh,
+                                   HangingNodeConstraints &constraints)
+{
+  constraints.clear();
+  DoFTools::make_hanging_node_constraints(dh, constraints);
+  constraints.close();
+}
+
+template <int dim>
+void
+mark_cells_for_refinement(Triangulation<dim> &triangulation,
+                          const Vector<float> &error,
+                          const double         refine_fraction,
+                          const double         coarsen_fraction,
+                          const unsigned int   max_level)
+{
+  AssertThrow(error.size() == triangulation.n_active_cells(),
+              ExcMessage("mark_cells_for_refinement: error size " +
+                         std::to_string(error.size()) +
+                         " does not match the number of active cells " +
+                         std::to_string(triangulation.n_active_cells())));
+
+  GridRefinement::refine_and_coarsen_fixed_fraction(triangulation,
+                                                    error,
+                                                    refine_fraction,
+                                                    coarsen_fraction);
+
+  if (max_level > 0)
+    {
+      for (const auto &cell : triangulation.active_cell_iterators())
+        {
+          if (cell->level() >= static_cast<int>(max_level))
+            cell->clear_refine_flag();
+        }
+    }
+
+  triangulation.prepare_coarsening_and_refinement();
+}
+
+template <int dim>
+void
+copy_refinement_flags(const Triangulation<dim> &source,
+                      Triangulation<dim> &      target)
+{
+  AssertThrow(source.n_active_cells() == target.n_active_cells(),
+              ExcMessage("copy_refinement_flags: the meshes differ"));
+
+  std::vector<bool> flags;
+  source.save_refine_flags(flags);
+  target.load_refine_flags(flags);
+  source.save_coarsen_flags(flags);
+  target.load_coarsen_flags(flags);
+}
+
+template <int dim>
+Point<dim>
+closest_segment_point(const Point<dim> &p,
+                      const Point<dim> &segment_p0,
+                      const Point<dim> &segment_p1)
+{
+  const auto d = segment_p1 - segment_p0;
+  double     t = d * (p - segment_p0) / d.norm_square();
+  // clamp to [0,1]
+  t = std::max(0.0, std::min(1.0, t));
+
+  return segment_p0 + t * d;
+}
+
+template <int dim>
+std::array<double, 2>
+barycentric_coordinates(const Point<dim> &p,
+                        const Point<dim> &segment_p0,
+                        const Point<dim> &segment_p1)
+{
+  const auto   d = segment_p1 - segment_p0;
+  const double t = d * (p - segment_p0) / d.norm_square();
+
+  // t=0 corresponds to the first point segment_p0
+  return {{1.0 - t, t}};
+}
+
+// TabulatedFunction
+
+TabulatedFunction::TabulatedFunction()
+  : x_min(0)
+  , x_max(0)
+  , inv_dx(0)
+{}
+
+void
+TabulatedFunction::initialize(const Function<1> &f_new,
+                              const double       x_min_new,
+                              const double       x_max_new,
+                              const unsigned int n)
+{
+  f = &f_new;
+  table.clear();
+
+  if (n < 2)
+    return;
+
+  AssertThrow(x_max_new > x_min_new,
+              ExcMessage("TabulatedFunction: x_max=" +
+                         std::to_string(x_max_new) + " <= x_min=" +
+                         std::to_string(x_min_new)));
+
+  x_min  = x_min_new;
+  x_max  = x_max_new;
+  inv_dx = (n - 1) / (x_max - x_min);
+
+  table.resize(n);
+  for (unsigned int i = 0; i < n; ++i)
+    table[i] = f->value(Point<1>(x_min + i / inv_dx));
+}
+
+bool
+TabulatedFunction::empty() const
+{
+  return table.empty();
+}
+
+double
+TabulatedFunction::get_x_min() const
+{
+  return x_min;
+}
+
+double
+TabulatedFunction::get_x_max() const
+{
+  return x_max;
+}
+
+const std::vector<double> &
+TabulatedFunction::get_table() const
+{
+  return table;
+}
+
+double
+TabulatedFunction::value(const double x) const
+{
+  if (table.empty() || !(x >= x_min && x <= x_max))
+    return f->value(Point<1>(x));
+
+  const double       t = (x - x_min) * inv_dx;
+  const unsigned int i = std::min(static_cast<unsigned int>(t),
+                                  static_cast<unsigned int>(table.size() - 2));
+  const double       w = t - i;
+
+  return (1 - w) * table[i] + w * table[i + 1];
+}
+
+double
+TabulatedFunction::value(const Point<1> &p, const unsigned int) const
+{
+  return value(p[0]);
+}
+
+void
+TabulatedFunction::value_list(const std::vector<Point<1>> &points,
+                              std::vector<double> &        values,
+                              const unsigned int) const
+{
+  AssertDimension(points.size(), values.size());
+
+  for (unsigned int i = 0; i < points.size(); ++i)
+    values[i] = value(points[i][0]);
+}
+
+void
+TabulatedFunction::value_list(const std::vector<double> &x,
+                              std::vector<double> &      values) const
+{
+  values.resize(x.size());
+
+  for (unsigned int i = 0; i < x.size(); ++i)
+    values[i] = value(x[i]);
+}
+
+// Triangle
+
+template <int dim>
+void
+Triangle<dim>::reinit(const Point<dim> &p0,
+                      const Point<dim> &p1,
+                      const Point<dim> &p2)
+{
+  m_points[0] = p0;
+  m_points[1] = p1;
+  m_points[2] = p2;
+
+  calculate_normal_and_area();
+
+  m_center = (p0 + p1 + p2) / 3;
+
+  m_longest_side =
+    std::max(std::max((p1 - p0).norm(), (p2 - p0).norm()), (p1 - p2).norm());
+}
+
+template <int dim>
+Point<dim>
+Triangle<dim>::center() const
+{
+  return m_center;
+}
+
+template <int dim>
+Point<dim>
+Triangle<dim>::normal() const
+{
+  return m_normal;
+}
+
+template <int dim>
+double
+Triangle<dim>::area() const
+{
+  return m_area;
+}
+
+template <int dim>
+double
+Triangle<dim>::longest_side() const
+{
+  return m_longest_side;
+}
+
+template <int dim>
+Point<dim>
+Triangle<dim>::closest_triangle_point(const Point<dim> &p) const
+{
+  const Point<dim> p_proj = project_to_triangle_plane(p);
+
+  const auto t3 = barycentric_coordinates(p_proj);
+
+  bool inside = true;
+
+  for (const auto &t : t3)
+    inside = inside && (t >= 0) && (t <= 1);
+
+  if (inside)
+    {
+      return p_proj;
+    }
+  else
+    {
+      Point<dim> p_closest;
+      double     d2_min = -1;
+
+      for (unsigned int i = 0; i < 3; ++i)
+        {
+          const Point<dim> p_edge =
+            closest_segment_point(p, m_points[i], m_points[(i + 1) % 3]);
+          const double d2 = (p - p_edge).norm_square();
+
+          if (d2 < d2_min || d2_min < 0)
+            {
+              d2_min    = d2;
+              p_closest = p_edge;
+            }
+        }
+
+      return p_closest;
+    }
+}
+
+template <int dim>
+void
+Triangle<dim>::calculate_normal_and_area()
+{
+  m_normal = Point<dim>(
+    cross_product_3d(m_points[1] - m_points[0], m_points[2] - m_points[0]));
+
+  m_area = 0.5 * m_normal.norm();
+
+  // normalize
+  if (m_area > 0)
+    m_normal /= (2 * m_area);
+}
+
+template <int dim>
+double
+Triangle<dim>::signed_area(const Point<dim> &p0,
+                           const Point<dim> &p1,
+                           const Point<dim> &p2) const
+{
+  return 0.5 * (m_normal * cross_product_3d(p1 - p0, p2 - p0));
+}
+
+template <int dim>
+Point<dim>
+Triangle<dim>::project_to_triangle_plane(const Point<dim> &p) const
+{
+  return Point<dim>(p - m_normal * (m_normal * (p - m_points[0])));
+}
+
+template <int dim>
+std::array<double, 3>
+Triangle<dim>::barycentric_coordinates(const Point<dim> &p) const
+{
+  return {{signed_area(p, m_points[1], m_points[2]) / m_area,
+           signed_area(m_points[0], p, m_points[2]) / m_area,
+           signed_area(m_points[0], m_points[1], p) / m_area}};
+}
+
+// InterpolationPlan
+
+template <int dim>
+InterpolationPlan<dim>::InterpolationPlan()
+  : m_source_revision(0)
+  , m_source_type(0)
+{}
+
+template <int dim>
+void
+InterpolationPlan<dim>::clear()
+{
+  m_target_points.clear();
+  m_markers.clear();
+  m_source_revision = 0;
+  m_source_type     = 0;
+  m_target_indices.clear();
+  m_source_indices.clear();
+  m_weights.clear();
+}
+
+template <int dim>
+bool
+InterpolationPlan<dim>::empty() const
+{
+  return m_source_revision == 0;
+}
+
+template <int dim>
+void
+InterpolationPlan<dim>::reinit(const std::vector<Point<dim>> &target_points,
+                               const std::vector<bool> &      markers,
+                               const unsigned long            source_revision,
+                               const unsigned int             source_type)
+{
+  AssertDimension(target_points.size(), markers.size());
+
+  clear();
+
+  m_target_points   = target_points;
+  m_markers         = markers;
+  m_source_revision = source_revision;
+  m_source_type     = source_type;
+}
+
+template <int dim>
+void
+InterpolationPlan<dim>::add(const unsigned int i,
+                            const unsigned int j,
+                            const double       w)
+{
+  AssertIndexRange(i, m_target_points.size());
+
+  m_target_indices.push_back(i);
+  m_source_indices.push_back(j);
+  m_weights.push_back(w);
+}
+
+template <int dim>
+bool
+InterpolationPlan<dim>::matches(const std::vector<Point<dim>> &target_points,
+                                const std::vector<bool> &      markers,
+                                const unsigned long            source_revision,
+                                const unsigned int source_type) const
+{
+  return !empty() && m_source_revision == source_revision &&
+         m_source_type == source_type && m_markers == markers &&
+         m_target_points == target_points;
+}
+
+template <int dim>
+void
+InterpolationPlan<dim>::apply(const std::vector<double> &source_field,
+                              Vector<double> &           target_values) const
+{
+  target_values.reinit(m_target_points.size());
+
+  const unsigned int n = m_weights.size();
+  for (unsigned int k = 0; k < n; ++k)
+    {
+      AssertIndexRange(m_source_indices[k], source_field.size());
+
+      target_values[m_target_indices[k]] +=
+        m_weights[k] * source_field[m_source_indices[k]];
+    }
+}
+
+template <int dim>
+unsigned long
+InterpolationPlan<dim>::get_source_revision() const
+{
+  return m_source_revision;
+}
+
+template <int dim>
+unsigned int
+InterpolationPlan<dim>::get_source_type() const
+{
+  return m_source_type;
+}
+
+template <int dim>
+unsigned long
+InterpolationPlan<dim>::new_revision()
+{
+  // zero is reserved for empty plans, atomic since interpolators are also
+  // created and read concurrently (parameter sweeps, coupling tasks)
+  static std::atomic<unsigned long> r(0);
+  return ++r;
+}
+
+// MappedFile
+
+MappedFile::MappedFile(const std::string &file_name)
+  : data(nullptr)
+  , n_bytes(0)
+  , mapped(false)
+  , opened(false)
+{
+#ifdef MACPLAS_HAVE_MMAP
+  const int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st;
+  if (::fstat(fd, &st) == 0)
+    {
+      opened  = true;
+      n_bytes = st.st_size;
+
+      if (n_bytes > 0)
+        {
+          void *p = ::mmap(nullptr, n_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (p != MAP_FAILED)
+            {
+              data   = static_cast<const char *>(p);
+              mapped = true;
+#  ifdef POSIX_MADV_SEQUENTIAL
+              posix_madvise(p, n_bytes, POSIX_MADV_SEQUENTIAL);
+#  endif
+            }
+        }
+    }
+  ::close(fd);
+
+  if (mapped || !opened)
+    return;
+#endif
+
+  // fallback: read the whole file into memory
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file.is_open())
+    {
+      opened = false;
+      return;
+    }
+
+  buffer.assign(std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>());
+  opened  = true;
+  data    = buffer.data();
+  n_bytes = buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MACPLAS_HAVE_MMAP
+  if (mapped)
+    ::munmap(const_cast<char *>(data), n_bytes);
+#endif
+}
+
+bool
+MappedFile::is_open() const
+{
+  return opened;
+}
+
+const char *
+MappedFile::begin() const
+{
+  return data;
+}
+
+const char *
+MappedFile::end() const
+{
+  return data + n_bytes;
+}
+
+std::size_t
+MappedFile::size() const
+{
+  return n_bytes;
+}
+
+// TextParser
+
+TextParser::TextParser(const char *begin, const char *end)
+  : position(begin)
+  , buffer_end(end)
+{}
+
+bool
+TextParser::at_end()
+{
+  skip_whitespace();
+
+  return position >= buffer_end;
+}
+
+bool
+TextParser::get_line(TextParser &line)
+{
+  while (position < buffer_end)
+    {
+      const char *line_end = static_cast<const char *>(
+        std::memchr(position, '\n', buffer_end - position));
+      if (!line_end)
+        line_end = buffer_end;
+
+      line     = TextParser(position, line_end);
+      position = line_end < buffer_end ? line_end + 1 : buffer_end;
+
+      if (!line.at_end())
+        return true;
+    }
+
+  return false;
+}
+
+std::string
+TextParser::get_token()
+{
+  const char *begin, *end;
+  next_token(begin, end);
+
+  return std::string(begin, end);
+}
+
+double
+TextParser::get_double()
+{
+  const char *begin, *end;
+  next_token(begin, end);
+
+  const std::size_t n = end - begin;
+  AssertThrow(n > 0, ExcMessage("TextParser: number expected, end found"));
+
+  // terminate the token for strtod, the buffer is read-only
+  char        local[64];
+  std::string long_token;
+  const char *token;
+  if (n < sizeof(local))
+    {
+      std::memcpy(local, begin, n);
+      local[n] = '\0';
+      token    = local;
+    }
+  else
+    {
+      long_token.assign(begin, end);
+      token = long_token.c_str();
+    }
+
+  char *        parsed_end;
+  const double x = std::strtod(token, &parsed_end);
+
+  AssertThrow(parsed_end == token + n,
+              ExcMessage("TextParser: '" + std::string(begin, end) +
+                         "' is not a number"));
+
+  return x;
+}
+
+unsigned long
+TextParser::get_ulong()
+{
+  const double x = get_double();
+
+  AssertThrow(x >= 0 && x == std::floor(x),
+              ExcMessage("TextParser: " + std::to_string(x) +
+                         " is not a non-negative integer"));
+
+  return static_cast<unsigned long>(x);
+}
+
+void
+TextParser::skip_whitespace()
+{
+  while (position < buffer_end &&
+         std::isspace(static_cast<unsigned char>(*position)))
+    ++position;
+}
+
+void
+TextParser::next_token(const char *&begin, const char *&end)
+{
+  skip_whitespace();
+
+  begin = position;
+  while (position < buffer_end &&
+         !std::isspace(static_cast<unsigned char>(*position)))
+    ++position;
+  end = position;
+}
+
+// FileCache
+
+template <typename T>
+bool
+FileCache<T>::get(const std::string &  file_name,
+                  const FileSignature &signature,
+                  T &                  object)
+{
+  Data &d = data();
+
+  std::shared_ptr<const T> cached;
+  {
+    std::lock_guard<std::mutex> lock(d.mutex);
+
+    const auto it = d.entries.find(file_name);
+    if (it == d.entries.end())
+      return false;
+
+    if (it->second.signature != signature || signature.size == 0)
+      {
+        d.entries.erase(it);
+        return false;
+      }
+
+    it->second.last_use = ++d.counter;
+    cached              = it->second.object;
+  }
+
+  // copy without holding the lock
+  object = *cached;
+  return true;
+}
+
+template <typename T>
+void
+FileCache<T>::add(const std::string &  file_name,
+                  const FileSignature &signature,
+                  const T &            object)
+{
+  Data &d = data();
+
+  if (signature.size == 0)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.capacity == 0)
+      return;
+  }
+
+  // copy without holding the lock
+  const std::shared_ptr<const T> copy(new T(object));
+
+  std::lock_guard<std::mutex> lock(d.mutex);
+
+  d.entries.erase(file_name);
+  // caching disabled in the meantime
+  if (d.capacity == 0)
+    return;
+
+  while (!d.entries.empty() && d.entries.size() >= d.capacity)
+    {
+      auto oldest = d.entries.begin();
+      for (auto it = d.entries.begin(); it != d.entries.end(); ++it)
+        {
+          if (it->second.last_use < oldest->second.last_use)
+            oldest = it;
+        }
+      d.entries.erase(oldest);
+    }
+
+  d.entries[file_name] = Entry{signature, copy, ++d.counter};
+}
+
+template <typename T>
+void
+FileCache<T>::set_capacity(const unsigned int n)
+{
+  Data &d = data();
+
+  std::lock_guard<std::mutex> lock(d.mutex);
+  d.capacity = n;
+  while (d.entries.size() > d.capacity)
+    d.entries.erase(d.entries.begin());
+}
+
+template <typename T>
+void
+FileCache<T>::clear()
+{
+  Data &d = data();
+
+  std::lock_guard<std::mutex> lock(d.mutex);
+  d.entries.clear();
+}
+
+template <typename T>
+typename FileCache<T>::Data &
+FileCache<T>::data()
+{
+  static Data d;
+  return d;
+}
+
+// SurfaceInterpolator3D
+
+SurfaceInterpolator3D::SurfaceInterpolator3D()
+  : revision(InterpolationPlan<dim>::new_revision())
+  , profiler(std::make_shared<Profiler>())
+{}
+
+void
+SurfaceInterpolator3D::read_vtk(const std::string &file_name)
+{
+  Timer timer;
+
+  clear();
+
+  const auto signature = file_signature(file_name);
+  if (read_cached(file_name, signature))
+    return;
+
+  const MappedFile mapped_file(file_name);
+
+  if (!mapped_file.is_open())
+    {
+      Logger::get_default().warning()
+        << "Could not open '" << file_name << "'\n";
+      return;
+    }
+  else
+    Logger::get_default().info() << "Reading '" << file_name << "'";
+
+
+  TextParser  file(mapped_file.begin(), mapped_file.end());
+  std::string s, data_type, data_name;
+
+  // First line should be "# vtk DataFile Version 4.2"
+  while (!file.at_end())
+    {
+      s = file.get_token();
+
+      if (s == "POINTS")
+        {
+          const unsigned int n = file.get_ulong();
+          file.get_token(); // data type
+          points.resize(n);
+
+          for (unsigned int i = 0; i < n; ++i)
+            {
+              for (unsigned int k = 0; k < dim; ++k)
+                points[i][k] = file.get_double();
+            }
+        }
+      else if (s == "CELLS")
+        {
+          const unsigned int n = file.get_ulong();
+          file.get_token(); // size
+          triangles.resize(n);
+
+          for (unsigned int i = 0; i < n; ++i)
+            {
+              s = file.get_token();
+              if (s != "3")
+                throw std::runtime_error("Triangle expected, numPoints=" + s +
+                                         "found");
+              for (unsigned int k = 0; k < 3; ++k)
+                triangles[i][k] = file.get_ulong();
+            }
+        }
+      else
+        {
+          if (s == "CELL_DATA" || s == "POINT_DATA")
+            data_type = s;
+
+          if (s == "SCALARS")
+            {
+              data_name = file.get_token();
+              file.get_token(); // data type
+              file.get_token(); // LOOKUP_TABLE
+              file.get_token();
+
+              unsigned int N =
+                data_type == "CELL_DATA" ? triangles.size() : points.size();
+
+              std::vector<double> &f = data_type == "CELL_DATA" ?
+                                         cell_fields[data_name] :
+                                         point_fields[data_name];
+              f.resize(N);
+
+              for (unsigned int i = 0; i < N; ++i)
+                f[i] = file.get_double();
+            }
+
+          if (s == "FIELD")
+            {
+              file.get_token(); // FieldData
+              const unsigned int n_fields = file.get_ulong();
+
+              for (unsigned int k = 0; k < n_fields; ++k)
+                {
+                  data_name = file.get_token();
+                  for (unsigned int j = 0; j < 3; ++j)
+                    file.get_token();
+
+                  unsigned int N =
+                    data_type == "CELL_DATA" ? triangles.size() : points.size();
+
+                  std::vector<double> &f = data_type == "CELL_DATA" ?
+                                             cell_fields[data_name] :
+                                             point_fields[data_name];
+                  f.resize(N);
+
+                  for (unsigned int i = 0; i < N; ++i)
+                    f[i] = file.get_double();
+                }
+            }
+        }
+    }
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+
+  info();
+  preprocess();
+
+  FileCache<SurfaceInterpolator3D>::add(file_name, signature, *this);
+}
+
+void
+SurfaceInterpolator3D::read_vtu(const std::string &file_name)
+{
+  Timer timer;
+
+  clear();
+
+  const auto signature = file_signature(file_name);
+  if (read_cached(file_name, signature))
+    return;
+
+  const MappedFile file(file_name);
+
+  if (!file.is_open())
+    {
+      Logger::get_default().warning()
+        << "Could not open '" << file_name << "'\n";
+      return;
+    }
+  else
+    Logger::get_default().info() << "Reading '" << file_name << "'";
+
+  const char *const begin = file.begin();
+  const char *const end   = file.end();
+
+  const auto find = [end](const char *from, const std::string &pattern) {
+    return std::search(from, end, pattern.begin(), pattern.end());
+  };
+
+  // value of an attribute of an XML tag, empty if not found
+  const auto attribute = [](const std::string &tag, const std::string &name) {
+    const std::string key = " " + name + "=\"";
+    const auto        pos = tag.find(key);
+    if (pos == std::string::npos)
+      return std::string();
+
+    const auto value_begin = pos + key.size();
+    return tag.substr(value_begin, tag.find('"', value_begin) - value_begin);
+  };
+
+  // raw appended data may contain any bytes, the XML part ends before it
+  const char *const appended_tag  = find(begin, "<AppendedData");
+  const char *      appended_data = end;
+  std::string       appended_encoding;
+  if (appended_tag != end)
+    {
+      const char *tag_end = std::find(appended_tag, end, '>');
+      appended_encoding =
+        attribute(std::string(appended_tag, tag_end), "encoding");
+
+      appended_data = std::find(tag_end, end, '_');
+      AssertThrow(appended_data != end,
+                  ExcMessage("read_vtu: no appended data in '" + file_name +
+                             "'"));
+      ++appended_data;
+    }
+
+  // data arrays, with the contents if not appended
+  struct DataArray
+  {
+    std::string  section;
+    std::string  name;
+    std::string  type;
+    std::string  format;
+    unsigned int n_components;
+    std::size_t  offset;
+    const char * begin;
+    const char * end;
+  };
+  std::vector<DataArray> arrays;
+
+  std::string header_type = "UInt32";
+  bool        compressed  = false;
+  bool        big_endian  = false;
+  std::string section;
+
+  for (const char *p = std::find(begin, appended_tag, '<'); p < appended_tag;
+       p             = std::find(p, appended_tag, '<'))
+    {
+      const char *tag_end = std::find(p, appended_tag, '>');
+      AssertThrow(tag_end != appended_tag,
+                  ExcMessage("read_vtu: unterminated tag in '" + file_name +
+                             "'"));
+
+      std::string tag(p, tag_end + 1);
+      std::replace_if(
+        tag.begin(),
+        tag.end(),
+        [](const char c) {
+          return std::isspace(static_cast<unsigned char>(c));
+        },
+        ' ');
+      p = tag_end + 1;
+
+      const std::string tag_name =
+        tag.substr(1, tag.find_first_of(" />", 2) - 1);
+
+      if (tag_name == "VTKFile")
+        {
+          if (!attribute(tag, "header_type").empty())
+            header_type = attribute(tag, "header_type");
+          compressed = !attribute(tag, "compressor").empty();
+          big_endian = attribute(tag, "byte_order") == "BigEndian";
+        }
+      else if (tag_name == "Piece")
+        {
+          const std::string n_points = attribute(tag, "NumberOfPoints");
+          const std::string n_cells  = attribute(tag, "NumberOfCells");
+          AssertThrow(!n_points.empty() && !n_cells.empty(),
+                      ExcMessage("read_vtu: no number of points and cells "
+                                 "in '" +
+                                 file_name + "'"));
+
+          points.resize(Utilities::string_to_int(n_points));
+          triangles.resize(Utilities::string_to_int(n_cells));
+        }
+      else if (tag_name == "PointData" || tag_name == "CellData" ||
+               tag_name == "Points" || tag_name == "Cells")
+        section = tag_name;
+      else if (tag_name == "/PointData" || tag_name == "/CellData" ||
+               tag_name == "/Points" || tag_name == "/Cells")
+        section.clear();
+      else if (tag_name == "DataArray")
+        {
+          DataArray a;
+          a.section = section;
+          a.name    = attribute(tag, "Name");
+          a.type    = attribute(tag, "type");
+          a.format  = attribute(tag, "format");
+
+          const std::string n_components = attribute(tag, "NumberOfComponents");
+          a.n_components =
+            n_components.empty() ? 1 : Utilities::string_to_int(n_components);
+
+          const std::string offset = attribute(tag, "offset");
+          a.offset = offset.empty() ? 0 : std::stoull(offset);
+
+          a.begin = a.end = p;
+          if (tag[tag.size() - 2] != '/')
+            {
+              a.end = find(p, "</DataArray>");
+              p     = a.end;
+            }
+
+          arrays.push_back(a);
+        }
+    }
+
+  AssertThrow(header_type == "UInt32" || header_type == "UInt64",
+              ExcMessage("read_vtu: unsupported header type '" + header_type +
+                         "'"));
+  const unsigned int header_size = header_type == "UInt64" ? 8 : 4;
+
+  const std::uint16_t one = 1;
+  const bool host_big_endian = *reinterpret_cast<const char *>(&one) == 0;
+
+  // the appended arrays are contiguous, the next offset ends an array
+  std::vector<std::size_t> offsets;
+  for (const auto &a : arrays)
+    {
+      if (a.format == "appended")
+        offsets.push_back(a.offset);
+    }
+  std::sort(offsets.begin(), offsets.end());
+
+  std::vector<char> decoded, buffer;
+
+  // uncompressed binary data of an array, without copying if possible
+  const auto binary_data =
+    [&](const DataArray &a) -> std::pair<const char *, std::size_t> {
+    AssertThrow(big_endian == host_big_endian,
+                ExcMessage("read_vtu: byte order of '" + file_name +
+                           "' differs from the system"));
+
+    const char *b       = a.begin;
+    const char *e       = a.end;
+    bool        encoded = true;
+
+    if (a.format == "appended")
+      {
+        AssertThrow(a.offset <= static_cast<std::size_t>(end - appended_data),
+                    ExcMessage("read_vtu: invalid offset in '" + file_name +
+                               "'"));
+
+        encoded = appended_encoding == "base64";
+        b       = appended_data + a.offset;
+
+        const auto next =
+          std::upper_bound(offsets.begin(), offsets.end(), a.offset);
+        if (next != offsets.end())
+          e = appended_data + std::min<std::size_t>(*next, end - appended_data);
+        else
+          e = encoded ? find(b, "</AppendedData>") : end;
+      }
+
+    if (encoded)
+      {
+        decoded.clear();
+        base64_decode(b, e, decoded);
+        b = decoded.data();
+        e = b + decoded.size();
+      }
+
+    return decode_vtu_block(b, e, header_size, compressed, buffer);
+  };
+
+  for (const auto &a : arrays)
+    {
+      const bool is_connectivity =
+        a.section == "Cells" && a.name == "connectivity"; // only connectivity
+      if (a.section.empty() || (a.section == "Cells" && !is_connectivity))
+        continue;
+
+      std::vector<double> data;
+
+      if (a.format == "ascii")
+        {
+          TextParser parser(a.begin, a.end);
+          while (!parser.at_end())
+            data.push_back(parser.get_double());
+        }
+      else
+        {
+          AssertThrow(a.format == "binary" || a.format == "appended",
+                      ExcMessage("read_vtu: unsupported format '" + a.format +
+                                 "'"));
+
+          const auto d = binary_data(a);
+          convert_vtu_values(d.first, d.second, a.type, data);
+        }
+
+      const unsigned int n         = data.size();
+      const std::string  data_type = "<" + a.section + ">";
+      const std::string &data_name = a.name;
+
+      if (a.section == "CellData" && a.n_components == dim) // vector field
+        {
+          if (n != dim * triangles.size())
+            throw std::runtime_error(data_type + " " +
+                                     std::to_string(triangles.size()) + " " +
+                                     data_name + " " + std::to_string(n));
+
+          auto &field = cell_vector_fields[data_name];
+          field.resize(n / dim);
+
+          for (unsigned int i = 0; i < n / dim; ++i)
+            {
+              for (unsigned int k = 0; k < dim; ++k)
+                field[i][k] = data[dim * i + k];
+            }
+        }
+      else if (a.section == "CellData") // cell field
+        {
+          if (n != triangles.size())
+            throw std::runtime_error(data_type + " " +
+                                     std::to_string(triangles.size()) + " " +
+                                     data_name + " " + std::to_string(n));
+
+          cell_fields[data_name] = std::move(data);
+        }
+      else if (a.section == "PointData") // point field
+        {
+          if (n != points.size())
+            throw std::runtime_error(data_type + " " +
+                                     std::to_string(points.size()) + " " +
+                                     data_name + " " + std::to_string(n));
+
+          point_fields[data_name] = std::move(data);
+        }
+      else if (a.section == "Points") // point coordinates
+        {
+          if (n != 3 * points.size())
+            throw std::runtime_error(data_type + " " +
+                                     std::to_string(points.size()) + " " +
+                                     data_name + " " + std::to_string(n));
+
+          for (unsigned int i = 0; i < n / 3; ++i)
+            {
+              unsigned int k = 3 * i;
+
+              points[i] = Point<dim>(data[k], data[k + 1], data[k + 2]);
+            }
+        }
+      else if (is_connectivity)
+        {
+          if (n != 3 * triangles.size())
+            throw std::runtime_error(data_type + " " +
+                                     std::to_string(points.size()) + " " +
+                                     data_name + " " + std::to_string(n));
+
+          for (unsigned int i = 0; i < n / 3; ++i)
+            {
+              unsigned int k = 3 * i;
+
+              triangles[i] = {{static_cast<unsigned long>(data[k]),
+                               static_cast<unsigned long>(data[k + 1]),
+                               static_cast<unsigned long>(data[k + 2])}};
+            }
+        }
+    }
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+
+  info();
+  preprocess();
+
+  FileCache<SurfaceInterpolator3D>::add(file_name, signature, *this);
+}
+
+void
+SurfaceInterpolator3D::write_vtu(const std::string &file_name,
+                                 const VTUFormat    format) const
+{
+  Timer timer;
+
+  Logger::get_default().info() << "Saving to '" << file_name << "'";
+
+  if (format != AsciiVTU)
+    {
+      write_vtu_binary(file_name, format);
+      Logger::get_default().info() << " " << format_time(timer) << "\n";
+      return;
+    }
+
+  std::ofstream f_out(file_name);
+  AssertThrow(f_out.is_open(), ExcFileNotOpen(file_name));
+
+  const unsigned int n_points    = points.size();
+  const unsigned int n_triangles = triangles.size();
+
+  f_out
+    << "<?xml version=\"1.0\"?>\n"
+       "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+       "<UnstructuredGrid>\n"
+       "<Piece NumberOfPoints=\""
+    << n_points << "\" NumberOfCells=\"" << n_triangles << "\">\n";
+
+
+  f_out << "<CellData>\n";
+  for (const auto &it : cell_fields)
+    {
+      f_out << "<DataArray type=\"Float64\" Name=\"" << it.first
+            << "\" format=\"ascii\">\n";
+      for (const auto &x : it.second)
+        f_out << std::scientific << std::setprecision(14) << x << " ";
+      f_out << "\n</DataArray>\n";
+    }
+  for (const auto &it : cell_vector_fields)
+    {
+      f_out << "<DataArray type=\"Float64\" Name=\"" << it.first
+            << "\" NumberOfComponents=\"3\" format=\"ascii\">\n";
+      for (const auto &x : it.second)
+        f_out << std::scientific << std::setprecision(14) << x << "\n";
+      f_out << "</DataArray>\n";
+    }
+  f_out << "</CellData>\n";
+
+
+  f_out << "<PointData>\n";
+  for (const auto &it : point_fields)
+    {
+      f_out << "<DataArray type=\"Float64\" Name=\"" << it.first
+            << "\" format=\"ascii\">\n";
+      for (const auto &x : it.second)
+        f_out << std::scientific << std::setprecision(14) << x << " ";
+      f_out << "\n</DataArray>\n";
+    }
+  f_out << "</PointData>\n";
+
+
+  f_out << "<Points>\n";
+  f_out
+    << "<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
+  for (const auto &p : points)
+    f_out << std::scientific << std::setprecision(14) << p << "\n";
+  f_out << "</DataArray>\n";
+  f_out << "</Points>\n";
+
+
+  f_out << "<Cells>\n";
+
+  f_out
+    << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
+  for (const auto &t : triangles)
+    {
+      for (const auto &v : t)
+        f_out << v << " ";
+      f_out << "\n";
+    }
+  f_out << "</DataArray>\n";
+
+  f_out << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
+  for (unsigned int i = 0; i < n_triangles; ++i)
+    f_out << 3 * (i + 1) << " ";
+  f_out << "\n</DataArray>\n";
+
+  f_out << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n";
+  for (unsigned int i = 0; i < n_triangles; ++i)
+    f_out << "5 "; // VTK_TRIANGLE
+  f_out << "\n</DataArray>\n";
+
+  f_out << "</Cells>\n";
+
+
+  f_out << "</Piece>\n"
+           "</UnstructuredGrid>\n"
+           "</VTKFile>\n";
+
+  AssertThrow(f_out.good(), ExcIO());
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+}
+
+void
+SurfaceInterpolator3D::write_vtu_binary(const std::string &file_name,
+                                        const VTUFormat    format) const
+{
+  std::ofstream f_out(file_name, std::ios::binary);
+  AssertThrow(f_out.is_open(), ExcFileNotOpen(file_name));
+
+  const unsigned int n_points    = points.size();
+  const unsigned int n_triangles = triangles.size();
+
+  const std::uint16_t one        = 1;
+  const bool          big_endian = *reinterpret_cast<const char *>(&one) == 0;
+
+  f_out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+        << (big_endian ? "BigEndian" : "LittleEndian")
+        << "\" header_type=\"UInt64\""
+        << (format == CompressedVTU ? " compressor=\"vtkZLibDataCompressor\"" :
+                                      "")
+        << ">\n"
+        << "<UnstructuredGrid>\n"
+        << "<Piece NumberOfPoints=\"" << n_points << "\" NumberOfCells=\""
+        << n_triangles << "\">\n";
+
+  std::string appended;
+
+  // binary data of an array, written inline or appended at the end
+  const auto write_array = [&](const std::string &attributes,
+                               const char *       data,
+                               const std::size_t  n_bytes) {
+    const std::string block =
+      encode_vtu_block(std::string(data, n_bytes), format);
+
+    if (format == AppendedVTU)
+      {
+        f_out << "<DataArray " << attributes
+              << " format=\"appended\" offset=\"" << appended.size()
+              << "\"/>\n";
+        appended += block;
+      }
+    else
+      f_out << "<DataArray " << attributes << " format=\"binary\">\n"
+            << block << "\n</DataArray>\n";
+  };
+
+
+  f_out << "<CellData>\n";
+  for (const auto &it : cell_fields)
+    write_array("type=\"Float64\" Name=\"" + it.first + "\"",
+                reinterpret_cast<const char *>(it.second.data()),
+                it.second.size() * sizeof(double));
+  for (const auto &it : cell_vector_fields)
+    {
+      std::vector<double> data(dim * it.second.size());
+      for (unsigned int i = 0; i < it.second.size(); ++i)
+        {
+          for (unsigned int k = 0; k < dim; ++k)
+            data[dim * i + k] = it.second[i][k];
+        }
+
+      write_array("type=\"Float64\" Name=\"" + it.first +
+                    "\" NumberOfComponents=\"3\"",
+                  reinterpret_cast<const char *>(data.data()),
+                  data.size() * sizeof(double));
+    }
+  f_out << "</CellData>\n";
+
+
+  f_out << "<PointData>\n";
+  for (const auto &it : point_fields)
+    write_array("type=\"Float64\" Name=\"" + it.first + "\"",
+                reinterpret_cast<const char *>(it.second.data()),
+                it.second.size() * sizeof(double));
+  f_out << "</PointData>\n";
+
+
+  std::vector<double> coordinates(dim * n_points);
+  for (unsigned int i = 0; i < n_points; ++i)
+    {
+      for (unsigned int k = 0; k < dim; ++k)
+        coordinates[dim * i + k] = points[i][k];
+    }
+
+  f_out << "<Points>\n";
+  write_array("type=\"Float64\" NumberOfComponents=\"3\"",
+              reinterpret_cast<const char *>(coordinates.data()),
+              coordinates.size() * sizeof(double));
+  f_out << "</Points>\n";
+
+
+  std::vector<std::int64_t> connectivity(3 * n_triangles);
+  std::vector<std::int64_t> offsets(n_triangles);
+  std::vector<std::uint8_t> types(n_triangles, 5); // VTK_TRIANGLE
+  for (unsigned int i = 0; i < n_triangles; ++i)
+    {
+      for (unsigned int k = 0; k < 3; ++k)
+        connectivity[3 * i + k] = triangles[i][k];
+      offsets[i] = 3 * (i + 1);
+    }
+
+  f_out << "<Cells>\n";
+  write_array("type=\"Int64\" Name=\"connectivity\"",
+              reinterpret_cast<const char *>(connectivity.data()),
+              connectivity.size() * sizeof(std::int64_t));
+  write_array("type=\"Int64\" Name=\"offsets\"",
+              reinterpret_cast<const char *>(offsets.data()),
+              offsets.size() * sizeof(std::int64_t));
+  write_array("type=\"UInt8\" Name=\"types\"",
+              reinterpret_cast<const char *>(types.data()),
+              types.size());
+  f_out << "</Cells>\n";
+
+
+  f_out << "</Piece>\n"
+           "</UnstructuredGrid>\n";
+
+  if (format == AppendedVTU)
+    {
+      f_out << "<AppendedData encoding=\"raw\">\n_";
+      f_out.write(appended.data(), appended.size());
+      f_out << "\n</AppendedData>\n";
+    }
+
+  f_out << "</VTKFile>\n";
+
+  AssertThrow(f_out.good(), ExcIO());
+}
+
+bool
+SurfaceInterpolator3D::read_cached(const std::string &  file_name,
+                                   const FileSignature &signature)
+{
+  Timer timer;
+
+  if (!FileCache<SurfaceInterpolator3D>::get(file_name, signature, *this))
+    return false;
+
+  // same mesh, but do not reuse the interpolation plans of other instances
+  revision = InterpolationPlan<dim>::new_revision();
+
+  Logger::get_default().info() << "Reading '" << file_name << "' from cache "
+                               << format_time(timer) << "\n";
+
+  info();
+  return true;
+}
+
+std::pair<const char *, std::size_t>
+SurfaceInterpolator3D::decode_vtu_block(const char *       begin,
+                                        const char *       end,
+                                        const unsigned int header_size,
+                                        const bool         compressed,
+                                        std::vector<char> &buffer)
+{
+  const std::size_t n_bytes = end - begin;
+
+  const auto header = [&](const std::size_t i) -> std::size_t {
+    AssertThrow((i + 1) * header_size <= n_bytes,
+                ExcMessage("decode_vtu_block: truncated header"));
+
+    if (header_size == 8)
+      {
+        std::uint64_t x;
+        std::memcpy(&x, begin + 8 * i, 8);
+        return x;
+      }
+
+    std::uint32_t x;
+    std::memcpy(&x, begin + 4 * i, 4);
+    return x;
+  };
+
+  if (!compressed)
+    {
+      const std::size_t n = header(0);
+      AssertThrow(header_size + n <= n_bytes,
+                  ExcMessage("decode_vtu_block: truncated data"));
+
+      return {begin + header_size, n};
+    }
+
+#ifdef DEAL_II_WITH_ZLIB
+  const std::size_t n_blocks        = header(0);
+  const std::size_t block_size      = header(1);
+  const std::size_t last_block_size = header(2);
+
+  // the last block is full if its size is zero
+  const std::size_t n_uncompressed =
+    n_blocks == 0 ? 0 :
+                    (n_blocks - 1) * block_size +
+                      (last_block_size > 0 ? last_block_size : block_size);
+  buffer.resize(n_uncompressed);
+
+  std::size_t position = (3 + n_blocks) * header_size;
+  std::size_t offset   = 0;
+  for (std::size_t i = 0; i < n_blocks; ++i)
+    {
+      const std::size_t compressed_size = header(3 + i);
+      AssertThrow(position + compressed_size <= n_bytes,
+                  ExcMessage("decode_vtu_block: truncated data"));
+
+      const std::size_t expected_size =
+        i + 1 < n_blocks || last_block_size == 0 ? block_size : last_block_size;
+      uLongf n = expected_size;
+
+      const int err =
+        uncompress(reinterpret_cast<Bytef *>(buffer.data() + offset),
+                   &n,
+                   reinterpret_cast<const Bytef *>(begin + position),
+                   compressed_size);
+      AssertThrow(err == Z_OK && n == expected_size,
+                  ExcMessage("decode_vtu_block: zlib error " +
+                             std::to_string(err)));
+
+      position += compressed_size;
+      offset += n;
+    }
+
+  return {buffer.data(), n_uncompressed};
+#else
+  (void)buffer;
+  AssertThrow(false,
+              ExcMessage("decode_vtu_block: compressed data require deal.II "
+                         "with zlib"));
+  return {begin, 0};
+#endif
+}
+
+void
+SurfaceInterpolator3D::convert_vtu_values(const char *         data,
+                                          const std::size_t    n_bytes,
+                                          const std::string &  type,
+                                          std::vector<double> &values)
+{
+  if (type == "Float64")
+    copy_vtu_values<double>(data, n_bytes, values);
+  else if (type == "Float32")
+    copy_vtu_values<float>(data, n_bytes, values);
+  else if (type == "Int8")
+    copy_vtu_values<std::int8_t>(data, n_bytes, values);
+  else if (type == "UInt8")
+    copy_vtu_values<std::uint8_t>(data, n_bytes, values);
+  else if (type == "Int16")
+    copy_vtu_values<std::int16_t>(data, n_bytes, values);
+  else if (type == "UInt16")
+    copy_vtu_values<std::uint16_t>(data, n_bytes, values);
+  else if (type == "Int32")
+    copy_vtu_values<std::int32_t>(data, n_bytes, values);
+  else if (type == "UInt32")
+    copy_vtu_values<std::uint32_t>(data, n_bytes, values);
+  else if (type == "Int64")
+    copy_vtu_values<std::int64_t>(data, n_bytes, values);
+  else if (type == "UInt64")
+    copy_vtu_values<std::uint64_t>(data, n_bytes, values);
+  else
+    AssertThrow(false,
+                ExcMessage("convert_vtu_values: unsupported type '" + type +
+                           "'"));
+}
+
+template <typename S>
+void
+SurfaceInterpolator3D::copy_vtu_values(const char *         data,
+                                       const std::size_t    n_bytes,
+                                       std::vector<double> &values)
+{
+  AssertThrow(n_bytes % sizeof(S) == 0,
+              ExcMessage("copy_vtu_values: " + std::to_string(n_bytes) +
+                         " bytes are not a multiple of the value size"));
+
+  const std::size_t n = n_bytes / sizeof(S);
+  values.resize(n);
+
+  // the data are not necessarily aligned
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      S x;
+      std::memcpy(&x, data + i * sizeof(S), sizeof(S));
+      values[i] = x;
+    }
+}
+
+std::string
+SurfaceInterpolator3D::encode_vtu_block(const std::string &data,
+                                        const VTUFormat    format)
+{
+  const auto header = [](const std::vector<std::uint64_t> &h) {
+    return std::string(reinterpret_cast<const char *>(h.data()),
+                       h.size() * sizeof(std::uint64_t));
+  };
+
+  if (format == BinaryVTU)
+    {
+      const std::string block = header({data.size()}) + data;
+      return base64_encode(block.data(), block.size());
+    }
+
+  if (format == AppendedVTU)
+    return header({data.size()}) + data;
+
+  AssertThrow(format == CompressedVTU, ExcNotImplemented());
+
+#ifdef DEAL_II_WITH_ZLIB
+  if (data.empty())
+    {
+      const std::string h = header({0, 0, 0});
+      return base64_encode(h.data(), h.size());
+    }
+
+  uLongf      n = compressBound(data.size());
+  std::string compressed(n, '\0');
+
+  const int err = compress2(reinterpret_cast<Bytef *>(&compressed[0]),
+                            &n,
+                            reinterpret_cast<const Bytef *>(data.data()),
+                            data.size(),
+                            Z_BEST_SPEED);
+  AssertThrow(err == Z_OK,
+              ExcMessage("encode_vtu_block: zlib error " +
+                         std::to_string(err)));
+  compressed.resize(n);
+
+  // a single block, the header and data are encoded separately like by VTK
+  const std::string h =
+    header({1, data.size(), data.size(), compressed.size()});
+
+  return base64_encode(h.data(), h.size()) +
+         base64_encode(compressed.data(), compressed.size());
+#else
+  AssertThrow(false,
+              ExcMessage("encode_vtu_block: compressed output requires "
+                         "deal.II with zlib"));
+  return "";
+#endif
+}
+
+void
+SurfaceInterpolator3D::interpolate(const FieldType &              field_type,
+                                   const std::string &            field_name,
+                                   const std::vector<Point<dim>> &target_points,
+                                   const std::vector<bool> &      markers,
+                                   Vector<double> &target_values) const
+{
+  Timer timer;
+
+  Logger::get_default().info() << "Interpolating field '" << field_name << "'";
+
+  InterpolationPlan<dim> plan;
+  create_plan(field_type, target_points, markers, plan);
+  interpolate(plan, field_name, target_values);
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+}
+
+void
+SurfaceInterpolator3D::interpolate(
+  const FieldType &                  field_type,
+  const std::string &                field_name,
+  const std::vector<Point<dim - 1>> &target_points,
+  const std::vector<bool> &          markers,
+  Vector<double> &                   target_values) const
+{
+  const unsigned int n_values = target_points.size();
+
+  std::vector<Point<dim>> points_3d(n_values);
+
+  // convert from 2D cylindrical coordinates (r,z) to 3D (x,y,z)
+  for (unsigned int i = 0; i < n_values; ++i)
+    {
+      points_3d[i][0] = target_points[i][0];
+      points_3d[i][1] = 0;
+      points_3d[i][2] = target_points[i][1];
+    }
+
+  interpolate(field_type, field_name, points_3d, markers, target_values);
+}
+
+void
+SurfaceInterpolator3D::interpolate(const FieldType &              field_type,
+                                   const std::string &            field_name,
+                                   const std::vector<Point<dim>> &target_points,
+                                   const std::vector<bool> &      markers,
+                                   Vector<double> &         target_values,
+                                   InterpolationPlan<dim> &plan) const
+{
+  Timer timer;
+
+  Logger::get_default().info() << "Interpolating field '" << field_name << "'";
+
+  if (!plan.matches(target_points, markers, revision, field_type))
+    {
+      Logger::get_default().info() << " (new plan)";
+      create_plan(field_type, target_points, markers, plan);
+    }
+
+  interpolate(plan, field_name, target_values);
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+}
+
+void
+SurfaceInterpolator3D::interpolate(
+  const FieldType &                  field_type,
+  const std::string &                field_name,
+  const std::vector<Point<dim - 1>> &target_points,
+  const std::vector<bool> &          markers,
+  Vector<double> &                   target_values,
+  InterpolationPlan<dim> &           plan) const
+{
+  const unsigned int n_values = target_points.size();
+
+  std::vector<Point<dim>> points_3d(n_values);
+
+  // convert from 2D cylindrical coordinates (r,z) to 3D (x,y,z)
+  for (unsigned int i = 0; i < n_values; ++i)
+    {
+      points_3d[i][0] = target_points[i][0];
+      points_3d[i][1] = 0;
+      points_3d[i][2] = target_points[i][1];
+    }
+
+  interpolate(field_type, field_name, points_3d, markers, target_values, plan);
+}
+
+void
+SurfaceInterpolator3D::interpolate(const InterpolationPlan<dim> &plan,
+                                   const std::string &           field_name,
+                                   Vector<double> &target_values) const
+{
+  const Profiler::Scope scope(*profiler, "interpolation/interpolate");
+
+  AssertThrow(plan.get_source_revision() == revision,
+              ExcMessage("Interpolation plan does not match the mesh"));
+
+  const FieldType field_type = static_cast<FieldType>(plan.get_source_type());
+
+  plan.apply(field(field_type, field_name), target_values);
+}
+
+void
+SurfaceInterpolator3D::create_plan(const FieldType &              field_type,
+                                   const std::vector<Point<dim>> &target_points,
+                                   const std::vector<bool> &      markers,
+                                   InterpolationPlan<dim> &       plan) const
+{
+  const Profiler::Scope scope(*profiler, "interpolation/create_plan");
+
+  AssertThrow(field_type == CellField || field_type == PointField,
+              ExcNotImplemented());
+
+  plan.reinit(target_points, markers, revision, field_type);
+
+  const unsigned int n_values = target_points.size();
+
+  for (unsigned int i = 0; i < n_values; ++i)
+    {
+      if (!markers[i])
+        continue;
+
+      Point<dim>         p_found;
+      const unsigned int j_found = closest_triangle(target_points[i], p_found);
+
+      switch (field_type)
+        {
+          case CellField:
+            plan.add(i, j_found, 1);
+            break;
+
+          case PointField:
+            const Triangle<dim> &triangle = triangle_cache[j_found];
+            const auto           t3 = triangle.barycentric_coordinates(p_found);
+            const auto &         v  = triangles[j_found];
+            for (unsigned int k = 0; k < 3; ++k)
+              plan.add(i, v[k], t3[k]);
+            break;
+        }
+    }
+}
+
+void
+SurfaceInterpolator3D::create_plan(
+  const FieldType &                  field_type,
+  const std::vector<Point<dim - 1>> &target_points,
+  const std::vector<bool> &          markers,
+  InterpolationPlan<dim> &           plan) const
+{
+  const unsigned int n_values = target_points.size();
+
+  std::vector<Point<dim>> points_3d(n_values);
+
+  // convert from 2D cylindrical coordinates (r,z) to 3D (x,y,z)
+  for (unsigned int i = 0; i < n_values; ++i)
+    {
+      points_3d[i][0] = target_points[i][0];
+      points_3d[i][1] = 0;
+      points_3d[i][2] = target_points[i][1];
+    }
+
+  create_plan(field_type, points_3d, markers, plan);
+}
+
+bool
+SurfaceInterpolator3D::empty() const
+{
+  return points.empty() || triangles.empty();
+}
+
+std::shared_ptr<Profiler>
+SurfaceInterpolator3D::get_profiler() const
+{
+  return profiler;
+}
+
+void
+SurfaceInterpolator3D::set_profiler(const std::shared_ptr<Profiler> &profiler)
+{
+  this->profiler = profiler;
+}
+
+void
+SurfaceInterpolator3D::convert(const FieldType &  source_type,
+                               const std::string &source_name,
+                               const FieldType &  target_type,
+                               const std::string &target_name)
+{
+  const std::string target_name_updated =
+    target_name.empty() ? source_name : target_name;
+
+  if (source_type == CellField && target_type == PointField)
+    {
+      cell_to_point(source_name, target_name_updated);
+    }
+  else if (source_type == PointField && target_type == CellField)
+    {
+      point_to_cell(source_name, target_name_updated);
+    }
+  else
+    {
+      throw std::runtime_error(
+        "Unsupported combination of source and target field types.");
+    }
+}
+
+const std::vector<double> &
+SurfaceInterpolator3D::field(const FieldType &  field_type,
+                             const std::string &field_name) const
+{
+  const auto &fields = field_type == CellField ? cell_fields : point_fields;
+  const auto &it     = fields.find(field_name);
+
+  if (it == fields.end())
+    throw std::runtime_error("Field '" + field_name + "' does not exist.");
+
+  return it->second;
+}
+
+std::vector<double> &
+SurfaceInterpolator3D::field(const FieldType &  field_type,
+                             const std::string &field_name)
+{
+  return field_type == CellField ? cell_fields[field_name] :
+                                   point_fields[field_name];
+}
+
+const std::vector<Point<SurfaceInterpolator3D::dim>> &
+SurfaceInterpolator3D::vector_field(const FieldType &  field_type,
+                                    const std::string &field_name) const
+{
+  AssertThrow(field_type == CellField, ExcNotImplemented());
+
+  const auto &fields = cell_vector_fields;
+  const auto &it     = fields.find(field_name);
+
+  if (it == fields.end())
+    throw std::runtime_error("Field '" + field_name + "' does not exist.");
+
+  return it->second;
+}
+
+void
+SurfaceInterpolator3D::cell_to_point(const std::string &source_name,
+                                     const std::string &target_name)
+{
+  Timer timer;
+
+  Logger::get_default().info()
+    << "Convering field '" << source_name << "' from cell to point";
+
+  const unsigned int n_points    = points.size();
+  const unsigned int n_triangles = triangles.size();
+
+  const std::vector<double> &source_field = field(CellField, source_name);
+
+  std::vector<double> &target_field = field(PointField, target_name);
+  target_field.resize(n_points);
+  std::fill(target_field.begin(), target_field.end(), 0);
+
+  std::vector<int> count(n_points, 0);
+
+  for (unsigned int i = 0; i < n_triangles; ++i)
+    {
+      const auto &v = triangles[i];
+      for (const auto &id : v)
+        {
+          target_field[id] += source_field[i];
+          count[id]++;
+        }
+    }
+
+  for (unsigned int i = 0; i < n_points; ++i)
+    {
+      if (count[i] > 0)
+        target_field[i] /= count[i];
+    }
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+}
+
+void
+SurfaceInterpolator3D::point_to_cell(const std::string &source_name,
+                                     const std::string &target_name)
+{
+  Timer timer;
+
+  Logger::get_default().info()
+    << "Convering field '" << source_name << "' from point to cell";
+
+  const unsigned int n_triangles = triangles.size();
+
+  const std::vector<double> &source_field = field(PointField, source_name);
+
+  std::vector<double> &target_field = field(CellField, target_name);
+  target_field.resize(n_triangles);
+  std::fill(target_field.begin(), target_field.end(), 0);
+
+  std::vector<int> count(n_triangles, 0);
 
-bool
-isfinite(const Vector<double> &data)
-{
-  for (const auto &x : data)
+  for (unsigned int i = 0; i < n_triangles; ++i)
     {
-      if (!std::isfinite(x))
-        return false;
+      const auto &v = triangles[i];
+      for (const auto &id : v)
+        {
+          target_field[i] += source_field[id];
+          count[i]++;
+        }
     }
-  return true;
+
+  for (unsigned int i = 0; i < n_triangles; ++i)
+    {
+      if (count[i] > 0)
+        target_field[i] /= count[i];
+    }
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
 }
 
-template <int dim>
 void
-output_data_vector(const Vector<double> &data,
-                   const std::string &   name,
-                   DataOut<dim> &        data_out)
+SurfaceInterpolator3D::clear()
 {
-  if (isfinite(data))
-    data_out.add_data_vector(data, name);
-  else
-    std::cout << name << " contains invalid data, skipping\n";
-  ;
+  points.clear();
+  triangles.clear();
+  cell_fields.clear();
+  point_fields.clear();
+  cell_vector_fields.clear();
+  triangle_cache.clear();
+  bvh_nodes.clear();
+  bvh_triangles.clear();
+  revision = InterpolationPlan<dim>::new_revision();
 }
 
-std::vector<double>
-split_string(const std::string &s, const char delimiter)
+void
+SurfaceInterpolator3D::info() const
 {
-  const auto s_split = Utilities::split_string_list(s, delimiter);
-  return Utilities::string_to_double(s_split);
+  Logger::get_default().detail() << "n_points:" << points.size() << " "
+                                 << "n_triangles:" << triangles.size() << "\n";
+
+  for (const auto &it : cell_fields)
+    Logger::get_default().detail()
+      << "CellData " << it.first << " " << it.second.size() << "\n";
+
+  for (const auto &it : point_fields)
+    Logger::get_default().detail()
+      << "PointData " << it.first << " " << it.second.size() << "\n";
 }
 
 void
-initialize_function(std::unique_ptr<Function<1>> &f,
-                    const std::string &           expression,
-                    const std::string &           vars)
+SurfaceInterpolator3D::preprocess()
 {
-  if (expression.empty())
-    return;
+  Timer timer;
 
-  const std::string ext =
-    expression.size() <= 4 ? "" : expression.substr(expression.size() - 4);
+  Logger::get_default().info() << "Preprocessing data";
 
-  if (ext == ".txt" || ext == ".dat" || ext == ".tsv")
+  const unsigned int n_triangles = triangles.size();
+
+  auto &area         = cell_fields["area"];
+  auto &longest_side = cell_fields["longest_side"];
+  auto &center       = cell_vector_fields["center"];
+  auto &normal       = cell_vector_fields["normal"];
+
+  area.resize(n_triangles);
+  longest_side.resize(n_triangles);
+  center.resize(n_triangles);
+  normal.resize(n_triangles);
+  triangle_cache.resize(n_triangles);
+
+  for (unsigned int i = 0; i < n_triangles; ++i)
     {
-      std::ifstream infile(expression);
-      AssertThrow(infile, ExcFileNotOpen(expression.c_str()));
+      const auto &   v        = triangles[i];
+      Triangle<dim> &triangle = triangle_cache[i];
+      triangle.reinit(points[v[0]], points[v[1]], points[v[2]]);
+
+      // for output, should be moved to debug mode
+      center[i]       = triangle.center();
+      normal[i]       = triangle.normal();
+      area[i]         = triangle.area();
+      longest_side[i] = triangle.longest_side();
+    }
 
-      std::vector<double> points, data;
+  build_bvh();
 
-      std::string line;
+  revision = InterpolationPlan<dim>::new_revision();
 
-      while (std::getline(infile, line))
-        {
-          std::stringstream ss(line);
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+}
 
-          double x, y;
-          ss >> x >> y;
+void
+SurfaceInterpolator3D::build_bvh()
+{
+  const unsigned int n_triangles = triangles.size();
 
-          points.push_back(x);
-          data.push_back(y);
-        }
+  bvh_nodes.clear();
+  bvh_triangles.resize(n_triangles);
+  for (unsigned int i = 0; i < n_triangles; ++i)
+    bvh_triangles[i] = i;
 
-      if (points.empty())
-        {
-          std::cout << expression << " contains no data\n";
-        }
-      else
+  if (n_triangles == 0)
+    return;
+
+  bvh_nodes.push_back({Point<dim>(), Point<dim>(), 0, n_triangles, 0});
+
+  std::vector<unsigned int> stack(1, 0);
+  while (!stack.empty())
+    {
+      const unsigned int n = stack.back();
+      stack.pop_back();
+
+      const unsigned int begin = bvh_nodes[n].begin;
+      const unsigned int end   = bvh_nodes[n].end;
+
+      // bounding boxes of the triangle vertices and of the triangle centers
+      Point<dim> box_min = points[triangles[bvh_triangles[begin]][0]];
+      Point<dim> box_max = box_min;
+      Point<dim> c_min   = triangle_cache[bvh_triangles[begin]].center();
+      Point<dim> c_max   = c_min;
+
+      for (unsigned int i = begin; i < end; ++i)
         {
-          std::cout << expression << " contains " << points.size()
-                    << " datapoints\n";
+          const unsigned int j = bvh_triangles[i];
+          const Point<dim>   c = triangle_cache[j].center();
 
-          std::cout << expression << " f(" << points.front()
-                    << ")=" << data.front() << '\n';
-          if (points.size() > 1)
-            std::cout << expression << " f(" << points.back()
-                      << ")=" << data.back() << '\n';
+          for (unsigned int d = 0; d < dim; ++d)
+            {
+              for (const auto &v : triangles[j])
+                {
+                  box_min[d] = std::min(box_min[d], points[v][d]);
+                  box_max[d] = std::max(box_max[d], points[v][d]);
+                }
+              c_min[d] = std::min(c_min[d], c[d]);
+              c_max[d] = std::max(c_max[d], c[d]);
+            }
         }
 
-      using F = Functions::InterpolatedTensorProductGridData<1>;
-
-      const unsigned int n = points.size();
+      bvh_nodes[n].box_min = box_min;
+      bvh_nodes[n].box_max = box_max;
 
-#ifdef DEAL_II_WITH_CXX14
-      f = std::make_unique<F>(std::array<std::vector<double>, 1>{{points}},
-                              Table<1, double>{n, data.begin()});
-#else
-      f = std::unique_ptr<F>(new F(std::array<std::vector<double>, 1>{{points}},
-                                   Table<1, double>{n, data.begin()}));
-#endif
-    }
-  else
-    {
-      using F = FunctionParser<1>;
+      if (end - begin <= bvh_leaf_size)
+        continue;
 
-#ifdef DEAL_II_WITH_CXX14
-      f = std::make_unique<F>();
-#else
-      f = std::unique_ptr<F>(new F());
-#endif
+      // split at the median triangle center along the longest extent
+      unsigned int axis = 0;
+      for (unsigned int d = 1; d < dim; ++d)
+        {
+          if (c_max[d] - c_min[d] > c_max[axis] - c_min[axis])
+            axis = d;
+        }
 
-      auto *fp = dynamic_cast<F *>(f.get());
-      fp->initialize(vars, expression, F::ConstMap());
+      const unsigned int mid = begin + (end - begin) / 2;
+      std::nth_element(bvh_triangles.begin() + begin,
+                       bvh_triangles.begin() + mid,
+                       bvh_triangles.begin() + end,
+                       [this, axis](const unsigned int a,
+                                    const unsigned int b) {
+                         return triangle_cache[a].center()[axis] <
+                                triangle_cache[b].center()[axis];
+                       });
+
+      const unsigned int child = bvh_nodes.size();
+      bvh_nodes[n].child       = child;
+      bvh_nodes.push_back({Point<dim>(), Point<dim>(), begin, mid, 0});
+      bvh_nodes.push_back({Point<dim>(), Point<dim>(), mid, end, 0});
+
+      stack.push_back(child);
+      stack.push_back(child + 1);
     }
 }
 
-void
-initialize_function(std::unique_ptr<Function<2>> &f,
-                    const std::string &           expression,
-                    const std::string &           vars)
+unsigned int
+SurfaceInterpolator3D::closest_triangle(const Point<dim> &p,
+                                        Point<dim> &      p_closest) const
 {
-  const std::string ext =
-    expression.size() <= 4 ? "" : expression.substr(expression.size() - 4);
-
-  if (ext == ".txt" || ext == ".dat" || ext == ".tsv")
-    {
-      std::ifstream infile(expression);
-      AssertThrow(infile, ExcFileNotOpen(expression.c_str()));
+  AssertThrow(!bvh_nodes.empty(), ExcInterpolationFailed<dim>(p));
+
+  // squared distance from p to the bounding box of the node
+  const auto box_distance_square = [&p](const BVHNode &node) {
+    double d2 = 0;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        if (p[d] < node.box_min[d])
+          d2 += sqr(node.box_min[d] - p[d]);
+        else if (p[d] > node.box_max[d])
+          d2 += sqr(p[d] - node.box_max[d]);
+      }
+    return d2;
+  };
 
-      std::array<std::vector<double>, 2> points;
+  unsigned int j_found = 0;
+  double       d2_min  = std::numeric_limits<double>::max();
 
-      for (unsigned int k = 0; k < 2; ++k)
-        {
-          int n;
-          infile >> n;
-          points[k].resize(n);
-        }
+  // branch and bound: nodes farther than the closest triangle are skipped
+  std::vector<std::pair<double, unsigned int>> stack;
+  stack.reserve(64);
+  stack.emplace_back(box_distance_square(bvh_nodes[0]), 0);
 
-      Table<2, double> data(points[0].size(), points[1].size());
+  while (!stack.empty())
+    {
+      const auto top = stack.back();
+      stack.pop_back();
 
-      double tmp;
-      infile >> tmp; // read dummy value
+      if (top.first >= d2_min)
+        continue;
 
-      for (unsigned int i = 0; i < points[0].size(); ++i)
-        infile >> points[0][i];
+      const BVHNode &node = bvh_nodes[top.second];
 
-      for (unsigned int j = 0; j < points[1].size(); ++j)
+      if (node.child == 0)
         {
-          infile >> points[1][j];
-
-          for (unsigned int i = 0; i < points[0].size(); ++i)
+          for (unsigned int i = node.begin; i < node.end; ++i)
             {
-              infile >> data[i][j];
-            }
-        }
+              const unsigned int j = bvh_triangles[i];
 
-      if (points[0].empty())
-        {
-          std::cout << expression << " contains no data\n";
+              const Point<dim> p_trial =
+                triangle_cache[j].closest_triangle_point(p);
+
+              const double d2 = (p_trial - p).norm_square();
+              if (d2 < d2_min)
+                {
+                  d2_min    = d2;
+                  p_closest = p_trial;
+                  j_found   = j;
+                }
+            }
         }
       else
         {
-          std::cout << expression << " contains " << points[0].size() << " x "
-                    << points[1].size() << " datapoints\n";
+          const double d2_0 = box_distance_square(bvh_nodes[node.child]);
+          const double d2_1 = box_distance_square(bvh_nodes[node.child + 1]);
 
-          std::cout << expression << " points[0]=" << points[0].front()
-                    << " .. " << points[0].back() << '\n';
-          std::cout << expression << " points[1]=" << points[1].front()
-                    << " .. " << points[1].back() << '\n';
+          // the closer child is put on top of the stack
+          if (d2_0 < d2_1)
+            {
+              stack.emplace_back(d2_1, node.child + 1);
+              stack.emplace_back(d2_0, node.child);
+            }
+          else
+            {
+              stack.emplace_back(d2_0, node.child);
+              stack.emplace_back(d2_1, node.child + 1);
+            }
         }
-
-      using F = Functions::InterpolatedTensorProductGridData<2>;
-
-#ifdef DEAL_II_WITH_CXX14
-      f = std::make_unique<F>(points, data);
-#else
-      f = std::unique_ptr<F>(new F(points, data));
-#endif
     }
-  else
-    {
-      using F = FunctionParser<2>;
 
-#ifdef DEAL_II_WITH_CXX14
-      f = std::make_unique<F>();
-#else
-      f = std::unique_ptr<F>(new F());
-#endif
+  AssertThrow(d2_min < std::numeric_limits<double>::max(),
+              ExcInterpolationFailed<dim>(p));
 
-      auto *fp = dynamic_cast<F *>(f.get());
-      fp->initialize(vars, expression, F::ConstMap());
-    }
+  return j_found;
 }
 
-template <class T>
-std::pair<T, T>
-minmax(const Vector<T> &x)
-{
-  const auto mm = std::minmax_element(x.begin(), x.end());
-  return std::make_pair(*mm.first, *mm.second);
-}
+// SurfaceInterpolator2D
 
-template <class T>
-std::pair<T, T>
-minmax(const BlockVector<T> &x)
+SurfaceInterpolator2D::SurfaceInterpolator2D()
+  : revision(InterpolationPlan<dim>::new_revision())
+  , profiler(std::make_shared<Profiler>())
+{}
+
+void
+SurfaceInterpolator2D::read_txt(const std::string &file_name)
 {
-  std::vector<T> data;
+  Timer timer;
 
-  for (unsigned int i = 0; i < x.n_blocks(); ++i)
+  clear();
+
+  const auto signature = file_signature(file_name);
+  if (FileCache<SurfaceInterpolator2D>::get(file_name, signature, *this))
     {
-      const auto mm = std::minmax_element(x.block(i).begin(), x.block(i).end());
-      data.push_back(*mm.first);
-      data.push_back(*mm.second);
+      // same mesh, but do not reuse the interpolation plans of other instances
+      revision = InterpolationPlan<dim>::new_revision();
+
+      Logger::get_default().info() << "Reading '" << file_name
+                                   << "' from cache " << format_time(timer)
+                                   << "\n";
+      info();
+      return;
     }
-  const auto mm = std::minmax_element(data.begin(), data.end());
-  return std::make_pair(*mm.first, *mm.second);
-}
 
-double
-dx_analytical(const double a, const double b, const double dt)
-{
-  if (b == 0)
-    return a * dt; // a*dt + b*sqr(dt)/2
+  const MappedFile mapped_file(file_name);
 
-  return a / b * (std::exp(b * dt) - 1);
-}
+  if (!mapped_file.is_open())
+    {
+      Logger::get_default().warning()
+        << "Could not open '" << file_name << "'\n";
+      return;
+    }
+  else
+    Logger::get_default().info() << "Reading '" << file_name << "'";
 
-std::vector<std::array<double, 2>>
-get_interpolation_weights(const std::vector<double> &times, const double t)
-{
-  AssertThrow(!times.empty(),
-              ExcMessage("get_interpolation_weights: empty array passed"));
 
-  // early return 1
-  if (times.size() == 1)
-    return {{{times[0], 1}}};
+  std::vector<std::string>         field_names;
+  std::vector<std::vector<double>> field_values;
 
-  std::vector<double> T = times;
-  std::sort(T.begin(), T.end());
+  TextParser file(mapped_file.begin(), mapped_file.end());
+  TextParser line(nullptr, nullptr);
+  while (file.get_line(line))
+    {
+      if (field_names.empty())
+        {
+          line.get_token(); // First 2 columns are x and y;
+          line.get_token();
+          while (!line.at_end()) // then - field names
+            field_names.push_back(line.get_token());
 
-  // early return 2
-  if (t <= T.front())
-    return {{{T.front(), 1}}};
+          field_values.resize(field_names.size());
+        }
+      else
+        {
+          Point<dim> p;
+          p[0] = line.get_double();
+          p[1] = line.get_double();
 
-  // early return 2
-  if (t >= T.back())
-    return {{{T.back(), 1}}};
+          points.push_back(p);
 
-  // find t1 and t2
-  for (unsigned int i = 0; i < T.size() - 1; ++i)
-    {
-      const double t1 = T[i];
-      const double t2 = T[i + 1];
+          for (unsigned int i = 0; i < field_names.size(); ++i)
+            field_values[i].push_back(line.get_double());
+        }
+    }
+
+  for (unsigned int i = 0; i < field_names.size(); ++i)
+    fields[field_names[i]] = std::move(field_values[i]);
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
+
+  info();
+
+  FileCache<SurfaceInterpolator2D>::add(file_name, signature, *this);
+}
 
-      if (t == t1 || t == t2)
-        return {{{t, 1}}};
+void
+SurfaceInterpolator2D::set_points(const std::vector<Point<dim>> &new_points)
+{
+  clear();
+  points = new_points;
 
-      if (t1 <= t && t <= t2)
-        {
-          const double dt = t2 - t1;
-          const double w1 = (t2 - t) / dt;
-          const double w2 = 1 - w1;
+#ifdef DEBUG
+  info();
+#endif
+}
 
-          return {{{t1, w1}}, {{t2, w2}}};
-        }
+void
+SurfaceInterpolator2D::set_points(const std::vector<Point<dim + 1>> &new_points)
+{
+  points.resize(new_points.size());
+
+  for (unsigned int i = 0; i < points.size(); ++i)
+    {
+      points[i][0] = std::hypot(new_points[i][0], new_points[i][1]);
+      points[i][1] = new_points[i][2];
     }
 
-  // this should never occur
-  AssertThrow(false, ExcMessage("get_interpolation_weights: failed"));
+  revision = InterpolationPlan<dim>::new_revision();
 }
 
-std::string
-format_time(const double x)
+const std::vector<Point<SurfaceInterpolator2D::dim>> &
+SurfaceInterpolator2D::get_points() const
 {
-  return "(" + std::to_string(x) + " s)";
+  return points;
 }
 
-std::string
-format_time(const Timer &timer)
+const std::vector<std::string>
+SurfaceInterpolator2D::get_field_names() const
 {
-  return format_time(timer.wall_time());
+  std::vector<std::string> names;
+
+  for (const auto &it : fields)
+    names.push_back(it.first);
+
+  return names;
 }
 
-std::vector<std::string>
-coordinate_names(const unsigned int dim)
+void
+SurfaceInterpolator2D::interpolate(const std::string &            field_name,
+                                   const std::vector<Point<dim>> &target_points,
+                                   const std::vector<bool> &      markers,
+                                   Vector<double> &target_values) const
 {
-  if (dim == 1)
-    return {"x"};
-  if (dim == 2)
-    return {"r", "z"};
-  if (dim == 3)
-    return {"x", "y", "z"};
+  Timer timer;
 
-  AssertThrow(false, ExcNotImplemented());
-  return {};
+  Logger::get_default().info() << "Interpolating field '" << field_name << "'";
+
+  InterpolationPlan<dim> plan;
+  create_plan(target_points, markers, plan);
+  interpolate(plan, field_name, target_values);
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
 }
 
-template <typename T>
 void
-write_data(const T &data, const std::string &file_name)
+SurfaceInterpolator2D::interpolate(
+  const std::string &                field_name,
+  const std::vector<Point<dim + 1>> &target_points,
+  const std::vector<bool> &          markers,
+  Vector<double> &                   target_values) const
 {
-  try
-    {
-      std::cout << "Saving to '" << file_name << "'\n";
-      std::ofstream f(file_name);
-      data.block_write(f);
-    }
-  catch (std::exception &e)
+  const unsigned int n_values = target_points.size();
+
+  std::vector<Point<dim>> points_2d(n_values);
+
+  // convert from 3D (x,y,z) to 2D cylindrical coordinates (r,z)
+  for (unsigned int i = 0; i < n_values; ++i)
     {
-      std::cout << e.what() << "\n";
+      points_2d[i][0] = std::hypot(target_points[i][0], target_points[i][1]);
+      points_2d[i][1] = target_points[i][2];
     }
+
+  interpolate(field_name, points_2d, markers, target_values);
 }
 
-template <typename T>
 void
-read_data(T &data, const std::string &file_name)
+SurfaceInterpolator2D::interpolate(const std::string &            field_name,
+                                   const std::vector<Point<dim>> &target_points,
+                                   const std::vector<bool> &      markers,
+                                   Vector<double> &         target_values,
+                                   InterpolationPlan<dim> &plan) const
 {
-  try
-    {
-      std::ifstream f(file_name);
-      if (f.is_open())
-        {
-          std::cout << "Reading from '" << file_name << "'\n";
-          data.block_read(f);
-        }
-      else
-        {
-          std::cout << "Skipping reading from '" << file_name << "'\n";
-        }
-    }
-  catch (std::exception &e)
+  Timer timer;
+
+  Logger::get_default().info() << "Interpolating field '" << field_name << "'";
+
+  if (!plan.matches(target_points, markers, revision))
     {
-      std::cout << e.what() << "\n";
+      Logger::get_default().info() << " (new plan)";
+      create_plan(target_points, markers, plan);
     }
+
+  interpolate(plan, field_name, target_values);
+
+  Logger::get_default().info() << " " << format_time(timer) << "\n";
 }
 
-template <int dim>
-inline std::map<unsigned int, unsigned int>
-get_boundary_summary(const Triangulation<dim> &mesh)
+void
+SurfaceInterpolator2D::interpolate(
+  const std::string &                field_name,
+  const std::vector<Point<dim + 1>> &target_points,
+  const std::vector<bool> &          markers,
+  Vector<double> &                   target_values,
+  InterpolationPlan<dim> &           plan) const
 {
-  std::map<unsigned int, unsigned int> info;
+  const unsigned int n_values = target_points.size();
 
-  typename Triangulation<dim>::active_cell_iterator cell = mesh.begin_active(),
-                                                    endc = mesh.end();
+  std::vector<Point<dim>> points_2d(n_values);
 
-  for (; cell != endc; ++cell)
+  // convert from 3D (x,y,z) to 2D cylindrical coordinates (r,z)
+  for (unsigned int i = 0; i < n_values; ++i)
     {
-      for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
-        {
-          const auto &face = cell->face(i);
-
-          if (face->at_boundary())
-            {
-              info[face->boundary_id()]++;
-            }
-        }
+      points_2d[i][0] = std::hypot(target_points[i][0], target_points[i][1]);
+      points_2d[i][1] = target_points[i][2];
     }
 
-  return info;
+  interpolate(field_name, points_2d, markers, target_values, plan);
 }
 
-template <int dim>
-std::map<unsigned int, Point<dim>>
-get_boundary_points(const Triangulation<dim> &mesh,
-                    const unsigned int        boundary_id)
+void
+SurfaceInterpolator2D::interpolate(const InterpolationPlan<dim> &plan,
+                                   const std::string &           field_name,
+                                   Vector<double> &target_values) const
 {
-  std::map<unsigned int, Point<dim>> points;
+  const Profiler::Scope scope(*profiler, "interpolation/interpolate");
 
-  typename Triangulation<dim>::active_cell_iterator cell = mesh.begin_active(),
-                                                    endc = mesh.end();
-
-  for (; cell != endc; ++cell)
-    {
-      for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
-        {
-          const auto &face = cell->face(i);
+  AssertThrow(plan.get_source_revision() == revision,
+              ExcMessage("Interpolation plan does not match the mesh"));
 
-          if (face->at_boundary() && face->boundary_id() == boundary_id)
-            {
-              for (unsigned int j = 0; j < GeometryInfo<dim>::vertices_per_face;
-                   ++j)
-                {
-                  points[face->vertex_index(j)] = face->vertex(j);
-                }
-            }
-        }
-    }
-  return points;
+  plan.apply(field(field_name), target_values);
 }
 
-template <int dim>
 void
-update_boundary_points(const Triangulation<dim> &                mesh,
-                       const std::map<unsigned int, Point<dim>> &new_points)
+SurfaceInterpolator2D::create_plan(const std::vector<Point<dim>> &target_points,
+                                   const std::vector<bool> &      markers,
+                                   InterpolationPlan<dim> &       plan) const
 {
-  typename Triangulation<dim>::active_cell_iterator cell = mesh.begin_active(),
-                                                    endc = mesh.end();
+  const Profiler::Scope scope(*profiler, "interpolation/create_plan");
 
-  for (; cell != endc; ++cell)
+  plan.reinit(target_points, markers, revision);
+
+  const unsigned int n_values = target_points.size();
+
+  for (unsigned int i = 0; i < n_values; ++i)
     {
-      for (unsigned int i = 0; i < GeometryInfo<dim>::faces_per_cell; ++i)
-        {
-          const auto &face = cell->face(i);
+      if (!markers[i])
+        continue;
 
-          if (face->at_boundary())
-            {
-              for (unsigned int j = 0; j < GeometryInfo<dim>::vertices_per_face;
-                   ++j)
-                {
-                  const unsigned int k  = face->vertex_index(j);
-                  const auto         it = new_points.find(k);
+      Point<dim>         p_found;
+      const unsigned int j_found = closest_segment(target_points[i], p_found);
 
-                  if (it != new_points.end())
-                    face->vertex(j) = it->second;
-                }
-            }
-        }
+      const auto t2 =
+        barycentric_coordinates(p_found, points[j_found], points[j_found + 1]);
+      for (unsigned int k = 0; k < 2; ++k)
+        plan.add(i, j_found + k, t2[k]);
     }
 }
 
-template <int dim>
-void
-output_boundary_field_at_quadrature_points(const DoFHandler<dim> &dh,
-                                           FEFaceValues<dim> &   fe_face_values,
-                                           const Vector<double> &field,
-                                           const unsigned int    boundary_id,
-                                           const std::string &   file_name)
+Point<SurfaceInterpolator2D::dim>
+SurfaceInterpolator2D::project(const Point<dim> &p) const
 {
-  try
-    {
-      Timer timer;
-      std::cout << "Saving to '" << file_name;
-      std::ofstream output(file_name);
-
-      const auto dims = coordinate_names(dim);
-      for (const auto &d : dims)
-        output << d << "[m]\t";
+  Point<dim> p_found;
+  closest_segment(p, p_found);
 
-      output << "f\n";
+  return p_found;
+}
 
+bool
+SurfaceInterpolator2D::empty() const
+{
+  return points.empty();
+}
 
-      const Quadrature<dim - 1> &face_quadrature =
-        fe_face_values.get_quadrature();
-      const unsigned int n_face_q_points = face_quadrature.size();
+std::shared_ptr<Profiler>
+SurfaceInterpolator2D::get_profiler() const
+{
+  return profiler;
+}
 
-      std::vector<double> field_face_q(n_face_q_points);
+void
+SurfaceInterpolator2D::set_profiler(const std::shared_ptr<Profiler> &profiler)
+{
+  this->profiler = profiler;
+}
 
-      typename DoFHandler<dim>::active_cell_iterator cell = dh.begin_active(),
-                                                     endc = dh.end();
-      for (; cell != endc; ++cell)
-        {
-          for (unsigned int face_number = 0;
-               face_number < GeometryInfo<dim>::faces_per_cell;
-               ++face_number)
-            {
-              if (!cell->face(face_number)->at_boundary())
-                continue;
+const std::vector<double> &
+SurfaceInterpolator2D::field(const std::string &field_name) const
+{
+  const auto &it = fields.find(field_name);
 
-              if (cell->face(face_number)->boundary_id() != boundary_id)
-                continue;
+  if (it == fields.end())
+    throw std::runtime_error("Field '" + field_name + "' does not exist.");
 
-              fe_face_values.reinit(cell, face_number);
-              fe_face_values.get_function_values(field, field_face_q);
+  return it->second;
+}
 
-              for (unsigned int q = 0; q < n_face_q_points; ++q)
-                {
-                  const Point<dim> &p = fe_face_values.quadrature_point(q);
+unsigned int
+SurfaceInterpolator2D::closest_segment(const Point<dim> &p,
+                                       Point<dim> &      p_closest) const
+{
+  const unsigned int n_points = points.size();
 
-                  for (unsigned int d = 0; d < dim; ++d)
-                    output << p[d] << '\t';
+  AssertThrow(n_points >= 2, ExcInterpolationFailed<dim>(p));
 
-                  output << field_face_q[q] << '\n';
-                }
-            }
-        }
-      std::cout << " " << format_time(timer) << "\n";
-    }
-  catch (std::exception &e)
+  unsigned int j_found = 0;
+  double       d2_min  = -1;
+
+  // number of segments is n_points-1
+  for (unsigned int j = 0; j + 1 < n_points; ++j)
     {
-      std::cout << e.what() << "\n";
-    }
-}
+      const Point<dim> p_trial =
+        closest_segment_point(p, points[j], points[j + 1]);
 
-template <int dim>
-Point<dim>
-closest_segment_point(const Point<dim> &p,
-                      const Point<dim> &segment_p0,
-                      const Point<dim> &segment_p1)
-{
-  const auto d = segment_p1 - segment_p0;
-  double     t = d * (p - segment_p0) / d.norm_square();
-  // clamp to [0,1]
-  t = std::max(0.0, std::min(1.0, t));
+      const double d2 = (p_trial - p).norm_square();
+      if (d2 < d2_min || d2_min < 0)
+        {
+          d2_min    = d2;
+          p_closest = p_trial;
+          j_found   = j;
+        }
+    }
 
-  return segment_p0 + t * d;
+  return j_found;
 }
 
-template <int dim>
-std::array<double, 2>
-barycentric_coordinates(const Point<dim> &p,
-                        const Point<dim> &segment_p0,
-                        const Point<dim> &segment_p1)
+void
+SurfaceInterpolator2D::clear()
 {
-  const auto   d = segment_p1 - segment_p0;
-  const double t = d * (p - segment_p0) / d.norm_square();
-
-  // t=0 corresponds to the first point segment_p0
-  return {{1.0 - t, t}};
+  points.clear();
+  fields.clear();
+  revision = InterpolationPlan<dim>::new_revision();
 }
 
-// Triangle
-
-template <int dim>
 void
-Triangle<dim>::reinit(const Point<dim> &p0,
-                      const Point<dim> &p1,
-                      const Point<dim> &p2)
+SurfaceInterpolator2D::info() const
 {
-  m_points[0] = p0;
-  m_points[1] = p1;
-  m_points[2] = p2;
+  Logger::get_default().detail() << "n_points:" << points.size() << "\n";
 
-  calculate_normal_and_area();
+  for (const auto &it : fields)
+    Logger::get_default().detail()
+      << "PointData " << it.first << " " << it.second.size() << "\n";
+}
 
-  m_center = (p0 + p1 + p2) / 3;
+// DoFGradientEvaluation
 
-  m_longest_side =
-    std::max(std::max((p1 - p0).norm(), (p2 - p0).norm()), (p1 - p2).norm());
-}
+template <int dim>
+DoFGradientEvaluation<dim>::ScratchData::ScratchData(
+  const FiniteElement<dim> &fe,
+  const Quadrature<dim> &   quadrature,
+  const unsigned int        n_fields)
+  : fe_values(fe, quadrature, update_gradients)
+  , values_cell(n_fields * fe.dofs_per_cell)
+  , grad_q(n_fields * quadrature.size())
+{}
 
 template <int dim>
-Point<dim>
-Triangle<dim>::center() const
-{
-  return m_center;
-}
+DoFGradientEvaluation<dim>::ScratchData::ScratchData(
+  const ScratchData &scratch_data)
+  : fe_values(scratch_data.fe_values.get_fe(),
+              scratch_data.fe_values.get_quadrature(),
+              scratch_data.fe_values.get_update_flags())
+  , values_cell(scratch_data.values_cell)
+  , grad_q(scratch_data.grad_q)
+{}
 
 template <int dim>
-Point<dim>
-Triangle<dim>::normal() const
+void
+DoFGradientEvaluation<dim>::clear()
 {
-  return m_normal;
+  dh = nullptr;
+  field_indices.clear();
+  fields.clear();
+  gradients.clear();
 }
 
 template <int dim>
-double
-Triangle<dim>::area() const
+void
+DoFGradientEvaluation<dim>::add_field(const std::string &   name,
+                                      const Vector<double> &field)
 {
-  return m_area;
+  const auto it = field_indices.find(name);
+
+  if (it == field_indices.end())
+    {
+      field_indices[name] = fields.size();
+      fields.push_back(field);
+    }
+  else
+    fields[it->second] = field;
+
+  gradients.clear();
 }
 
 template <int dim>
-double
-Triangle<dim>::longest_side() const
+void
+DoFGradientEvaluation<dim>::attach_dof_handler(
+  const DoFHandler<dim> &dof_handler)
 {
-  return m_longest_side;
+  dh = &dof_handler;
 }
 
 template <int dim>
-Point<dim>
-Triangle<dim>::closest_triangle_point(const Point<dim> &p) const
+void
+DoFGradientEvaluation<dim>::calculate(const unsigned int n_quadrature_points)
 {
-  const Point<dim> p_proj = project_to_triangle_plane(p);
+  const auto &      fe = dh->get_fe();
+  const QGauss<dim> quadrature(n_quadrature_points == 0 ? fe.degree + 1 :
+                                                          n_quadrature_points);
 
-  const auto t3 = barycentric_coordinates(p_proj);
+  const unsigned int n_dofs        = dh->n_dofs();
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  const unsigned int n_q_points    = quadrature.size();
+  const unsigned int n_fields      = fields.size();
 
-  bool inside = true;
+  std::vector<unsigned int> count(n_dofs, 0);
 
-  for (const auto &t : t3)
-    inside = inside && (t >= 0) && (t <= 1);
+  FullMatrix<double> qpoint_to_dof_matrix(dofs_per_cell, n_q_points);
+  FETools::compute_projection_from_quadrature_points_matrix(
+    fe, quadrature, quadrature, qpoint_to_dof_matrix);
 
-  if (inside)
+  // check data sizes and initialize gradients with zeros
+  for (const auto &it : field_indices)
     {
-      return p_proj;
+      const auto &s = it.first;
+      const auto  n = fields[it.second].size();
+      AssertThrow(n == n_dofs,
+                  ExcMessage("DoFGradientEvaluation: field '" + s + "' size " +
+                             std::to_string(n) + " does not match n_dofs = " +
+                             std::to_string(n_dofs)));
     }
-  else
-    {
-      Point<dim> p_closest;
-      double     d2_min = -1;
 
-      for (unsigned int i = 0; i < 3; ++i)
+  gradients.assign(n_fields,
+                   std::vector<Tensor<1, dim>>(n_dofs, Tensor<1, dim>()));
+
+  // all fields are processed in a single pass over the cells, sharing the
+  // FEValues::reinit, DoF lookup and shape function gradients
+  auto worker =
+    [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData &                                         scratch,
+        CopyData &                                            copy) {
+      FEValues<dim> &fe_values = scratch.fe_values;
+      fe_values.reinit(cell);
+
+      copy.local_dof_indices.resize(dofs_per_cell);
+      cell->get_dof_indices(copy.local_dof_indices);
+
+      for (unsigned int f = 0; f < n_fields; ++f)
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          scratch.values_cell[f * dofs_per_cell + i] =
+            fields[f][copy.local_dof_indices[i]];
+
+      // calculate gradients at quadrature points
+      std::fill(scratch.grad_q.begin(), scratch.grad_q.end(), Tensor<1, dim>());
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          {
+            const Tensor<1, dim> &shape_grad = fe_values.shape_grad(i, q);
+
+            for (unsigned int f = 0; f < n_fields; ++f)
+              scratch.grad_q[f * n_q_points + q] +=
+                scratch.values_cell[f * dofs_per_cell + i] * shape_grad;
+          }
+
+      // extrapolate from quadrature points to DoFs
+      copy.grad_cell.assign(n_fields * dofs_per_cell, Tensor<1, dim>());
+      for (unsigned int f = 0; f < n_fields; ++f)
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            copy.grad_cell[f * dofs_per_cell + i] +=
+              qpoint_to_dof_matrix(i, q) * scratch.grad_q[f * n_q_points + q];
+    };
+
+  // add result to global gradient
+  auto copier = [&](const CopyData &copy) {
+    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+      {
+        const types::global_dof_index j = copy.local_dof_indices[i];
+
+        count[j] += 1;
+
+        for (unsigned int f = 0; f < n_fields; ++f)
+          gradients[f][j] += copy.grad_cell[f * dofs_per_cell + i];
+      }
+  };
+
+  WorkStream::run(dh->begin_active(),
+                  dh->end(),
+                  worker,
+                  copier,
+                  ScratchData(fe, quadrature, n_fields),
+                  CopyData());
+
+  // average contributions from neighbouring cells
+  for (auto &grad : gradients)
+    {
+      for (unsigned int i = 0; i < n_dofs; ++i)
         {
-          const Point<dim> p_edge =
-            closest_segment_point(p, m_points[i], m_points[(i + 1) % 3]);
-          const double d2 = (p - p_edge).norm_square();
+          AssertThrow(count[i] > 0,
+                      ExcMessage("count[" + std::to_string(i) +
+                                 "]=" + std::to_string(count[i]) +
+                                 ", positive value expected"));
 
-          if (d2 < d2_min || d2_min < 0)
-            {
-              d2_min    = d2;
-              p_closest = p_edge;
-            }
+          grad[i] /= count[i];
         }
-
-      return p_closest;
     }
 }
 
 template <int dim>
-void
-Triangle<dim>::calculate_normal_and_area()
+const std::vector<Tensor<1, dim>> &
+DoFGradientEvaluation<dim>::get_gradient(const std::string &name) const
 {
-  m_normal = Point<dim>(
-    cross_product_3d(m_points[1] - m_points[0], m_points[2] - m_points[0]));
+  const unsigned int i = field_indices.at(name);
 
-  m_area = 0.5 * m_normal.norm();
+  AssertThrow(i < gradients.size(),
+              ExcMessage("DoFGradientEvaluation: gradient of '" + name +
+                         "' is not calculated"));
 
-  // normalize
-  if (m_area > 0)
-    m_normal /= (2 * m_area);
+  return gradients[i];
 }
 
+// DoFPointEvaluation
+
 template <int dim>
-double
-Triangle<dim>::signed_area(const Point<dim> &p0,
-                           const Point<dim> &p1,
-                           const Point<dim> &p2) const
+void
+DoFPointEvaluation<dim>::clear()
 {
-  return 0.5 * (m_normal * cross_product_3d(p1 - p0, p2 - p0));
+  dh = nullptr;
+  points.clear();
+  cells.clear();
+  reference_points.clear();
+  found.clear();
+  dof_indices.clear();
+  shape_values.clear();
+  vertices.clear();
+  n_dofs         = 0;
+  n_active_cells = 0;
 }
 
 template <int dim>
-Point<dim>
-Triangle<dim>::project_to_triangle_plane(const Point<dim> &p) const
+void
+DoFPointEvaluation<dim>::reinit(const DoFHandler<dim> &        dof_handler,
+                                const std::vector<Point<dim>> &p)
 {
-  return Point<dim>(p - m_normal * (m_normal * (p - m_points[0])));
+  if (is_up_to_date(dof_handler, p))
+    return;
+
+  clear();
+  dh     = &dof_handler;
+  points = p;
+  locate_points();
 }
 
 template <int dim>
-std::array<double, 3>
-Triangle<dim>::barycentric_coordinates(const Point<dim> &p) const
+bool
+DoFPointEvaluation<dim>::is_up_to_date(
+  const DoFHandler<dim> &        dof_handler,
+  const std::vector<Point<dim>> &p) const
 {
-  return {{signed_area(p, m_points[1], m_points[2]) / m_area,
-           signed_area(m_points[0], p, m_points[2]) / m_area,
-           signed_area(m_points[0], m_points[1], p) / m_area}};
-}
+  if (dh != &dof_handler || points != p || n_dofs != dof_handler.n_dofs() ||
+      n_active_cells != dof_handler.get_triangulation().n_active_cells())
+    return false;
 
-// SurfaceInterpolator3D
+  // points outside the mesh could be inside the moved mesh
+  if (!vertices.empty() &&
+      vertices != dof_handler.get_triangulation().get_vertices())
+    return false;
+
+  // detect mesh motion
+  const MappingQ1<dim> mapping;
+  for (unsigned int i = 0; i < points.size(); ++i)
+    {
+      if (!found[i])
+        continue;
+
+      const Point<dim> p_real =
+        mapping.transform_unit_to_real_cell(cells[i], reference_points[i]);
+
+      if (p_real.distance(points[i]) > 1e-10 * cells[i]->diameter())
+        return false;
+    }
+
+  return true;
+}
 
+template <int dim>
 void
-SurfaceInterpolator3D::read_vtk(const std::string &file_name)
+DoFPointEvaluation<dim>::locate_points()
 {
-  Timer timer;
+  const auto &fe = dh->get_fe();
 
-  clear();
+  AssertThrow(fe.n_components() == 1, ExcNotImplemented());
 
-  std::ifstream file(file_name);
+  const unsigned int n_points      = points.size();
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
 
-  if (!file.is_open())
-    {
-      std::cout << "Could not open '" << file_name << "'\n";
-      return;
-    }
-  else
-    std::cout << "Reading '" << file_name << "'";
+  const MappingQ1<dim>      mapping;
+  const Triangulation<dim> &tria = dh->get_triangulation();
 
+  n_dofs         = dh->n_dofs();
+  n_active_cells = tria.n_active_cells();
 
-  std::string s, data_type, data_name;
+  cells.resize(n_points);
+  reference_points.resize(n_points);
+  found.resize(n_points, false);
+  dof_indices.resize(n_points * dofs_per_cell, 0);
+  shape_values.resize(n_points * dofs_per_cell, 0);
 
-  // First line should be "# vtk DataFile Version 4.2"
-  while (file >> s)
+#if DEAL_II_VERSION_GTE(9, 2, 0)
+  const GridTools::Cache<dim> cache(tria, mapping);
+
+  typename Triangulation<dim>::active_cell_iterator hint = tria.begin_active();
+#endif
+
+  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+  for (unsigned int i = 0; i < n_points; ++i)
     {
-      if (s == "POINTS")
+      try
         {
-          unsigned int n;
-          file >> n >> s /*data type*/;
-          points.resize(n);
+#if DEAL_II_VERSION_GTE(9, 2, 0)
+          const auto cell_point =
+            GridTools::find_active_cell_around_point(cache, points[i], hint);
 
-          for (unsigned int i = 0; i < n; ++i)
-            {
-              file >> points[i][0] >> points[i][1] >> points[i][2];
-            }
+          if (cell_point.first.state() != IteratorState::valid)
+            continue;
+
+          hint     = cell_point.first;
+          cells[i] = typename DoFHandler<dim>::active_cell_iterator(
+            &tria, hint->level(), hint->index(), dh.get());
+#else
+          const auto cell_point =
+            GridTools::find_active_cell_around_point(mapping, *dh, points[i]);
+
+          cells[i] = cell_point.first;
+#endif
+          reference_points[i] =
+            GeometryInfo<dim>::project_to_unit_cell(cell_point.second);
+          found[i] = true;
         }
-      else if (s == "CELLS")
+      catch (std::exception &e)
         {
-          unsigned int n;
-          file >> n >> s /*size*/;
-          triangles.resize(n);
-
-          for (unsigned int i = 0; i < n; ++i)
-            {
-              file >> s;
-              if (s != "3")
-                throw std::runtime_error("Triangle expected, numPoints=" + s +
-                                         "found");
-              file >> triangles[i][0] >> triangles[i][1] >> triangles[i][2];
-            }
+          continue;
         }
-      else
+
+      cells[i]->get_dof_indices(local_dof_indices);
+
+      for (unsigned int j = 0; j < dofs_per_cell; ++j)
         {
-          if (s == "CELL_DATA" || s == "POINT_DATA")
-            data_type = s;
+          dof_indices[i * dofs_per_cell + j] = local_dof_indices[j];
+          shape_values[i * dofs_per_cell + j] =
+            fe.shape_value(j, reference_points[i]);
+        }
+    }
 
-          if (s == "SCALARS")
-            {
-              file >> data_name >> s /*data type*/;
-              file >> s >> s; // LOOKUP_TABLE
+  if (std::find(found.begin(), found.end(), false) != found.end())
+    vertices = tria.get_vertices();
+}
 
-              unsigned int N =
-                data_type == "CELL_DATA" ? triangles.size() : points.size();
+template <int dim>
+std::vector<double>
+DoFPointEvaluation<dim>::evaluate(const Vector<double> &field) const
+{
+  return evaluate(std::vector<const Vector<double> *>{&field})[0];
+}
 
-              std::vector<double> &f = data_type == "CELL_DATA" ?
-                                         cell_fields[data_name] :
-                                         point_fields[data_name];
-              f.resize(N);
+template <int dim>
+std::vector<std::vector<double>>
+DoFPointEvaluation<dim>::evaluate(
+  const std::vector<const Vector<double> *> &fields) const
+{
+  const unsigned int n_fields = fields.size();
+  const unsigned int n_points = points.size();
+
+  std::vector<std::vector<double>> values(n_fields,
+                                          std::vector<double>(n_points, 0));
 
-              for (unsigned int i = 0; i < N; ++i)
-                file >> f[i];
-            }
+  if (n_points == 0)
+    return values;
 
-          if (s == "FIELD")
-            {
-              unsigned int n_fields;
-              file >> s /*FieldData*/ >> n_fields;
+  for (const auto &f : fields)
+    AssertDimension(f->size(), n_dofs);
 
-              for (unsigned int k = 0; k < n_fields; ++k)
-                {
-                  file >> data_name >> s >> s >> s;
+  const unsigned int dofs_per_cell = dof_indices.size() / n_points;
 
-                  unsigned int N =
-                    data_type == "CELL_DATA" ? triangles.size() : points.size();
+  parallel::apply_to_subranges(
+    0U,
+    n_points,
+    [&](const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; ++i)
+        {
+          if (!found[i])
+            continue;
 
-                  std::vector<double> &f = data_type == "CELL_DATA" ?
-                                             cell_fields[data_name] :
-                                             point_fields[data_name];
-                  f.resize(N);
+          const unsigned int offset = i * dofs_per_cell;
 
-                  for (unsigned int i = 0; i < N; ++i)
-                    file >> f[i];
-                }
+          for (unsigned int k = 0; k < n_fields; ++k)
+            {
+              const Vector<double> &f = *fields[k];
+
+              double v = 0;
+              for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                v += f[dof_indices[offset + j]] * shape_values[offset + j];
+
+              values[k][i] = v;
             }
         }
-    }
+    },
+    16);
 
-  std::cout << " " << format_time(timer) << "\n";
-
-  info();
-  preprocess();
+  return values;
 }
 
+// DoFFieldSmoother
+
+template <int dim>
 void
-SurfaceInterpolator3D::read_vtu(const std::string &file_name)
+DoFFieldSmoother<dim>::clear()
 {
-  Timer timer;
+  dh = nullptr;
+  field_indices.clear();
+  fields.clear();
+  bc1.clear();
+}
 
-  clear();
+template <int dim>
+void
+DoFFieldSmoother<dim>::set_bc1(const unsigned int id)
+{
+  bc1.insert(id);
+}
 
-  std::ifstream file(file_name);
+template <int dim>
+void
+DoFFieldSmoother<dim>::add_field(const std::string &   name,
+                                 const Vector<double> &field)
+{
+  const auto it = field_indices.find(name);
 
-  if (!file.is_open())
+  if (it == field_indices.end())
     {
-      std::cout << "Could not open '" << file_name << "'\n";
-      return;
+      field_indices[name] = fields.size();
+      fields.push_back(field);
     }
   else
-    std::cout << "Reading '" << file_name << "'";
+    fields[it->second] = field;
+}
 
-  std::string s, data_type, data_name;
+template <int dim>
+void
+DoFFieldSmoother<dim>::attach_dof_handler(const DoFHandler<dim> &dof_handler)
+{
+  dh = &dof_handler;
+}
+
+template <int dim>
+void
+DoFFieldSmoother<dim>::calculate(const double relax,
+                                 const double relax_boundary,
+                                 SmoothType   st)
+{
+  if (st == SmoothType::Cell)
+    smooth_cell(relax, relax_boundary);
+  else
+    Assert(st == SmoothType::None, ExcNotImplemented());
+}
 
-  bool data_start = false;
+template <int dim>
+void
+DoFFieldSmoother<dim>::smooth_cell(const double relax,
+                                   const double relax_boundary)
+{
+  const auto &fe = dh->get_fe();
 
-  while (file >> s)
-    {
-      // get number of points and cells
-      if (Utilities::match_at_string_start(s, "NumberOf"))
-        {
-          std::vector<std::string> l = Utilities::split_string_list(s, '"');
+  const unsigned int n_dofs        = dh->n_dofs();
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+  const unsigned int n_fields      = fields.size();
 
-          int n = Utilities::string_to_int(l[1]);
+  std::vector<unsigned int> count(n_dofs, 0);
 
-          if (l[0] == "NumberOfPoints=")
-            points.resize(n);
-          else if (l[0] == "NumberOfCells=")
-            triangles.resize(n);
+  std::vector<Vector<double>> fields_new(n_fields, Vector<double>(n_dofs));
 
-          continue;
-        }
+  std::vector<bool> all_boundary_dofs(n_dofs, false);
+  DoFTools::extract_boundary_dofs(*dh, ComponentMask(), all_boundary_dofs);
+
+  // all fields are processed in a single pass over the cells
+  auto worker = [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+                    std::vector<double> &values_cell,
+                    CopyData &           copy) {
+    copy.local_dof_indices.resize(dofs_per_cell);
+    cell->get_dof_indices(copy.local_dof_indices);
+
+    values_cell.resize(dofs_per_cell);
+    copy.values_cell.resize(n_fields * dofs_per_cell);
+
+    for (unsigned int f = 0; f < n_fields; ++f)
+      {
+        const Vector<double> &field = fields[f];
+
+        // average value in cell
+        double f_cell = 0;
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          {
+            values_cell[i] = field[copy.local_dof_indices[i]];
+            f_cell += values_cell[i];
+          }
+        f_cell /= dofs_per_cell;
+
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          {
+            const unsigned int j = copy.local_dof_indices[i];
+            const double r = all_boundary_dofs[j] ? relax_boundary : relax;
+            copy.values_cell[f * dofs_per_cell + i] =
+              r * f_cell + (1 - r) * values_cell[i];
+          }
+      }
+  };
+
+  auto copier = [&](const CopyData &copy) {
+    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+      {
+        const types::global_dof_index j = copy.local_dof_indices[i];
+
+        count[j] += 1;
+
+        for (unsigned int f = 0; f < n_fields; ++f)
+          fields_new[f][j] += copy.values_cell[f * dofs_per_cell + i];
+      }
+  };
+
+  WorkStream::run(dh->begin_active(),
+                  dh->end(),
+                  worker,
+                  copier,
+                  std::vector<double>(dofs_per_cell),
+                  CopyData());
+
+  // average contributions from neighbouring cells
+  for (auto &f_new : fields_new)
+    {
+      for (unsigned int i = 0; i < n_dofs; ++i)
+        {
+          AssertThrow(count[i] > 0,
+                      ExcMessage("count[" + std::to_string(i) +
+                                 "]=" + std::to_string(count[i]) +
+                                 ", positive value expected"));
 
-      // detect cell and point data (also points and cells)
-      if (Utilities::match_at_string_start(s, "<Cell") ||
-          Utilities::match_at_string_start(s, "<Point"))
-        data_type = s;
+          f_new[i] /= count[i];
+        }
+    }
 
-      // get name
-      if (Utilities::match_at_string_start(s, "Name="))
-        data_name = Utilities::split_string_list(s, '"')[1];
+  // apply Dirichlet boundary conditions
+  for (const auto &b : bc1)
+    {
+      std::vector<bool> boundary_dofs(n_dofs, false);
 
-      // prepare for reading data
-      if (s == "<DataArray")
-        data_start = true;
+      DoFTools::extract_boundary_dofs(*dh,
+                                      ComponentMask(),
+                                      boundary_dofs,
+                                      {static_cast<types::boundary_id>(b)});
 
-      // <DataArray ...> has been reached, now read the data
-      if (data_start && s.back() == '>')
+      for (unsigned int f = 0; f < n_fields; ++f)
         {
-          std::vector<std::string> data;
+          Vector<double> &f_new = fields_new[f];
 
-          while (file >> s)
+          for (unsigned int i = 0; i < n_dofs; ++i)
             {
-              // end of data array reached, process it
-              if (s == "</DataArray>")
-                {
-                  const unsigned int n = data.size();
-
-                  if (data_type == "<CellData>") // cell field
-                    {
-                      if (n != triangles.size())
-                        throw std::runtime_error(
-                          data_type + " " + std::to_string(triangles.size()) +
-                          " " + data_name + " " + std::to_string(n));
-
-                      auto &field = cell_fields[data_name];
-                      field.resize(n);
-
-                      for (unsigned int i = 0; i < n; ++i)
-                        field[i] = std::stod(data[i]);
-                    }
-                  else if (data_type == "<PointData>") // point field
-                    {
-                      if (n != points.size())
-                        throw std::runtime_error(
-                          data_type + " " + std::to_string(points.size()) +
-                          " " + data_name + " " + std::to_string(n));
-
-                      auto &field = point_fields[data_name];
-                      field.resize(n);
-
-                      for (unsigned int i = 0; i < n; ++i)
-                        field[i] = std::stod(data[i]);
-                    }
-                  else if (data_type == "<Points>") // point coordinates
-                    {
-                      if (n != 3 * points.size())
-                        throw std::runtime_error(
-                          data_type + " " + std::to_string(points.size()) +
-                          " " + data_name + " " + std::to_string(n));
-
-                      for (unsigned int i = 0; i < n / 3; ++i)
-                        {
-                          unsigned int k = 3 * i;
-
-                          points[i] = Point<dim>(std::stod(data[k]),
-                                                 std::stod(data[k + 1]),
-                                                 std::stod(data[k + 2]));
-                        }
-                    }
-                  else if (data_type == "<Cells>" &&
-                           data_name == "connectivity") // only connectivity
-                    {
-                      if (n != 3 * triangles.size())
-                        throw std::runtime_error(
-                          data_type + " " + std::to_string(points.size()) +
-                          " " + data_name + " " + std::to_string(n));
-
-                      for (unsigned int i = 0; i < n / 3; ++i)
-                        {
-                          unsigned int k = 3 * i;
-
-                          triangles[i] = {{std::stoul(data[k]),
-                                           std::stoul(data[k + 1]),
-                                           std::stoul(data[k + 2])}};
-                        }
-                    }
-
-                  data_start = false;
-                  data_name.clear();
-                  break;
-                }
-              else // append
-                data.push_back(s);
+              if (boundary_dofs[i])
+                f_new[i] = fields[f][i];
             }
         }
     }
 
-  std::cout << " " << format_time(timer) << "\n";
-
-  info();
-  preprocess();
+  fields.swap(fields_new);
 }
 
-void
-SurfaceInterpolator3D::write_vtu(const std::string &file_name) const
+template <int dim>
+const Vector<double> &
+DoFFieldSmoother<dim>::get_field(const std::string &name) const
 {
-  Timer timer;
-
-  std::cout << "Saving to '" << file_name << "'";
+  return fields[field_indices.at(name)];
+}
 
-  std::ofstream f_out(file_name);
+// BlockDiagonalPreconditioner
 
-  const unsigned int n_points    = points.size();
-  const unsigned int n_triangles = triangles.size();
+template <typename PreconditionerType>
+void
+BlockDiagonalPreconditioner<PreconditionerType>::clear()
+{
+  preconditioners.clear();
+}
 
-  f_out
-    << "<?xml version=\"1.0\"?>\n"
-       "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
-       "<UnstructuredGrid>\n"
-       "<Piece NumberOfPoints=\""
-    << n_points << "\" NumberOfCells=\"" << n_triangles << "\">\n";
+template <typename PreconditionerType>
+template <typename AdditionalData>
+void
+BlockDiagonalPreconditioner<PreconditionerType>::initialize(
+  const BlockSparseMatrix<double> &matrix,
+  const AdditionalData &           data)
+{
+  AssertDimension(matrix.n_block_rows(), matrix.n_block_cols());
 
+  const unsigned int n_blocks = matrix.n_block_rows();
 
-  f_out << "<CellData>\n";
-  for (const auto &it : cell_fields)
-    {
-      f_out << "<DataArray type=\"Float64\" Name=\"" << it.first
-            << "\" format=\"ascii\">\n";
-      for (const auto &x : it.second)
-        f_out << std::scientific << std::setprecision(14) << x << " ";
-      f_out << "\n</DataArray>\n";
-    }
-  for (const auto &it : cell_vector_fields)
+  preconditioners.resize(n_blocks);
+  for (unsigned int i = 0; i < n_blocks; ++i)
     {
-      f_out << "<DataArray type=\"Float64\" Name=\"" << it.first
-            << "\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-      for (const auto &x : it.second)
-        f_out << std::scientific << std::setprecision(14) << x << "\n";
-      f_out << "</DataArray>\n";
+      preconditioners[i] = std::make_unique<PreconditionerType>();
+      preconditioners[i]->initialize(matrix.block(i, i), data);
     }
-  f_out << "</CellData>\n";
-
+}
 
-  f_out << "<PointData>\n";
-  for (const auto &it : point_fields)
-    {
-      f_out << "<DataArray type=\"Float64\" Name=\"" << it.first
-            << "\" format=\"ascii\">\n";
-      for (const auto &x : it.second)
-        f_out << std::scientific << std::setprecision(14) << x << " ";
-      f_out << "\n</DataArray>\n";
-    }
-  f_out << "</PointData>\n";
+template <typename PreconditionerType>
+void
+BlockDiagonalPreconditioner<PreconditionerType>::vmult(
+  BlockVector<double> &      dst,
+  const BlockVector<double> &src) const
+{
+  AssertDimension(dst.n_blocks(), preconditioners.size());
+  AssertDimension(src.n_blocks(), preconditioners.size());
 
+  for (unsigned int i = 0; i < preconditioners.size(); ++i)
+    preconditioners[i]->vmult(dst.block(i), src.block(i));
+}
 
-  f_out << "<Points>\n";
-  f_out
-    << "<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-  for (const auto &p : points)
-    f_out << std::scientific << std::setprecision(14) << p << "\n";
-  f_out << "</DataArray>\n";
-  f_out << "</Points>\n";
+template <typename PreconditionerType>
+void
+BlockDiagonalPreconditioner<PreconditionerType>::Tvmult(
+  BlockVector<double> &      dst,
+  const BlockVector<double> &src) const
+{
+  AssertDimension(dst.n_blocks(), preconditioners.size());
+  AssertDimension(src.n_blocks(), preconditioners.size());
 
+  for (unsigned int i = 0; i < preconditioners.size(); ++i)
+    preconditioners[i]->Tvmult(dst.block(i), src.block(i));
+}
 
-  f_out << "<Cells>\n";
+// FieldStore
 
-  f_out
-    << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-  for (const auto &t : triangles)
+void
+FieldStore::set(const std::string &name, const Vector<double> &value)
+{
+  const auto it = fields.find(name);
+  if (it != fields.end() && owned.count(name) > 0 &&
+      it->second.use_count() == 1 && it->second->size() == value.size())
     {
-      for (const auto &v : t)
-        f_out << v << " ";
-      f_out << "\n";
+      const_cast<Vector<double> &>(*it->second) = value;
+      return;
     }
-  f_out << "</DataArray>\n";
 
-  f_out << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-  for (unsigned int i = 0; i < n_triangles; ++i)
-    f_out << 3 * (i + 1) << " ";
-  f_out << "\n</DataArray>\n";
+  fields[name] = std::make_shared<Vector<double>>(value);
+  owned.insert(name);
+}
 
-  f_out << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n";
-  for (unsigned int i = 0; i < n_triangles; ++i)
-    f_out << "5 "; // VTK_TRIANGLE
-  f_out << "\n</DataArray>\n";
+void
+FieldStore::set(const std::string &name, Vector<double> &&value)
+{
+  fields[name] = std::make_shared<Vector<double>>(std::move(value));
+  owned.insert(name);
+}
 
-  f_out << "</Cells>\n";
+void
+FieldStore::set(const std::string &name, const FieldPointer &value)
+{
+  AssertThrow(value, ExcMessage("FieldStore::set: '" + name + "' is null"));
 
+  fields[name] = value;
+  owned.erase(name);
+}
 
-  f_out << "</Piece>\n"
-           "</UnstructuredGrid>\n"
-           "</VTKFile>\n";
+bool
+FieldStore::has(const std::string &name) const
+{
+  return fields.find(name) != fields.end();
+}
 
-  std::cout << " " << format_time(timer) << "\n";
+const Vector<double> &
+FieldStore::get(const std::string &name) const
+{
+  return *get_shared(name);
 }
 
-void
-SurfaceInterpolator3D::interpolate(const FieldType &              field_type,
-                                   const std::string &            field_name,
-                                   const std::vector<Point<dim>> &target_points,
-                                   const std::vector<bool> &      markers,
-                                   Vector<double> &target_values) const
+FieldStore::FieldPointer
+FieldStore::get_shared(const std::string &name) const
 {
-  AssertThrow(field_type == CellField || field_type == PointField,
-              ExcNotImplemented());
+  const auto it = fields.find(name);
+  AssertThrow(it != fields.end(),
+              ExcMessage("FieldStore: field '" + name + "' does not exist"));
 
-  Timer timer;
+  return it->second;
+}
+
+Vector<double> &
+FieldStore::get_mutable(const std::string &name)
+{
+  FieldPointer &f = fields[name];
 
-  std::cout << "Interpolating field '" << field_name << "'";
+  if (!f)
+    {
+      f = std::make_shared<Vector<double>>();
+      owned.insert(name);
+    }
+  else if (owned.count(name) == 0 || f.use_count() > 1)
+    {
+      // copy on write
+      f = std::make_shared<Vector<double>>(*f);
+      owned.insert(name);
+    }
 
-  const std::vector<double> &source_field = field(field_type, field_name);
+  // allocated by this store as non-const and not shared
+  return const_cast<Vector<double> &>(*f);
+}
 
-  const unsigned int n_triangles = triangles.size();
-  const unsigned int n_values    = target_points.size();
-  target_values.reinit(n_values);
+FieldStore
+FieldStore::snapshot() const
+{
+  FieldStore s;
+  s.fields = fields;
+  // the fields are shared now, owned fields are copied on write
+  s.owned = owned;
+  return s;
+}
 
-  for (unsigned int i = 0; i < n_values; ++i)
-    {
-      if (!markers[i])
-        continue;
+void
+FieldStore::erase(const std::string &name)
+{
+  fields.erase(name);
+  owned.erase(name);
+}
 
-      Point<dim>   p_found;
-      unsigned int j_found = 0;
-      double       d2_min  = -1;
-      for (unsigned int j = 0; j < n_triangles; ++j)
-        {
-          const Triangle<dim> &triangle = triangle_cache[j];
+void
+FieldStore::clear()
+{
+  fields.clear();
+  owned.clear();
+}
+
+unsigned int
+FieldStore::size() const
+{
+  return fields.size();
+}
+
+std::vector<std::string>
+FieldStore::get_names() const
+{
+  std::vector<std::string> names;
+  for (const auto &it : fields)
+    names.push_back(it.first);
+  return names;
+}
 
-          if ((target_points[i] - triangle.center()).norm() >
-              3 * triangle.longest_side())
-            continue;
+FieldStore::Container::const_iterator
+FieldStore::begin() const
+{
+  return fields.begin();
+}
 
-          Point<dim> p_trial =
-            triangle.closest_triangle_point(target_points[i]);
+FieldStore::Container::const_iterator
+FieldStore::end() const
+{
+  return fields.end();
+}
 
-          double d2 = (p_trial - target_points[i]).norm_square();
-          if (d2 < d2_min || d2_min < 0)
-            {
-              d2_min  = d2;
-              p_found = p_trial;
-              j_found = j;
-            }
-        }
 
-      if (d2_min < 0)
-        {
-#ifdef DEBUG
-          std::cout << "Warning: point " << target_points[i]
-                    << " not found, continuing with full search\n";
-#endif
-          // same as above, now checking each triangle
-          for (unsigned int j = 0; j < n_triangles; ++j)
-            {
-              const Triangle<dim> &triangle = triangle_cache[j];
+// ThreadLimit
 
-              Point<dim> p_trial =
-                triangle.closest_triangle_point(target_points[i]);
+void
+ThreadLimit::set(const unsigned int n_threads)
+{
+  if (is_fixed())
+    return;
 
-              double d2 = (p_trial - target_points[i]).norm_square();
-              if (d2 < d2_min || d2_min < 0)
-                {
-                  d2_min  = d2;
-                  p_found = p_trial;
-                  j_found = j;
-                }
-            }
-        }
-      AssertThrow(d2_min >= 0, ExcInterpolationFailed<dim>(target_points[i]));
+  MultithreadInfo::set_thread_limit(n_threads > 0 ? n_threads :
+                                                    MultithreadInfo::n_cores());
+}
 
-      switch (field_type)
-        {
-          case CellField:
-            target_values[i] = source_field[j_found];
-            break;
+void
+ThreadLimit::fix(const unsigned int n_threads)
+{
+  MultithreadInfo::set_thread_limit(n_threads > 0 ? n_threads :
+                                                    MultithreadInfo::n_cores());
+  fixed() = true;
+}
 
-          case PointField:
-            const Triangle<dim> &triangle = triangle_cache[j_found];
-            const auto           t3 = triangle.barycentric_coordinates(p_found);
-            const auto &         v  = triangles[j_found];
-            for (unsigned int k = 0; k < 3; ++k)
-              target_values[i] += t3[k] * source_field[v[k]];
-            break;
-        }
-    }
+void
+ThreadLimit::release()
+{
+  fixed() = false;
+}
 
-  std::cout << " " << format_time(timer) << "\n";
+bool
+ThreadLimit::is_fixed()
+{
+  return fixed();
 }
 
-void
-SurfaceInterpolator3D::interpolate(
-  const FieldType &                  field_type,
-  const std::string &                field_name,
-  const std::vector<Point<dim - 1>> &target_points,
-  const std::vector<bool> &          markers,
-  Vector<double> &                   target_values) const
+std::atomic<bool> &
+ThreadLimit::fixed()
 {
-  const unsigned int n_values = target_points.size();
+  static std::atomic<bool> flag(false);
+  return flag;
+}
 
-  std::vector<Point<dim>> points_3d(n_values);
+// Logger
 
-  // convert from 2D cylindrical coordinates (r,z) to 3D (x,y,z)
-  for (unsigned int i = 0; i < n_values; ++i)
-    {
-      points_3d[i][0] = target_points[i][0];
-      points_3d[i][1] = 0;
-      points_3d[i][2] = target_points[i][1];
-    }
+Logger::Logger()
+  : level(Detail)
+  , output(&buffer)
+  , null_output(nullptr)
+{
+  // the shared buffer must outlive all loggers and the incomplete line of
+  // the thread must outlive the thread-local ones
+  shared_buffer();
+  pending_line();
+
+  const char *env = std::getenv("MACPLAS_LOG_LEVEL");
+  if (env)
+    set_level(std::string(env));
+}
 
-  interpolate(field_type, field_name, points_3d, markers, target_values);
+Logger::~Logger()
+{
+  buffer.commit();
 }
 
-bool
-SurfaceInterpolator3D::empty() const
+void
+Logger::set_level(const Level l)
 {
-  return points.empty() || triangles.empty();
+  level = l;
 }
 
 void
-SurfaceInterpolator3D::convert(const FieldType &  source_type,
-                               const std::string &source_name,
-                               const FieldType &  target_type,
-                               const std::string &target_name)
+Logger::set_level(const std::string &l)
 {
-  const std::string target_name_updated =
-    target_name.empty() ? source_name : target_name;
+  const std::vector<std::string> names =
+    Utilities::split_string_list(get_level_names(), '|');
 
-  if (source_type == CellField && target_type == PointField)
-    {
-      cell_to_point(source_name, target_name_updated);
-    }
-  else if (source_type == PointField && target_type == CellField)
-    {
-      point_to_cell(source_name, target_name_updated);
-    }
-  else
-    {
-      throw std::runtime_error(
-        "Unsupported combination of source and target field types.");
-    }
+  const auto it = std::find(names.begin(), names.end(), l);
+  AssertThrow(it != names.end(),
+              ExcMessage("Logger: unknown level '" + l +
+                         "', expected one of " + get_level_names()));
+
+  set_level(static_cast<Level>(it - names.begin()));
 }
 
-const std::vector<double> &
-SurfaceInterpolator3D::field(const FieldType &  field_type,
-                             const std::string &field_name) const
+Logger::Level
+Logger::get_level() const
 {
-  const auto &fields = field_type == CellField ? cell_fields : point_fields;
-  const auto &it     = fields.find(field_name);
+  return level;
+}
 
-  if (it == fields.end())
-    throw std::runtime_error("Field '" + field_name + "' does not exist.");
+std::string
+Logger::get_level_names()
+{
+  return "quiet|error|warning|info|detail";
+}
 
-  return it->second;
+bool
+Logger::is_enabled(const Level l) const
+{
+#ifdef MACPLAS_DISABLE_LOGGING
+  (void)l;
+  return false;
+#else
+  return l != Quiet && l <= level;
+#endif
 }
 
-std::vector<double> &
-SurfaceInterpolator3D::field(const FieldType &  field_type,
-                             const std::string &field_name)
+std::ostream &
+Logger::stream(const Level l)
 {
-  return field_type == CellField ? cell_fields[field_name] :
-                                   point_fields[field_name];
+  return is_enabled(l) ? output : null_output;
 }
 
-const std::vector<Point<SurfaceInterpolator3D::dim>> &
-SurfaceInterpolator3D::vector_field(const FieldType &  field_type,
-                                    const std::string &field_name) const
+std::ostream &
+Logger::error()
 {
-  AssertThrow(field_type == CellField, ExcNotImplemented());
+  return stream(Error);
+}
 
-  const auto &fields = cell_vector_fields;
-  const auto &it     = fields.find(field_name);
+std::ostream &
+Logger::warning()
+{
+  return stream(Warning);
+}
 
-  if (it == fields.end())
-    throw std::runtime_error("Field '" + field_name + "' does not exist.");
+std::ostream &
+Logger::info()
+{
+  return stream(Info);
+}
 
-  return it->second;
+std::ostream &
+Logger::detail()
+{
+  return stream(Detail);
 }
 
 void
-SurfaceInterpolator3D::cell_to_point(const std::string &source_name,
-                                     const std::string &target_name)
+Logger::set_buffer_size(const std::size_t n)
 {
-  Timer timer;
+  SharedBuffer &              b = shared_buffer();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  b.max_size = n;
+}
 
-  std::cout << "Convering field '" << source_name << "' from cell to point";
+void
+Logger::flush()
+{
+  SharedBuffer &              b = shared_buffer();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  std::cout << b.data << std::flush;
+  b.data.clear();
+}
 
-  const unsigned int n_points    = points.size();
-  const unsigned int n_triangles = triangles.size();
+Logger &
+Logger::get_default()
+{
+  // the utilities are called from worker threads and background tasks
+  static thread_local Logger logger;
+  return logger;
+}
 
-  const std::vector<double> &source_field = field(CellField, source_name);
+Logger::SharedBuffer &
+Logger::shared_buffer()
+{
+  static SharedBuffer b;
+  return b;
+}
 
-  std::vector<double> &target_field = field(PointField, target_name);
-  target_field.resize(n_points);
-  std::fill(target_field.begin(), target_field.end(), 0);
+Logger::PendingLine &
+Logger::pending_line()
+{
+  static thread_local PendingLine p;
+  return p;
+}
 
-  std::vector<int> count(n_points, 0);
+Logger::PendingLine::~PendingLine()
+{
+  if (!text.empty())
+    shared_buffer().write_locked(text + '\n', true);
+}
 
-  for (unsigned int i = 0; i < n_triangles; ++i)
+void
+Logger::LineBuffer::commit()
+{
+  PendingLine &p = pending_line();
+  if (p.owner != this)
     {
-      const auto &v = triangles[i];
-      for (const auto &id : v)
-        {
-          target_field[id] += source_field[i];
-          count[id]++;
-        }
+      shared_buffer().write_locked("", true);
+      return;
     }
 
-  for (unsigned int i = 0; i < n_points; ++i)
+  shared_buffer().write_locked(p.text, true);
+  p.text.clear();
+  p.owner = nullptr;
+}
+
+int
+Logger::LineBuffer::overflow(int c)
+{
+  if (c != traits_type::eof())
     {
-      if (count[i] > 0)
-        target_field[i] /= count[i];
+      const char ch = traits_type::to_char_type(c);
+      xsputn(&ch, 1);
     }
-
-  std::cout << " " << format_time(timer) << "\n";
+  return traits_type::not_eof(c);
 }
 
-void
-SurfaceInterpolator3D::point_to_cell(const std::string &source_name,
-                                     const std::string &target_name)
+std::streamsize
+Logger::LineBuffer::xsputn(const char *s, std::streamsize n)
 {
-  Timer timer;
-
-  std::cout << "Convering field '" << source_name << "' from point to cell";
-
-  const unsigned int n_triangles = triangles.size();
-
-  const std::vector<double> &source_field = field(PointField, source_name);
-
-  std::vector<double> &target_field = field(CellField, target_name);
-  target_field.resize(n_triangles);
-  std::fill(target_field.begin(), target_field.end(), 0);
-
-  std::vector<int> count(n_triangles, 0);
+  PendingLine &p = pending_line();
 
-  for (unsigned int i = 0; i < n_triangles; ++i)
+  if (p.owner != this)
     {
-      const auto &v = triangles[i];
-      for (const auto &id : v)
+      // terminate the incomplete line of another logger, keeping the order
+      if (!p.text.empty())
         {
-          target_field[i] += source_field[id];
-          count[i]++;
+          shared_buffer().write_locked(p.text + '\n', false);
+          p.text.clear();
         }
+      p.owner = this;
     }
 
-  for (unsigned int i = 0; i < n_triangles; ++i)
+  p.text.append(s, n);
+
+  // pass complete lines only
+  const std::size_t k = p.text.rfind('\n');
+  if (k != std::string::npos)
     {
-      if (count[i] > 0)
-        target_field[i] /= count[i];
+      shared_buffer().write_locked(p.text.substr(0, k + 1), false);
+      p.text.erase(0, k + 1);
     }
 
-  std::cout << " " << format_time(timer) << "\n";
+  return n;
 }
 
-void
-SurfaceInterpolator3D::clear()
+int
+Logger::LineBuffer::sync()
 {
-  points.clear();
-  triangles.clear();
-  cell_fields.clear();
-  point_fields.clear();
-  cell_vector_fields.clear();
-  triangle_cache.clear();
+  commit();
+  return 0;
 }
 
-void
-SurfaceInterpolator3D::info() const
+Logger::SharedBuffer::SharedBuffer()
+  : max_size(0)
 {
-  std::cout << "n_points:" << points.size() << " "
-            << "n_triangles:" << triangles.size() << "\n";
+  const char *env = std::getenv("MACPLAS_LOG_BUFFER_SIZE");
+  if (env)
+    max_size = std::stoul(env);
+}
 
-  for (const auto &it : cell_fields)
-    std::cout << "CellData " << it.first << " " << it.second.size() << "\n";
+Logger::SharedBuffer::~SharedBuffer()
+{
+  std::cout << data << std::flush;
+}
 
-  for (const auto &it : point_fields)
-    std::cout << "PointData " << it.first << " " << it.second.size() << "\n";
+void
+Logger::SharedBuffer::write(const std::string &s, const bool flush)
+{
+  data += s;
+
+  if (data.size() > max_size)
+    {
+      std::cout << data;
+      data.clear();
+      if (flush)
+        std::cout << std::flush;
+    }
 }
 
 void
-SurfaceInterpolator3D::preprocess()
+Logger::SharedBuffer::write_locked(const std::string &s, const bool flush)
 {
-  Timer timer;
+  std::lock_guard<std::mutex> lock(mutex);
+  write(s, flush);
+}
 
-  std::cout << "Preprocessing data";
 
-  const unsigned int n_triangles = triangles.size();
+// BackgroundWriter
 
-  auto &area         = cell_fields["area"];
-  auto &longest_side = cell_fields["longest_side"];
-  auto &center       = cell_vector_fields["center"];
-  auto &normal       = cell_vector_fields["normal"];
+BackgroundWriter::BackgroundWriter()
+  : max_queued_tasks(0)
+  , busy(false)
+  , stop(false)
+{}
 
-  area.resize(n_triangles);
-  longest_side.resize(n_triangles);
-  center.resize(n_triangles);
-  normal.resize(n_triangles);
-  triangle_cache.resize(n_triangles);
+BackgroundWriter::~BackgroundWriter()
+{
+  flush();
 
-  for (unsigned int i = 0; i < n_triangles; ++i)
+  if (thread.joinable())
     {
-      const auto &   v        = triangles[i];
-      Triangle<dim> &triangle = triangle_cache[i];
-      triangle.reinit(points[v[0]], points[v[1]], points[v[2]]);
-
-      // for output, should be moved to debug mode
-      center[i]       = triangle.center();
-      normal[i]       = triangle.normal();
-      area[i]         = triangle.area();
-      longest_side[i] = triangle.longest_side();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      condition.notify_all();
+      thread.join();
     }
+}
 
-  std::cout << " " << format_time(timer) << "\n";
+void
+BackgroundWriter::set_max_queued_tasks(const unsigned int n)
+{
+  flush();
+  max_queued_tasks = n;
 }
 
-// SurfaceInterpolator2D
+bool
+BackgroundWriter::is_synchronous() const
+{
+  return max_queued_tasks == 0;
+}
 
 void
-SurfaceInterpolator2D::read_txt(const std::string &file_name)
+BackgroundWriter::submit(std::function<void()> task)
 {
-  Timer timer;
+  if (is_synchronous())
+    {
+      try
+        {
+          task();
+        }
+      catch (std::exception &e)
+        {
+          Logger::get_default().error() << e.what() << "\n";
+        }
+      return;
+    }
 
-  clear();
+  std::unique_lock<std::mutex> lock(mutex);
+
+  if (!thread.joinable())
+    thread = std::thread(&BackgroundWriter::run, this);
+
+  // bounded queue: wait until the I/O thread takes the oldest task
+  condition.wait(lock, [this]() { return tasks.size() < max_queued_tasks; });
+  tasks.push_back(std::move(task));
 
-  std::ifstream file(file_name);
+  lock.unlock();
+  condition.notify_all();
+}
+
+void
+BackgroundWriter::write_file(const std::string &      file_name,
+                             std::string              contents,
+                             const std::ios::openmode mode)
+{
+  submit([file_name, mode, contents = std::move(contents)]() {
+    std::ofstream output(file_name, mode);
+    AssertThrow(output.is_open(), ExcFileNotOpen(file_name));
+    output << contents;
+    AssertThrow(output.good(), ExcIO());
+  });
+}
+
+void
+BackgroundWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this]() { return tasks.empty() && !busy; });
+}
 
-  if (!file.is_open())
+void
+BackgroundWriter::run()
+{
+  while (true)
     {
-      std::cout << "Could not open '" << file_name << "'\n";
-      return;
-    }
-  else
-    std::cout << "Reading '" << file_name << "'";
-
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this]() { return stop || !tasks.empty(); });
 
-  std::vector<std::string>         field_names;
-  std::vector<std::vector<double>> field_values;
+      if (tasks.empty())
+        return;
 
-  std::string line;
-  while (std::getline(file, line))
-    {
-      if (line.empty())
-        continue;
+      std::function<void()> task = std::move(tasks.front());
+      tasks.pop_front();
+      busy = true;
 
-      std::stringstream ss(line);
+      lock.unlock();
+      condition.notify_all();
 
-      if (field_names.empty())
+      try
         {
-          std::string name;
-          ss >> name >> name; // First 2 columns are x and y;
-          while (ss >> name)  // then - field names
-            field_names.push_back(name);
-
-          field_values.resize(field_names.size());
+          task();
         }
-      else
+      catch (std::exception &e)
         {
-          Point<dim> p;
-          ss >> p[0] >> p[1];
-
-          points.push_back(p);
-
-          double val;
-          for (unsigned int i = 0; i < field_names.size(); ++i)
-            {
-              ss >> val;
-              field_values[i].push_back(val);
-            }
+          // the default logger belongs to the calling thread
+          Logger logger;
+          logger.error() << e.what() << "\n";
         }
+
+      lock.lock();
+      busy = false;
+      lock.unlock();
+      condition.notify_all();
     }
+}
 
-  for (unsigned int i = 0; i < field_names.size(); ++i)
-    fields[field_names[i]] = field_values[i];
+// DataOutSnapshot
 
-  std::cout << " " << format_time(timer) << "\n";
+template <int dim>
+DataOutSnapshot<dim>::DataOutSnapshot(
+  const std::vector<DataOutBase::Patch<dim>> &patches,
+  const std::vector<std::string> &            dataset_names,
+  const DataRanges &                          data_ranges)
+  : patches(patches)
+  , dataset_names(dataset_names)
+  , data_ranges(data_ranges)
+{}
 
-  info();
+template <int dim>
+const std::vector<DataOutBase::Patch<dim>> &
+DataOutSnapshot<dim>::get_patches() const
+{
+  return patches;
 }
 
-void
-SurfaceInterpolator2D::set_points(const std::vector<Point<dim>> &new_points)
+template <int dim>
+std::vector<std::string>
+DataOutSnapshot<dim>::get_dataset_names() const
 {
-  clear();
-  points = new_points;
+  return dataset_names;
+}
 
-#ifdef DEBUG
-  info();
+template <int dim>
+typename DataOutSnapshot<dim>::DataRanges
+#if DEAL_II_VERSION_GTE(9, 0, 0)
+DataOutSnapshot<dim>::get_nonscalar_data_ranges() const
+#else
+DataOutSnapshot<dim>::get_vector_data_ranges() const
 #endif
+{
+  return data_ranges;
 }
 
-void
-SurfaceInterpolator2D::set_points(const std::vector<Point<dim + 1>> &new_points)
-{
-  points.resize(new_points.size());
+// BufferedDataOut
 
-  for (unsigned int i = 0; i < points.size(); ++i)
-    {
-      points[i][0] = std::hypot(new_points[i][0], new_points[i][1]);
-      points[i][1] = new_points[i][2];
-    }
+template <int dim>
+std::shared_ptr<DataOutSnapshot<dim>>
+BufferedDataOut<dim>::snapshot() const
+{
+#if DEAL_II_VERSION_GTE(9, 0, 0)
+  return std::make_shared<DataOutSnapshot<dim>>(
+    this->get_patches(),
+    this->get_dataset_names(),
+    this->get_nonscalar_data_ranges());
+#else
+  return std::make_shared<DataOutSnapshot<dim>>(
+    this->get_patches(),
+    this->get_dataset_names(),
+    this->get_vector_data_ranges());
+#endif
 }
 
-const std::vector<Point<SurfaceInterpolator2D::dim>> &
-SurfaceInterpolator2D::get_points() const
+// DataOutWriter
+
+template <int dim>
+std::string
+DataOutWriter<dim>::get_format_names()
 {
-  return points;
+  return "vtk|vtu|hdf5";
 }
 
-const std::vector<std::string>
-SurfaceInterpolator2D::get_field_names() const
+template <int dim>
+std::string
+DataOutWriter<dim>::get_extension(const std::string &format)
 {
-  std::vector<std::string> names;
-
-  for (const auto &it : fields)
-    names.push_back(it.first);
-
-  return names;
+  return format == "hdf5" ? "h5" : format;
 }
 
+template <int dim>
 void
-SurfaceInterpolator2D::interpolate(const std::string &            field_name,
-                                   const std::vector<Point<dim>> &target_points,
-                                   const std::vector<bool> &      markers,
-                                   Vector<double> &target_values) const
+DataOutWriter<dim>::write(DataOutInterface<dim> &data_out,
+                          const std::string &    file_name,
+                          const std::string &    series_name,
+                          const std::string &    format,
+                          const double           time,
+                          const int              precision)
 {
-  Timer timer;
+  if (format == "vtu")
+    {
+      write_vtu(data_out, file_name, series_name, time);
+      return;
+    }
 
-  std::cout << "Interpolating field '" << field_name << "'";
+  if (format == "hdf5")
+    {
+      write_hdf5(data_out, file_name, series_name, time);
+      return;
+    }
 
-  const std::vector<double> &source_field = field(field_name);
+  AssertThrow(format == "vtk",
+              ExcMessage("Unsupported output format " + format));
 
-  const unsigned int n_points = points.size();
-  const unsigned int n_values = target_points.size();
-  target_values.reinit(n_values);
+  std::ofstream output(file_name + ".vtk");
+  output << std::setprecision(precision);
+  data_out.write_vtk(output);
+}
 
-  for (unsigned int i = 0; i < n_values; ++i)
+template <int dim>
+void
+DataOutWriter<dim>::write(BufferedDataOut<dim> &data_out,
+                          const std::string &   file_name,
+                          const std::string &   series_name,
+                          const std::string &   format,
+                          const double          time,
+                          const int             precision,
+                          BackgroundWriter &    writer)
+{
+  if (writer.is_synchronous())
     {
-      if (!markers[i])
-        continue;
+      write(data_out, file_name, series_name, format, time, precision);
+      return;
+    }
 
-      Point<dim>   p_found;
-      unsigned int j_found = 0;
-      double       d2_min  = -1;
+  const std::shared_ptr<DataOutSnapshot<dim>> snapshot = data_out.snapshot();
 
-      // number of segments is n_points-1
-      for (unsigned int j = 0; j + 1 < n_points; ++j)
-        {
-          Point<dim> p_trial =
-            closest_segment_point(target_points[i], points[j], points[j + 1]);
+  writer.submit(
+    [this, snapshot, file_name, series_name, format, time, precision]() {
+      write(*snapshot, file_name, series_name, format, time, precision);
+    });
+}
 
-          double d2 = (p_trial - target_points[i]).norm();
-          if (d2 < d2_min || d2_min < 0)
-            {
-              d2_min  = d2;
-              p_found = p_trial;
-              j_found = j;
-            }
-        }
+template <int dim>
+void
+DataOutWriter<dim>::write_vtu(DataOutInterface<dim> &data_out,
+                              const std::string &    file_name,
+                              const std::string &    series_name,
+                              const double           time)
+{
+  DataOutBase::VtkFlags flags;
+  flags.time = time;
+#if DEAL_II_VERSION_GTE(9, 5, 0)
+  flags.compression_level = DataOutBase::CompressionLevel::best_speed;
+#else
+  flags.compression_level = DataOutBase::VtkFlags::best_speed;
+#endif
+  data_out.set_flags(flags);
 
-      const auto t2 =
-        barycentric_coordinates(p_found, points[j_found], points[j_found + 1]);
-      for (unsigned int k = 0; k < 2; ++k)
-        target_values[i] += t2[k] * source_field[j_found + k];
-    }
+  std::ofstream output(file_name + ".vtu");
+  data_out.write_vtu(output);
+
+  // the same snapshot could be written several times
+  if (vtu_records.empty() || vtu_records.back().first != time)
+    vtu_records.emplace_back(time, file_name + ".vtu");
+  else
+    vtu_records.back().second = file_name + ".vtu";
 
-  std::cout << " " << format_time(timer) << "\n";
+  std::ofstream pvd_output(series_name + ".pvd");
+  DataOutBase::write_pvd_record(pvd_output, vtu_records);
 }
 
+template <int dim>
 void
-SurfaceInterpolator2D::interpolate(
-  const std::string &                field_name,
-  const std::vector<Point<dim + 1>> &target_points,
-  const std::vector<bool> &          markers,
-  Vector<double> &                   target_values) const
+DataOutWriter<dim>::write_hdf5(DataOutInterface<dim> &data_out,
+                               const std::string &    file_name,
+                               const std::string &    series_name,
+                               const double           time)
 {
-  const unsigned int n_values = target_points.size();
+#ifdef DEAL_II_WITH_HDF5
+  DataOutBase::DataOutFilter data_filter(
+    DataOutBase::DataOutFilterFlags(true, true));
+  data_out.write_filtered_data(data_filter);
 
-  std::vector<Point<dim>> points_2d(n_values);
+  std::vector<double> nodes;
+  data_filter.fill_node_data(nodes);
 
-  // convert from 3D (x,y,z) to 2D cylindrical coordinates (r,z)
-  for (unsigned int i = 0; i < n_values; ++i)
+  // write the mesh only if it has changed since the last snapshot
+  const bool write_mesh = mesh_file_name.empty() || nodes != mesh_nodes;
+  if (write_mesh)
     {
-      points_2d[i][0] = std::hypot(target_points[i][0], target_points[i][1]);
-      points_2d[i][1] = target_points[i][2];
+      std::stringstream ss;
+      ss << std::setprecision(8) << series_name << "-mesh-t" << time << ".h5";
+      mesh_file_name = ss.str();
+      mesh_nodes.swap(nodes);
     }
 
-  interpolate(field_name, points_2d, markers, target_values);
-}
+  const std::string solution_file_name = file_name + ".h5";
 
-Point<SurfaceInterpolator2D::dim>
-SurfaceInterpolator2D::project(const Point<dim> &p) const
-{
-  const unsigned int n_points = points.size();
+  data_out.write_hdf5_parallel(data_filter,
+                               write_mesh,
+                               mesh_file_name,
+                               solution_file_name,
+                               MPI_COMM_SELF);
 
-  // same logic as in interpolate
-  Point<dim> p_found;
-  double     d2_min = -1;
+  const XDMFEntry entry = data_out.create_xdmf_entry(
+    data_filter, mesh_file_name, solution_file_name, time, MPI_COMM_SELF);
 
-  // number of segments is n_points-1
-  for (unsigned int j = 0; j + 1 < n_points; ++j)
+  // the same snapshot could be written several times
+  if (xdmf_times.empty() || xdmf_times.back() != time)
     {
-      Point<dim> p_trial = closest_segment_point(p, points[j], points[j + 1]);
-
-      double d2 = (p_trial - p).norm();
-      if (d2 < d2_min || d2_min < 0)
-        {
-          d2_min  = d2;
-          p_found = p_trial;
-        }
+      xdmf_times.push_back(time);
+      xdmf_entries.push_back(entry);
     }
+  else
+    xdmf_entries.back() = entry;
 
-  return p_found;
+  data_out.write_xdmf_file(xdmf_entries, series_name + ".xdmf", MPI_COMM_SELF);
+#else
+  (void)data_out;
+  (void)file_name;
+  (void)series_name;
+  (void)time;
+  AssertThrow(false,
+              ExcMessage("HDF5 output requires deal.II with HDF5 support"));
+#endif
 }
 
-bool
-SurfaceInterpolator2D::empty() const
+// Profiler
+
+Profiler::Scope::Scope(Profiler &profiler, const std::string &name)
+  : profiler(profiler)
+  , name(name)
 {
-  return points.empty();
+  profiler.enter(name);
 }
 
-const std::vector<double> &
-SurfaceInterpolator2D::field(const std::string &field_name) const
+Profiler::Scope::~Scope()
 {
-  const auto &it = fields.find(field_name);
-
-  if (it == fields.end())
-    throw std::runtime_error("Field '" + field_name + "' does not exist.");
-
-  return it->second;
+  profiler.leave(name);
 }
 
-void
-SurfaceInterpolator2D::clear()
+Profiler::Profiler()
+  : timer_output(std::cout, TimerOutput::never, TimerOutput::cpu_and_wall_times)
+  , last_time(std::numeric_limits<double>::quiet_NaN())
+  , per_time_step(false)
+{}
+
+Profiler::~Profiler()
 {
-  points.clear();
-  fields.clear();
+  if (report_name.empty())
+    return;
+
+  try
+    {
+      Logger::get_default().info()
+        << "Saving profiling report to '" << report_name << ".json'\n";
+
+      std::ofstream f_json(report_name + ".json");
+      AssertThrow(f_json.is_open(), ExcFileNotOpen(report_name + ".json"));
+      write_json(f_json);
+
+      std::ofstream f_csv(report_name + ".csv");
+      AssertThrow(f_csv.is_open(), ExcFileNotOpen(report_name + ".csv"));
+      write_csv(f_csv);
+    }
+  catch (std::exception &e)
+    {
+      Logger::get_default().error() << e.what() << "\n";
+    }
 }
 
 void
-SurfaceInterpolator2D::info() const
+Profiler::set_report(const std::string &base_name, const bool per_time_step)
 {
-  std::cout << "n_points:" << points.size() << "\n";
+  report_name         = base_name;
+  this->per_time_step = per_time_step;
 
-  for (const auto &it : fields)
-    std::cout << "PointData " << it.first << " " << it.second.size() << "\n";
+  if (per_time_step)
+    {
+      std::ofstream output(report_name + "-steps.csv");
+      output << "t[s],phase,wall_time[s]\n";
+    }
 }
 
-// DoFGradientEvaluation
-
-template <int dim>
 void
-DoFGradientEvaluation<dim>::clear()
+Profiler::enter(const std::string &name)
 {
-  dh = nullptr;
-  fields.clear();
-  gradients.clear();
+  timer_output.enter_subsection(name);
 }
 
-template <int dim>
 void
-DoFGradientEvaluation<dim>::add_field(const std::string &   name,
-                                      const Vector<double> &field)
+Profiler::leave(const std::string &name)
 {
-  fields[name] = field;
-  gradients.erase(name);
+  timer_output.leave_subsection(name);
+
+  // the memory is only reported in the summary
+  if (report_name.empty())
+    return;
+
+  Utilities::System::MemoryStats stats;
+  Utilities::System::get_memory_stats(stats);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  double &m = memory[name];
+  m         = std::max(m, stats.VmRSS / 1024.0);
 }
 
-template <int dim>
 void
-DoFGradientEvaluation<dim>::attach_dof_handler(
-  const DoFHandler<dim> &dof_handler)
+Profiler::add_count(const std::string &name, const double value)
 {
-  dh = &dof_handler;
+  std::lock_guard<std::mutex> lock(mutex);
+  counters[name] += value;
 }
 
-template <int dim>
 void
-DoFGradientEvaluation<dim>::calculate(const unsigned int n_quadrature_points)
+Profiler::end_time_step(const double t)
 {
-  const auto &      fe = dh->get_fe();
-  const QGauss<dim> quadrature(n_quadrature_points == 0 ? fe.degree + 1 :
-                                                          n_quadrature_points);
+  if (t == last_time)
+    return;
+  last_time = t;
 
-  const unsigned int n_dofs        = dh->n_dofs();
-  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-  const unsigned int n_q_points    = quadrature.size();
+  if (!per_time_step || report_name.empty())
+    return;
 
-  FEValues<dim> fe_values(fe, quadrature, update_gradients);
+  const auto wall_times =
+    timer_output.get_summary_data(TimerOutput::total_wall_time);
 
-  std::vector<unsigned int> count(n_dofs, 0);
+  std::ofstream output(report_name + "-steps.csv", std::ios::app);
+  output << std::setprecision(8);
+  for (const auto &it : wall_times)
+    {
+      const double dt_wall = it.second - last_wall_times[it.first];
+      if (dt_wall > 0)
+        output << t << ',' << it.first << ',' << dt_wall << '\n';
+    }
 
-  FullMatrix<double> qpoint_to_dof_matrix(dofs_per_cell, n_q_points);
-  FETools::compute_projection_from_quadrature_points_matrix(
-    fe, quadrature, quadrature, qpoint_to_dof_matrix);
+  last_wall_times = wall_times;
+}
+
+std::map<std::string, double>
+Profiler::get_wall_times() const
+{
+  return timer_output.get_summary_data(TimerOutput::total_wall_time);
+}
 
-  // gradient at quadrature points
-  std::vector<Tensor<1, dim>> grad_q(n_q_points, Tensor<1, dim>());
+std::map<std::string, double>
+Profiler::get_counters() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return counters;
+}
 
-  // gradient components at quadrature points and DoFs
-  Vector<double> grad_component_q(n_q_points);
-  Vector<double> grad_component_cell(dofs_per_cell);
+void
+Profiler::write_json(std::ostream &out) const
+{
+  const auto n_calls = timer_output.get_summary_data(TimerOutput::n_calls);
+  const auto wall_times =
+    timer_output.get_summary_data(TimerOutput::total_wall_time);
+  const auto cpu_times =
+    timer_output.get_summary_data(TimerOutput::total_cpu_time);
 
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+  std::lock_guard<std::mutex> lock(mutex);
 
-  // check data sizes and initialize gradients with zeros
-  for (const auto &it : fields)
+  out << std::setprecision(8);
+  out << "{\n  \"phases\": [";
+  for (auto it = n_calls.begin(); it != n_calls.end(); ++it)
     {
-      const auto &s = it.first;
-      const auto  n = fields[s].size();
-      AssertThrow(n == n_dofs,
-                  ExcMessage("DoFGradientEvaluation: field '" + s + "' size " +
-                             std::to_string(n) + " does not match n_dofs = " +
-                             std::to_string(n_dofs)));
-
-      gradients[s] = std::vector<Tensor<1, dim>>(n, Tensor<1, dim>());
+      const auto m = memory.find(it->first);
+      out << (it == n_calls.begin() ? "" : ",") << "\n    {\"name\": \""
+          << it->first << "\", \"calls\": " << it->second
+          << ", \"wall_time\": " << wall_times.at(it->first)
+          << ", \"cpu_time\": " << cpu_times.at(it->first)
+          << ", \"memory_MB\": " << (m != memory.end() ? m->second : 0)
+          << "}";
     }
-
-  typename DoFHandler<dim>::active_cell_iterator cell = dh->begin_active(),
-                                                 endc = dh->end();
-  for (; cell != endc; ++cell)
+  out << "\n  ],\n  \"counters\": {";
+  for (auto it = counters.begin(); it != counters.end(); ++it)
     {
-      fe_values.reinit(cell);
+      out << (it == counters.begin() ? "" : ",") << "\n    \"" << it->first
+          << "\": " << it->second;
+    }
+  out << "\n  }\n}\n";
+}
 
-      cell->get_dof_indices(local_dof_indices);
+void
+Profiler::write_csv(std::ostream &out) const
+{
+  const auto n_calls = timer_output.get_summary_data(TimerOutput::n_calls);
+  const auto wall_times =
+    timer_output.get_summary_data(TimerOutput::total_wall_time);
+  const auto cpu_times =
+    timer_output.get_summary_data(TimerOutput::total_cpu_time);
 
-      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-        count[local_dof_indices[i]] += 1;
+  std::lock_guard<std::mutex> lock(mutex);
 
-      for (auto &it : fields)
-        {
-          // calculate gradient at quadrature points for each field
-          fe_values.get_function_gradients(it.second, grad_q);
+  out << std::setprecision(8);
+  out << "name,calls,wall_time[s],cpu_time[s],memory[MB]\n";
+  for (const auto &it : n_calls)
+    {
+      const auto m = memory.find(it.first);
+      out << it.first << ',' << it.second << ',' << wall_times.at(it.first)
+          << ',' << cpu_times.at(it.first) << ','
+          << (m != memory.end() ? m->second : 0) << '\n';
+    }
 
-          std::vector<Tensor<1, dim>> &grad = gradients.at(it.first);
+  // counters have no times
+  for (const auto &it : counters)
+    out << it.first << ',' << it.second << ",,,\n";
+}
 
-          for (unsigned int k = 0; k < dim; ++k)
-            {
-              // setup a vector of k-th gradient component for each dimension
-              for (unsigned int q = 0; q < n_q_points; ++q)
-                grad_component_q[q] = grad_q[q][k];
+// CheckpointArchive
 
-              // extrapolate from quadrature points to DoFs
-              qpoint_to_dof_matrix.vmult(grad_component_cell, grad_component_q);
+unsigned int
+CheckpointArchive::get_format_version()
+{
+  return 1;
+}
 
-              // add result to global gradient
-              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                grad[local_dof_indices[i]][k] += grad_component_cell[i];
-            }
-        }
-    }
+std::string
+CheckpointArchive::get_file_name(const std::string &base_name,
+                                 const unsigned int i)
+{
+  return base_name + "-" + std::to_string(i) + ".bin";
+}
 
-  // average contributions from neighbouring cells
-  for (auto &it : gradients)
-    {
-      for (unsigned int i = 0; i < n_dofs; ++i)
-        {
-          AssertThrow(count[i] > 0,
-                      ExcMessage("count[" + std::to_string(i) +
-                                 "]=" + std::to_string(count[i]) +
-                                 ", positive value expected"));
+void
+CheckpointArchive::clear()
+{
+  sections.clear();
+}
+
+bool
+CheckpointArchive::has(const std::string &name) const
+{
+  return sections.find(name) != sections.end();
+}
 
-          it.second[i] /= count[i];
-        }
+std::vector<std::string>
+CheckpointArchive::get_names(const std::string &prefix) const
+{
+  std::vector<std::string> names;
+  for (const auto &it : sections)
+    {
+      if (it.first.compare(0, prefix.size(), prefix) == 0)
+        names.push_back(it.first.substr(prefix.size()));
     }
+  return names;
 }
 
-template <int dim>
-const std::vector<Tensor<1, dim>> &
-DoFGradientEvaluation<dim>::get_gradient(const std::string &name) const
+void
+CheckpointArchive::add_string(const std::string &name, const std::string &data)
 {
-  return gradients.at(name);
+  sections[name] = data;
 }
 
-// DoFFieldSmoother
+const std::string &
+CheckpointArchive::get_string(const std::string &name) const
+{
+  const auto it = sections.find(name);
+  AssertThrow(it != sections.end(),
+              ExcMessage("Checkpoint section '" + name + "' not found"));
+  return it->second;
+}
 
-template <int dim>
 void
-DoFFieldSmoother<dim>::clear()
+CheckpointArchive::add_value(const std::string &name, const double value)
 {
-  dh = nullptr;
-  fields.clear();
-  bc1.clear();
+  const char *p = reinterpret_cast<const char *>(&value);
+  add_string(name, std::string(p, p + sizeof(value)));
 }
 
-template <int dim>
-void
-DoFFieldSmoother<dim>::set_bc1(const unsigned int id)
+double
+CheckpointArchive::get_value(const std::string &name) const
 {
-  bc1.insert(id);
+  const std::string &data = get_string(name);
+  AssertThrow(data.size() == sizeof(double),
+              ExcMessage("Checkpoint section '" + name +
+                         "' is not a single value"));
+
+  double value;
+  std::copy(data.begin(), data.end(), reinterpret_cast<char *>(&value));
+  return value;
 }
 
-template <int dim>
+template <typename T>
 void
-DoFFieldSmoother<dim>::add_field(const std::string &   name,
-                                 const Vector<double> &field)
+CheckpointArchive::add_data(const std::string &name, const T &data)
 {
-  fields[name] = field;
+  std::ostringstream ss;
+  data.block_write(ss);
+  add_string(name, ss.str());
 }
 
-template <int dim>
+template <typename T>
 void
-DoFFieldSmoother<dim>::attach_dof_handler(const DoFHandler<dim> &dof_handler)
+CheckpointArchive::get_data(const std::string &name, T &data) const
 {
-  dh = &dof_handler;
+  std::istringstream ss(get_string(name));
+  data.block_read(ss);
 }
 
 template <int dim>
 void
-DoFFieldSmoother<dim>::calculate(const double relax,
-                                 const double relax_boundary,
-                                 SmoothType   st)
+CheckpointArchive::add_mesh(const std::string &       name,
+                            const Triangulation<dim> &triangulation)
 {
-  if (st == SmoothType::Cell)
-    smooth_cell(relax, relax_boundary);
-  else
-    Assert(st == SmoothType::None, ExcNotImplemented());
+  std::ostringstream              ss;
+  boost::archive::binary_oarchive oa(ss);
+  oa << triangulation;
+  add_string(name, ss.str());
 }
 
 template <int dim>
 void
-DoFFieldSmoother<dim>::smooth_cell(const double relax,
-                                   const double relax_boundary)
+CheckpointArchive::get_mesh(const std::string & name,
+                            Triangulation<dim> &triangulation) const
 {
-  const auto &fe = dh->get_fe();
-
-  const unsigned int n_dofs        = dh->n_dofs();
-  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-
-  std::vector<unsigned int> count(n_dofs, 0);
+  std::istringstream              ss(get_string(name));
+  boost::archive::binary_iarchive ia(ss);
+  ia >> triangulation;
+}
 
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+void
+CheckpointArchive::write(const std::string &base_name,
+                         const unsigned int n_keep) const
+{
+  AssertThrow(n_keep >= 1, ExcMessage("At least one checkpoint must be kept"));
 
-  std::map<std::string, Vector<double>> fields_new;
+  std::ostringstream payload;
+  for (const auto &it : sections)
+    {
+      const std::uint64_t name_size = it.first.size();
+      const std::uint64_t data_size = it.second.size();
+      payload.write(reinterpret_cast<const char *>(&name_size),
+                    sizeof(name_size));
+      payload << it.first;
+      payload.write(reinterpret_cast<const char *>(&data_size),
+                    sizeof(data_size));
+      payload << it.second;
+    }
 
-  for (const auto &it : fields)
-    fields_new[it.first].reinit(n_dofs);
+  const std::string   data      = payload.str();
+  const std::uint32_t version   = get_format_version();
+  const std::uint64_t data_size = data.size();
+  const std::uint64_t hash      = checksum(data);
 
-  std::vector<bool> all_boundary_dofs(n_dofs, false);
-  DoFTools::extract_boundary_dofs(*dh, ComponentMask(), all_boundary_dofs);
+  const std::string tmp_name = base_name + "-tmp.bin";
+  {
+    std::ofstream f(tmp_name, std::ios::binary);
+    f << "MACPLAS-CHECKPOINT\n";
+    f.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    f.write(reinterpret_cast<const char *>(&data_size), sizeof(data_size));
+    f.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    f << data;
+    f.close();
+
+    AssertThrow(f, ExcMessage("Cannot write checkpoint '" + tmp_name + "'"));
+  }
 
-  typename DoFHandler<dim>::active_cell_iterator cell = dh->begin_active(),
-                                                 endc = dh->end();
-  for (; cell != endc; ++cell)
+  // rotate the older checkpoints, the oldest one is overwritten
+  for (unsigned int i = n_keep - 1; i > 0; --i)
     {
-      cell->get_dof_indices(local_dof_indices);
+      const std::string old_name = get_file_name(base_name, i - 1);
+      const std::string new_name = get_file_name(base_name, i);
 
-      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-        count[local_dof_indices[i]] += 1;
+      // not all backups exist after the first checkpoints
+      if (!std::ifstream(old_name).is_open())
+        continue;
 
-      for (const auto &it : fields)
-        {
-          const Vector<double> &f = it.second;
+      AssertThrow(std::rename(old_name.c_str(), new_name.c_str()) == 0,
+                  ExcMessage("Cannot rename checkpoint '" + old_name +
+                             "' to '" + new_name + "'"));
+    }
 
-          // average value in cell
-          double f_cell = 0;
-          for (unsigned int i = 0; i < dofs_per_cell; ++i)
-            f_cell += f[local_dof_indices[i]];
-          f_cell /= dofs_per_cell;
+  const std::string file_name = get_file_name(base_name, 0);
+  AssertThrow(std::rename(tmp_name.c_str(), file_name.c_str()) == 0,
+              ExcMessage("Cannot rename checkpoint '" + tmp_name + "' to '" +
+                         file_name + "'"));
+}
+
+std::string
+CheckpointArchive::read(const std::string &base_name,
+                        const unsigned int n_keep)
+{
+  for (unsigned int i = 0; i < n_keep; ++i)
+    {
+      const std::string file_name = get_file_name(base_name, i);
+      const std::string error     = read_file(file_name);
 
-          Vector<double> &f_new = fields_new.at(it.first);
+      if (error.empty())
+        return file_name;
 
-          for (unsigned int i = 0; i < dofs_per_cell; ++i)
-            {
-              const unsigned int j = local_dof_indices[i];
-              const double r = all_boundary_dofs[j] ? relax_boundary : relax;
-              f_new[j] += r * f_cell + (1 - r) * f[j];
-            }
-        }
+      Logger::get_default().warning()
+        << "Skipping checkpoint '" << file_name << "': " << error << "\n";
     }
 
-  // average contributions from neighbouring cells
-  for (auto &it : fields_new)
-    {
-      for (unsigned int i = 0; i < n_dofs; ++i)
-        {
-          AssertThrow(count[i] > 0,
-                      ExcMessage("count[" + std::to_string(i) +
-                                 "]=" + std::to_string(count[i]) +
-                                 ", positive value expected"));
+  clear();
+  return "";
+}
 
-          it.second[i] /= count[i];
-        }
-    }
+std::string
+CheckpointArchive::read_file(const std::string &file_name)
+{
+  clear();
 
-  // apply Dirichlet boundary conditions
-  for (const auto &b : bc1)
+  std::ifstream f(file_name, std::ios::binary);
+  if (!f.is_open())
+    return "file not found";
+
+  std::string magic;
+  std::getline(f, magic);
+  if (magic != "MACPLAS-CHECKPOINT")
+    return "not a checkpoint file";
+
+  std::uint32_t version   = 0;
+  std::uint64_t data_size = 0;
+  std::uint64_t hash      = 0;
+  f.read(reinterpret_cast<char *>(&version), sizeof(version));
+  f.read(reinterpret_cast<char *>(&data_size), sizeof(data_size));
+  f.read(reinterpret_cast<char *>(&hash), sizeof(hash));
+  if (!f)
+    return "truncated header";
+
+  if (version != get_format_version())
+    return "unsupported format version " + std::to_string(version);
+
+  // the size comes from the file, validate it before allocating the buffer
+  const std::streampos data_begin = f.tellg();
+  f.seekg(0, std::ios::end);
+  const std::streamoff remaining = f.tellg() - data_begin;
+  f.seekg(data_begin);
+  if (!f || remaining < 0 ||
+      data_size != static_cast<std::uint64_t>(remaining))
+    return "invalid data size";
+
+  std::string data(data_size, '\0');
+  f.read(&data[0], data_size);
+  if (!f)
+    return "truncated data";
+
+  if (checksum(data) != hash)
+    return "checksum mismatch";
+
+  std::istringstream payload(data);
+  std::uint64_t      position = 0;
+  while (payload.peek() != std::char_traits<char>::eof())
     {
-      std::vector<bool> boundary_dofs(n_dofs, false);
-
-      DoFTools::extract_boundary_dofs(*dh,
-                                      ComponentMask(),
-                                      boundary_dofs,
-                                      {static_cast<types::boundary_id>(b)});
+      std::uint64_t name_size = 0, section_size = 0;
 
-      for (const auto &it : fields)
+      payload.read(reinterpret_cast<char *>(&name_size), sizeof(name_size));
+      position += sizeof(name_size);
+      if (!payload || name_size > data_size - position)
+        {
+          clear();
+          return "invalid section name size";
+        }
+      std::string name(name_size, '\0');
+      payload.read(&name[0], name_size);
+      position += name_size;
+
+      payload.read(reinterpret_cast<char *>(&section_size),
+                   sizeof(section_size));
+      position += sizeof(section_size);
+      if (!payload || section_size > data_size - position)
         {
-          Vector<double> &f_new = fields_new.at(it.first);
+          clear();
+          return "invalid section '" + name + "'";
+        }
+      std::string section(section_size, '\0');
+      payload.read(&section[0], section_size);
+      position += section_size;
 
-          for (unsigned int i = 0; i < n_dofs; ++i)
-            {
-              if (boundary_dofs[i])
-                f_new[i] = it.second[i];
-            }
+      if (!payload)
+        {
+          clear();
+          return "invalid section '" + name + "'";
         }
+
+      sections[name].swap(section);
     }
 
-  fields = fields_new;
+  return "";
 }
 
-template <int dim>
-const Vector<double> &
-DoFFieldSmoother<dim>::get_field(const std::string &name) const
+std::uint64_t
+CheckpointArchive::checksum(const std::string &data)
 {
-  return fields.at(name);
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (const char c : data)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ULL;
+    }
+  return hash;
 }
 
 namespace
@@ -2545,8 +7763,15 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
   DoFHandler<dim> dof_handler(triangulation);
   dof_handler.distribute_dofs(q1);
 
+  // the hanging vertices follow their parent vertices
+  HangingNodeConstraints hanging_node_constraints;
+  DoFTools::make_hanging_node_constraints(dof_handler,
+                                          hanging_node_constraints);
+  hanging_node_constraints.close();
+
   DynamicSparsityPattern dsp(dof_handler.n_dofs(), dof_handler.n_dofs());
   DoFTools::make_sparsity_pattern(dof_handler, dsp);
+  hanging_node_constraints.condense(dsp);
   dsp.compress();
 
   SparsityPattern sparsity_pattern;
@@ -2559,6 +7784,7 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
 
   MatrixCreator::create_laplace_matrix(
     StaticMappingQ1<dim>::mapping, dof_handler, quadrature, S, coefficient);
+  hanging_node_constraints.condense(S);
 
   // set up the boundary values for the laplace problem
   std::map<types::global_dof_index, double>                   fixed_dofs[dim];
@@ -2582,7 +7808,9 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
           const typename std::map<unsigned int, Point<dim>>::const_iterator
             map_iter = new_points.find(vertex_index);
 
-          if (map_iter != map_end)
+          if (map_iter != map_end &&
+              !hanging_node_constraints.is_constrained(
+                cell->vertex_dof_index(vertex_no, 0)))
             for (unsigned int i = 0; i < dim; ++i)
               fixed_dofs[i].insert(std::pair<types::global_dof_index, double>(
                 cell->vertex_dof_index(vertex_no, 0),
@@ -2603,6 +7831,9 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
     tasks += Threads::new_task(&laplace_solve, S, fixed_dofs[i], us[i], tol);
   tasks.join_all();
 
+  for (unsigned int i = 0; i < dim; ++i)
+    hanging_node_constraints.distribute(us[i]);
+
   // change the coordinates of the points of the triangulation
   // according to the computed values
   std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
@@ -2652,8 +7883,11 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
   MatrixCreator::create_laplace_matrix(
     StaticMappingQ1<dim>::mapping, dof_handler, quadrature, S, coefficient);
 
-  // set up the boundary values for the laplace problem
+  // set up the boundary values for the laplace problem, the hanging
+  // vertices follow their parent vertices
   std::array<AffineConstraints<double>, dim> constraints;
+  for (unsigned int i = 0; i < dim; ++i)
+    DoFTools::make_hanging_node_constraints(dof_handler, constraints[i]);
   typename std::map<unsigned int, Point<dim>>::const_iterator map_end =
     new_points.end();
 
@@ -2672,7 +7906,9 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
           const typename std::map<unsigned int, Point<dim>>::const_iterator
             map_iter = new_points.find(vertex_index);
 
-          if (map_iter != map_end)
+          if (map_iter != map_end &&
+              !constraints[0].is_constrained(
+                cell->vertex_dof_index(vertex_no, 0)))
             for (unsigned int i = 0; i < dim; ++i)
               {
                 constraints[i].add_line(cell->vertex_dof_index(vertex_no, 0));
@@ -2723,4 +7959,342 @@ laplace_transform(const std::map<unsigned int, Point<dim>> &new_points,
 }
 #endif
 
+
+// MeshMotion
+
+template <int dim>
+MeshMotion<dim>::MeshMotion()
+  : solver_type("CG")
+  , tolerance(1e-10)
+{}
+
+template <int dim>
+void
+MeshMotion<dim>::clear()
+{
+  vertex_dofs.clear();
+  fixed_vertices.clear();
+  hanging_node_constraints.clear();
+  system_matrix.clear();
+  laplace_matrix.clear();
+  sparsity_pattern.reinit(0, 0, 0);
+  direct_solver.clear();
+  preconditioner.clear();
+  for (auto &d : displacement)
+    d.reinit(0);
+}
+
+template <int dim>
+void
+MeshMotion<dim>::set_solver(const std::string &type, const double tol)
+{
+  AssertThrow(type == "UMFPACK" || type == "CG",
+              ExcMessage("MeshMotion: unsupported solver type '" + type +
+                         "'"));
+
+  if (type != solver_type)
+    clear();
+
+  solver_type = type;
+  tolerance   = tol;
+}
+
+template <int dim>
+bool
+MeshMotion<dim>::is_up_to_date(
+  const std::map<unsigned int, Point<dim>> &new_points,
+  const Triangulation<dim> &                triangulation) const
+{
+  if (vertex_dofs.size() != triangulation.n_vertices() ||
+      fixed_vertices.size() != new_points.size())
+    return false;
+
+  unsigned int i = 0;
+  for (const auto &it : new_points)
+    {
+      if (it.first != fixed_vertices[i])
+        return false;
+      ++i;
+    }
+
+  return true;
+}
+
+template <int dim>
+void
+MeshMotion<dim>::setup(const std::map<unsigned int, Point<dim>> &new_points,
+                       const Triangulation<dim> &                triangulation)
+{
+  clear();
+
+  FE_Q<dim> q1(1);
+
+  DoFHandler<dim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(q1);
+  const unsigned int n_dofs = dof_handler.n_dofs();
+
+  vertex_dofs.resize(triangulation.n_vertices(),
+                     numbers::invalid_dof_index);
+  for (const auto &cell : dof_handler.active_cell_iterators())
+    for (unsigned int vertex_no = 0;
+         vertex_no < GeometryInfo<dim>::vertices_per_cell;
+         ++vertex_no)
+      vertex_dofs[cell->vertex_index(vertex_no)] =
+        cell->vertex_dof_index(vertex_no, 0);
+
+  DoFTools::make_hanging_node_constraints(dof_handler,
+                                          hanging_node_constraints);
+  hanging_node_constraints.close();
+
+  DynamicSparsityPattern dsp(n_dofs, n_dofs);
+  DoFTools::make_sparsity_pattern(dof_handler, dsp);
+  hanging_node_constraints.condense(dsp);
+
+  sparsity_pattern.copy_from(dsp);
+  sparsity_pattern.compress();
+
+  laplace_matrix.reinit(sparsity_pattern);
+
+  MatrixCreator::create_laplace_matrix(StaticMappingQ1<dim>::mapping,
+                                       dof_handler,
+                                       QGauss<dim>(4),
+                                       laplace_matrix);
+
+  // hanging vertices are not prescribed, they follow their parent vertices
+  std::vector<bool> fixed(n_dofs, false);
+  for (const auto &it : new_points)
+    {
+      fixed_vertices.push_back(it.first);
+
+      const types::global_dof_index k = vertex_dofs[it.first];
+      fixed[k] = !hanging_node_constraints.is_constrained(k);
+    }
+
+  // eliminate the hanging and the prescribed DoFs, keeping the matrix
+  // symmetric
+  system_matrix.reinit(sparsity_pattern);
+  system_matrix.copy_from(laplace_matrix);
+  hanging_node_constraints.condense(system_matrix);
+  for (unsigned int i = 0; i < n_dofs; ++i)
+    for (auto it = system_matrix.begin(i); it != system_matrix.end(i); ++it)
+      if ((fixed[i] || fixed[it->column()]) && it->column() != i)
+        it->value() = 0;
+
+  if (solver_type == "UMFPACK")
+    direct_solver.initialize(system_matrix);
+  else
+    preconditioner.initialize(system_matrix, 1.2);
+
+  for (auto &d : displacement)
+    d.reinit(n_dofs);
+}
+
+template <int dim>
+void
+MeshMotion<dim>::move(const std::map<unsigned int, Point<dim>> &new_points,
+                      Triangulation<dim> &triangulation)
+{
+  if (!is_up_to_date(new_points, triangulation))
+    setup(new_points, triangulation);
+
+  const std::vector<Point<dim>> &vertices = triangulation.get_vertices();
+  const unsigned int             n_dofs   = system_matrix.m();
+
+  auto solve_component = [&](const unsigned int i) {
+    // prescribed displacements
+    Vector<double> u_fixed(n_dofs);
+    for (const auto &it : new_points)
+      {
+        const types::global_dof_index k = vertex_dofs[it.first];
+        if (!hanging_node_constraints.is_constrained(k))
+          u_fixed[k] = it.second[i] - vertices[it.first][i];
+      }
+    // the lifting must satisfy the constraints, the hanging DoFs depend on
+    // the prescribed ones
+    hanging_node_constraints.distribute(u_fixed);
+
+    Vector<double> rhs(n_dofs);
+    laplace_matrix.vmult(rhs, u_fixed);
+    rhs *= -1;
+    hanging_node_constraints.condense(rhs);
+
+    Vector<double> &u = displacement[i];
+    for (const auto &it : new_points)
+      {
+        const types::global_dof_index k = vertex_dofs[it.first];
+        if (hanging_node_constraints.is_constrained(k))
+          continue;
+
+        rhs[k] = system_matrix.diag_element(k) * u_fixed[k];
+        u[k]   = u_fixed[k];
+      }
+
+    if (solver_type == "UMFPACK")
+      {
+        direct_solver.vmult(u, rhs);
+      }
+    else
+      {
+        SolverControl            control(n_dofs, tolerance, false, false);
+        SolverCG<Vector<double>> solver(control);
+        solver.solve(system_matrix, u, rhs, preconditioner);
+      }
+
+    hanging_node_constraints.distribute(u);
+  };
+
+  if (solver_type == "UMFPACK")
+    {
+      // the factorization is shared, solve sequentially
+      for (unsigned int i = 0; i < dim; ++i)
+        solve_component(i);
+    }
+  else
+    {
+      // solve linear systems in parallel
+      Threads::TaskGroup<> tasks;
+      for (unsigned int i = 0; i < dim; ++i)
+        tasks += Threads::new_task(
+          std::function<void()>([&solve_component, i]() {
+            solve_component(i);
+          }));
+      tasks.join_all();
+    }
+
+  std::vector<Point<dim>> vertices_new = vertices;
+  for (unsigned int j = 0; j < vertices_new.size(); ++j)
+    if (vertex_dofs[j] != numbers::invalid_dof_index)
+      for (unsigned int i = 0; i < dim; ++i)
+        vertices_new[j][i] += displacement[i][vertex_dofs[j]];
+
+  set_vertices(triangulation, vertices_new);
+}
+
+template <int dim>
+void
+MeshMotion<dim>::set_vertices(Triangulation<dim> &           triangulation,
+                              const std::vector<Point<dim>> &vertices)
+{
+  AssertDimension(vertices.size(), triangulation.n_vertices());
+
+  std::vector<bool> vertex_touched(triangulation.n_vertices(), false);
+  for (const auto &cell : triangulation.active_cell_iterators())
+    for (unsigned int vertex_no = 0;
+         vertex_no < GeometryInfo<dim>::vertices_per_cell;
+         ++vertex_no)
+      {
+        const unsigned int j = cell->vertex_index(vertex_no);
+        if (!vertex_touched[j])
+          {
+            cell->vertex(vertex_no) = vertices[j];
+            vertex_touched[j]       = true;
+          }
+      }
+}
+
+// FieldTransfer
+
+template <int dim>
+FieldTransfer<dim>::FieldTransfer(const DoFHandler<dim> &dh)
+  : dh(dh)
+{}
+
+template <int dim>
+unsigned int
+FieldTransfer<dim>::add(const Vector<double> &field)
+{
+  AssertThrow(!is_prepared(),
+              ExcMessage("FieldTransfer: cannot add fields after prepare"));
+  AssertDimension(field.size(), dh.n_dofs());
+
+  fields_old.push_back(field);
+
+  return fields_old.size() - 1;
+}
+
+template <int dim>
+void
+FieldTransfer<dim>::add(const FieldStore &store)
+{
+  for (const auto &it : store)
+    {
+      if (it.second->size() != dh.n_dofs())
+        continue;
+
+      store_names.push_back(it.first);
+      store_indices.push_back(add(*it.second));
+    }
+}
+
+template <int dim>
+void
+FieldTransfer<dim>::prepare()
+{
+  solution_transfer.reset(new SolutionTransfer<dim, Vector<double>>(dh));
+  solution_transfer->prepare_for_coarsening_and_refinement(fields_old);
+}
+
+template <int dim>
+void
+FieldTransfer<dim>::interpolate(const HangingNodeConstraints &constraints)
+{
+  AssertThrow(is_prepared(),
+              ExcMessage("FieldTransfer: interpolate called before prepare"));
+
+  fields_new.resize(fields_old.size());
+  for (auto &f : fields_new)
+    f.reinit(dh.n_dofs());
+
+  solution_transfer->interpolate(fields_old, fields_new);
+
+  for (auto &f : fields_new)
+    constraints.distribute(f);
+}
+
+template <int dim>
+void
+FieldTransfer<dim>::get(const unsigned int i, Vector<double> &field)
+{
+  AssertIndexRange(i, fields_new.size());
+
+  field.swap(fields_new[i]);
+}
+
+template <int dim>
+void
+FieldTransfer<dim>::get(FieldStore &store)
+{
+  for (const auto &name : store.get_names())
+    {
+      if (std::find(store_names.begin(), store_names.end(), name) ==
+          store_names.end())
+        store.erase(name);
+    }
+
+  for (unsigned int i = 0; i < store_names.size(); ++i)
+    {
+      AssertIndexRange(store_indices[i], fields_new.size());
+
+      store.set(store_names[i], std::move(fields_new[store_indices[i]]));
+    }
+}
+
+template <int dim>
+void
+FieldTransfer<dim>::clear()
+{
+  solution_transfer.reset();
+  fields_old.clear();
+  fields_new.clear();
+  store_names.clear();
+  store_indices.clear();
+}
+
+template <int dim>
+bool
+FieldTransfer<dim>::is_prepared() const
+{
+  return static_cast<bool>(solution_transfer);
+}
+
 #endif
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/manifold_lib.h>
 
+#include <cstdio>
+#include <fstream>
+
 #include "../../include/temperature_solver.h"
 #include "../../include/utilities.h"
 
@@ -22,6 +25,14 @@ private:
   void
   initialize();
 
+  void
+  test_vtu_formats(const SurfaceInterpolator3D & surf,
+                   const std::vector<Point<dim>> &points,
+                   const std::vector<bool> &      boundary_dofs) const;
+
+  void
+  test_file_cache() const;
+
   CylindricalManifold<dim> manifold;
 
   TemperatureSolver<dim>     solver;
@@ -111,6 +122,9 @@ Problem<dim>::initialize()
   surf.interpolate(
     SurfaceInterpolator3D::PointField, "q", points, boundary_dofs, q);
 
+  test_vtu_formats(surf, points, boundary_dofs);
+  test_file_cache();
+
   std::function<double(const double)> zero = [=](const double) { return 0; };
   solver.set_bc_rad_mixed(boundary_id, q, zero, zero);
 
@@ -134,6 +148,93 @@ Problem<dim>::initialize()
   solver2.set_bc_rad_mixed(boundary_id, q, zero, zero);
 }
 
+template <int dim>
+void
+Problem<dim>::test_vtu_formats(const SurfaceInterpolator3D & surf,
+                               const std::vector<Point<dim>> &points,
+                               const std::vector<bool> &boundary_dofs) const
+{
+  const std::vector<std::pair<SurfaceInterpolator3D::VTUFormat, std::string>>
+    formats = {{SurfaceInterpolator3D::AsciiVTU, "ascii"},
+               {SurfaceInterpolator3D::BinaryVTU, "binary"},
+#ifdef DEAL_II_WITH_ZLIB
+               {SurfaceInterpolator3D::CompressedVTU, "compressed"},
+#endif
+               {SurfaceInterpolator3D::AppendedVTU, "appended"}};
+
+  const std::vector<std::pair<SurfaceInterpolator3D::FieldType, std::string>>
+    fields = {{SurfaceInterpolator3D::PointField, "q"},
+              {SurfaceInterpolator3D::CellField, "q"},
+              {SurfaceInterpolator3D::PointField, "q_from_cell"},
+              {SurfaceInterpolator3D::CellField, "q_from_point"}};
+
+  for (const auto &format : formats)
+    {
+      const std::string file_name = "q-" + format.second + ".vtu";
+      surf.write_vtu(file_name, format.first);
+
+      SurfaceInterpolator3D surf_read;
+      surf_read.read_vtu(file_name);
+
+      for (const auto &field : fields)
+        {
+          Vector<double> q(points.size()), q_read(points.size());
+          surf.interpolate(
+            field.first, field.second, points, boundary_dofs, q);
+          surf_read.interpolate(
+            field.first, field.second, points, boundary_dofs, q_read);
+
+          const double q_max = q.linfty_norm();
+          q_read -= q;
+
+          std::cout << file_name << ": max difference of '" << field.second
+                    << "' " << q_read.linfty_norm() << "\n";
+
+          AssertThrow(q_read.linfty_norm() <= 1e-10 * q_max,
+                      ExcMessage(file_name + ": field '" + field.second +
+                                 "' changed by writing and reading"));
+        }
+    }
+}
+
+template <int dim>
+void
+Problem<dim>::test_file_cache() const
+{
+  const std::string file_name = "f-cache.txt";
+
+  // the data are cached at the first read, each rewrite keeps the size
+  const std::vector<std::pair<std::string, bool>> versions = {
+    {"1", false}, // initial
+    {"1", false}, // unchanged, taken from the cache
+    {"2", false}, // rewritten in place immediately
+    {"3", true},  // replaced by another file
+  };
+
+  for (const auto &version : versions)
+    {
+      const std::string name = version.second ? "f-cache-new.txt" : file_name;
+      {
+        std::ofstream out(name);
+        out << "0 " << version.first << "\n1 " << version.first << "\n";
+      }
+      if (version.second)
+        std::rename(name.c_str(), file_name.c_str());
+
+      std::unique_ptr<Function<1>> f;
+      initialize_function(f, file_name);
+
+      const double value    = f->value(Point<1>(0.5));
+      const double expected = std::stod(version.first);
+
+      std::cout << file_name << ": f(0.5)=" << value << " expected "
+                << expected << "\n";
+
+      AssertThrow(std::abs(value - expected) <= 1e-12,
+                  ExcMessage(file_name + ": change not detected by cache"));
+    }
+}
+
 int
 main()
 {
@@ -0,0 +1,216 @@
+#include <deal.II/grid/grid_generator.h>
+
+#include "../../include/temperature_solver.h"
+#include "../../include/utilities.h"
+
+using namespace dealii;
+
+template <int dim>
+class Problem
+{
+public:
+  explicit Problem(const unsigned int order);
+
+  void
+  run();
+
+private:
+  void
+  make_grid();
+
+  void
+  refine_and_transfer();
+
+  void
+  move_mesh(const std::string &method);
+
+  Point<dim>
+  moved_point(const Point<dim> &p) const;
+
+  double
+  exact_solution(const Point<dim> &p) const;
+
+  TemperatureSolver<dim> solver;
+};
+
+template <int dim>
+Problem<dim>::Problem(const unsigned int order)
+  : solver(order, true)
+{}
+
+template <int dim>
+void
+Problem<dim>::run()
+{
+  make_grid();
+  refine_and_transfer();
+
+  move_mesh("UMFPACK");
+  move_mesh("CG");
+  move_mesh("laplace_transform");
+}
+
+template <int dim>
+void
+Problem<dim>::make_grid()
+{
+  Triangulation<dim> &triangulation = solver.get_mesh();
+  GridGenerator::hyper_cube(triangulation, 0, 1, true);
+
+  triangulation.refine_global(2);
+
+  solver.initialize();
+
+  std::vector<Point<dim>> points;
+  solver.get_support_points(points);
+
+  Vector<double> &temperature = solver.get_temperature();
+  for (unsigned int i = 0; i < points.size(); ++i)
+    temperature[i] = exact_solution(points[i]);
+}
+
+template <int dim>
+void
+Problem<dim>::refine_and_transfer()
+{
+  Triangulation<dim> &triangulation = solver.get_mesh();
+
+  // refine twice near the origin to get hanging nodes on two levels
+  for (unsigned int k = 0; k < 2; ++k)
+    {
+      for (const auto &cell : triangulation.active_cell_iterators())
+        if (cell->center().norm() < 0.5)
+          cell->set_refine_flag();
+
+      solver.prepare_for_refinement();
+      triangulation.execute_coarsening_and_refinement();
+      solver.finish_refinement();
+    }
+
+  std::vector<Point<dim>> points;
+  solver.get_support_points(points);
+
+  const Vector<double> &temperature = solver.get_temperature();
+  AssertThrow(temperature.size() == points.size(),
+              ExcMessage("Temperature is not transferred to the new mesh"));
+
+  double max_error = 0;
+  for (unsigned int i = 0; i < points.size(); ++i)
+    max_error =
+      std::max(max_error, std::abs(temperature[i] - exact_solution(points[i])));
+
+  std::cout << "Number of active cells: " << triangulation.n_active_cells()
+            << "\n"
+            << "Max transfer error: " << max_error << " K\n";
+
+  AssertThrow(max_error < 1e-8,
+              ExcMessage("Linear field is not transferred exactly"));
+}
+
+template <int dim>
+void
+Problem<dim>::move_mesh(const std::string &method)
+{
+  Triangulation<dim> triangulation;
+  triangulation.copy_triangulation(solver.get_mesh());
+
+  // move the whole boundary, including the refined faces at x=0 and y=0
+  std::map<unsigned int, Point<dim>> new_points;
+  for (const auto &cell : triangulation.active_cell_iterators())
+    for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+      {
+        if (!cell->face(f)->at_boundary())
+          continue;
+
+        for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_face; ++v)
+          new_points[cell->face(f)->vertex_index(v)] =
+            moved_point(cell->face(f)->vertex(v));
+      }
+
+  const std::vector<Point<dim>> vertices_old = triangulation.get_vertices();
+
+  if (method == "laplace_transform")
+    laplace_transform(new_points, triangulation);
+  else
+    {
+      MeshMotion<dim> mesh_motion;
+      mesh_motion.set_solver(method);
+      mesh_motion.move(new_points, triangulation);
+    }
+
+  // the displacement is linear, the Laplace solution reproduces it exactly
+  // at all interior vertices, including the hanging ones
+  const std::vector<Point<dim>> &vertices = triangulation.get_vertices();
+  const std::vector<bool> &      used     = triangulation.get_used_vertices();
+
+  double max_error = 0;
+  for (unsigned int j = 0; j < vertices.size(); ++j)
+    if (used[j] && new_points.find(j) == new_points.end())
+      max_error = std::max(max_error,
+                           vertices[j].distance(moved_point(vertices_old[j])));
+
+  std::cout << method << ": max error of interior vertices: " << max_error
+            << " m\n";
+
+  AssertThrow(max_error < 1e-6,
+              ExcMessage(method + ": linear mesh motion is not reproduced"));
+}
+
+template <int dim>
+Point<dim>
+Problem<dim>::moved_point(const Point<dim> &p) const
+{
+  // affine map with a nonzero displacement everywhere on the boundary
+  Point<dim> q = p;
+  q[0] += 0.1 + 0.2 * p[1];
+  q[1] += -0.05 + 0.1 * p[0];
+  if (dim == 3)
+    q[2] += 0.05 * p[0] - 0.1 * p[1];
+
+  return q;
+}
+
+template <int dim>
+double
+Problem<dim>::exact_solution(const Point<dim> &p) const
+{
+  double T = 1000;
+  for (unsigned int i = 0; i < dim; ++i)
+    T += 100 * (i + 1) * p[i];
+
+  return T;
+}
+
+int
+main(int argc, char *argv[])
+{
+  const std::vector<std::string> arguments(argv, argv + argc);
+
+  int          dimension = 2;
+  unsigned int order     = 2;
+
+  for (unsigned int i = 1; i < arguments.size(); ++i)
+    {
+      if (arguments[i] == "2d" || arguments[i] == "2D")
+        dimension = 2;
+      if (arguments[i] == "3d" || arguments[i] == "3D")
+        dimension = 3;
+      if (arguments[i] == "order" && i + 1 < arguments.size())
+        order = std::stoi(arguments[i + 1]);
+    }
+
+  if (dimension == 2)
+    {
+      Problem<2> p2(order);
+      p2.run();
+    }
+  else if (dimension == 3)
+    {
+      Problem<3> p3(order);
+      p3.run();
+    }
+
+  std::cout << "Finished\n";
+
+  return 0;
+}
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+./macplas-test-9 2D
+./macplas-test-9 2D order 1
+./macplas-test-9 3D